@@ -0,0 +1,171 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "api/api_routes.h"
+
+#include "cJSON.h"
+
+#include "app_events.h"
+#include "ha/ha_history.h"
+#include "ha/ha_ws_rx_pool.h"
+#include "ui/ui_runtime.h"
+#include "ui/ui_widget_factory.h"
+#include "ui/ui_widget_pool.h"
+
+static void set_json_headers(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+}
+
+static cJSON *ws_rx_to_json(void)
+{
+    ha_ws_rx_pool_stats_t stats = {0};
+    ha_ws_rx_pool_get_stats(&stats);
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "slab_size", (double)stats.slab_size);
+    cJSON_AddNumberToObject(obj, "slab_count", (double)stats.slab_count);
+    cJSON_AddNumberToObject(obj, "slabs_in_use", (double)stats.slabs_in_use);
+    cJSON_AddNumberToObject(obj, "slabs_high_water", (double)stats.slabs_high_water);
+    cJSON_AddNumberToObject(obj, "messages_in_flight", (double)stats.messages_in_flight);
+    cJSON_AddNumberToObject(obj, "reserved_total", (double)stats.reserved_total);
+    cJSON_AddNumberToObject(obj, "reserve_failures", (double)stats.reserve_failures);
+    cJSON_AddNumberToObject(obj, "dropped_oldest", (double)stats.dropped_oldest);
+    cJSON_AddNumberToObject(obj, "dropped_full", (double)stats.dropped_full);
+    cJSON_AddNumberToObject(obj, "dropped_oversize", (double)stats.dropped_oversize);
+    return obj;
+}
+
+static cJSON *app_events_to_json(void)
+{
+    static const char *const lane_names[APP_EVENT_LANE_COUNT] = {
+        [APP_EVENT_LANE_USER] = "user",
+        [APP_EVENT_LANE_BACKGROUND] = "background",
+    };
+    app_events_stats_t stats = {0};
+    app_events_get_stats(&stats);
+
+    cJSON *obj = cJSON_CreateObject();
+    for (size_t lane = 0; lane < APP_EVENT_LANE_COUNT; lane++) {
+        const app_events_lane_stats_t *lane_stats = &stats.lanes[lane];
+        cJSON *entry = cJSON_AddObjectToObject(obj, lane_names[lane]);
+        cJSON_AddNumberToObject(entry, "queued", (double)lane_stats->queued);
+        cJSON_AddNumberToObject(entry, "dropped", (double)lane_stats->dropped);
+        cJSON_AddNumberToObject(entry, "queue_depth", (double)lane_stats->queue_depth);
+        cJSON_AddNumberToObject(entry, "queue_high_water", (double)lane_stats->queue_high_water);
+        cJSON_AddNumberToObject(entry, "state_marks", (double)lane_stats->state_marks);
+        cJSON_AddNumberToObject(entry, "dirty_high_water", (double)lane_stats->dirty_high_water);
+    }
+    return obj;
+}
+
+static cJSON *ui_frames_to_json(void)
+{
+    ui_runtime_stats_t stats = {0};
+    ui_runtime_get_stats(&stats);
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "frames", (double)stats.frames);
+    cJSON_AddNumberToObject(obj, "lock_timeouts", (double)stats.lock_timeouts);
+    cJSON_AddNumberToObject(obj, "entities_applied", (double)stats.entities_applied);
+    cJSON_AddNumberToObject(obj, "reconciles", (double)stats.reconciles);
+    cJSON_AddNumberToObject(obj, "reconcile_entities", (double)stats.reconcile_entities);
+    cJSON_AddNumberToObject(obj, "hidden_deferred", (double)stats.hidden_deferred);
+    cJSON_AddNumberToObject(obj, "page_catchups", (double)stats.page_catchups);
+    cJSON_AddNumberToObject(obj, "resident_pages", (double)stats.resident_pages);
+    cJSON_AddNumberToObject(obj, "materialized_widgets", (double)stats.materialized_widgets);
+    cJSON_AddNumberToObject(obj, "layout_lock_last_ms", (double)stats.layout_lock_last_ms);
+    cJSON_AddNumberToObject(obj, "layout_lock_max_ms", (double)stats.layout_lock_max_ms);
+    cJSON_AddNumberToObject(obj, "layout_build_slices", (double)stats.layout_build_slices);
+    cJSON *latency = cJSON_AddObjectToObject(obj, "latency_ms");
+    cJSON_AddNumberToObject(latency, "samples", (double)stats.latency_samples);
+    cJSON_AddNumberToObject(latency, "avg", (double)stats.latency_avg_ms);
+    cJSON_AddNumberToObject(latency, "max", (double)stats.latency_max_ms);
+    cJSON *buckets = cJSON_AddArrayToObject(latency, "buckets");
+    for (size_t i = 0; i < UI_RUNTIME_LATENCY_BUCKETS; i++) {
+        cJSON *bucket = cJSON_CreateObject();
+        if (stats.bucket_le_ms[i] == UINT16_MAX) {
+            cJSON_AddNullToObject(bucket, "le");
+        } else {
+            cJSON_AddNumberToObject(bucket, "le", (double)stats.bucket_le_ms[i]);
+        }
+        cJSON_AddNumberToObject(bucket, "count", (double)stats.latency_buckets[i]);
+        cJSON_AddItemToArray(buckets, bucket);
+    }
+    return obj;
+}
+
+static cJSON *widget_renders_to_json(void)
+{
+    ui_widget_render_counter_t counters[UI_WIDGET_KIND_COUNT] = {0};
+    ui_widget_factory_get_render_stats(counters);
+
+    cJSON *obj = cJSON_CreateObject();
+    for (int kind = UI_WIDGET_KIND_NONE + 1; kind < UI_WIDGET_KIND_COUNT; kind++) {
+        cJSON *entry = cJSON_AddObjectToObject(obj, ui_widget_factory_kind_name((ui_widget_kind_t)kind));
+        cJSON_AddNumberToObject(entry, "performed", (double)counters[kind].performed);
+        cJSON_AddNumberToObject(entry, "skipped", (double)counters[kind].skipped);
+    }
+    return obj;
+}
+
+static cJSON *history_to_json(void)
+{
+    ha_history_stats_t stats = {0};
+    ha_history_get_stats(&stats);
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "series", (double)stats.series);
+    cJSON_AddNumberToObject(obj, "series_capacity", (double)stats.series_capacity);
+    cJSON_AddNumberToObject(obj, "series_bytes", (double)stats.series_bytes);
+    cJSON_AddNumberToObject(obj, "appends", (double)stats.appends);
+    cJSON_AddNumberToObject(obj, "compactions", (double)stats.compactions);
+    cJSON_AddNumberToObject(obj, "write_failures", (double)stats.write_failures);
+    cJSON_AddNumberToObject(obj, "samples_written", (double)stats.samples_written);
+    cJSON_AddNumberToObject(obj, "bytes_written", (double)stats.bytes_written);
+    cJSON_AddNumberToObject(obj, "full_rewrite_bytes", (double)stats.full_rewrite_bytes);
+    cJSON_AddNumberToObject(obj, "backfill_slices", (double)stats.backfill_slices);
+    cJSON_AddNumberToObject(obj, "backfill_minutes", (double)stats.backfill_minutes);
+    return obj;
+}
+
+static cJSON *widget_pool_to_json(void)
+{
+    ui_widget_pool_stats_t stats = {0};
+    ui_widget_pool_get_stats(&stats);
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "parked", (double)stats.parked);
+    cJSON_AddNumberToObject(obj, "capacity", (double)stats.capacity);
+    cJSON_AddNumberToObject(obj, "hits", (double)stats.hits);
+    cJSON_AddNumberToObject(obj, "misses", (double)stats.misses);
+    cJSON_AddNumberToObject(obj, "discarded", (double)stats.discarded);
+    return obj;
+}
+
+esp_err_t api_diagnostics_get_handler(httpd_req_t *req)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) {
+        return httpd_resp_send_500(req);
+    }
+    cJSON_AddItemToObject(root, "ws_rx", ws_rx_to_json());
+    cJSON_AddItemToObject(root, "app_events", app_events_to_json());
+    cJSON_AddItemToObject(root, "ui_frames", ui_frames_to_json());
+    cJSON_AddItemToObject(root, "widget_renders", widget_renders_to_json());
+    cJSON_AddItemToObject(root, "widget_pool", widget_pool_to_json());
+    cJSON_AddItemToObject(root, "history", history_to_json());
+
+    char *payload = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (payload == NULL) {
+        return httpd_resp_send_500(req);
+    }
+
+    set_json_headers(req);
+    esp_err_t err = httpd_resp_sendstr(req, payload);
+    cJSON_free(payload);
+    return err;
+}
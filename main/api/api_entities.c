@@ -9,6 +9,8 @@
 #include "cJSON.h"
 
 #include "app_config.h"
+#include "ha/ha_entity_catalog.h"
+#include "ha/ha_entity_ids.h"
 #include "ha/ha_model.h"
 
 #define API_ENTITIES_MAX_ITEMS_DEFAULT 128U
@@ -42,6 +44,30 @@ static size_t parse_max_items(const char *value)
     return (size_t)parsed;
 }
 
+static bool listed_in_model(const ha_entity_info_t *items, size_t count, const char *entity_id)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(ha_entity_ids_str(items[i].entity), entity_id) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void add_entity_json(cJSON *arr, const char *id, const char *name, const char *domain, const char *unit,
+    const char *device_class, uint32_t supported_features, const char *icon)
+{
+    cJSON *it = cJSON_CreateObject();
+    cJSON_AddStringToObject(it, "id", id);
+    cJSON_AddStringToObject(it, "name", name);
+    cJSON_AddStringToObject(it, "domain", domain);
+    cJSON_AddStringToObject(it, "unit", unit);
+    cJSON_AddStringToObject(it, "device_class", device_class);
+    cJSON_AddNumberToObject(it, "supported_features", (double)supported_features);
+    cJSON_AddStringToObject(it, "icon", icon);
+    cJSON_AddItemToArray(arr, it);
+}
+
 esp_err_t api_entities_get_handler(httpd_req_t *req)
 {
     char domain[APP_MAX_NAME_LEN] = {0};
@@ -70,30 +96,51 @@ esp_err_t api_entities_get_handler(httpd_req_t *req)
     size_t count = ha_model_list_entities(
         domain[0] ? domain : NULL, search[0] ? search : NULL, items, max_items);
 
+    /* Entities outside the layout only exist in the catalog (id + name); fill the remaining slots. */
+    ha_entity_catalog_entry_t *extra = NULL;
+    size_t extra_count = 0;
+    if (count < max_items) {
+        extra = calloc(max_items - count, sizeof(ha_entity_catalog_entry_t));
+        if (extra != NULL) {
+            extra_count = ha_entity_catalog_list(
+                domain[0] ? domain : NULL, search[0] ? search : NULL, extra, max_items - count);
+        }
+    }
+
     cJSON *root = cJSON_CreateObject();
     cJSON *arr = cJSON_CreateArray();
     if (root == NULL || arr == NULL) {
         free(items);
+        free(extra);
         cJSON_Delete(root);
         cJSON_Delete(arr);
         return httpd_resp_send_500(req);
     }
 
     for (size_t i = 0; i < count; i++) {
-        cJSON *it = cJSON_CreateObject();
-        cJSON_AddStringToObject(it, "id", items[i].id);
-        cJSON_AddStringToObject(it, "name", items[i].name);
-        cJSON_AddStringToObject(it, "domain", items[i].domain);
-        cJSON_AddStringToObject(it, "unit", items[i].unit);
-        cJSON_AddStringToObject(it, "device_class", items[i].device_class);
-        cJSON_AddNumberToObject(it, "supported_features", (double)items[i].supported_features);
-        cJSON_AddStringToObject(it, "icon", items[i].icon);
-        cJSON_AddItemToArray(arr, it);
+        add_entity_json(arr, ha_entity_ids_str(items[i].entity), items[i].name, items[i].domain, items[i].unit,
+            items[i].device_class, items[i].supported_features, items[i].icon);
+    }
+    size_t total = count;
+    for (size_t i = 0; i < extra_count; i++) {
+        if (listed_in_model(items, count, extra[i].entity_id)) {
+            continue;
+        }
+        char entity_domain[APP_MAX_NAME_LEN] = {0};
+        const char *dot = strchr(extra[i].entity_id, '.');
+        size_t domain_len = (dot != NULL) ? (size_t)(dot - extra[i].entity_id) : 0U;
+        if (domain_len >= sizeof(entity_domain)) {
+            domain_len = sizeof(entity_domain) - 1U;
+        }
+        memcpy(entity_domain, extra[i].entity_id, domain_len);
+        add_entity_json(arr, extra[i].entity_id, extra[i].name, entity_domain, "", "", 0U, "");
+        total++;
     }
     free(items);
+    free(extra);
 
     cJSON_AddItemToObject(root, "items", arr);
-    cJSON_AddNumberToObject(root, "count", (double)count);
+    cJSON_AddNumberToObject(root, "count", (double)total);
     char *payload = cJSON_PrintUnformatted(root);
     cJSON_Delete(root);
     if (payload == NULL) {
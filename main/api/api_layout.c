@@ -12,6 +12,7 @@
 #include "app_events.h"
 #include "app_config.h"
 #include "ha/ha_client.h"
+#include "ha/ha_history.h"
 #include "layout/layout_store.h"
 #include "layout/layout_validate.h"
 #include "util/log_tags.h"
@@ -103,6 +104,12 @@ esp_err_t api_layout_put_handler(httpd_req_t *req)
         return httpd_resp_send_500(req);
     }
 
+    /* Before the UI rebuilds, so new graphs find their series loaded. */
+    esp_err_t history_err = ha_history_sync_layout();
+    if (history_err != ESP_OK) {
+        ESP_LOGW(TAG_LAYOUT, "Failed to sync graph history with the layout: %s", esp_err_to_name(history_err));
+    }
+
     app_event_t event = {.type = EV_LAYOUT_UPDATED};
     app_events_publish(&event, pdMS_TO_TICKS(20));
     esp_err_t ha_notify_err = ha_client_notify_layout_updated();
@@ -61,6 +61,11 @@ static esp_err_t guarded_api_screenshot_bmp_get(httpd_req_t *req)
     return http_guard_handle(req, api_screenshot_bmp_get_handler);
 }
 
+static esp_err_t guarded_api_diagnostics_get(httpd_req_t *req)
+{
+    return http_guard_handle(req, api_diagnostics_get_handler);
+}
+
 esp_err_t api_routes_register(httpd_handle_t server)
 {
     if (server == NULL) {
@@ -133,6 +138,12 @@ esp_err_t api_routes_register(httpd_handle_t server)
         .handler = guarded_api_screenshot_bmp_get,
         .user_ctx = NULL,
     };
+    httpd_uri_t get_diagnostics = {
+        .uri = "/api/diagnostics",
+        .method = HTTP_GET,
+        .handler = guarded_api_diagnostics_get,
+        .user_ctx = NULL,
+    };
 
     ESP_RETURN_ON_ERROR(httpd_register_uri_handler(server, &get_layout), "api_routes", "GET /api/layout");
     ESP_RETURN_ON_ERROR(httpd_register_uri_handler(server, &put_layout), "api_routes", "PUT /api/layout");
@@ -148,6 +159,8 @@ esp_err_t api_routes_register(httpd_handle_t server)
     ESP_RETURN_ON_ERROR(httpd_register_uri_handler(server, &get_wifi_scan), "api_routes", "GET /api/wifi/scan");
     ESP_RETURN_ON_ERROR(
         httpd_register_uri_handler(server, &get_screenshot_bmp), "api_routes", "GET /api/screenshot.bmp");
+    ESP_RETURN_ON_ERROR(
+        httpd_register_uri_handler(server, &get_diagnostics), "api_routes", "GET /api/diagnostics");
 
     return ESP_OK;
 }
@@ -8,6 +8,7 @@
 #include "cJSON.h"
 
 #include "app_config.h"
+#include "ha/ha_entity_ids.h"
 #include "ha/ha_model.h"
 
 static void set_json_headers(httpd_req_t *req)
@@ -20,13 +21,19 @@ static void set_json_headers(httpd_req_t *req)
 static cJSON *state_to_json(const ha_state_t *state)
 {
     cJSON *obj = cJSON_CreateObject();
-    cJSON_AddStringToObject(obj, "entity_id", state->entity_id);
+    cJSON_AddStringToObject(obj, "entity_id", ha_entity_ids_str(state->entity));
     cJSON_AddStringToObject(obj, "state", state->state);
     cJSON_AddStringToObject(obj, "attributes_json", state->attributes_json);
     cJSON_AddNumberToObject(obj, "last_changed_unix_ms", (double)state->last_changed_unix_ms);
     return obj;
 }
 
+static bool api_state_append_item(const ha_state_t *state, void *user_ctx)
+{
+    cJSON_AddItemToArray((cJSON *)user_ctx, state_to_json(state));
+    return true;
+}
+
 esp_err_t api_state_get_handler(httpd_req_t *req)
 {
     char entity_id[APP_MAX_ENTITY_ID_LEN] = {0};
@@ -52,24 +59,14 @@ esp_err_t api_state_get_handler(httpd_req_t *req)
 
     size_t count = 0;
     if (entity_id[0] != '\0') {
-        ha_state_t state = {0};
-        if (ha_model_get_state(entity_id, &state)) {
-            cJSON_AddItemToArray(items, state_to_json(&state));
+        ha_model_state_ref_t ref = {0};
+        if (ha_model_borrow_state(ha_entity_ids_find(entity_id), &ref)) {
+            cJSON_AddItemToArray(items, state_to_json(ref.state));
+            ha_model_release_state(&ref);
             count = 1;
         }
     } else {
-        const size_t max_items = 128;
-        ha_state_t *states = calloc(max_items, sizeof(ha_state_t));
-        if (states == NULL) {
-            cJSON_Delete(root);
-            cJSON_Delete(items);
-            return httpd_resp_send_500(req);
-        }
-        count = ha_model_list_states(states, max_items);
-        for (size_t i = 0; i < count; i++) {
-            cJSON_AddItemToArray(items, state_to_json(&states[i]));
-        }
-        free(states);
+        count = ha_model_visit_states(api_state_append_item, items);
     }
 
     cJSON_AddItemToObject(root, "items", items);
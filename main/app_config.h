@@ -16,10 +16,15 @@
 #define APP_UI_REWORK_V2 1
 #define APP_UI_TEST_WEATHER_ICON_OVERLAY 0
 
-#define APP_EVENT_QUEUE_LENGTH 96
+/* Non-state events only (layout, navigate, connect); state changes coalesce in the app_events dirty set.
+ * The user lane (navigation) has its own queue, drained ahead of the background one. */
+#define APP_EVENT_QUEUE_LENGTH 16
+#define APP_EVENT_USER_QUEUE_LENGTH 8
 #define APP_EVENT_QUEUE_WAIT_MS 50
 
 #define APP_LAYOUT_PATH "/littlefs/layout.json"
+/* Compiled form of APP_LAYOUT_PATH, rewritten on every save and loaded at boot. */
+#define APP_LAYOUT_COMPILED_PATH "/littlefs/layout.bin"
 #define APP_LAYOUT_MAX_JSON_LEN 16384
 #define APP_LAYOUT_MAX_ERRORS 16
 
@@ -49,6 +54,14 @@
 #define APP_MAX_PAGES 5
 #define APP_MAX_WIDGETS_PER_PAGE 32
 #define APP_MAX_WIDGETS_TOTAL (APP_MAX_PAGES * APP_MAX_WIDGETS_PER_PAGE)
+/* Pages whose widget trees stay materialized; the least recently shown one is evicted beyond this. */
+#define APP_UI_RESIDENT_PAGES_MAX 3
+/* Parked widget trees kept for reuse after page eviction or layout reload (about two pages). */
+#define APP_UI_WIDGET_POOL_MAX (APP_MAX_WIDGETS_PER_PAGE * 2)
+/* Display lock budget of a layout swap, and the widget building done per lock hold; trees beyond a
+ * slice are built over the following frames. */
+#define APP_UI_LAYOUT_LOCK_BUDGET_MS 50
+#define APP_UI_LAYOUT_BUILD_SLICE_MS 20
 
 #define APP_MAX_ENTITY_ID_LEN 96
 #define APP_MAX_WIDGET_ID_LEN 32
@@ -62,9 +75,27 @@
 
 #define APP_HA_MAX_ENTITIES 256
 #define APP_HA_MAX_STATES 256
-#define APP_HA_ATTRS_MAX_LEN 512
+/* Upper bound for one state's attributes JSON; the model only stores the bytes actually used. */
+#define APP_HA_ATTRS_MAX_LEN 4096
+#define APP_HA_ATTR_ARENA_BYTES (128 * 1024)
+/* Interned entity_id pool (model entities + layout references), power of two. */
+#define APP_HA_ENTITY_ID_POOL_MAX 1024
+#define APP_HA_ENTITY_ID_ARENA_BYTES 32768
+/* Editor catalog of entities outside the layout (id + friendly name), power of two. */
+#define APP_HA_CATALOG_MAX_ENTRIES 4096
+#define APP_HA_CATALOG_ARENA_BYTES (160 * 1024)
+/* Minute history of graph entities: one series (about 20 KB PSRAM) per distinct entity. */
+#define APP_HA_HISTORY_MAX_SERIES 32
+#define APP_HA_HISTORY_RETENTION_MIN 1440U
+/* Gaps are backfilled from HA's recorder one slice per request, small enough for one WS frame. */
+#define APP_HA_HISTORY_BACKFILL_SLICE_MIN 60U
 
 #define APP_HA_QUEUE_LENGTH 96
+/* WS receive ring: frames are assembled in place in runs of consecutive slabs and queued by reference.
+ * The ring must hold at least one maximum-size frame; slab size trades tail waste for bookkeeping. */
+#define APP_HA_WS_RX_MAX_MESSAGE_LEN (64 * 1024 - 1)
+#define APP_HA_WS_RX_SLAB_SIZE 1024
+#define APP_HA_WS_RX_SLAB_COUNT 128
 #define APP_HA_TASK_STACK 10240
 #define APP_HA_TASK_PRIO 8
 
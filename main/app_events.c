@@ -4,41 +4,227 @@
 #include "app_events.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "util/log_tags.h"
 
-static QueueHandle_t s_event_queue = NULL;
+/* Handles run 1..APP_HA_ENTITY_ID_POOL_MAX, bit N marks handle N. */
+#define APP_EVENTS_DIRTY_WORDS ((APP_HA_ENTITY_ID_POOL_MAX + 1U + 31U) / 32U)
 
-esp_err_t app_events_init(void)
+static QueueHandle_t s_event_queues[APP_EVENT_LANE_COUNT];
+/* An entity is marked in at most one lane for a drain: a user mark takes it out of the background
+ * set when drained. */
+static uint32_t s_dirty_bits[APP_EVENT_LANE_COUNT][APP_EVENTS_DIRTY_WORDS];
+static uint32_t s_dirty_pending[APP_EVENT_LANE_COUNT];
+static TaskHandle_t s_listener = NULL;
+static int64_t s_dirty_since_us = 0;
+/* Counters are bumped lock-free by publishers and read by app_events_get_stats. */
+static app_events_lane_stats_t s_lane_stats[APP_EVENT_LANE_COUNT];
+
+static void app_events_wake_listener(void)
 {
-    if (s_event_queue != NULL) {
-        return ESP_OK;
+    TaskHandle_t listener = __atomic_load_n(&s_listener, __ATOMIC_ACQUIRE);
+    if (listener != NULL) {
+        xTaskNotifyGive(listener);
     }
-    s_event_queue = xQueueCreate(APP_EVENT_QUEUE_LENGTH, sizeof(app_event_t));
-    if (s_event_queue == NULL) {
-        ESP_LOGE(TAG_APP, "Failed to create event queue");
-        return ESP_ERR_NO_MEM;
+}
+
+static void app_events_raise_high_water(uint32_t *high_water, uint32_t value)
+{
+    uint32_t seen = __atomic_load_n(high_water, __ATOMIC_RELAXED);
+    while (value > seen &&
+           !__atomic_compare_exchange_n(high_water, &seen, value, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
     }
-    return ESP_OK;
 }
 
-QueueHandle_t app_events_get_queue(void)
+static app_event_lane_t app_events_lane_of(app_event_type_t type)
+{
+    return (type == EV_UI_NAVIGATE) ? APP_EVENT_LANE_USER : APP_EVENT_LANE_BACKGROUND;
+}
+
+esp_err_t app_events_init(void)
 {
-    return s_event_queue;
+    static const UBaseType_t lengths[APP_EVENT_LANE_COUNT] = {
+        [APP_EVENT_LANE_USER] = APP_EVENT_USER_QUEUE_LENGTH,
+        [APP_EVENT_LANE_BACKGROUND] = APP_EVENT_QUEUE_LENGTH,
+    };
+    for (size_t lane = 0; lane < APP_EVENT_LANE_COUNT; lane++) {
+        if (s_event_queues[lane] != NULL) {
+            continue;
+        }
+        s_event_queues[lane] = xQueueCreate(lengths[lane], sizeof(app_event_t));
+        if (s_event_queues[lane] == NULL) {
+            ESP_LOGE(TAG_APP, "Failed to create event queue (lane %u)", (unsigned)lane);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
 }
 
 bool app_events_publish(const app_event_t *event, TickType_t timeout_ticks)
 {
-    if (s_event_queue == NULL || event == NULL) {
+    if (event != NULL && event->type == EV_HA_STATE_CHANGED) {
+        app_events_mark_state_dirty(event->data.ha_state_changed.entity);
+        return true;
+    }
+    if (event == NULL) {
         return false;
     }
-    return xQueueSend(s_event_queue, event, timeout_ticks) == pdTRUE;
+    app_event_lane_t lane = app_events_lane_of(event->type);
+    QueueHandle_t queue = s_event_queues[lane];
+    if (queue == NULL) {
+        return false;
+    }
+    app_events_lane_stats_t *stats = &s_lane_stats[lane];
+    if (xQueueSend(queue, event, timeout_ticks) != pdTRUE) {
+        __atomic_fetch_add(&stats->dropped, 1U, __ATOMIC_RELAXED);
+        return false;
+    }
+    __atomic_fetch_add(&stats->queued, 1U, __ATOMIC_RELAXED);
+    app_events_raise_high_water(&stats->queue_high_water, (uint32_t)uxQueueMessagesWaiting(queue));
+    app_events_wake_listener();
+    return true;
 }
 
 bool app_events_receive(app_event_t *event, TickType_t timeout_ticks)
 {
-    if (s_event_queue == NULL || event == NULL) {
+    QueueHandle_t user = s_event_queues[APP_EVENT_LANE_USER];
+    QueueHandle_t background = s_event_queues[APP_EVENT_LANE_BACKGROUND];
+    if (user == NULL || background == NULL || event == NULL) {
         return false;
     }
-    return xQueueReceive(s_event_queue, event, timeout_ticks) == pdTRUE;
+    if (xQueueReceive(user, event, 0) == pdTRUE) {
+        return true;
+    }
+    return xQueueReceive(background, event, timeout_ticks) == pdTRUE;
+}
+
+static void app_events_mark_dirty(ha_entity_handle_t entity, app_event_lane_t lane)
+{
+    if (entity == HA_ENTITY_HANDLE_NONE || entity > APP_HA_ENTITY_ID_POOL_MAX) {
+        return;
+    }
+    uint32_t bit = 1U << (entity & 31U);
+    uint32_t previous = __atomic_fetch_or(&s_dirty_bits[lane][entity >> 5], bit, __ATOMIC_RELEASE);
+    if ((previous & bit) == 0U) {
+        /* Already-dirty entities were notified when first marked. */
+        uint32_t pending = __atomic_add_fetch(&s_dirty_pending[lane], 1U, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_lane_stats[lane].state_marks, 1U, __ATOMIC_RELAXED);
+        app_events_raise_high_water(&s_lane_stats[lane].dirty_high_water, pending);
+        int64_t unset = 0;
+        (void)__atomic_compare_exchange_n(
+            &s_dirty_since_us, &unset, esp_timer_get_time(), false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        app_events_wake_listener();
+    }
+}
+
+void app_events_mark_state_dirty(ha_entity_handle_t entity)
+{
+    app_events_mark_dirty(entity, APP_EVENT_LANE_BACKGROUND);
+}
+
+void app_events_mark_user_state_dirty(ha_entity_handle_t entity)
+{
+    app_events_mark_dirty(entity, APP_EVENT_LANE_USER);
+}
+
+/* Takes marks of one lane until out_entities is full. Only the consumer clears bits, so every bit
+ * picked from a loaded word is still set; marks made meanwhile stay for the next drain. Returns true
+ * if marks of the lane were left behind. */
+static bool app_events_take_lane(
+    app_event_lane_t lane, ha_entity_handle_t *out_entities, size_t max_out, size_t *inout_count)
+{
+    size_t count = *inout_count;
+    bool leftover = false;
+    for (size_t w = 0; w < APP_EVENTS_DIRTY_WORDS; w++) {
+        uint32_t bits = __atomic_load_n(&s_dirty_bits[lane][w], __ATOMIC_ACQUIRE);
+        if (bits == 0U) {
+            continue;
+        }
+        if (count == max_out) {
+            leftover = true;
+            break;
+        }
+        uint32_t taken = 0;
+        while (bits != 0U && count < max_out) {
+            uint32_t b = (uint32_t)__builtin_ctz(bits);
+            bits &= bits - 1U;
+            taken |= 1U << b;
+            out_entities[count++] = (ha_entity_handle_t)((w << 5) | b);
+        }
+        (void)__atomic_fetch_and(&s_dirty_bits[lane][w], ~taken, __ATOMIC_ACQUIRE);
+        __atomic_fetch_sub(&s_dirty_pending[lane], (uint32_t)__builtin_popcount(taken), __ATOMIC_RELAXED);
+        if (lane == APP_EVENT_LANE_USER) {
+            /* Applied now; a background mark of the same entity would only repeat the apply. */
+            uint32_t dup = __atomic_fetch_and(&s_dirty_bits[APP_EVENT_LANE_BACKGROUND][w], ~taken, __ATOMIC_ACQUIRE);
+            if ((dup & taken) != 0U) {
+                __atomic_fetch_sub(&s_dirty_pending[APP_EVENT_LANE_BACKGROUND],
+                    (uint32_t)__builtin_popcount(dup & taken), __ATOMIC_RELAXED);
+            }
+        }
+        leftover = leftover || bits != 0U;
+    }
+    *inout_count = count;
+    return leftover;
+}
+
+size_t app_events_take_dirty_states(ha_entity_handle_t *out_entities, size_t max_out, int64_t *out_oldest_mark_us)
+{
+    if (out_oldest_mark_us != NULL) {
+        *out_oldest_mark_us = 0;
+    }
+    if (out_entities == NULL || max_out == 0U) {
+        return 0;
+    }
+    int64_t since_us = __atomic_exchange_n(&s_dirty_since_us, 0, __ATOMIC_RELAXED);
+    size_t count = 0;
+    bool leftover = false;
+    for (size_t lane = 0; lane < APP_EVENT_LANE_COUNT; lane++) {
+        leftover = app_events_take_lane((app_event_lane_t)lane, out_entities, max_out, &count) || leftover;
+    }
+    if (leftover && since_us != 0) {
+        /* Remaining marks are still as old as the batch that was just taken. */
+        int64_t unset = 0;
+        (void)__atomic_compare_exchange_n(
+            &s_dirty_since_us, &unset, since_us, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+    if (out_oldest_mark_us != NULL) {
+        *out_oldest_mark_us = since_us;
+    }
+    return count;
+}
+
+bool app_events_has_dirty_states(void)
+{
+    for (size_t lane = 0; lane < APP_EVENT_LANE_COUNT; lane++) {
+        for (size_t w = 0; w < APP_EVENTS_DIRTY_WORDS; w++) {
+            if (__atomic_load_n(&s_dirty_bits[lane][w], __ATOMIC_ACQUIRE) != 0U) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void app_events_set_listener(TaskHandle_t task)
+{
+    __atomic_store_n(&s_listener, task, __ATOMIC_RELEASE);
+}
+
+void app_events_get_stats(app_events_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    for (size_t lane = 0; lane < APP_EVENT_LANE_COUNT; lane++) {
+        const app_events_lane_stats_t *src = &s_lane_stats[lane];
+        app_events_lane_stats_t *dst = &out_stats->lanes[lane];
+        dst->queued = __atomic_load_n(&src->queued, __ATOMIC_RELAXED);
+        dst->dropped = __atomic_load_n(&src->dropped, __ATOMIC_RELAXED);
+        dst->queue_depth =
+            (s_event_queues[lane] != NULL) ? (uint32_t)uxQueueMessagesWaiting(s_event_queues[lane]) : 0U;
+        dst->queue_high_water = __atomic_load_n(&src->queue_high_water, __ATOMIC_RELAXED);
+        dst->state_marks = __atomic_load_n(&src->state_marks, __ATOMIC_RELAXED);
+        dst->dirty_high_water = __atomic_load_n(&src->dirty_high_water, __ATOMIC_RELAXED);
+    }
 }
@@ -4,12 +4,15 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/task.h"
 
 #include "app_config.h"
+#include "ha/ha_entity_ids.h"
 
 typedef enum {
     EV_NONE = 0,
@@ -21,7 +24,7 @@ typedef enum {
 } app_event_type_t;
 
 typedef struct {
-    char entity_id[APP_MAX_ENTITY_ID_LEN];
+    ha_entity_handle_t entity;
 } app_event_state_changed_t;
 
 typedef struct {
@@ -36,7 +39,46 @@ typedef struct {
     } data;
 } app_event_t;
 
+/* Lanes in drain order: user-initiated work (touch feedback, navigation) goes ahead of background
+ * HA sync, connection and layout events. */
+typedef enum {
+    APP_EVENT_LANE_USER = 0,
+    APP_EVENT_LANE_BACKGROUND,
+    APP_EVENT_LANE_COUNT,
+} app_event_lane_t;
+
+typedef struct {
+    uint32_t queued;
+    /* Publishes that timed out on a full queue. */
+    uint32_t dropped;
+    uint32_t queue_depth;
+    uint32_t queue_high_water;
+    /* Entities newly marked dirty, and the most pending at once. */
+    uint32_t state_marks;
+    uint32_t dirty_high_water;
+} app_events_lane_stats_t;
+
+typedef struct {
+    app_events_lane_stats_t lanes[APP_EVENT_LANE_COUNT];
+} app_events_stats_t;
+
 esp_err_t app_events_init(void);
-QueueHandle_t app_events_get_queue(void);
+/* Queues a non-state event on its lane (EV_UI_NAVIGATE: user, the rest: background).
+ * EV_HA_STATE_CHANGED is routed to app_events_mark_state_dirty instead. */
 bool app_events_publish(const app_event_t *event, TickType_t timeout_ticks);
+/* User lane first; timeout_ticks only applies to the wait on the background lane. */
 bool app_events_receive(app_event_t *event, TickType_t timeout_ticks);
+
+/* State changes coalesce in a per-entity dirty bitset per lane: N updates to one entity before the
+ * consumer drains cost one apply, and the sets can never overflow. Lock-free, callable from any task. */
+void app_events_mark_state_dirty(ha_entity_handle_t entity);
+/* User-initiated change (optimistic touch feedback): drained ahead of every background mark. */
+void app_events_mark_user_state_dirty(ha_entity_handle_t entity);
+/* Moves up to max_out dirty handles into out_entities, user lane first, and clears them; the rest stay
+ * marked. out_oldest_mark_us (optional) receives the esp_timer time the oldest pending mark was made,
+ * 0 if none. */
+size_t app_events_take_dirty_states(ha_entity_handle_t *out_entities, size_t max_out, int64_t *out_oldest_mark_us);
+bool app_events_has_dirty_states(void);
+/* Task woken (task notification) whenever a state is marked dirty or an event is queued. */
+void app_events_set_listener(TaskHandle_t task);
+void app_events_get_stats(app_events_stats_t *out_stats);
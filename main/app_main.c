@@ -18,6 +18,7 @@
 #include "drivers/display_init.h"
 #include "drivers/touch_init.h"
 #include "ha/ha_client.h"
+#include "ha/ha_history.h"
 #include "ha/ha_model.h"
 #include "layout/layout_store.h"
 #include "net/time_sync.h"
@@ -134,6 +135,7 @@ void app_main(void)
     ESP_ERROR_CHECK(init_net_stack());
     ESP_ERROR_CHECK(app_events_init());
     ESP_ERROR_CHECK(ha_model_init());
+    ESP_ERROR_CHECK(ha_history_init());
     ESP_ERROR_CHECK(runtime_settings_init());
 
     esp_err_t settings_err = runtime_settings_load(&s_runtime_settings);
@@ -214,6 +216,10 @@ void app_main(void)
     }
 
     ESP_ERROR_CHECK(layout_store_init());
+    esp_err_t history_err = ha_history_sync_layout();
+    if (history_err != ESP_OK) {
+        ESP_LOGW(TAG_APP, "Graph history unavailable: %s", esp_err_to_name(history_err));
+    }
     ESP_ERROR_CHECK(http_server_start());
 
     if (boot_screen_mode == BOOT_SCREEN_DASHBOARD) {
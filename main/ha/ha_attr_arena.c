@@ -0,0 +1,242 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_attr_arena.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "util/log_tags.h"
+
+/* Blocks are carved from one bump arena and recycled through per-class free lists. Classes
+ * grow by ~1.5x so a blob wastes at most a third of its block; the 4-byte header keeps the
+ * length and class so release/len need no lookup. A free block keeps its header (marked free)
+ * and stores the next pointer right after it, so the carved region can always be walked.
+ * When a store would fail, adjacent free blocks are merged and re-split (ha_attr_arena_merge_free). */
+typedef struct {
+    uint16_t len;
+    uint8_t size_class;
+    uint8_t is_free;
+} ha_attr_block_hdr_t;
+
+static const uint16_t s_class_sizes[] = {
+    32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192,
+};
+#define HA_ATTR_CLASS_COUNT (sizeof(s_class_sizes) / sizeof(s_class_sizes[0]))
+#define HA_ATTR_HDR_SIZE sizeof(ha_attr_block_hdr_t)
+
+_Static_assert(APP_HA_ATTRS_MAX_LEN + 4U <= 8192U, "largest attribute blob must fit the largest size class");
+_Static_assert(APP_HA_ATTRS_MAX_LEN <= UINT16_MAX, "blob length must fit into uint16_t");
+
+static uint8_t *s_arena = NULL;
+static size_t s_carved = 0;
+static void *s_free_lists[HA_ATTR_CLASS_COUNT];
+static size_t s_free_bytes = 0;
+static size_t s_block_count = 0;
+static uint32_t s_alloc_failures = 0;
+static uint32_t s_merge_passes = 0;
+static size_t s_releases_since_merge = 0;
+
+static int ha_attr_arena_class_for(size_t block_bytes)
+{
+    for (size_t i = 0; i < HA_ATTR_CLASS_COUNT; i++) {
+        if (block_bytes <= s_class_sizes[i]) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static ha_attr_block_hdr_t *ha_attr_arena_hdr(const void *blob)
+{
+    return (ha_attr_block_hdr_t *)(void *)((uint8_t *)(uintptr_t)blob - HA_ATTR_HDR_SIZE);
+}
+
+static void *ha_attr_arena_pop(size_t cls)
+{
+    void *block = s_free_lists[cls];
+    if (block != NULL) {
+        memcpy(&s_free_lists[cls], (uint8_t *)block + HA_ATTR_HDR_SIZE, sizeof(void *));
+        s_free_bytes -= s_class_sizes[cls];
+    }
+    return block;
+}
+
+static void ha_attr_arena_push(void *block, size_t cls)
+{
+    ha_attr_block_hdr_t *hdr = (ha_attr_block_hdr_t *)block;
+    hdr->len = 0;
+    hdr->size_class = (uint8_t)cls;
+    hdr->is_free = 1;
+    memcpy((uint8_t *)block + HA_ATTR_HDR_SIZE, &s_free_lists[cls], sizeof(void *));
+    s_free_lists[cls] = block;
+    s_free_bytes += s_class_sizes[cls];
+}
+
+/* Largest class that fits bytes and leaves either nothing or a whole block behind. Every class is a
+ * multiple of 16 and any multiple of 16 from 32 up is a sum of 32s and 48s, so a split always exists. */
+static size_t ha_attr_arena_split_class(size_t bytes)
+{
+    for (size_t cls = HA_ATTR_CLASS_COUNT; cls-- > 0;) {
+        if (s_class_sizes[cls] > bytes) {
+            continue;
+        }
+        size_t rest = bytes - s_class_sizes[cls];
+        if (rest == 0 || rest >= s_class_sizes[0]) {
+            return cls;
+        }
+    }
+    return 0;
+}
+
+/* Walks the carved region once, merging each run of adjacent free blocks. A run at the end goes back
+ * to the bump pointer; any other run is re-split into the largest classes that tile it. Live blobs
+ * never move, so borrowed pointers stay valid. */
+static void ha_attr_arena_merge_free(void)
+{
+    memset(s_free_lists, 0, sizeof(s_free_lists));
+    s_free_bytes = 0;
+    size_t pos = 0;
+    while (pos < s_carved) {
+        const ha_attr_block_hdr_t *hdr = (const ha_attr_block_hdr_t *)(s_arena + pos);
+        if (!hdr->is_free) {
+            pos += s_class_sizes[hdr->size_class];
+            continue;
+        }
+        size_t run_start = pos;
+        while (pos < s_carved && ((const ha_attr_block_hdr_t *)(s_arena + pos))->is_free) {
+            pos += s_class_sizes[((const ha_attr_block_hdr_t *)(s_arena + pos))->size_class];
+        }
+        if (pos == s_carved) {
+            s_carved = run_start;
+            break;
+        }
+        for (size_t at = run_start; at < pos;) {
+            size_t cls = ha_attr_arena_split_class(pos - at);
+            ha_attr_arena_push(s_arena + at, cls);
+            at += s_class_sizes[cls];
+        }
+    }
+    s_merge_passes++;
+    s_releases_since_merge = 0;
+}
+
+/* Exact class from its free list or fresh bump space, else a recycled block of a bigger class. */
+static void *ha_attr_arena_take(int *inout_cls)
+{
+    size_t cls = (size_t)*inout_cls;
+    void *block = ha_attr_arena_pop(cls);
+    if (block == NULL && s_carved + s_class_sizes[cls] <= APP_HA_ATTR_ARENA_BYTES) {
+        block = s_arena + s_carved;
+        s_carved += s_class_sizes[cls];
+    }
+    for (size_t bigger = cls + 1U; block == NULL && bigger < HA_ATTR_CLASS_COUNT; bigger++) {
+        block = ha_attr_arena_pop(bigger);
+        if (block != NULL) {
+            *inout_cls = (int)bigger;
+        }
+    }
+    return block;
+}
+
+esp_err_t ha_attr_arena_init(void)
+{
+    if (s_arena != NULL) {
+        return ESP_OK;
+    }
+    s_arena = (uint8_t *)heap_caps_malloc(APP_HA_ATTR_ARENA_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (s_arena == NULL) {
+        s_arena = (uint8_t *)heap_caps_malloc(APP_HA_ATTR_ARENA_BYTES, MALLOC_CAP_8BIT);
+    }
+    if (s_arena == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ha_attr_arena_reset();
+    return ESP_OK;
+}
+
+const void *ha_attr_arena_store(const void *data, size_t len)
+{
+    if (s_arena == NULL || data == NULL || len > APP_HA_ATTRS_MAX_LEN) {
+        return NULL;
+    }
+
+    int cls = ha_attr_arena_class_for(HA_ATTR_HDR_SIZE + len + 1U);
+    if (cls < 0) {
+        return NULL;
+    }
+
+    void *block = ha_attr_arena_take(&cls);
+    if (block == NULL && s_free_bytes >= s_class_sizes[cls] && s_releases_since_merge > 0) {
+        /* Enough free space, but split into smaller blocks than this blob needs. */
+        ha_attr_arena_merge_free();
+        block = ha_attr_arena_take(&cls);
+    }
+    if (block == NULL) {
+        if (s_alloc_failures++ == 0) {
+            ESP_LOGW(TAG_HA_MODEL, "Attribute arena full (%u bytes), storing further attributes as {}",
+                (unsigned)APP_HA_ATTR_ARENA_BYTES);
+        }
+        return NULL;
+    }
+
+    ha_attr_block_hdr_t *hdr = (ha_attr_block_hdr_t *)block;
+    hdr->len = (uint16_t)len;
+    hdr->size_class = (uint8_t)cls;
+    hdr->is_free = 0;
+    char *blob = (char *)block + HA_ATTR_HDR_SIZE;
+    memcpy(blob, data, len);
+    blob[len] = '\0';
+    s_block_count++;
+    return blob;
+}
+
+bool ha_attr_arena_owns(const void *blob)
+{
+    return s_arena != NULL && blob != NULL && (const uint8_t *)blob >= s_arena + HA_ATTR_HDR_SIZE &&
+           (const uint8_t *)blob < s_arena + APP_HA_ATTR_ARENA_BYTES;
+}
+
+void ha_attr_arena_release(const void *blob)
+{
+    if (!ha_attr_arena_owns(blob)) {
+        return;
+    }
+    ha_attr_block_hdr_t *hdr = ha_attr_arena_hdr(blob);
+    ha_attr_arena_push(hdr, hdr->size_class);
+    s_block_count--;
+    s_releases_since_merge++;
+}
+
+size_t ha_attr_arena_blob_len(const void *blob)
+{
+    return ha_attr_arena_owns(blob) ? ha_attr_arena_hdr(blob)->len : 0;
+}
+
+size_t ha_attr_arena_block_size(const void *blob)
+{
+    return ha_attr_arena_owns(blob) ? s_class_sizes[ha_attr_arena_hdr(blob)->size_class] : 0;
+}
+
+void ha_attr_arena_reset(void)
+{
+    memset(s_free_lists, 0, sizeof(s_free_lists));
+    s_carved = 0;
+    s_free_bytes = 0;
+    s_block_count = 0;
+    s_releases_since_merge = 0;
+}
+
+void ha_attr_arena_get_stats(ha_attr_arena_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    out_stats->capacity_bytes = (s_arena != NULL) ? APP_HA_ATTR_ARENA_BYTES : 0;
+    out_stats->carved_bytes = s_carved;
+    out_stats->free_list_bytes = s_free_bytes;
+    out_stats->block_count = s_block_count;
+    out_stats->alloc_failures = s_alloc_failures;
+    out_stats->merge_passes = s_merge_passes;
+}
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "app_config.h"
+
+/* Size-classed storage for state attribute blobs (JSON text or typed forecast rows). Not thread-safe:
+ * ha_model is the only user and calls it under its model mutex. */
+typedef struct {
+    size_t capacity_bytes;
+    size_t carved_bytes;
+    size_t free_list_bytes;
+    size_t block_count;
+    uint32_t alloc_failures;
+    uint32_t merge_passes; /* free-block merges run because a store found only fragments */
+} ha_attr_arena_stats_t;
+
+esp_err_t ha_attr_arena_init(void);
+/* Returns a 4-byte aligned copy of data[0..len) plus NUL, or NULL when the arena is exhausted. */
+const void *ha_attr_arena_store(const void *data, size_t len);
+void ha_attr_arena_release(const void *blob);
+size_t ha_attr_arena_blob_len(const void *blob);
+size_t ha_attr_arena_block_size(const void *blob);
+bool ha_attr_arena_owns(const void *blob);
+/* Drops every blob and rewinds the arena. Only valid once nothing references a blob (ha_model_reset). */
+void ha_attr_arena_reset(void);
+void ha_attr_arena_get_stats(ha_attr_arena_stats_t *out_stats);
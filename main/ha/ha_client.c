@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include "cJSON.h"
 #include "esp_crt_bundle.h"
@@ -24,15 +25,22 @@
 
 #include "app_config.h"
 #include "app_events.h"
+#include "ha/ha_entity_catalog.h"
+#include "ha/ha_entity_ids.h"
+#include "ha/ha_history.h"
 #include "ha/ha_model.h"
 #include "ha/ha_ws.h"
+#include "ha/ha_ws_rx_pool.h"
 #include "layout/layout_store.h"
 #include "net/wifi_mgr.h"
+#include "util/json_scan.h"
 #include "util/log_tags.h"
 
+/* Queued WS text frame; payload points into the receive slab ring and is returned via the lease. */
 typedef struct {
     char *payload;
     int len;
+    ha_ws_rx_lease_t lease;
 } ha_ws_rx_msg_t;
 
 typedef struct {
@@ -59,6 +67,9 @@ typedef enum {
 #define HA_WS_ENTITIES_SUB_MAX (APP_MAX_WIDGETS_TOTAL * 2)
 #define HA_WS_ENTITIES_SUB_ID_BYTES ((size_t)HA_WS_ENTITIES_SUB_MAX * (size_t)APP_MAX_ENTITY_ID_LEN)
 #define HA_WS_ENTITIES_SUB_REQ_BYTES ((size_t)HA_WS_ENTITIES_SUB_MAX * sizeof(uint32_t))
+/* Per-entity subscriptions dropped by a layout edit, waiting for unsubscribe_events. Overflow only
+ * leaves a subscription open until reconnect; its events no longer match a known req_id. */
+#define HA_WS_ENTITIES_UNSUB_QUEUE_MAX 32U
 #define HA_SVC_TRACE_CAPACITY 48U
 
 typedef struct {
@@ -95,6 +106,9 @@ typedef struct {
     char *entities_sub_targets;
     uint32_t *entities_sub_req_ids;
     char *entities_sub_seen;
+    uint32_t entities_unsub_queue[HA_WS_ENTITIES_UNSUB_QUEUE_MAX];
+    uint8_t entities_unsub_count;
+    char *ws_diff_attrs_buf;
     uint8_t ping_timeout_strikes;
     uint8_t ws_short_session_strikes;
     bool pending_force_wifi_recover;
@@ -127,8 +141,22 @@ typedef struct {
     bool weather_ws_req_inflight;
     uint32_t weather_ws_req_id;
     char weather_ws_req_entity_id[APP_MAX_ENTITY_ID_LEN];
+    /* Graph history backfill: one history_during_period request at a time; a slice whose answer
+     * never arrives is asked again, shorter. Cleared on every (re)connect. */
+    bool history_backfill_inflight;
+    bool history_backfill_unsupported;
+    uint32_t history_backfill_req_id;
+    ha_entity_handle_t history_backfill_entity;
+    uint32_t history_backfill_start_ts;
+    uint32_t history_backfill_end_ts;
+    uint32_t history_backfill_slice_min;
+    int64_t history_backfill_sent_unix_ms;
+    int64_t next_history_backfill_unix_ms;
     uint32_t layout_entity_signature;
     uint16_t layout_entity_count;
+    char *layout_filter_ids; /* sorted layout entity_ids (APP_MAX_ENTITY_ID_LEN stride) for ingest filtering */
+    uint16_t layout_filter_count;
+    bool layout_filter_ready;
     int64_t ws_priority_boost_until_unix_ms;
     int last_ws_tls_stack_err;
     esp_err_t last_ws_tls_esp_err;
@@ -202,6 +230,11 @@ static const int64_t HA_HTTP_BUDGET_LOG_INTERVAL_MS = 300000;
 static const int64_t HA_BG_BUDGET_CHANGE_LOG_MIN_MS = 10000;
 static const int64_t HA_WS_PRIORITY_BOOST_MS = 5000;
 static const int64_t HA_WEATHER_FORECAST_RETRY_MIN_MS = 300000;
+static const int64_t HA_HISTORY_BACKFILL_GRACE_MS = 15000;
+static const int64_t HA_HISTORY_BACKFILL_TIMEOUT_MS = 20000;
+static const int64_t HA_HISTORY_BACKFILL_IDLE_MS = 30000;
+/* A slice answered by nothing (its frame was over APP_HA_WS_RX_MAX_MESSAGE_LEN) is halved down to this. */
+static const uint32_t HA_HISTORY_BACKFILL_SLICE_FLOOR_MIN = 5;
 static const int64_t HA_SVC_LATENCY_INFO_MS = 0;
 static const int64_t HA_SVC_LATENCY_WARN_MS = 500;
 static const int64_t HA_SVC_TRACE_MAX_AGE_MS = 5000;
@@ -216,7 +249,6 @@ static bool ha_client_is_tls_bad_input_data(int tls_stack_err);
 static void ha_client_priority_sync_queue_push_locked(const char *entity_id);
 static size_t ha_client_collect_layout_entity_ids(char *entity_ids, size_t max_count, bool *out_need_weather_forecast);
 static bool ha_client_entity_is_weather(const char *entity_id);
-static bool ha_client_entity_id_in_list(const char *entity_ids, size_t entity_count, const char *entity_id);
 static void ha_client_queue_weather_priority_sync_from_layout(int64_t now_ms);
 static ha_bg_budget_level_t ha_client_eval_bg_budget_level(
     size_t free_internal, uint8_t ws_q_fill_pct, uint32_t ws_error_streak);
@@ -240,9 +272,7 @@ static void ha_client_free_entities_sub_buffers(void);
 static char *ha_client_entities_sub_target_at(uint16_t idx);
 static char *ha_client_entities_sub_seen_at(uint16_t idx);
 static uint16_t ha_client_prepare_entities_resubscribe_locked(int64_t now_ms);
-static const size_t HA_WS_RX_ASSEMBLY_BUF_SIZE = 65536U;
-static char *s_ws_rx_buf = NULL;
-static size_t s_ws_rx_buf_cap = 0;
+static ha_ws_rx_lease_t s_ws_rx_lease = {0};
 static int s_ws_rx_len = 0;
 static int s_ws_rx_expected_len = 0;
 static bool s_ws_rx_overflow = false;
@@ -287,10 +317,8 @@ static void ha_client_free_ws_msg(ha_ws_rx_msg_t *msg)
     if (msg == NULL) {
         return;
     }
-    if (msg->payload != NULL) {
-        free(msg->payload);
-        msg->payload = NULL;
-    }
+    ha_ws_rx_pool_release(&msg->lease);
+    msg->payload = NULL;
     msg->len = 0;
 }
 
@@ -305,41 +333,61 @@ static void ha_client_flush_ws_rx_queue(void)
     }
 }
 
-static void ha_client_enqueue_ws_text(const char *data, int len)
+/* Hands the assembled frame to the HA task by reference; the queue then owns the lease. */
+static void ha_client_enqueue_ws_text(ha_ws_rx_lease_t *lease, int len)
 {
-    if (data == NULL || len <= 0 || s_client.ws_rx_queue == NULL) {
+    if (lease == NULL || lease->data == NULL || len <= 0 || s_client.ws_rx_queue == NULL) {
+        ha_ws_rx_pool_release(lease);
         return;
     }
 
-    ha_ws_rx_msg_t msg = {0};
-    /* Keep internal heap headroom for TLS by preferring PSRAM for queued WS payloads. */
-    msg.payload = (char *)heap_caps_malloc((size_t)len + 1U, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (msg.payload == NULL) {
-        msg.payload = (char *)malloc((size_t)len + 1U);
-    }
-    if (msg.payload == NULL) {
-        ESP_LOGW(TAG_HA_CLIENT, "Drop WS message: out of memory (len=%d)", len);
-        return;
-    }
-    memcpy(msg.payload, data, (size_t)len);
-    msg.payload[len] = '\0';
-    msg.len = len;
+    ha_ws_rx_msg_t msg = {
+        .payload = lease->data,
+        .len = len,
+        .lease = *lease,
+    };
+    memset(lease, 0, sizeof(*lease));
 
     if (xQueueSend(s_client.ws_rx_queue, &msg, 0) != pdTRUE) {
         /* Keep freshest state changes: drop oldest queued message and retry once. */
         ha_ws_rx_msg_t dropped = {0};
         if (xQueueReceive(s_client.ws_rx_queue, &dropped, 0) == pdTRUE) {
             ha_client_free_ws_msg(&dropped);
+            ha_ws_rx_pool_note_drop_oldest();
             if (xQueueSend(s_client.ws_rx_queue, &msg, 0) == pdTRUE) {
                 ESP_LOGW(TAG_HA_CLIENT, "WS rx queue full: dropped oldest message to keep latest (len=%d)", len);
                 return;
             }
         }
         ESP_LOGW(TAG_HA_CLIENT, "Drop WS message: rx queue full (len=%d)", len);
+        ha_ws_rx_pool_note_drop_full();
         ha_client_free_ws_msg(&msg);
     }
 }
 
+/* Reserves slabs for a new frame. When the ring is full, the oldest queued frames are evicted
+ * (same freshest-wins policy as a full queue) until the new one fits. The new frame is dropped
+ * instead when nothing is left to evict, or when evicting cannot open a long enough run because the
+ * frame the HA task is handling blocks the tail. */
+static bool ha_client_reserve_ws_rx(size_t len)
+{
+    while (!ha_ws_rx_pool_reserve(len, &s_ws_rx_lease)) {
+        ha_ws_rx_msg_t oldest = {0};
+        if (s_client.ws_rx_queue == NULL || xQueuePeek(s_client.ws_rx_queue, &oldest, 0) != pdTRUE ||
+            !ha_ws_rx_pool_eviction_can_fit(&oldest.lease, len)) {
+            ha_ws_rx_pool_note_drop_full();
+            ESP_LOGW(TAG_HA_CLIENT, "Drop WS message: receive slabs exhausted (len=%u)", (unsigned)len);
+            return false;
+        }
+        ha_ws_rx_msg_t dropped = {0};
+        if (xQueueReceive(s_client.ws_rx_queue, &dropped, 0) == pdTRUE) {
+            ha_client_free_ws_msg(&dropped);
+            ha_ws_rx_pool_note_drop_oldest();
+        }
+    }
+    return true;
+}
+
 static int64_t ha_client_now_ms(void)
 {
     return esp_timer_get_time() / 1000;
@@ -754,6 +802,8 @@ static void ha_client_clear_entities_sub_buffers(void)
     if (s_client.entities_sub_seen != NULL) {
         memset(s_client.entities_sub_seen, 0, HA_WS_ENTITIES_SUB_ID_BYTES);
     }
+    /* The subscriptions themselves end with the connection or are resubscribed from scratch. */
+    s_client.entities_unsub_count = 0;
 }
 
 static uint16_t ha_client_prepare_entities_resubscribe_locked(int64_t now_ms)
@@ -806,6 +856,10 @@ static void ha_client_free_entities_sub_buffers(void)
         heap_caps_free(s_client.entities_sub_seen);
         s_client.entities_sub_seen = NULL;
     }
+    if (s_client.ws_diff_attrs_buf != NULL) {
+        heap_caps_free(s_client.ws_diff_attrs_buf);
+        s_client.ws_diff_attrs_buf = NULL;
+    }
 }
 
 static esp_err_t ha_client_ensure_entities_sub_buffers(void)
@@ -874,36 +928,12 @@ fail:
     return ESP_ERR_NO_MEM;
 }
 
-static esp_err_t ha_client_ensure_ws_rx_buffer(void)
-{
-    if (s_ws_rx_buf != NULL && s_ws_rx_buf_cap > 0U) {
-        return ESP_OK;
-    }
-
-    char *buf = (char *)heap_caps_malloc(HA_WS_RX_ASSEMBLY_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (buf == NULL) {
-        /* Fallback only if PSRAM allocation is unavailable. */
-        buf = (char *)heap_caps_malloc(HA_WS_RX_ASSEMBLY_BUF_SIZE, MALLOC_CAP_8BIT);
-    }
-    if (buf == NULL) {
-        ESP_LOGE(TAG_HA_CLIENT, "Failed to allocate WS RX assembly buffer (%u bytes)", (unsigned)HA_WS_RX_ASSEMBLY_BUF_SIZE);
-        return ESP_ERR_NO_MEM;
-    }
-
-    s_ws_rx_buf = buf;
-    s_ws_rx_buf_cap = HA_WS_RX_ASSEMBLY_BUF_SIZE;
-    s_ws_rx_buf[0] = '\0';
-    return ESP_OK;
-}
-
 static void ha_client_reset_ws_rx_assembly(void)
 {
     s_ws_rx_len = 0;
     s_ws_rx_expected_len = 0;
     s_ws_rx_overflow = false;
-    if (s_ws_rx_buf != NULL && s_ws_rx_buf_cap > 0U) {
-        s_ws_rx_buf[0] = '\0';
-    }
+    ha_ws_rx_pool_release(&s_ws_rx_lease);
 }
 
 static void ha_client_handle_text_chunk(const ha_ws_event_t *event)
@@ -912,10 +942,6 @@ static void ha_client_handle_text_chunk(const ha_ws_event_t *event)
         return;
     }
 
-    if (ha_client_ensure_ws_rx_buffer() != ESP_OK) {
-        return;
-    }
-
     int chunk_len = event->data_len;
     if (chunk_len < 0) {
         ESP_LOGW(TAG_HA_CLIENT, "Dropped WS chunk with invalid len=%d", event->data_len);
@@ -929,6 +955,14 @@ static void ha_client_handle_text_chunk(const ha_ws_event_t *event)
         } else {
             s_ws_rx_expected_len = chunk_len;
         }
+        if (!ha_ws_rx_pool_fits((size_t)s_ws_rx_expected_len)) {
+            s_ws_rx_overflow = true;
+            ha_ws_rx_pool_note_drop_oversize();
+            ESP_LOGW(TAG_HA_CLIENT, "WS message too large for receive slabs (%d > %d), dropping",
+                s_ws_rx_expected_len, (int)APP_HA_WS_RX_MAX_MESSAGE_LEN);
+        } else if (!ha_client_reserve_ws_rx((size_t)s_ws_rx_expected_len)) {
+            s_ws_rx_overflow = true;
+        }
     } else if (s_ws_rx_len == 0 && s_ws_rx_expected_len == 0) {
         ESP_LOGW(TAG_HA_CLIENT, "Dropped orphan WS chunk (offset=%d len=%d)", event->payload_offset, chunk_len);
         return;
@@ -940,15 +974,17 @@ static void ha_client_handle_text_chunk(const ha_ws_event_t *event)
             ESP_LOGW(TAG_HA_CLIENT, "WS chunk payload missing (offset=%d len=%d), dropping message",
                 event->payload_offset, chunk_len);
         } else if (!s_ws_rx_overflow) {
-            int space = (int)s_ws_rx_buf_cap - 1 - s_ws_rx_len;
+            /* The run was sized from payload_len; a frame outgrowing it is dropped like before. */
+            int space = s_ws_rx_expected_len - s_ws_rx_len;
             if (space < chunk_len) {
                 s_ws_rx_overflow = true;
-                ESP_LOGW(TAG_HA_CLIENT, "WS message too large for buffer (%d > %d), dropping fragmented message",
-                    s_ws_rx_len + chunk_len, (int)s_ws_rx_buf_cap - 1);
+                ha_ws_rx_pool_note_drop_oversize();
+                ESP_LOGW(TAG_HA_CLIENT, "WS message larger than announced (%d > %d), dropping fragmented message",
+                    s_ws_rx_len + chunk_len, s_ws_rx_expected_len);
             } else {
-                memcpy(&s_ws_rx_buf[s_ws_rx_len], event->data, (size_t)chunk_len);
+                memcpy(&s_ws_rx_lease.data[s_ws_rx_len], event->data, (size_t)chunk_len);
                 s_ws_rx_len += chunk_len;
-                s_ws_rx_buf[s_ws_rx_len] = '\0';
+                s_ws_rx_lease.data[s_ws_rx_len] = '\0';
             }
         }
     }
@@ -967,7 +1003,7 @@ static void ha_client_handle_text_chunk(const ha_ws_event_t *event)
     }
 
     if (!s_ws_rx_overflow && s_ws_rx_len > 0) {
-        ha_client_enqueue_ws_text(s_ws_rx_buf, s_ws_rx_len);
+        ha_client_enqueue_ws_text(&s_ws_rx_lease, s_ws_rx_len);
     }
     ha_client_reset_ws_rx_assembly();
 }
@@ -2138,102 +2174,10 @@ static esp_err_t ha_client_ensure_http_client(const char *base_url, const char *
     return ESP_OK;
 }
 
-static bool ha_client_entity_id_in_list(const char *entity_ids, size_t count, const char *entity_id)
-{
-    if (entity_ids == NULL || entity_id == NULL) {
-        return false;
-    }
-
-    for (size_t i = 0; i < count; i++) {
-        const char *entry = entity_ids + (i * APP_MAX_ENTITY_ID_LEN);
-        if (strncmp(entry, entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-static void ha_client_collect_entity_id(
-    cJSON *widget, const char *key, char *entity_ids, size_t *count, size_t max_count)
-{
-    if (widget == NULL || key == NULL || entity_ids == NULL || count == NULL || *count >= max_count) {
-        return;
-    }
-
-    cJSON *id_item = cJSON_GetObjectItemCaseSensitive(widget, key);
-    if (!cJSON_IsString(id_item) || id_item->valuestring == NULL || id_item->valuestring[0] == '\0') {
-        return;
-    }
-    if (ha_client_entity_id_in_list(entity_ids, *count, id_item->valuestring)) {
-        return;
-    }
-
-    char *dst = entity_ids + (*count * APP_MAX_ENTITY_ID_LEN);
-    safe_copy_cstr(dst, APP_MAX_ENTITY_ID_LEN, id_item->valuestring);
-    (*count)++;
-}
-
+/* Entity_ids of the compiled layout, in first-use order; no layout JSON is read or parsed. */
 static size_t ha_client_collect_layout_entity_ids(char *entity_ids, size_t max_count, bool *out_need_weather_forecast)
 {
-    if (entity_ids == NULL || max_count == 0) {
-        if (out_need_weather_forecast != NULL) {
-            *out_need_weather_forecast = false;
-        }
-        return 0;
-    }
-
-    char *layout_json = NULL;
-    esp_err_t load_err = layout_store_load(&layout_json);
-    if (load_err != ESP_OK || layout_json == NULL) {
-        layout_json = strdup(layout_store_default_json());
-        if (layout_json == NULL) {
-            return 0;
-        }
-    }
-
-    cJSON *root = cJSON_Parse(layout_json);
-    free(layout_json);
-    if (root == NULL) {
-        if (out_need_weather_forecast != NULL) {
-            *out_need_weather_forecast = false;
-        }
-        return 0;
-    }
-
-    size_t count = 0;
-    bool need_weather_forecast = false;
-    cJSON *pages = cJSON_GetObjectItemCaseSensitive(root, "pages");
-    if (cJSON_IsArray(pages)) {
-        int page_count = cJSON_GetArraySize(pages);
-        for (int p = 0; p < page_count && count < max_count; p++) {
-            cJSON *page = cJSON_GetArrayItem(pages, p);
-            cJSON *widgets = cJSON_GetObjectItemCaseSensitive(page, "widgets");
-            if (!cJSON_IsArray(widgets)) {
-                continue;
-            }
-
-            int widget_count = cJSON_GetArraySize(widgets);
-            for (int w = 0; w < widget_count && count < max_count; w++) {
-                cJSON *widget = cJSON_GetArrayItem(widgets, w);
-                if (!cJSON_IsObject(widget)) {
-                    continue;
-                }
-                cJSON *type = cJSON_GetObjectItemCaseSensitive(widget, "type");
-                if (cJSON_IsString(type) && type->valuestring != NULL &&
-                    strcmp(type->valuestring, "weather_3day") == 0) {
-                    need_weather_forecast = true;
-                }
-                ha_client_collect_entity_id(widget, "entity_id", entity_ids, &count, max_count);
-                ha_client_collect_entity_id(widget, "secondary_entity_id", entity_ids, &count, max_count);
-            }
-        }
-    }
-
-    cJSON_Delete(root);
-    if (out_need_weather_forecast != NULL) {
-        *out_need_weather_forecast = need_weather_forecast;
-    }
-    return count;
+    return layout_store_copy_entity_ids(entity_ids, max_count, out_need_weather_forecast, NULL);
 }
 
 static int ha_client_entity_id_sort_cmp(const void *lhs, const void *rhs)
@@ -2244,29 +2188,44 @@ static int ha_client_entity_id_sort_cmp(const void *lhs, const void *rhs)
     return strncmp((const char *)lhs, (const char *)rhs, APP_MAX_ENTITY_ID_LEN);
 }
 
-static uint32_t ha_client_layout_entity_signature(char *entity_ids, size_t entity_count)
+/* Takes ownership of a sorted id list as the ingest filter. */
+static void ha_client_install_layout_filter(char *sorted_entity_ids, size_t entity_count)
 {
-    if (entity_ids == NULL || entity_count == 0) {
-        return 0;
+    if (s_client.mutex == NULL) {
+        free(sorted_entity_ids);
+        return;
     }
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    char *previous = s_client.layout_filter_ids;
+    s_client.layout_filter_ids = sorted_entity_ids;
+    s_client.layout_filter_count = (entity_count > UINT16_MAX) ? UINT16_MAX : (uint16_t)entity_count;
+    s_client.layout_filter_ready = true;
+    xSemaphoreGive(s_client.mutex);
+    free(previous);
+}
 
-    qsort(entity_ids, entity_count, APP_MAX_ENTITY_ID_LEN, ha_client_entity_id_sort_cmp);
+static void ha_client_free_layout_filter(void)
+{
+    free(s_client.layout_filter_ids);
+    s_client.layout_filter_ids = NULL;
+    s_client.layout_filter_count = 0;
+    s_client.layout_filter_ready = false;
+}
 
-    uint32_t hash = 2166136261u; /* FNV-1a 32-bit */
-    for (size_t i = 0; i < entity_count; i++) {
-        const char *entry = entity_ids + (i * APP_MAX_ENTITY_ID_LEN);
-        for (size_t j = 0; j < APP_MAX_ENTITY_ID_LEN; j++) {
-            uint8_t ch = (uint8_t)entry[j];
-            if (ch == '\0') {
-                break;
-            }
-            hash ^= ch;
-            hash *= 16777619u;
-        }
-        hash ^= 0xFFu; /* delimiter to avoid concatenation ambiguity */
-        hash *= 16777619u;
+/* Earliest-stage ingest check: binary search over the sorted layout ids. Everything passes until the
+ * first layout snapshot exists, so a missing filter never hides states. */
+static bool ha_client_layout_filter_allows(const char *entity_id)
+{
+    if (entity_id == NULL || entity_id[0] == '\0' || s_client.mutex == NULL) {
+        return false;
     }
-    return hash;
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    bool allowed = !s_client.layout_filter_ready ||
+                   (s_client.layout_filter_ids != NULL &&
+                       bsearch(entity_id, s_client.layout_filter_ids, s_client.layout_filter_count,
+                           APP_MAX_ENTITY_ID_LEN, ha_client_entity_id_sort_cmp) != NULL);
+    xSemaphoreGive(s_client.mutex);
+    return allowed;
 }
 
 static bool ha_client_capture_layout_snapshot(
@@ -2287,10 +2246,12 @@ static bool ha_client_capture_layout_snapshot(
     }
 
     bool need_weather_forecast = false;
-    size_t entity_count = ha_client_collect_layout_entity_ids(entity_ids, max_entities, &need_weather_forecast);
-    uint32_t signature = ha_client_layout_entity_signature(entity_ids, entity_count);
-
-    free(entity_ids);
+    uint32_t signature = 0;
+    size_t entity_count = layout_store_copy_entity_ids(entity_ids, max_entities, &need_weather_forecast, &signature);
+    if (entity_count > 0) {
+        qsort(entity_ids, entity_count, APP_MAX_ENTITY_ID_LEN, ha_client_entity_id_sort_cmp);
+    }
+    ha_client_install_layout_filter(entity_ids, entity_count);
 
     *out_signature = signature;
     *out_count = (entity_count > UINT16_MAX) ? UINT16_MAX : (uint16_t)entity_count;
@@ -2564,11 +2525,13 @@ static void ha_client_publish_event(app_event_type_t type, const char *entity_id
     static uint32_t dropped_count = 0;
     static int64_t last_drop_log_ms = 0;
 
-    app_event_t event = {.type = type};
-    if (type == EV_HA_STATE_CHANGED && entity_id != NULL) {
-        snprintf(event.data.ha_state_changed.entity_id, sizeof(event.data.ha_state_changed.entity_id), "%s", entity_id);
+    if (type == EV_HA_STATE_CHANGED) {
+        /* Coalesced in the dirty set, never queued; a handle of NONE was never stored in the model. */
+        app_events_mark_state_dirty(ha_entity_ids_find(entity_id));
+        return;
     }
 
+    app_event_t event = {.type = type};
     bool queued = app_events_publish(&event, pdMS_TO_TICKS(10));
     if (queued) {
         return;
@@ -2580,14 +2543,14 @@ static void ha_client_publish_event(app_event_type_t type, const char *entity_id
         return;
     }
 
-    QueueHandle_t q = app_events_get_queue();
-    UBaseType_t depth = (q != NULL) ? uxQueueMessagesWaiting(q) : 0;
+    app_events_stats_t stats = {0};
+    app_events_get_stats(&stats);
     ESP_LOGW(TAG_HA_CLIENT,
         "App event queue saturated: dropped=%u type=%d entity=%s depth=%u/%u",
         (unsigned)dropped_count,
         (int)type,
         (entity_id != NULL && entity_id[0] != '\0') ? entity_id : "-",
-        (unsigned)depth,
+        (unsigned)stats.lanes[APP_EVENT_LANE_BACKGROUND].queue_depth,
         (unsigned)APP_EVENT_QUEUE_LENGTH);
     dropped_count = 0;
     last_drop_log_ms = now_ms;
@@ -2672,6 +2635,58 @@ static esp_err_t ha_client_send_weather_daily_forecast_ws(const char *entity_id,
     return err;
 }
 
+static void ha_client_format_utc(uint32_t unix_ts, char *dst, size_t dst_size)
+{
+    time_t t = (time_t)unix_ts;
+    struct tm tm_utc = {0};
+    gmtime_r(&t, &tm_utc);
+    strftime(dst, dst_size, "%Y-%m-%dT%H:%M:%S+00:00", &tm_utc);
+}
+
+/* Recorded states of one entity in [start_ts, end_ts), in HA's compressed form: {"s": ..., "lu": ...}
+ * per change, starting with the state at start_ts. */
+static esp_err_t ha_client_send_history_during_period(
+    const char *entity_id, uint32_t start_ts, uint32_t end_ts, uint32_t *out_req_id)
+{
+    if (entity_id == NULL || entity_id[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *ids = cJSON_CreateArray();
+    cJSON *id_item = cJSON_CreateString(entity_id);
+    if (root == NULL || ids == NULL || id_item == NULL) {
+        cJSON_Delete(root);
+        cJSON_Delete(ids);
+        cJSON_Delete(id_item);
+        return ESP_ERR_NO_MEM;
+    }
+
+    char start_time[32] = {0};
+    char end_time[32] = {0};
+    ha_client_format_utc(start_ts, start_time, sizeof(start_time));
+    ha_client_format_utc(end_ts, end_time, sizeof(end_time));
+
+    uint32_t req_id = ha_client_next_message_id();
+    cJSON_AddNumberToObject(root, "id", (double)req_id);
+    cJSON_AddStringToObject(root, "type", "history/history_during_period");
+    cJSON_AddStringToObject(root, "start_time", start_time);
+    cJSON_AddStringToObject(root, "end_time", end_time);
+    cJSON_AddItemToArray(ids, id_item);
+    cJSON_AddItemToObject(root, "entity_ids", ids);
+    cJSON_AddBoolToObject(root, "include_start_time_state", true);
+    cJSON_AddBoolToObject(root, "significant_changes_only", false);
+    cJSON_AddBoolToObject(root, "minimal_response", true);
+    cJSON_AddBoolToObject(root, "no_attributes", true);
+
+    esp_err_t err = ha_client_send_json(root);
+    cJSON_Delete(root);
+    if (err == ESP_OK && out_req_id != NULL) {
+        *out_req_id = req_id;
+    }
+    return err;
+}
+
 static esp_err_t ha_client_send_subscribe_single_entity(const char *entity_id, uint32_t *out_req_id)
 {
     if (entity_id == NULL || entity_id[0] == '\0') {
@@ -2706,6 +2721,20 @@ static esp_err_t ha_client_send_subscribe_single_entity(const char *entity_id, u
     return err;
 }
 
+static esp_err_t ha_client_send_unsubscribe_events(uint32_t subscription)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    cJSON_AddNumberToObject(root, "id", (double)ha_client_next_message_id());
+    cJSON_AddStringToObject(root, "type", "unsubscribe_events");
+    cJSON_AddNumberToObject(root, "subscription", (double)subscription);
+    esp_err_t err = ha_client_send_json(root);
+    cJSON_Delete(root);
+    return err;
+}
+
 static esp_err_t ha_client_send_subscribe_layout_state_trigger(void)
 {
     size_t max_entities = (size_t)APP_MAX_WIDGETS_TOTAL * 2U;
@@ -2875,6 +2904,18 @@ static esp_err_t ha_client_send_pong(uint32_t pong_id)
     return err;
 }
 
+static char *ha_client_alloc_attrs_buf(void)
+{
+    char *buf = (char *)heap_caps_malloc(APP_HA_ATTRS_MAX_LEN, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buf == NULL) {
+        buf = (char *)heap_caps_malloc(APP_HA_ATTRS_MAX_LEN, MALLOC_CAP_8BIT);
+    }
+    if (buf != NULL) {
+        buf[0] = '\0';
+    }
+    return buf;
+}
+
 static bool ha_client_import_state_object(cJSON *state_obj)
 {
     if (!cJSON_IsObject(state_obj)) {
@@ -2891,83 +2932,96 @@ static bool ha_client_import_state_object(cJSON *state_obj)
     }
 
     ha_state_t model_state = {0};
-    snprintf(model_state.entity_id, sizeof(model_state.entity_id), "%s", entity_id->valuestring);
+    model_state.entity = ha_model_intern_entity_id(entity_id->valuestring);
+    if (model_state.entity == HA_ENTITY_HANDLE_NONE) {
+        return false;
+    }
+    /* Scratch for the serialized attributes; the model copies only the used bytes into its arena. */
+    char *attrs_json = ha_client_alloc_attrs_buf();
+    if (attrs_json == NULL) {
+        return false;
+    }
+    model_state.attributes_json = attrs_json;
+    ha_forecast_row_t forecast_rows[HA_STATE_ATTRS_FORECAST_MAX];
+    const char *model_entity_id = ha_entity_ids_str(model_state.entity);
     snprintf(model_state.state, sizeof(model_state.state), "%s", state->valuestring);
     model_state.last_changed_unix_ms = esp_timer_get_time() / 1000;
     bool weather_missing_forecast = false;
-    bool is_media_player = ha_client_entity_is_media_player(model_state.entity_id);
-    ha_state_t previous_compact_state = {0};
-    bool has_previous_compact_state = false;
-    if (is_media_player) {
-        has_previous_compact_state = ha_model_get_state(model_state.entity_id, &previous_compact_state);
-    }
+    bool is_media_player = ha_client_entity_is_media_player(model_entity_id);
 
     if (cJSON_IsObject(attributes)) {
         bool serialized = false;
-        if (ha_client_entity_is_weather(model_state.entity_id)) {
-            serialized = ha_client_serialize_weather_attrs_compact(
-                attributes, model_state.attributes_json, sizeof(model_state.attributes_json));
-            bool weather_has_forecast = serialized && ha_client_weather_attrs_has_forecast_json(model_state.attributes_json);
+        if (ha_client_entity_is_weather(model_entity_id)) {
+            serialized = ha_client_serialize_weather_attrs_compact(attributes, attrs_json, APP_HA_ATTRS_MAX_LEN);
+            bool weather_has_forecast = serialized && ha_client_weather_attrs_has_forecast_json(attrs_json);
             if (serialized && !weather_has_forecast) {
-                ha_state_t previous_weather_state = {0};
-                if (ha_model_get_state(model_state.entity_id, &previous_weather_state)) {
+                ha_model_state_ref_t previous_weather = {0};
+                if (ha_model_borrow_state(model_state.entity, &previous_weather)) {
                     cJSON *previous_forecast =
-                        ha_client_extract_compact_forecast_from_attrs_json(previous_weather_state.attributes_json);
+                        ha_client_extract_compact_forecast_from_attrs_json(previous_weather.state->attributes_json);
+                    ha_model_release_state(&previous_weather);
                     if (previous_forecast != NULL) {
                         if (!ha_client_append_compact_forecast_to_attrs_json(
-                                model_state.attributes_json, sizeof(model_state.attributes_json), previous_forecast)) {
-                            ESP_LOGW(TAG_HA_CLIENT, "Failed to preserve previous forecast for %s", model_state.entity_id);
+                                attrs_json, APP_HA_ATTRS_MAX_LEN, previous_forecast)) {
+                            ESP_LOGW(TAG_HA_CLIENT, "Failed to preserve previous forecast for %s", model_entity_id);
                         }
                     }
                 }
-                weather_has_forecast = ha_client_weather_attrs_has_forecast_json(model_state.attributes_json);
+                weather_has_forecast = ha_client_weather_attrs_has_forecast_json(attrs_json);
             }
             if (serialized && !weather_has_forecast) {
                 weather_missing_forecast = true;
             }
-        } else if (ha_client_entity_is_climate(model_state.entity_id)) {
-            serialized = ha_client_serialize_climate_attrs_compact(
-                attributes, model_state.attributes_json, sizeof(model_state.attributes_json));
+        } else if (ha_client_entity_is_climate(model_entity_id)) {
+            serialized = ha_client_serialize_climate_attrs_compact(attributes, attrs_json, APP_HA_ATTRS_MAX_LEN);
             if (!serialized) {
-                snprintf(model_state.attributes_json, sizeof(model_state.attributes_json), "{}");
+                snprintf(attrs_json, APP_HA_ATTRS_MAX_LEN, "{}");
                 serialized = true;
             }
-        } else if (ha_client_entity_is_media_player(model_state.entity_id)) {
-            serialized = ha_client_serialize_media_player_attrs_compact(
-                attributes, model_state.attributes_json, sizeof(model_state.attributes_json));
+        } else if (ha_client_entity_is_media_player(model_entity_id)) {
+            serialized = ha_client_serialize_media_player_attrs_compact(attributes, attrs_json, APP_HA_ATTRS_MAX_LEN);
             if (!serialized) {
-                snprintf(model_state.attributes_json, sizeof(model_state.attributes_json), "{}");
+                snprintf(attrs_json, APP_HA_ATTRS_MAX_LEN, "{}");
                 serialized = true;
             }
         }
 
         if (!serialized) {
+            /* Stored verbatim: take the typed attributes from the tree we already have. */
+            ha_state_attrs_from_cjson(attributes, &model_state.attrs, forecast_rows, HA_STATE_ATTRS_FORECAST_MAX);
             char *attr_json = cJSON_PrintUnformatted(attributes);
             if (attr_json != NULL) {
-                int written = snprintf(model_state.attributes_json, sizeof(model_state.attributes_json), "%s", attr_json);
-                if (written >= (int)sizeof(model_state.attributes_json)) {
+                int written = snprintf(attrs_json, APP_HA_ATTRS_MAX_LEN, "%s", attr_json);
+                if (written >= (int)APP_HA_ATTRS_MAX_LEN) {
                     ESP_LOGW(TAG_HA_CLIENT, "attributes_json truncated for %s (%d > %u bytes)",
-                        model_state.entity_id, written, (unsigned)(sizeof(model_state.attributes_json) - 1U));
+                        model_entity_id, written, (unsigned)(APP_HA_ATTRS_MAX_LEN - 1U));
                 }
                 cJSON_free(attr_json);
             }
         }
     } else {
-        snprintf(model_state.attributes_json, sizeof(model_state.attributes_json), "{}");
+        snprintf(attrs_json, APP_HA_ATTRS_MAX_LEN, "{}");
     }
 
     bool media_player_compact_changed = true;
-    if (is_media_player && has_previous_compact_state) {
-        media_player_compact_changed =
-            (strncmp(previous_compact_state.state, model_state.state, sizeof(model_state.state)) != 0) ||
-            (strncmp(previous_compact_state.attributes_json, model_state.attributes_json,
-                sizeof(model_state.attributes_json)) != 0);
-        if (!media_player_compact_changed) {
-            model_state.last_changed_unix_ms = previous_compact_state.last_changed_unix_ms;
+    bool has_previous_compact_state = false;
+    if (is_media_player) {
+        ha_model_state_ref_t previous_compact = {0};
+        has_previous_compact_state = ha_model_borrow_state(model_state.entity, &previous_compact);
+        if (has_previous_compact_state) {
+            media_player_compact_changed =
+                (strncmp(previous_compact.state->state, model_state.state, sizeof(model_state.state)) != 0) ||
+                (strncmp(previous_compact.state->attributes_json, attrs_json, APP_HA_ATTRS_MAX_LEN) != 0);
+            if (!media_player_compact_changed) {
+                model_state.last_changed_unix_ms = previous_compact.state->last_changed_unix_ms;
+            }
+            ha_model_release_state(&previous_compact);
         }
     }
 
     ha_model_upsert_state(&model_state);
+    heap_caps_free(attrs_json);
+    model_state.attributes_json = NULL;
     if (weather_missing_forecast && s_client.mutex != NULL) {
         bool scheduled_retry = false;
         int64_t now_ms = ha_client_now_ms();
@@ -2975,27 +3029,27 @@ static bool ha_client_import_state_object(cJSON *state_obj)
         bool allow_priority_sync =
             s_client.layout_needs_weather_forecast && (s_client.initial_layout_sync_done || !APP_HA_FETCH_INITIAL_STATES);
         if (allow_priority_sync && now_ms >= s_client.next_weather_forecast_retry_unix_ms) {
-            ha_client_priority_sync_queue_push_locked(model_state.entity_id);
+            ha_client_priority_sync_queue_push_locked(model_entity_id);
             s_client.next_priority_sync_unix_ms = now_ms;
             s_client.next_weather_forecast_retry_unix_ms = now_ms + HA_WEATHER_FORECAST_RETRY_MIN_MS;
             scheduled_retry = true;
         }
         xSemaphoreGive(s_client.mutex);
         if (!scheduled_retry) {
-            ESP_LOGD(TAG_HA_CLIENT, "Weather forecast retry deferred for %s", model_state.entity_id);
+            ESP_LOGD(TAG_HA_CLIENT, "Weather forecast retry deferred for %s", model_entity_id);
         }
     }
 
     ha_entity_info_t entity = {0};
-    safe_copy_cstr(entity.id, sizeof(entity.id), model_state.entity_id);
-    safe_copy_cstr(entity.name, sizeof(entity.name), model_state.entity_id);
-    const char *dot = strchr(model_state.entity_id, '.');
+    entity.entity = model_state.entity;
+    safe_copy_cstr(entity.name, sizeof(entity.name), model_entity_id);
+    const char *dot = strchr(model_entity_id, '.');
     if (dot != NULL) {
-        size_t domain_len = (size_t)(dot - model_state.entity_id);
+        size_t domain_len = (size_t)(dot - model_entity_id);
         if (domain_len >= sizeof(entity.domain)) {
             domain_len = sizeof(entity.domain) - 1U;
         }
-        memcpy(entity.domain, model_state.entity_id, domain_len);
+        memcpy(entity.domain, model_entity_id, domain_len);
         entity.domain[domain_len] = '\0';
     } else {
         snprintf(entity.domain, sizeof(entity.domain), "unknown");
@@ -3107,34 +3161,133 @@ static void ha_client_mark_entities_seen(const char *entity_id)
     xSemaphoreGive(s_client.mutex);
 }
 
-static uint32_t ha_client_import_ws_entities_added(cJSON *added_map)
+static void ha_client_forget_entities_seen_locked(const char *entity_id)
 {
-    if (!cJSON_IsObject(added_map)) {
-        return 0;
+    for (uint16_t i = 0; i < s_client.entities_sub_seen_count && i < HA_WS_ENTITIES_SUB_MAX; i++) {
+        char *seen = ha_client_entities_sub_seen_at(i);
+        if (seen == NULL || strncmp(seen, entity_id, APP_MAX_ENTITY_ID_LEN) != 0) {
+            continue;
+        }
+        uint16_t last = (uint16_t)(s_client.entities_sub_seen_count - 1U);
+        const char *last_seen = ha_client_entities_sub_seen_at(last);
+        if (i != last && last_seen != NULL) {
+            memcpy(seen, last_seen, APP_MAX_ENTITY_ID_LEN);
+        }
+        s_client.entities_sub_seen_count = last;
+        return;
     }
+}
 
-    uint32_t imported = 0;
-    cJSON *entry = NULL;
-    cJSON_ArrayForEach(entry, added_map)
-    {
-        if (entry->string == NULL || !cJSON_IsObject(entry)) {
+/* Moves the per-entity subscriptions to the layout filter just installed: targets that left the
+ * layout are dropped (sent ones queued for unsubscribe_events) and new entity_ids are appended to the
+ * subscribe sequence, whose first event carries their state. Kept subscriptions stay untouched.
+ * Returns false, with nothing changed, when a full resubscribe is needed instead. */
+static bool ha_client_apply_entities_sub_delta_locked(int64_t now_ms, uint16_t *out_added, uint16_t *out_removed)
+{
+    if (s_client.layout_filter_ids == NULL || s_client.layout_filter_count > HA_WS_ENTITIES_SUB_MAX ||
+        s_client.entities_sub_targets == NULL || s_client.entities_sub_req_ids == NULL ||
+        s_client.entities_sub_seen == NULL) {
+        return false;
+    }
+
+    /* Compaction keeps order, so the sent targets stay a prefix. */
+    uint16_t kept = 0;
+    uint16_t kept_sent = 0;
+    uint16_t removed = 0;
+    for (uint16_t i = 0; i < s_client.entities_sub_target_count && i < HA_WS_ENTITIES_SUB_MAX; i++) {
+        char *target = ha_client_entities_sub_target_at(i);
+        bool wanted = bsearch(target, s_client.layout_filter_ids, s_client.layout_filter_count,
+                          APP_MAX_ENTITY_ID_LEN, ha_client_entity_id_sort_cmp) != NULL;
+        bool sent = (i < s_client.entities_sub_sent_count);
+        if (!wanted) {
+            if (sent && s_client.entities_sub_req_ids[i] != 0U) {
+                if (s_client.entities_unsub_count < HA_WS_ENTITIES_UNSUB_QUEUE_MAX) {
+                    s_client.entities_unsub_queue[s_client.entities_unsub_count++] = s_client.entities_sub_req_ids[i];
+                } else {
+                    ESP_LOGW(TAG_HA_CLIENT, "Unsubscribe queue full, leaving subscription for %s open", target);
+                }
+            }
+            ha_client_forget_entities_seen_locked(target);
+            removed++;
             continue;
         }
-        cJSON *state_item = cJSON_GetObjectItemCaseSensitive(entry, "s");
-        cJSON *attrs_item = cJSON_GetObjectItemCaseSensitive(entry, "a");
-        const char *state_value = cJSON_IsString(state_item) && state_item->valuestring != NULL
-            ? state_item->valuestring
-            : "unknown";
-        bool state_changed = ha_client_import_ws_entity_state(entry->string, state_value, attrs_item);
-        ha_client_mark_entities_seen(entry->string);
-        if (!state_changed) {
+        if (kept != i) {
+            memcpy(ha_client_entities_sub_target_at(kept), target, APP_MAX_ENTITY_ID_LEN);
+            s_client.entities_sub_req_ids[kept] = s_client.entities_sub_req_ids[i];
+        }
+        kept_sent += sent ? 1U : 0U;
+        kept++;
+    }
+
+    uint16_t added = 0;
+    for (uint16_t f = 0; f < s_client.layout_filter_count; f++) {
+        const char *entity_id = s_client.layout_filter_ids + ((size_t)f * APP_MAX_ENTITY_ID_LEN);
+        bool present = false;
+        for (uint16_t i = 0; i < kept && !present; i++) {
+            present = strncmp(ha_client_entities_sub_target_at(i), entity_id, APP_MAX_ENTITY_ID_LEN) == 0;
+        }
+        if (present || entity_id[0] == '\0') {
             continue;
         }
-        ha_client_trace_service_state_changed(entry->string, state_value);
-        ha_client_publish_event(EV_HA_STATE_CHANGED, entry->string);
-        imported++;
+        uint16_t idx = (uint16_t)(kept + added);
+        safe_copy_cstr(ha_client_entities_sub_target_at(idx), APP_MAX_ENTITY_ID_LEN, entity_id);
+        s_client.entities_sub_req_ids[idx] = 0;
+        added++;
+    }
+
+    s_client.entities_sub_target_count = (uint16_t)(kept + added);
+    s_client.entities_sub_sent_count = kept_sent;
+    if (s_client.entities_sub_sent_count < s_client.entities_sub_target_count) {
+        s_client.pending_subscribe = APP_HA_SUBSCRIBE_STATE_CHANGED;
+        s_client.next_entities_subscribe_unix_ms = now_ms;
     }
-    return imported;
+    *out_added = added;
+    *out_removed = removed;
+    return true;
+}
+
+/* Sends unsubscribe_events for the queued subscriptions, oldest first; stops at the first failure. */
+static void ha_client_flush_entities_unsubscribes(void)
+{
+    for (;;) {
+        uint32_t subscription = 0;
+        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+        if (s_client.entities_unsub_count > 0U) {
+            subscription = s_client.entities_unsub_queue[0];
+        }
+        xSemaphoreGive(s_client.mutex);
+        if (subscription == 0U || ha_client_send_unsubscribe_events(subscription) != ESP_OK) {
+            return;
+        }
+
+        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+        if (s_client.entities_unsub_count > 0U && s_client.entities_unsub_queue[0] == subscription) {
+            s_client.entities_unsub_count--;
+            memmove(&s_client.entities_unsub_queue[0], &s_client.entities_unsub_queue[1],
+                (size_t)s_client.entities_unsub_count * sizeof(s_client.entities_unsub_queue[0]));
+        }
+        xSemaphoreGive(s_client.mutex);
+    }
+}
+
+static bool ha_client_import_ws_entity_added(const char *entity_id, cJSON *entry)
+{
+    if (entity_id == NULL || entity_id[0] == '\0' || !cJSON_IsObject(entry)) {
+        return false;
+    }
+    cJSON *state_item = cJSON_GetObjectItemCaseSensitive(entry, "s");
+    cJSON *attrs_item = cJSON_GetObjectItemCaseSensitive(entry, "a");
+    const char *state_value = cJSON_IsString(state_item) && state_item->valuestring != NULL
+        ? state_item->valuestring
+        : "unknown";
+    bool state_changed = ha_client_import_ws_entity_state(entity_id, state_value, attrs_item);
+    ha_client_mark_entities_seen(entity_id);
+    if (!state_changed) {
+        return false;
+    }
+    ha_client_trace_service_state_changed(entity_id, state_value);
+    ha_client_publish_event(EV_HA_STATE_CHANGED, entity_id);
+    return true;
 }
 
 static void ha_client_apply_ws_attr_plus(cJSON *attrs_obj, cJSON *plus_attrs)
@@ -3171,98 +3324,271 @@ static void ha_client_apply_ws_attr_minus(cJSON *attrs_obj, cJSON *minus_obj)
     }
 }
 
-static uint32_t ha_client_import_ws_entities_changed(cJSON *changed_map)
+static bool ha_client_import_ws_entity_changed(const char *entity_id, cJSON *entry)
 {
-    if (!cJSON_IsObject(changed_map)) {
-        return 0;
+    if (entity_id == NULL || entity_id[0] == '\0' || !cJSON_IsObject(entry)) {
+        return false;
+    }
+    if (ha_client_entity_is_media_player(entity_id) && ha_client_ws_media_player_change_can_skip(entry)) {
+        ha_client_mark_entities_seen(entity_id);
+        return false;
     }
 
-    uint32_t updated = 0;
-    cJSON *entry = NULL;
-    cJSON_ArrayForEach(entry, changed_map)
-    {
-        if (entry->string == NULL || !cJSON_IsObject(entry)) {
-            continue;
+    ha_model_state_ref_t prev = {0};
+    bool has_prev = ha_model_borrow_state(ha_entity_ids_find(entity_id), &prev);
+    char next_state[32] = "unknown";
+    cJSON *attrs_obj = NULL;
+    if (has_prev) {
+        if (prev.state->state[0] != '\0') {
+            safe_copy_cstr(next_state, sizeof(next_state), prev.state->state);
         }
-        if (ha_client_entity_is_media_player(entry->string) &&
-            ha_client_ws_media_player_change_can_skip(entry)) {
-            ha_client_mark_entities_seen(entry->string);
-            continue;
+        if (prev.state->attributes_json[0] != '\0') {
+            attrs_obj = cJSON_Parse(prev.state->attributes_json);
         }
+        ha_model_release_state(&prev);
+    }
+    if (!cJSON_IsObject(attrs_obj)) {
+        cJSON_Delete(attrs_obj);
+        attrs_obj = cJSON_CreateObject();
+    }
+    if (attrs_obj == NULL) {
+        return false;
+    }
 
-        ha_state_t prev = {0};
-        bool has_prev = ha_model_get_state(entry->string, &prev);
-        char next_state[32] = "unknown";
-        if (has_prev && prev.state[0] != '\0') {
-            safe_copy_cstr(next_state, sizeof(next_state), prev.state);
+    cJSON *plus_obj = cJSON_GetObjectItemCaseSensitive(entry, "+");
+    if (cJSON_IsObject(plus_obj)) {
+        cJSON *plus_state = cJSON_GetObjectItemCaseSensitive(plus_obj, "s");
+        if (cJSON_IsString(plus_state) && plus_state->valuestring != NULL) {
+            safe_copy_cstr(next_state, sizeof(next_state), plus_state->valuestring);
         }
+        cJSON *plus_attrs = cJSON_GetObjectItemCaseSensitive(plus_obj, "a");
+        ha_client_apply_ws_attr_plus(attrs_obj, plus_attrs);
+    }
 
-        cJSON *attrs_obj = NULL;
-        if (has_prev && prev.attributes_json[0] != '\0') {
-            attrs_obj = cJSON_Parse(prev.attributes_json);
-        }
-        if (!cJSON_IsObject(attrs_obj)) {
-            cJSON_Delete(attrs_obj);
-            attrs_obj = cJSON_CreateObject();
-        }
-        if (attrs_obj == NULL) {
-            continue;
-        }
+    cJSON *minus_obj = cJSON_GetObjectItemCaseSensitive(entry, "-");
+    ha_client_apply_ws_attr_minus(attrs_obj, minus_obj);
 
-        cJSON *plus_obj = cJSON_GetObjectItemCaseSensitive(entry, "+");
-        if (cJSON_IsObject(plus_obj)) {
-            cJSON *plus_state = cJSON_GetObjectItemCaseSensitive(plus_obj, "s");
-            if (cJSON_IsString(plus_state) && plus_state->valuestring != NULL) {
-                safe_copy_cstr(next_state, sizeof(next_state), plus_state->valuestring);
-            }
-            cJSON *plus_attrs = cJSON_GetObjectItemCaseSensitive(plus_obj, "a");
-            ha_client_apply_ws_attr_plus(attrs_obj, plus_attrs);
+    bool state_changed = ha_client_import_ws_entity_state(entity_id, next_state, attrs_obj);
+    cJSON_Delete(attrs_obj);
+    ha_client_mark_entities_seen(entity_id);
+    if (!state_changed) {
+        return false;
+    }
+    ha_client_trace_service_state_changed(entity_id, next_state);
+    ha_client_publish_event(EV_HA_STATE_CHANGED, entity_id);
+    return true;
+}
+
+static bool ha_client_import_ws_entity_removed(const char *entity_id)
+{
+    if (entity_id == NULL || entity_id[0] == '\0') {
+        return false;
+    }
+    bool state_changed = ha_client_import_ws_entity_state(entity_id, "unavailable", NULL);
+    ha_client_mark_entities_seen(entity_id);
+    if (!state_changed) {
+        return false;
+    }
+    ha_client_trace_service_state_changed(entity_id, "unavailable");
+    ha_client_publish_event(EV_HA_STATE_CHANGED, entity_id);
+    return true;
+}
+
+/* Attribute keys that also feed ha_entity_info_t; a diff touching them takes the tree path. */
+static bool ha_client_ws_diff_touches_entity_info(const json_span_t *plus_attrs)
+{
+    static const char *const keys[] = {"friendly_name", "unit_of_measurement", "device_class", "icon",
+        "supported_features"};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if (json_scan_object_get(plus_attrs, keys[i], NULL)) {
+            return true;
         }
+    }
+    return false;
+}
 
-        cJSON *minus_obj = cJSON_GetObjectItemCaseSensitive(entry, "-");
-        ha_client_apply_ws_attr_minus(attrs_obj, minus_obj);
+/* Applies a subscribe_entities "c" entry straight onto the stored attribute text: the previous
+ * attributes are merged with the "+" members and "-" keys by copying spans into a reused scratch
+ * buffer, and the model extracts typed attributes from that text without a tree. Returns false
+ * when the entry needs the cJSON path (compacted domains, entity info changes, overflow);
+ * *out_changed is set only when the model actually stored something new. */
+static bool ha_client_apply_ws_entity_diff(const char *entity_id, const json_span_t *entry, bool *out_changed)
+{
+    *out_changed = false;
+    if (ha_client_entity_is_weather(entity_id) || ha_client_entity_is_climate(entity_id) ||
+        ha_client_entity_is_media_player(entity_id)) {
+        return false;
+    }
 
-        bool state_changed = ha_client_import_ws_entity_state(entry->string, next_state, attrs_obj);
-        cJSON_Delete(attrs_obj);
-        ha_client_mark_entities_seen(entry->string);
-        if (!state_changed) {
-            continue;
+    json_span_t plus = {0};
+    json_span_t plus_state = {0};
+    json_span_t plus_attrs = {0};
+    json_span_t minus = {0};
+    json_span_t minus_keys = {0};
+    if (json_scan_object_get(entry, "+", &plus) && plus.type == JSON_SPAN_OBJECT) {
+        (void)json_scan_object_get(&plus, "s", &plus_state);
+        (void)json_scan_object_get(&plus, "a", &plus_attrs);
+    }
+    if (json_scan_object_get(entry, "-", &minus) && minus.type == JSON_SPAN_OBJECT) {
+        (void)json_scan_object_get(&minus, "a", &minus_keys);
+    }
+    bool has_plus_attrs = (plus_attrs.type == JSON_SPAN_OBJECT);
+    bool has_minus_keys = (minus_keys.type == JSON_SPAN_ARRAY);
+    if (has_plus_attrs && ha_client_ws_diff_touches_entity_info(&plus_attrs)) {
+        return false;
+    }
+    if (s_client.ws_diff_attrs_buf == NULL) {
+        s_client.ws_diff_attrs_buf = ha_client_alloc_attrs_buf();
+        if (s_client.ws_diff_attrs_buf == NULL) {
+            return false;
         }
-        ha_client_trace_service_state_changed(entry->string, next_state);
-        ha_client_publish_event(EV_HA_STATE_CHANGED, entry->string);
-        updated++;
     }
-    return updated;
+
+    ha_state_t next = {0};
+    next.entity = ha_model_intern_entity_id(entity_id);
+    if (next.entity == HA_ENTITY_HANDLE_NONE) {
+        return false;
+    }
+    snprintf(next.state, sizeof(next.state), "unknown");
+
+    /* Unknown entities go through the tree path so their entity info is created too. */
+    ha_model_state_ref_t prev = {0};
+    if (!ha_model_borrow_state(next.entity, &prev)) {
+        return false;
+    }
+    if (prev.state->state[0] != '\0') {
+        safe_copy_cstr(next.state, sizeof(next.state), prev.state->state);
+    }
+    /* last_changed only moves with the state itself; attribute-only diffs keep the stored one. */
+    next.last_changed_unix_ms = prev.state->last_changed_unix_ms;
+    const char *base = prev.state->attributes_json;
+    bool merged = json_scan_merge_object(base, strlen(base), has_plus_attrs ? &plus_attrs : NULL,
+        has_minus_keys ? &minus_keys : NULL, s_client.ws_diff_attrs_buf, APP_HA_ATTRS_MAX_LEN);
+    ha_model_release_state(&prev);
+    if (!merged) {
+        return false;
+    }
+    char new_state[sizeof(next.state)] = {0};
+    if (plus_state.type == JSON_SPAN_STRING && json_span_copy_string(&plus_state, new_state, sizeof(new_state)) &&
+        strncmp(new_state, next.state, sizeof(next.state)) != 0) {
+        safe_copy_cstr(next.state, sizeof(next.state), new_state);
+        next.last_changed_unix_ms = esp_timer_get_time() / 1000;
+    }
+
+    next.attributes_json = s_client.ws_diff_attrs_buf;
+    bool stored = false;
+    (void)ha_model_upsert_state_changed(&next, &stored);
+    ha_client_mark_entities_seen(entity_id);
+    if (stored) {
+        ha_client_trace_service_state_changed(entity_id, next.state);
+        ha_client_publish_event(EV_HA_STATE_CHANGED, entity_id);
+        *out_changed = true;
+    }
+    return true;
 }
 
-static uint32_t ha_client_import_ws_entities_removed(cJSON *removed_list)
+/* Imports one entity value span of a subscribe_entities "a"/"c" map: "c" diffs are applied in
+ * place when possible, everything else is parsed into a private cJSON tree. */
+static bool ha_client_stream_ws_entity(const json_span_t *key, const json_span_t *value, bool changed)
 {
-    if (!cJSON_IsArray(removed_list)) {
-        return 0;
+    char entity_id[APP_MAX_ENTITY_ID_LEN] = {0};
+    if (!json_span_copy_string(key, entity_id, sizeof(entity_id)) || value->type != JSON_SPAN_OBJECT) {
+        return false;
     }
+    bool diff_changed = false;
+    if (changed && ha_client_apply_ws_entity_diff(entity_id, value, &diff_changed)) {
+        return diff_changed;
+    }
+    size_t raw_len = 0;
+    const char *raw = json_span_raw(value, &raw_len);
+    cJSON *entry = cJSON_ParseWithLength(raw, raw_len);
+    if (entry == NULL) {
+        return false;
+    }
+    bool updated = changed ? ha_client_import_ws_entity_changed(entity_id, entry)
+                           : ha_client_import_ws_entity_added(entity_id, entry);
+    cJSON_Delete(entry);
+    return updated;
+}
 
-    uint32_t removed = 0;
-    cJSON *entity_id = NULL;
-    cJSON_ArrayForEach(entity_id, removed_list)
-    {
-        if (!cJSON_IsString(entity_id) || entity_id->valuestring == NULL) {
-            continue;
+static void ha_client_finish_ws_entities_event(uint32_t added_count, uint32_t changed_count, uint32_t removed_count)
+{
+    bool mark_initial_done = false;
+    bool queue_weather_bootstrap = false;
+    uint16_t seen_count = 0;
+    uint16_t target_count = 0;
+    int64_t now_ms = ha_client_now_ms();
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    seen_count = s_client.entities_sub_seen_count;
+    target_count = s_client.entities_sub_target_count;
+    if (!s_client.initial_layout_sync_done && target_count > 0 &&
+        seen_count >= target_count) {
+        s_client.pending_initial_layout_sync = false;
+        s_client.pending_get_states = false;
+        s_client.get_states_req_id = 0;
+        s_client.initial_layout_sync_done = true;
+        s_client.initial_layout_sync_imported = seen_count;
+        if (!s_client.rest_enabled && s_client.layout_needs_weather_forecast) {
+            queue_weather_bootstrap = true;
         }
-        cJSON *attrs = cJSON_CreateObject();
-        if (attrs == NULL) {
+        mark_initial_done = true;
+    }
+    xSemaphoreGive(s_client.mutex);
+
+    if (queue_weather_bootstrap) {
+        ha_client_queue_weather_priority_sync_from_layout(now_ms);
+    }
+    if (mark_initial_done) {
+        ESP_LOGI(TAG_HA_CLIENT, "Initial layout state sync via WS entities stream: imported %u/%u entities",
+            (unsigned)seen_count, (unsigned)target_count);
+        ha_model_log_memory_report("initial_states");
+        ha_client_publish_event(EV_HA_CONNECTED, NULL);
+    } else if ((added_count + changed_count + removed_count) > 0U) {
+        ESP_LOGD(TAG_HA_CLIENT, "WS entities stream update: +%u ~%u -%u",
+            (unsigned)added_count, (unsigned)changed_count, (unsigned)removed_count);
+    }
+}
+
+/* subscribe_entities event: walks the a/c/r members in place and materializes one entity at a time,
+ * so a 64 KB initial burst never becomes one large DOM. */
+static void ha_client_stream_ws_entities_event(const json_span_t *event)
+{
+    uint32_t counts[3] = {0};
+    json_scan_iter_t it;
+    json_span_t key = {0};
+    json_span_t value = {0};
+    if (!json_scan_iter_begin(&it, event)) {
+        return;
+    }
+    while (json_scan_object_next(&it, &key, &value)) {
+        bool is_added = json_span_equals(&key, "a");
+        bool is_changed = json_span_equals(&key, "c");
+        json_scan_iter_t entries;
+        json_span_t entity_key = {0};
+        json_span_t entity_value = {0};
+        if ((is_added || is_changed) && json_scan_iter_begin(&entries, &value) && value.type == JSON_SPAN_OBJECT) {
+            while (json_scan_object_next(&entries, &entity_key, &entity_value)) {
+                if (ha_client_stream_ws_entity(&entity_key, &entity_value, is_changed)) {
+                    counts[is_changed ? 1 : 0]++;
+                }
+            }
+        } else if (json_span_equals(&key, "r") && json_scan_iter_begin(&entries, &value) &&
+                   value.type == JSON_SPAN_ARRAY) {
+            while (json_scan_array_next(&entries, &entity_value)) {
+                char entity_id[APP_MAX_ENTITY_ID_LEN] = {0};
+                if (json_span_copy_string(&entity_value, entity_id, sizeof(entity_id)) &&
+                    ha_client_import_ws_entity_removed(entity_id)) {
+                    counts[2]++;
+                }
+            }
+        } else {
             continue;
         }
-        bool state_changed = ha_client_import_ws_entity_state(entity_id->valuestring, "unavailable", attrs);
-        cJSON_Delete(attrs);
-        ha_client_mark_entities_seen(entity_id->valuestring);
-        if (!state_changed) {
-            continue;
+        if (entries.failed) {
+            ESP_LOGW(TAG_HA_CLIENT, "WS entities event truncated while scanning");
         }
-        ha_client_trace_service_state_changed(entity_id->valuestring, "unavailable");
-        ha_client_publish_event(EV_HA_STATE_CHANGED, entity_id->valuestring);
-        removed++;
     }
-    return removed;
+    ha_client_finish_ws_entities_event(counts[0], counts[1], counts[2]);
 }
 
 static void ha_client_handle_result_message(cJSON *root)
@@ -3340,20 +3666,26 @@ static void ha_client_handle_result_message(cJSON *root)
             cJSON *compact_forecast = ha_client_build_compact_forecast_array(raw_forecast);
             if (compact_forecast != NULL) {
                 ha_state_t state = {0};
-                if (ha_model_get_state(weather_entity_id, &state)) {
-                    if (state.attributes_json[0] == '\0') {
-                        snprintf(state.attributes_json, sizeof(state.attributes_json), "{}");
+                char *attrs_json = ha_client_alloc_attrs_buf();
+                if (attrs_json != NULL && ha_model_get_state_with_attrs(ha_entity_ids_find(weather_entity_id),
+                                              &state, attrs_json, APP_HA_ATTRS_MAX_LEN)) {
+                    if (attrs_json[0] == '\0') {
+                        snprintf(attrs_json, APP_HA_ATTRS_MAX_LEN, "{}");
                     }
                     if (ha_client_append_compact_forecast_to_attrs_json(
-                            state.attributes_json, sizeof(state.attributes_json), compact_forecast)) {
-                        state.last_changed_unix_ms = esp_timer_get_time() / 1000;
-                        ha_model_upsert_state(&state);
-                        ha_client_publish_event(EV_HA_STATE_CHANGED, weather_entity_id);
+                            attrs_json, APP_HA_ATTRS_MAX_LEN, compact_forecast)) {
+                        /* Only the forecast attribute moved: keep the stored last_changed. */
+                        bool stored = false;
+                        (void)ha_model_upsert_state_changed(&state, &stored);
+                        if (stored) {
+                            ha_client_publish_event(EV_HA_STATE_CHANGED, weather_entity_id);
+                        }
                         updated = true;
                     }
                 } else {
                     cJSON_Delete(compact_forecast);
                 }
+                heap_caps_free(attrs_json);
             }
         }
 
@@ -3366,48 +3698,65 @@ static void ha_client_handle_result_message(cJSON *root)
         }
     }
 
-    cJSON *result = cJSON_GetObjectItemCaseSensitive(root, "result");
-    if (!cJSON_IsArray(result)) {
-        return;
-    }
-
-    if (!is_get_states) {
-        return;
-    }
-    if (!(cJSON_IsBool(success_item) && cJSON_IsTrue(success_item))) {
+    if (is_get_states && cJSON_IsBool(success_item) && cJSON_IsTrue(success_item)) {
+        /* Successful get_states results are consumed by ha_client_stream_get_states_result(). */
+        ESP_LOGW(TAG_HA_CLIENT, "WS get_states result had no state array");
+    } else if (is_get_states) {
         ESP_LOGW(TAG_HA_CLIENT, "WS get_states returned non-success result");
-        return;
     }
+}
 
-    int n = cJSON_GetArraySize(result);
-    int imported = 0;
-    size_t layout_entity_count = 0;
-    bool filtered_to_layout = false;
-    size_t max_entities = (size_t)APP_MAX_WIDGETS_TOTAL * 2U;
-    char *layout_entity_ids = calloc(max_entities, APP_MAX_ENTITY_ID_LEN);
-    if (layout_entity_ids != NULL) {
-        bool need_weather_forecast = false;
-        layout_entity_count =
-            ha_client_collect_layout_entity_ids(layout_entity_ids, max_entities, &need_weather_forecast);
-        filtered_to_layout = (layout_entity_count > 0);
-    }
+/* Records an entity the layout does not use in the editor catalog, reading only its friendly_name span. */
+static void ha_client_catalog_note_state(const char *entity_id, const json_span_t *state_span)
+{
+    char name[APP_MAX_NAME_LEN] = {0};
+    json_span_t attrs = {0};
+    json_span_t friendly_name = {0};
+    if (json_scan_object_get(state_span, "attributes", &attrs) && attrs.type == JSON_SPAN_OBJECT &&
+        json_scan_object_get(&attrs, "friendly_name", &friendly_name)) {
+        (void)json_span_copy_string(&friendly_name, name, sizeof(name));
+    }
+    (void)ha_entity_catalog_upsert(entity_id, name);
+}
 
-    for (int i = 0; i < n; i++) {
-        cJSON *state_obj = cJSON_GetArrayItem(result, i);
-        if (!cJSON_IsObject(state_obj)) {
-            continue;
-        }
-        if (filtered_to_layout) {
-            cJSON *entity_id_item = cJSON_GetObjectItemCaseSensitive(state_obj, "entity_id");
-            if (!cJSON_IsString(entity_id_item) || entity_id_item->valuestring == NULL ||
-                !ha_client_entity_id_in_list(layout_entity_ids, layout_entity_count, entity_id_item->valuestring)) {
+/* get_states result: scans each element's entity_id in place and only materializes states the
+ * layout references; the rest only feed the editor catalog and are never allocated or interned. */
+static void ha_client_stream_get_states_result(const json_span_t *result)
+{
+    int n = 0;
+    int imported = 0;
+    ha_entity_catalog_reset();
+
+    json_scan_iter_t it;
+    json_span_t state_span = {0};
+    if (json_scan_iter_begin(&it, result)) {
+        while (json_scan_array_next(&it, &state_span)) {
+            n++;
+            json_span_t entity_id_span = {0};
+            char entity_id[APP_MAX_ENTITY_ID_LEN] = {0};
+            if (state_span.type != JSON_SPAN_OBJECT ||
+                !json_scan_object_get(&state_span, "entity_id", &entity_id_span) ||
+                !json_span_copy_string(&entity_id_span, entity_id, sizeof(entity_id))) {
+                continue;
+            }
+            if (!ha_client_layout_filter_allows(entity_id)) {
+                ha_client_catalog_note_state(entity_id, &state_span);
                 continue;
             }
+            size_t raw_len = 0;
+            const char *raw = json_span_raw(&state_span, &raw_len);
+            cJSON *state_obj = cJSON_ParseWithLength(raw, raw_len);
+            if (state_obj == NULL) {
+                continue;
+            }
+            (void)ha_client_import_state_object(state_obj);
+            cJSON_Delete(state_obj);
+            imported++;
+        }
+        if (it.failed) {
+            ESP_LOGW(TAG_HA_CLIENT, "WS get_states result truncated after %d states", n);
         }
-        (void)ha_client_import_state_object(state_obj);
-        imported++;
     }
-    free(layout_entity_ids);
 
     bool queue_weather_bootstrap = false;
     int64_t now_ms = ha_client_now_ms();
@@ -3423,12 +3772,9 @@ static void ha_client_handle_result_message(cJSON *root)
     if (queue_weather_bootstrap) {
         ha_client_queue_weather_priority_sync_from_layout(now_ms);
     }
-    if (filtered_to_layout) {
-        ESP_LOGI(TAG_HA_CLIENT, "Imported initial states via WS: %d/%d (layout=%u)", imported, n,
-            (unsigned)layout_entity_count);
-    } else {
-        ESP_LOGI(TAG_HA_CLIENT, "Imported initial states via WS: %d/%d", imported, n);
-    }
+    ESP_LOGI(TAG_HA_CLIENT, "Imported initial states via WS: %d/%d (catalog=%u)", imported, n,
+        (unsigned)ha_entity_catalog_count());
+    ha_model_log_memory_report("initial_states");
     /* Refresh UI/runtime once the initial snapshot is in the model.
      * Otherwise widgets may stay "unavailable" until the next state_changed event. */
     ha_client_publish_event(EV_HA_CONNECTED, NULL);
@@ -3439,10 +3785,8 @@ static void ha_client_handle_event_message(cJSON *root)
     cJSON *id_item = cJSON_GetObjectItemCaseSensitive(root, "id");
     uint32_t msg_id = cJSON_IsNumber(id_item) ? (uint32_t)id_item->valuedouble : 0;
     bool is_trigger_event = false;
-    bool is_entities_event = false;
     xSemaphoreTake(s_client.mutex, portMAX_DELAY);
     is_trigger_event = s_client.sub_state_via_trigger && (msg_id == s_client.trigger_sub_req_id);
-    is_entities_event = s_client.sub_state_via_entities && ha_client_entities_sub_req_known_locked(msg_id);
     xSemaphoreGive(s_client.mutex);
 
     cJSON *event = cJSON_GetObjectItemCaseSensitive(root, "event");
@@ -3450,51 +3794,6 @@ static void ha_client_handle_event_message(cJSON *root)
         return;
     }
 
-    if (is_entities_event) {
-        cJSON *added_map = cJSON_GetObjectItemCaseSensitive(event, "a");
-        cJSON *changed_map = cJSON_GetObjectItemCaseSensitive(event, "c");
-        cJSON *removed_list = cJSON_GetObjectItemCaseSensitive(event, "r");
-
-        uint32_t added_count = ha_client_import_ws_entities_added(added_map);
-        uint32_t changed_count = ha_client_import_ws_entities_changed(changed_map);
-        uint32_t removed_count = ha_client_import_ws_entities_removed(removed_list);
-
-        bool mark_initial_done = false;
-        bool queue_weather_bootstrap = false;
-        uint16_t seen_count = 0;
-        uint16_t target_count = 0;
-        int64_t now_ms = ha_client_now_ms();
-        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
-        seen_count = s_client.entities_sub_seen_count;
-        target_count = s_client.entities_sub_target_count;
-        if (!s_client.initial_layout_sync_done && target_count > 0 &&
-            seen_count >= target_count) {
-            s_client.pending_initial_layout_sync = false;
-            s_client.pending_get_states = false;
-            s_client.get_states_req_id = 0;
-            s_client.initial_layout_sync_done = true;
-            s_client.initial_layout_sync_imported = seen_count;
-            if (!s_client.rest_enabled && s_client.layout_needs_weather_forecast) {
-                queue_weather_bootstrap = true;
-            }
-            mark_initial_done = true;
-        }
-        xSemaphoreGive(s_client.mutex);
-
-        if (queue_weather_bootstrap) {
-            ha_client_queue_weather_priority_sync_from_layout(now_ms);
-        }
-        if (mark_initial_done) {
-            ESP_LOGI(TAG_HA_CLIENT, "Initial layout state sync via WS entities stream: imported %u/%u entities",
-                (unsigned)seen_count, (unsigned)target_count);
-            ha_client_publish_event(EV_HA_CONNECTED, NULL);
-        } else if ((added_count + changed_count + removed_count) > 0U) {
-            ESP_LOGD(TAG_HA_CLIENT, "WS entities stream update: +%u ~%u -%u",
-                (unsigned)added_count, (unsigned)changed_count, (unsigned)removed_count);
-        }
-        return;
-    }
-
     if (is_trigger_event) {
         cJSON *variables = cJSON_GetObjectItemCaseSensitive(event, "variables");
         cJSON *trigger = cJSON_IsObject(variables) ? cJSON_GetObjectItemCaseSensitive(variables, "trigger") : NULL;
@@ -3545,11 +3844,241 @@ static void ha_client_handle_event_message(cJSON *root)
     }
 }
 
+/* Global state_changed event: entities outside the layout are dropped (after a catalog note) before
+ * anything is allocated; layout entities only materialize data.new_state, never old_state. */
+static void ha_client_stream_state_changed_event(const json_span_t *event)
+{
+    json_span_t data = {0};
+    json_span_t entity_id_span = {0};
+    json_span_t new_state = {0};
+    char entity_id[APP_MAX_ENTITY_ID_LEN] = {0};
+    if (!json_scan_object_get(event, "data", &data) || data.type != JSON_SPAN_OBJECT ||
+        !json_scan_object_get(&data, "entity_id", &entity_id_span) ||
+        !json_span_copy_string(&entity_id_span, entity_id, sizeof(entity_id))) {
+        return;
+    }
+    (void)json_scan_object_get(&data, "new_state", &new_state);
+    if (!ha_client_layout_filter_allows(entity_id)) {
+        if (new_state.type == JSON_SPAN_OBJECT) {
+            ha_client_catalog_note_state(entity_id, &new_state);
+        }
+        return;
+    }
+    if (new_state.type != JSON_SPAN_OBJECT) {
+        return;
+    }
+
+    size_t raw_len = 0;
+    const char *raw = json_span_raw(&new_state, &raw_len);
+    cJSON *state_obj = cJSON_ParseWithLength(raw, raw_len);
+    if (state_obj == NULL) {
+        return;
+    }
+    if (ha_client_import_state_object(state_obj)) {
+        cJSON *state_item = cJSON_GetObjectItemCaseSensitive(state_obj, "state");
+        ha_client_trace_service_state_changed(
+            entity_id, cJSON_IsString(state_item) ? state_item->valuestring : NULL);
+        ha_client_publish_event(EV_HA_STATE_CHANGED, entity_id);
+    }
+    cJSON_Delete(state_obj);
+}
+
+/* history_during_period result, {"<entity_id>": [{"s": "21.5", "lu": 1718000000.1}, ...]}, read span by
+ * span into minute points of the slice (the last value of a minute wins). Returns the points kept. */
+static size_t ha_client_stream_history_points(
+    const json_span_t *result, uint32_t start_ts, uint32_t end_ts, ha_history_point_t *points, size_t max_points)
+{
+    size_t count = 0;
+    json_scan_iter_t it;
+    json_span_t key = {0};
+    json_span_t states = {0};
+    if (result == NULL || result->type != JSON_SPAN_OBJECT || !json_scan_iter_begin(&it, result)) {
+        return 0;
+    }
+    while (json_scan_object_next(&it, &key, &states)) {
+        json_scan_iter_t state_it;
+        json_span_t state_span = {0};
+        if (states.type != JSON_SPAN_ARRAY || !json_scan_iter_begin(&state_it, &states)) {
+            continue;
+        }
+        while (json_scan_array_next(&state_it, &state_span)) {
+            json_span_t s_span = {0};
+            json_span_t lu_span = {0};
+            char state_text[APP_MAX_STATE_LEN] = {0};
+            char lu_text[32] = {0};
+            size_t lu_len = 0;
+            const char *lu_raw = NULL;
+            float value = 0.0f;
+            if (state_span.type != JSON_SPAN_OBJECT || !json_scan_object_get(&state_span, "s", &s_span) ||
+                !json_scan_object_get(&state_span, "lu", &lu_span) || lu_span.type != JSON_SPAN_NUMBER ||
+                !json_span_copy_string(&s_span, state_text, sizeof(state_text)) ||
+                !ha_history_parse_value(state_text, &value)) {
+                continue;
+            }
+            lu_raw = json_span_raw(&lu_span, &lu_len);
+            if (lu_raw == NULL || lu_len == 0U || lu_len >= sizeof(lu_text)) {
+                continue;
+            }
+            memcpy(lu_text, lu_raw, lu_len);
+            double lu = strtod(lu_text, NULL);
+            uint32_t ts = (lu > (double)start_ts) ? (uint32_t)lu : start_ts;
+            ts -= ts % 60U;
+            if (ts >= end_ts) {
+                break;
+            }
+            if (count > 0U && points[count - 1U].ts == ts) {
+                points[count - 1U].value = value;
+            } else if (count < max_points) {
+                points[count].ts = ts;
+                points[count].value = value;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* Answer to the inflight backfill request: merges the slice into the entity's history. A failed
+ * request (recorder not loaded, older HA) pauses backfill until the next connect. */
+static void ha_client_finish_history_backfill(
+    ha_entity_handle_t entity, uint32_t start_ts, uint32_t end_ts, const json_span_t *result, bool success)
+{
+    /* One slice point per minute, plus the start state; only the WS RX path calls this. */
+    static ha_history_point_t s_points[APP_HA_HISTORY_BACKFILL_SLICE_MIN + 1U];
+    if (!success) {
+        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+        s_client.history_backfill_unsupported = true;
+        xSemaphoreGive(s_client.mutex);
+        ESP_LOGW(TAG_HA_CLIENT, "WS history_during_period rejected for %s, graph backfill paused",
+            ha_entity_ids_str(entity));
+        return;
+    }
+    size_t count = ha_client_stream_history_points(
+        result, start_ts, end_ts, s_points, sizeof(s_points) / sizeof(s_points[0]));
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    if (s_client.history_backfill_slice_min < APP_HA_HISTORY_BACKFILL_SLICE_MIN) {
+        s_client.history_backfill_slice_min *= 2U;
+        if (s_client.history_backfill_slice_min > APP_HA_HISTORY_BACKFILL_SLICE_MIN) {
+            s_client.history_backfill_slice_min = APP_HA_HISTORY_BACKFILL_SLICE_MIN;
+        }
+    }
+    xSemaphoreGive(s_client.mutex);
+    int added = ha_history_backfill_commit(entity, start_ts, end_ts, s_points, count);
+    if (added > 0) {
+        /* Graphs redraw on their entity's next apply. */
+        app_events_mark_state_dirty(entity);
+    }
+}
+
+/* Top-level dispatch without a DOM: the bulk frames (subscribe_entities and state_changed events,
+ * the get_states result) are handled here span by span. Returns false for every other message so the cJSON path
+ * below keeps handling auth, pings, service results and trigger events. */
+static bool ha_client_stream_text_message(const char *data, size_t len)
+{
+    json_span_t root = {0};
+    if (!json_scan_value(data, len, &root) || root.type != JSON_SPAN_OBJECT) {
+        return false;
+    }
+
+    json_span_t type = {0};
+    json_span_t id = {0};
+    json_span_t success = {0};
+    json_span_t event = {0};
+    json_span_t result = {0};
+    json_span_t key = {0};
+    json_span_t value = {0};
+    json_scan_iter_t it;
+    json_scan_iter_begin(&it, &root);
+    while (json_scan_object_next(&it, &key, &value)) {
+        if (json_span_equals(&key, "type")) {
+            type = value;
+        } else if (json_span_equals(&key, "id")) {
+            id = value;
+        } else if (json_span_equals(&key, "success")) {
+            success = value;
+        } else if (json_span_equals(&key, "event")) {
+            event = value;
+        } else if (json_span_equals(&key, "result")) {
+            result = value;
+        }
+    }
+    uint32_t msg_id = 0;
+    if (it.failed || !json_span_to_u32(&id, &msg_id) || msg_id == 0U) {
+        return false;
+    }
+
+    bool is_event = json_span_equals(&type, "event") && event.type == JSON_SPAN_OBJECT;
+    bool is_result = json_span_equals(&type, "result");
+    bool is_get_states = is_result && json_span_is_true(&success) && result.type == JSON_SPAN_ARRAY;
+    if (is_result && !is_get_states) {
+        bool is_history = false;
+        ha_entity_handle_t history_entity = HA_ENTITY_HANDLE_NONE;
+        uint32_t history_start_ts = 0;
+        uint32_t history_end_ts = 0;
+        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+        if (s_client.history_backfill_inflight && msg_id == s_client.history_backfill_req_id) {
+            is_history = true;
+            history_entity = s_client.history_backfill_entity;
+            history_start_ts = s_client.history_backfill_start_ts;
+            history_end_ts = s_client.history_backfill_end_ts;
+            s_client.history_backfill_inflight = false;
+            s_client.history_backfill_req_id = 0;
+            s_client.last_rx_unix_ms = ha_client_now_ms();
+        }
+        xSemaphoreGive(s_client.mutex);
+        if (is_history) {
+            ha_client_finish_history_backfill(
+                history_entity, history_start_ts, history_end_ts, &result, json_span_is_true(&success));
+            return true;
+        }
+    }
+    if (!is_event && !is_get_states) {
+        return false;
+    }
+    bool is_entities_event = false;
+    bool is_state_changed_event = false;
+    if (is_event) {
+        json_span_t event_type = {0};
+        is_state_changed_event =
+            json_scan_object_get(&event, "event_type", &event_type) && json_span_equals(&event_type, "state_changed");
+    }
+
+    int64_t now_ms = ha_client_now_ms();
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    if (is_event) {
+        is_entities_event = s_client.sub_state_via_entities && ha_client_entities_sub_req_known_locked(msg_id);
+    } else {
+        is_get_states = (msg_id == s_client.get_states_req_id);
+    }
+    if (is_entities_event || is_state_changed_event || is_get_states) {
+        s_client.last_rx_unix_ms = now_ms;
+    }
+    xSemaphoreGive(s_client.mutex);
+
+    if (is_entities_event) {
+        ha_client_stream_ws_entities_event(&event);
+        return true;
+    }
+    if (is_state_changed_event) {
+        ha_client_stream_state_changed_event(&event);
+        return true;
+    }
+    if (is_get_states) {
+        ha_client_trace_service_result(msg_id, true, NULL);
+        ha_client_stream_get_states_result(&result);
+        return true;
+    }
+    return false;
+}
+
 static void ha_client_handle_text_message(const char *data, int len)
 {
     if (data == NULL || len <= 0) {
         return;
     }
+    if (ha_client_stream_text_message(data, (size_t)len)) {
+        return;
+    }
 
     cJSON *root = cJSON_ParseWithLength(data, (size_t)len);
     if (root == NULL) {
@@ -3623,6 +4152,9 @@ static void ha_client_handle_text_message(const char *data, int len)
         s_client.weather_ws_req_inflight = false;
         s_client.weather_ws_req_id = 0;
         s_client.weather_ws_req_entity_id[0] = '\0';
+        s_client.history_backfill_inflight = false;
+        s_client.history_backfill_req_id = 0;
+        s_client.history_backfill_unsupported = false;
         ws_get_states_block_until = s_client.ws_get_states_block_until_unix_ms;
         if (ws_entities_stream) {
             uint16_t target_count = ha_client_prepare_entities_resubscribe_locked(now_ms);
@@ -3817,6 +4349,9 @@ static void ha_client_ws_event_cb(const ha_ws_event_t *event, void *user_ctx)
         s_client.weather_ws_req_inflight = false;
         s_client.weather_ws_req_id = 0;
         s_client.weather_ws_req_entity_id[0] = '\0';
+        s_client.history_backfill_inflight = false;
+        s_client.history_backfill_req_id = 0;
+        s_client.history_backfill_unsupported = false;
         s_client.last_ws_tls_stack_err = 0;
         s_client.last_ws_tls_esp_err = ESP_OK;
         s_client.last_ws_sock_errno = 0;
@@ -3871,6 +4406,9 @@ static void ha_client_ws_event_cb(const ha_ws_event_t *event, void *user_ctx)
         s_client.weather_ws_req_inflight = false;
         s_client.weather_ws_req_id = 0;
         s_client.weather_ws_req_entity_id[0] = '\0';
+        s_client.history_backfill_inflight = false;
+        s_client.history_backfill_req_id = 0;
+        s_client.history_backfill_unsupported = false;
         xSemaphoreGive(s_client.mutex);
         if (ws_session_age_ms > 0 && ws_session_age_ms < HA_WS_SHORT_SESSION_MS) {
             ESP_LOGW(TAG_HA_CLIENT,
@@ -3924,6 +4462,82 @@ static void ha_client_ws_event_cb(const ha_ws_event_t *event, void *user_ctx)
     }
 }
 
+/* One step of the graph history backfill over the WS, paced like the initial layout sync. Waits
+ * while the budget protects heap or WS queue, while the session settles and while a bulk sync or a
+ * user action has the link. */
+static void ha_client_history_backfill_step(int64_t now_ms, ha_bg_budget_level_t level, bool link_busy)
+{
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    bool inflight = s_client.history_backfill_inflight;
+    bool unsupported = s_client.history_backfill_unsupported;
+    int64_t sent_ms = s_client.history_backfill_sent_unix_ms;
+    int64_t connected_ms = s_client.ws_last_connected_unix_ms;
+    ha_entity_handle_t entity = s_client.history_backfill_entity;
+    uint32_t start_ts = s_client.history_backfill_start_ts;
+    uint32_t end_ts = s_client.history_backfill_end_ts;
+    if (s_client.history_backfill_slice_min == 0U) {
+        s_client.history_backfill_slice_min = APP_HA_HISTORY_BACKFILL_SLICE_MIN;
+    }
+    uint32_t slice_min = s_client.history_backfill_slice_min;
+    xSemaphoreGive(s_client.mutex);
+
+    if (inflight) {
+        if ((now_ms - sent_ms) < HA_HISTORY_BACKFILL_TIMEOUT_MS) {
+            return;
+        }
+        bool give_up = slice_min <= HA_HISTORY_BACKFILL_SLICE_FLOOR_MIN;
+        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+        s_client.history_backfill_inflight = false;
+        s_client.history_backfill_req_id = 0;
+        s_client.history_backfill_slice_min =
+            give_up ? APP_HA_HISTORY_BACKFILL_SLICE_MIN
+                    : ((slice_min / 2U > HA_HISTORY_BACKFILL_SLICE_FLOOR_MIN) ? (slice_min / 2U)
+                                                                              : HA_HISTORY_BACKFILL_SLICE_FLOOR_MIN);
+        xSemaphoreGive(s_client.mutex);
+        if (give_up) {
+            ESP_LOGW(TAG_HA_CLIENT, "No history for %s at %" PRIu32 ", skipping %u min",
+                ha_entity_ids_str(entity), start_ts, (unsigned)((end_ts - start_ts) / 60U));
+            (void)ha_history_backfill_commit(entity, start_ts, end_ts, NULL, 0);
+        } else {
+            ESP_LOGW(TAG_HA_CLIENT, "History request for %s unanswered, retrying with shorter slices",
+                ha_entity_ids_str(entity));
+        }
+        return;
+    }
+
+    int64_t wait_ms = 0;
+    if (unsupported) {
+        wait_ms = HA_HISTORY_BACKFILL_IDLE_MS;
+    } else if (link_busy || level >= HA_BG_BUDGET_PROTECT || connected_ms <= 0 ||
+               (now_ms - connected_ms) < HA_HISTORY_BACKFILL_GRACE_MS) {
+        wait_ms = ha_client_interval_initial_step_ms(level);
+    } else if (!ha_history_backfill_next(slice_min, &entity, &start_ts, &end_ts)) {
+        wait_ms = HA_HISTORY_BACKFILL_IDLE_MS;
+    }
+    if (wait_ms > 0) {
+        xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+        s_client.next_history_backfill_unix_ms = now_ms + wait_ms;
+        xSemaphoreGive(s_client.mutex);
+        return;
+    }
+
+    uint32_t req_id = 0;
+    esp_err_t err = ha_client_send_history_during_period(ha_entity_ids_str(entity), start_ts, end_ts, &req_id);
+    xSemaphoreTake(s_client.mutex, portMAX_DELAY);
+    if (err == ESP_OK) {
+        s_client.history_backfill_inflight = true;
+        s_client.history_backfill_req_id = req_id;
+        s_client.history_backfill_entity = entity;
+        s_client.history_backfill_start_ts = start_ts;
+        s_client.history_backfill_end_ts = end_ts;
+        s_client.history_backfill_sent_unix_ms = now_ms;
+        s_client.next_history_backfill_unix_ms = now_ms + ha_client_interval_initial_step_ms(level);
+    } else {
+        s_client.next_history_backfill_unix_ms = now_ms + HA_INITIAL_LAYOUT_SYNC_RETRY_INTERVAL_MS;
+    }
+    xSemaphoreGive(s_client.mutex);
+}
+
 static void ha_client_task(void *arg)
 {
     (void)arg;
@@ -3962,6 +4576,7 @@ static void ha_client_task(void *arg)
         bool ws_entities_subscribe_supported = false;
         uint16_t entities_sub_target_count = 0;
         uint16_t entities_sub_sent_count = 0;
+        uint8_t entities_unsub_count = 0;
         int64_t next_entities_subscribe_unix_ms = 0;
         uint32_t pending_pong_id = 0;
         uint32_t initial_layout_sync_index = 0;
@@ -3976,6 +4591,7 @@ static void ha_client_task(void *arg)
         int64_t next_auth_retry_unix_ms = 0;
         int64_t next_initial_layout_sync_unix_ms = 0;
         int64_t next_periodic_layout_sync_unix_ms = 0;
+        int64_t next_history_backfill_unix_ms = 0;
         int64_t next_priority_sync_unix_ms = 0;
         uint8_t priority_sync_count = 0;
         uint8_t ws_short_session_strikes = 0;
@@ -4019,6 +4635,7 @@ static void ha_client_task(void *arg)
         ws_entities_subscribe_supported = s_client.ws_entities_subscribe_supported;
         entities_sub_target_count = s_client.entities_sub_target_count;
         entities_sub_sent_count = s_client.entities_sub_sent_count;
+        entities_unsub_count = s_client.entities_unsub_count;
         next_entities_subscribe_unix_ms = s_client.next_entities_subscribe_unix_ms;
         initial_layout_sync_index = s_client.initial_layout_sync_index;
         initial_layout_sync_imported = s_client.initial_layout_sync_imported;
@@ -4032,6 +4649,7 @@ static void ha_client_task(void *arg)
         next_auth_retry_unix_ms = s_client.next_auth_retry_unix_ms;
         next_initial_layout_sync_unix_ms = s_client.next_initial_layout_sync_unix_ms;
         next_periodic_layout_sync_unix_ms = s_client.next_periodic_layout_sync_unix_ms;
+        next_history_backfill_unix_ms = s_client.next_history_backfill_unix_ms;
         next_priority_sync_unix_ms = s_client.next_priority_sync_unix_ms;
         priority_sync_count = s_client.priority_sync_count;
         ws_short_session_strikes = s_client.ws_short_session_strikes;
@@ -4343,6 +4961,9 @@ static void ha_client_task(void *arg)
                 xSemaphoreGive(s_client.mutex);
             }
         }
+        if (connected && authenticated && entities_unsub_count > 0U) {
+            ha_client_flush_entities_unsubscribes();
+        }
         if (connected && authenticated && pending_subscribe) {
             bool use_entities_subscribe_seq =
                 (!rest_enabled && ws_entities_subscribe_supported && entities_sub_target_count > 0);
@@ -4656,6 +5277,11 @@ static void ha_client_task(void *arg)
             }
         }
 
+        if (connected && authenticated && wifi_up && now_ms >= next_history_backfill_unix_ms) {
+            ha_client_history_backfill_step(now_ms, bg_budget_level,
+                ws_priority_boost_active || pending_get_states || pending_initial_layout_sync);
+        }
+
         vTaskDelay(HA_CLIENT_TASK_DELAY_TICKS);
     }
 }
@@ -4684,15 +5310,13 @@ esp_err_t ha_client_start(const ha_client_config_t *cfg)
     } else {
         ha_client_flush_ws_rx_queue();
     }
-    if (ha_client_ensure_ws_rx_buffer() != ESP_OK) {
+    if (ha_ws_rx_pool_init() != ESP_OK) {
+        ESP_LOGE(TAG_HA_CLIENT, "Failed to allocate WS receive slabs (%u x %u bytes)",
+            (unsigned)APP_HA_WS_RX_SLAB_COUNT, (unsigned)APP_HA_WS_RX_SLAB_SIZE);
         return ESP_ERR_NO_MEM;
     }
     if (ha_client_ensure_entities_sub_buffers() != ESP_OK) {
-        if (s_ws_rx_buf != NULL) {
-            heap_caps_free(s_ws_rx_buf);
-            s_ws_rx_buf = NULL;
-            s_ws_rx_buf_cap = 0;
-        }
+        ha_ws_rx_pool_deinit();
         return ESP_ERR_NO_MEM;
     }
 
@@ -4754,6 +5378,9 @@ esp_err_t ha_client_start(const ha_client_config_t *cfg)
     s_client.weather_ws_req_inflight = false;
     s_client.weather_ws_req_id = 0;
     s_client.weather_ws_req_entity_id[0] = '\0';
+    s_client.history_backfill_inflight = false;
+    s_client.history_backfill_req_id = 0;
+    s_client.history_backfill_unsupported = false;
     s_client.layout_entity_signature = 0;
     s_client.layout_entity_count = 0;
     s_client.ws_priority_boost_until_unix_ms = 0;
@@ -4781,11 +5408,7 @@ esp_err_t ha_client_start(const ha_client_config_t *cfg)
         ha_client_task, "ha_client", APP_HA_TASK_STACK, NULL, APP_HA_TASK_PRIO, &s_client.task_handle);
 #endif
     if (created != pdPASS) {
-        if (s_ws_rx_buf != NULL) {
-            heap_caps_free(s_ws_rx_buf);
-            s_ws_rx_buf = NULL;
-            s_ws_rx_buf_cap = 0;
-        }
+        ha_ws_rx_pool_deinit();
         ha_client_free_entities_sub_buffers();
         return ESP_FAIL;
     }
@@ -4826,11 +5449,8 @@ void ha_client_stop(void)
         vQueueDelete(s_client.ws_rx_queue);
         s_client.ws_rx_queue = NULL;
     }
-    if (s_ws_rx_buf != NULL) {
-        heap_caps_free(s_ws_rx_buf);
-        s_ws_rx_buf = NULL;
-        s_ws_rx_buf_cap = 0;
-    }
+    ha_client_reset_ws_rx_assembly();
+    ha_ws_rx_pool_deinit();
     xSemaphoreTake(s_client.mutex, portMAX_DELAY);
     s_client.started = false;
     s_client.rest_enabled = false;
@@ -4887,8 +5507,12 @@ void ha_client_stop(void)
     s_client.weather_ws_req_inflight = false;
     s_client.weather_ws_req_id = 0;
     s_client.weather_ws_req_entity_id[0] = '\0';
+    s_client.history_backfill_inflight = false;
+    s_client.history_backfill_req_id = 0;
+    s_client.history_backfill_unsupported = false;
     s_client.layout_entity_signature = 0;
     s_client.layout_entity_count = 0;
+    ha_client_free_layout_filter();
     s_client.ws_priority_boost_until_unix_ms = 0;
     s_client.last_ws_bad_input_unix_ms = 0;
     s_client.ws_get_states_block_until_unix_ms = 0;
@@ -4914,6 +5538,9 @@ esp_err_t ha_client_notify_layout_updated(void)
     bool scheduled_resync = false;
     bool scheduled_resubscribe = false;
     bool entity_set_changed = false;
+    bool entities_delta_applied = false;
+    uint16_t entities_added = 0;
+    uint16_t entities_removed = 0;
     bool forecast_capability_changed = false;
     bool rest_enabled = false;
     bool ws_entities_stream = false;
@@ -4930,7 +5557,15 @@ esp_err_t ha_client_notify_layout_updated(void)
         s_client.layout_needs_weather_forecast = new_need_weather_forecast;
     }
 
-    if (started && entity_set_changed) {
+    if (entity_set_changed) {
+        /* A newly placed graph backfills its series without waiting for the idle poll. */
+        s_client.next_history_backfill_unix_ms = 0;
+    }
+    if (started && entity_set_changed && ws_entities_stream && s_client.sub_state_via_entities) {
+        /* Layout edits only touch the subscriptions of entities that came or went. */
+        entities_delta_applied = ha_client_apply_entities_sub_delta_locked(now_ms, &entities_added, &entities_removed);
+    }
+    if (started && entity_set_changed && !entities_delta_applied) {
         s_client.initial_layout_sync_index = 0;
         s_client.initial_layout_sync_imported = 0;
         s_client.get_states_req_id = 0;
@@ -5019,9 +5654,17 @@ esp_err_t ha_client_notify_layout_updated(void)
     }
     xSemaphoreGive(s_client.mutex);
 
+    if (entities_delta_applied && entities_added > 0U && new_need_weather_forecast) {
+        /* A newly placed weather tile needs its forecast, which subscribe_entities does not carry. */
+        ha_client_queue_weather_priority_sync_from_layout(now_ms);
+    }
+
     if (started) {
         if (!has_snapshot) {
             ESP_LOGW(TAG_HA_CLIENT, "Layout updated: snapshot failed, keeping current HA subscriptions/sync state");
+        } else if (entities_delta_applied) {
+            ESP_LOGI(TAG_HA_CLIENT, "Layout updated: subscribing %u new entities, dropping %u, keeping the rest",
+                (unsigned)entities_added, (unsigned)entities_removed);
         } else if (scheduled_resubscribe || scheduled_resync) {
             if (rest_enabled) {
                 ESP_LOGI(TAG_HA_CLIENT, "Layout updated: scheduled immediate HA resubscribe/resync");
@@ -0,0 +1,248 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_entity_catalog.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "util/log_tags.h"
+
+/* Strings are packed back to back in one arena ("id\0name\0"); records hold offsets and the id hash,
+ * and an open-addressed index maps hash -> record + 1. A rename appends a new name; the old bytes are
+ * reclaimed by the next reset. */
+#define HA_CATALOG_INDEX_SLOTS (APP_HA_CATALOG_MAX_ENTRIES * 2U)
+
+_Static_assert(APP_HA_CATALOG_MAX_ENTRIES < UINT16_MAX, "catalog records must be addressable by uint16_t");
+_Static_assert((HA_CATALOG_INDEX_SLOTS & (HA_CATALOG_INDEX_SLOTS - 1U)) == 0,
+    "APP_HA_CATALOG_MAX_ENTRIES must be a power of two");
+
+typedef struct {
+    uint32_t id_offset;
+    uint32_t name_offset;
+    uint32_t hash;
+} ha_catalog_record_t;
+
+static SemaphoreHandle_t s_catalog_mutex = NULL;
+static char *s_arena = NULL;
+static size_t s_arena_used = 0;
+static ha_catalog_record_t *s_records = NULL;
+static uint16_t *s_index = NULL;
+static uint16_t s_count = 0;
+static bool s_full_logged = false;
+
+static void *ha_entity_catalog_alloc(size_t count, size_t size)
+{
+    void *ptr = heap_caps_calloc(count, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL) {
+        ptr = heap_caps_calloc(count, size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+static uint32_t ha_entity_catalog_hash(const char *entity_id)
+{
+    uint32_t hash = 2166136261U; /* FNV-1a */
+    for (size_t i = 0; i < (APP_MAX_ENTITY_ID_LEN - 1U) && entity_id[i] != '\0'; i++) {
+        hash ^= (uint8_t)entity_id[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static bool ha_entity_catalog_contains_ci(const char *haystack, const char *needle)
+{
+    if (needle == NULL || needle[0] == '\0') {
+        return true;
+    }
+    size_t h_len = strlen(haystack);
+    size_t n_len = strlen(needle);
+    for (size_t i = 0; n_len <= h_len && i <= (h_len - n_len); i++) {
+        size_t j = 0;
+        while (j < n_len && tolower((unsigned char)haystack[i + j]) == tolower((unsigned char)needle[j])) {
+            j++;
+        }
+        if (j == n_len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Returns the record index, or -1 with *out_slot set to the empty index slot to claim. */
+static int ha_entity_catalog_find_locked(const char *entity_id, uint32_t hash, uint32_t *out_slot)
+{
+    uint32_t mask = HA_CATALOG_INDEX_SLOTS - 1U;
+    for (uint32_t probe = 0; probe < HA_CATALOG_INDEX_SLOTS; probe++) {
+        uint32_t slot = (hash + probe) & mask;
+        uint16_t entry = s_index[slot];
+        if (entry == 0U) {
+            if (out_slot != NULL) {
+                *out_slot = slot;
+            }
+            return -1;
+        }
+        const ha_catalog_record_t *record = &s_records[entry - 1U];
+        if (record->hash == hash &&
+            strncmp(&s_arena[record->id_offset], entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
+            return (int)(entry - 1U);
+        }
+    }
+    return -1;
+}
+
+static bool ha_entity_catalog_append_locked(const char *text, size_t max_len, uint32_t *out_offset)
+{
+    size_t len = strnlen(text, max_len - 1U);
+    if (s_arena_used + len + 1U > APP_HA_CATALOG_ARENA_BYTES) {
+        return false;
+    }
+    *out_offset = (uint32_t)s_arena_used;
+    memcpy(&s_arena[s_arena_used], text, len);
+    s_arena[s_arena_used + len] = '\0';
+    s_arena_used += len + 1U;
+    return true;
+}
+
+esp_err_t ha_entity_catalog_init(void)
+{
+    if (s_catalog_mutex != NULL) {
+        return ESP_OK;
+    }
+    s_catalog_mutex = xSemaphoreCreateMutex();
+    if (s_catalog_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_arena = (char *)ha_entity_catalog_alloc(APP_HA_CATALOG_ARENA_BYTES, sizeof(char));
+    s_records = (ha_catalog_record_t *)ha_entity_catalog_alloc(APP_HA_CATALOG_MAX_ENTRIES, sizeof(ha_catalog_record_t));
+    s_index = (uint16_t *)ha_entity_catalog_alloc(HA_CATALOG_INDEX_SLOTS, sizeof(uint16_t));
+    if (s_arena == NULL || s_records == NULL || s_index == NULL) {
+        ESP_LOGE(TAG_HA_MODEL, "Failed to allocate entity catalog");
+        heap_caps_free(s_arena);
+        heap_caps_free(s_records);
+        heap_caps_free(s_index);
+        s_arena = NULL;
+        s_records = NULL;
+        s_index = NULL;
+        vSemaphoreDelete(s_catalog_mutex);
+        s_catalog_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    s_arena[0] = '\0';
+    s_arena_used = 1U;
+    return ESP_OK;
+}
+
+void ha_entity_catalog_reset(void)
+{
+    if (s_catalog_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_catalog_mutex, portMAX_DELAY);
+    memset(s_index, 0, HA_CATALOG_INDEX_SLOTS * sizeof(uint16_t));
+    s_arena_used = 1U;
+    s_count = 0;
+    s_full_logged = false;
+    xSemaphoreGive(s_catalog_mutex);
+}
+
+bool ha_entity_catalog_upsert(const char *entity_id, const char *name)
+{
+    if (s_catalog_mutex == NULL || entity_id == NULL || entity_id[0] == '\0') {
+        return false;
+    }
+    if (name == NULL) {
+        name = "";
+    }
+    uint32_t hash = ha_entity_catalog_hash(entity_id);
+    bool stored = true;
+
+    xSemaphoreTake(s_catalog_mutex, portMAX_DELAY);
+    uint32_t slot = 0;
+    int idx = ha_entity_catalog_find_locked(entity_id, hash, &slot);
+    if (idx >= 0) {
+        ha_catalog_record_t *record = &s_records[idx];
+        if (strncmp(&s_arena[record->name_offset], name, APP_MAX_NAME_LEN - 1U) != 0) {
+            uint32_t name_offset = 0;
+            stored = ha_entity_catalog_append_locked(name, APP_MAX_NAME_LEN, &name_offset);
+            if (stored) {
+                record->name_offset = name_offset;
+            }
+        }
+    } else if (s_count >= APP_HA_CATALOG_MAX_ENTRIES) {
+        stored = false;
+    } else {
+        ha_catalog_record_t record = {.hash = hash};
+        size_t saved_used = s_arena_used;
+        stored = ha_entity_catalog_append_locked(entity_id, APP_MAX_ENTITY_ID_LEN, &record.id_offset) &&
+                 ha_entity_catalog_append_locked(name, APP_MAX_NAME_LEN, &record.name_offset);
+        if (stored) {
+            s_records[s_count] = record;
+            s_index[slot] = (uint16_t)(s_count + 1U);
+            s_count++;
+        } else {
+            s_arena_used = saved_used;
+        }
+    }
+    if (!stored && !s_full_logged) {
+        s_full_logged = true;
+        ESP_LOGW(TAG_HA_MODEL, "Entity catalog full (%u entries, %u bytes), editor list is incomplete",
+            (unsigned)s_count, (unsigned)s_arena_used);
+    }
+    xSemaphoreGive(s_catalog_mutex);
+    return stored;
+}
+
+bool ha_entity_catalog_contains(const char *entity_id)
+{
+    if (s_catalog_mutex == NULL || entity_id == NULL || entity_id[0] == '\0') {
+        return false;
+    }
+    uint32_t hash = ha_entity_catalog_hash(entity_id);
+    xSemaphoreTake(s_catalog_mutex, portMAX_DELAY);
+    bool found = ha_entity_catalog_find_locked(entity_id, hash, NULL) >= 0;
+    xSemaphoreGive(s_catalog_mutex);
+    return found;
+}
+
+size_t ha_entity_catalog_list(
+    const char *domain_filter, const char *search, ha_entity_catalog_entry_t *out_entries, size_t max_out)
+{
+    if (s_catalog_mutex == NULL || out_entries == NULL || max_out == 0) {
+        return 0;
+    }
+    size_t domain_len = (domain_filter != NULL) ? strlen(domain_filter) : 0U;
+    size_t written = 0;
+
+    xSemaphoreTake(s_catalog_mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < s_count && written < max_out; i++) {
+        const char *entity_id = &s_arena[s_records[i].id_offset];
+        const char *name = &s_arena[s_records[i].name_offset];
+        if (domain_len > 0U && (strncmp(entity_id, domain_filter, domain_len) != 0 || entity_id[domain_len] != '.')) {
+            continue;
+        }
+        if (!ha_entity_catalog_contains_ci(entity_id, search) && !ha_entity_catalog_contains_ci(name, search)) {
+            continue;
+        }
+        ha_entity_catalog_entry_t *out = &out_entries[written++];
+        strlcpy(out->entity_id, entity_id, sizeof(out->entity_id));
+        strlcpy(out->name, (name[0] != '\0') ? name : entity_id, sizeof(out->name));
+    }
+    xSemaphoreGive(s_catalog_mutex);
+    return written;
+}
+
+size_t ha_entity_catalog_count(void)
+{
+    if (s_catalog_mutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(s_catalog_mutex, portMAX_DELAY);
+    size_t count = s_count;
+    xSemaphoreGive(s_catalog_mutex);
+    return count;
+}
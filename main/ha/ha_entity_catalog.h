@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "app_config.h"
+
+/* Lightweight directory of every entity HA reported (id + friendly name only) for the layout editor.
+ * Entities the layout does not reference land here instead of the model, so they cost a few dozen
+ * bytes each and are never interned. Thread-safe; rebuilt from scratch on every full state dump. */
+typedef struct {
+    char entity_id[APP_MAX_ENTITY_ID_LEN];
+    char name[APP_MAX_NAME_LEN];
+} ha_entity_catalog_entry_t;
+
+esp_err_t ha_entity_catalog_init(void);
+void ha_entity_catalog_reset(void);
+/* Adds or renames an entry; name may be NULL/"" (falls back to the id when listed). */
+bool ha_entity_catalog_upsert(const char *entity_id, const char *name);
+bool ha_entity_catalog_contains(const char *entity_id);
+/* Same filter semantics as ha_model_list_entities (domain prefix, case-insensitive id/name search). */
+size_t ha_entity_catalog_list(
+    const char *domain_filter, const char *search, ha_entity_catalog_entry_t *out_entries, size_t max_out);
+size_t ha_entity_catalog_count(void);
@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_entity_ids.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "util/log_tags.h"
+
+/* Append-only pool: strings live back to back in one arena, handle N maps to s_offsets[N].
+ * Writers serialize on s_intern_mutex; readers are lock-free because every slot/count is
+ * published with a release store only after the string bytes behind it are complete. */
+#define HA_ENTITY_IDS_INDEX_SLOTS (APP_HA_ENTITY_ID_POOL_MAX * 2U)
+#define HA_ENTITY_IDS_INDEX_EMPTY 0U
+
+_Static_assert(APP_HA_ENTITY_ID_POOL_MAX < UINT16_MAX, "entity handles must fit into uint16_t");
+_Static_assert(APP_HA_ENTITY_ID_ARENA_BYTES <= UINT16_MAX, "arena offsets must fit into uint16_t");
+_Static_assert((HA_ENTITY_IDS_INDEX_SLOTS & (HA_ENTITY_IDS_INDEX_SLOTS - 1U)) == 0,
+    "APP_HA_ENTITY_ID_POOL_MAX must be a power of two");
+
+static SemaphoreHandle_t s_intern_mutex = NULL;
+static char *s_arena = NULL;
+static size_t s_arena_used = 0;
+static uint16_t *s_offsets = NULL;
+static uint32_t *s_hashes = NULL;
+static uint16_t *s_index = NULL;
+static uint16_t s_count = 0;
+static bool s_full_logged = false;
+
+static void *ha_entity_ids_alloc(size_t count, size_t size)
+{
+    void *ptr = heap_caps_calloc(count, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL) {
+        ptr = heap_caps_calloc(count, size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+static void ha_entity_ids_free_buffers(void)
+{
+    heap_caps_free(s_arena);
+    heap_caps_free(s_offsets);
+    heap_caps_free(s_hashes);
+    heap_caps_free(s_index);
+    s_arena = NULL;
+    s_offsets = NULL;
+    s_hashes = NULL;
+    s_index = NULL;
+}
+
+static uint32_t ha_entity_ids_hash(const char *entity_id, size_t *out_len)
+{
+    /* FNV-1a, bounded like every other entity_id compare. */
+    uint32_t hash = 2166136261U;
+    size_t len = 0;
+    while (len < (APP_MAX_ENTITY_ID_LEN - 1U) && entity_id[len] != '\0') {
+        hash ^= (uint8_t)entity_id[len];
+        hash *= 16777619U;
+        len++;
+    }
+    if (out_len != NULL) {
+        *out_len = len;
+    }
+    return hash;
+}
+
+static ha_entity_handle_t ha_entity_ids_probe(const char *entity_id, size_t len, uint32_t hash, uint32_t *out_free_slot)
+{
+    uint32_t mask = HA_ENTITY_IDS_INDEX_SLOTS - 1U;
+    for (uint32_t probe = 0; probe < HA_ENTITY_IDS_INDEX_SLOTS; probe++) {
+        uint32_t slot_idx = (hash + probe) & mask;
+        uint16_t handle = __atomic_load_n(&s_index[slot_idx], __ATOMIC_ACQUIRE);
+        if (handle == HA_ENTITY_IDS_INDEX_EMPTY) {
+            if (out_free_slot != NULL) {
+                *out_free_slot = slot_idx;
+            }
+            return HA_ENTITY_HANDLE_NONE;
+        }
+        const char *candidate = &s_arena[s_offsets[handle]];
+        if (s_hashes[handle] == hash && strncmp(candidate, entity_id, len) == 0 && candidate[len] == '\0') {
+            return handle;
+        }
+    }
+    return HA_ENTITY_HANDLE_NONE;
+}
+
+esp_err_t ha_entity_ids_init(void)
+{
+    if (s_intern_mutex != NULL) {
+        return ESP_OK;
+    }
+    s_intern_mutex = xSemaphoreCreateMutex();
+    if (s_intern_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_arena = (char *)ha_entity_ids_alloc(APP_HA_ENTITY_ID_ARENA_BYTES, sizeof(char));
+    s_offsets = (uint16_t *)ha_entity_ids_alloc(APP_HA_ENTITY_ID_POOL_MAX + 1U, sizeof(uint16_t));
+    s_hashes = (uint32_t *)ha_entity_ids_alloc(APP_HA_ENTITY_ID_POOL_MAX + 1U, sizeof(uint32_t));
+    s_index = (uint16_t *)ha_entity_ids_alloc(HA_ENTITY_IDS_INDEX_SLOTS, sizeof(uint16_t));
+    if (s_arena == NULL || s_offsets == NULL || s_hashes == NULL || s_index == NULL) {
+        ESP_LOGE(TAG_HA_MODEL, "Failed to allocate entity id pool");
+        ha_entity_ids_free_buffers();
+        vSemaphoreDelete(s_intern_mutex);
+        s_intern_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Offset 0 is the empty string backing HA_ENTITY_HANDLE_NONE. */
+    s_arena[0] = '\0';
+    s_arena_used = 1U;
+    s_count = 0;
+    return ESP_OK;
+}
+
+ha_entity_handle_t ha_entity_ids_find(const char *entity_id)
+{
+    if (s_index == NULL || entity_id == NULL || entity_id[0] == '\0') {
+        return HA_ENTITY_HANDLE_NONE;
+    }
+    size_t len = 0;
+    uint32_t hash = ha_entity_ids_hash(entity_id, &len);
+    return ha_entity_ids_probe(entity_id, len, hash, NULL);
+}
+
+ha_entity_handle_t ha_entity_ids_intern(const char *entity_id)
+{
+    if (s_intern_mutex == NULL || entity_id == NULL || entity_id[0] == '\0') {
+        return HA_ENTITY_HANDLE_NONE;
+    }
+
+    size_t len = 0;
+    uint32_t hash = ha_entity_ids_hash(entity_id, &len);
+    ha_entity_handle_t handle = ha_entity_ids_probe(entity_id, len, hash, NULL);
+    if (handle != HA_ENTITY_HANDLE_NONE) {
+        return handle;
+    }
+
+    xSemaphoreTake(s_intern_mutex, portMAX_DELAY);
+    uint32_t free_slot = 0;
+    handle = ha_entity_ids_probe(entity_id, len, hash, &free_slot);
+    if (handle == HA_ENTITY_HANDLE_NONE) {
+        if (s_count >= APP_HA_ENTITY_ID_POOL_MAX || (s_arena_used + len + 1U) > APP_HA_ENTITY_ID_ARENA_BYTES) {
+            if (!s_full_logged) {
+                ESP_LOGW(TAG_HA_MODEL, "Entity id pool full (%u ids, %u bytes), dropping %s", (unsigned)s_count,
+                    (unsigned)s_arena_used, entity_id);
+                s_full_logged = true;
+            }
+        } else {
+            handle = (ha_entity_handle_t)(s_count + 1U);
+            memcpy(&s_arena[s_arena_used], entity_id, len);
+            s_arena[s_arena_used + len] = '\0';
+            s_offsets[handle] = (uint16_t)s_arena_used;
+            s_hashes[handle] = hash;
+            s_arena_used += len + 1U;
+            __atomic_store_n(&s_count, (uint16_t)handle, __ATOMIC_RELEASE);
+            __atomic_store_n(&s_index[free_slot], (uint16_t)handle, __ATOMIC_RELEASE);
+        }
+    }
+    xSemaphoreGive(s_intern_mutex);
+    return handle;
+}
+
+const char *ha_entity_ids_str(ha_entity_handle_t handle)
+{
+    if (s_arena == NULL || handle == HA_ENTITY_HANDLE_NONE || handle > __atomic_load_n(&s_count, __ATOMIC_ACQUIRE)) {
+        return "";
+    }
+    return &s_arena[s_offsets[handle]];
+}
+
+size_t ha_entity_ids_count(void)
+{
+    return (size_t)__atomic_load_n(&s_count, __ATOMIC_ACQUIRE);
+}
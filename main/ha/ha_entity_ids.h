@@ -0,0 +1,25 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "app_config.h"
+
+/* Stable compact handle for an interned entity_id string. Handles are never recycled,
+ * so they can be stored in events/widgets and compared as integers. */
+typedef uint16_t ha_entity_handle_t;
+
+#define HA_ENTITY_HANDLE_NONE ((ha_entity_handle_t)0)
+
+esp_err_t ha_entity_ids_init(void);
+ha_entity_handle_t ha_entity_ids_intern(const char *entity_id);
+ha_entity_handle_t ha_entity_ids_find(const char *entity_id);
+/* Returns the interned string (never NULL, "" for HA_ENTITY_HANDLE_NONE/unknown handles). */
+const char *ha_entity_ids_str(ha_entity_handle_t handle);
+size_t ha_entity_ids_count(void);
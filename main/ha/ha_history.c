@@ -0,0 +1,1272 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_history.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "app_config.h"
+#include "layout/layout_store.h"
+#include "util/log_tags.h"
+
+#define HA_HISTORY_BUCKET_SEC 60U
+#define HA_HISTORY_RETENTION_SEC (APP_HA_HISTORY_RETENTION_MIN * 60U)
+#define HA_HISTORY_MAX_SAMPLES ((int)(HA_HISTORY_RETENTION_SEC / HA_HISTORY_BUCKET_SEC))
+#define HA_HISTORY_SAVE_INTERVAL_SEC 120U
+#define HA_HISTORY_PERSIST_QUEUE_LEN 4U
+#define HA_HISTORY_PERSIST_TASK_STACK 4096
+#define HA_HISTORY_PERSIST_TASK_PRIO 2
+#define HA_HISTORY_DRAIN_TIMEOUT_MS 2000
+#define HA_HISTORY_VALID_EPOCH_MIN 1609459200U
+
+/* Version 1 files hold one flat sample array; version 2 is an append-only log of checksummed chunks,
+ * compacted into a single chunk once it holds HA_HISTORY_LOG_MAX_SAMPLES. */
+#define HA_HISTORY_FILE_MAGIC 0x47525048U
+#define HA_HISTORY_FILE_VERSION_FLAT 1U
+#define HA_HISTORY_FILE_VERSION 2U
+#define HA_HISTORY_CHUNK_MAGIC 0x4B4E4843U
+#define HA_HISTORY_LOG_MAX_SAMPLES (HA_HISTORY_MAX_SAMPLES * 2)
+#define HA_HISTORY_DIR "/littlefs/history"
+/* Per-widget logs of earlier firmware, imported once into the entity's series. */
+#define HA_HISTORY_LEGACY_DIR "/littlefs/graphs"
+#define HA_HISTORY_PATH_MAX 160
+
+/* Downsampling pyramid over the one-minute samples: min/max/sum per 5, 15 and 60 minute bucket.
+ * Slots are direct-mapped by bucket time; one spare slot per level covers a partial bucket at each
+ * end of the retention span. */
+#define HA_HISTORY_PYRAMID_LEVELS 3
+#define HA_HISTORY_LEVEL_SLOTS(bucket_sec) ((int)(HA_HISTORY_RETENTION_SEC / (bucket_sec)) + 1)
+#define HA_HISTORY_PYRAMID_SLOTS \
+    (HA_HISTORY_LEVEL_SLOTS(300U) + HA_HISTORY_LEVEL_SLOTS(900U) + HA_HISTORY_LEVEL_SLOTS(3600U))
+
+typedef struct {
+    uint32_t bucket_ts;
+    float value;
+} ha_history_sample_t;
+
+typedef struct {
+    /* Start of the bucket; a slot holding another bucket's time is empty for this one. */
+    uint32_t bucket_ts;
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+} ha_history_bucket_t;
+
+typedef struct {
+    uint32_t bucket_sec;
+    int first_slot;
+    int slot_count;
+} ha_history_level_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t count;
+} ha_history_file_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    /* FNV-1a over the chunk's samples. */
+    uint32_t checksum;
+} ha_history_chunk_header_t;
+
+typedef struct {
+    char path[HA_HISTORY_PATH_MAX];
+    /* Removed after a successful compaction: the legacy file the samples were imported from. */
+    char legacy_path[HA_HISTORY_PATH_MAX];
+    /* Rewrite the log with the samples, or append them as one chunk. */
+    bool compact;
+    int sample_count;
+    /* Series size when queued: what a full rewrite would have cost, for the stats. */
+    int history_count;
+    ha_history_sample_t samples[];
+} ha_history_persist_job_t;
+
+typedef struct {
+    ha_entity_handle_t entity;
+    uint32_t revision;
+    char path[HA_HISTORY_PATH_MAX];
+    char legacy_path[HA_HISTORY_PATH_MAX];
+    /* Ring of minute samples, oldest at head; access through ha_history_at. */
+    ha_history_sample_t samples[HA_HISTORY_MAX_SAMPLES];
+    int head;
+    int count;
+    ha_history_bucket_t pyramid[HA_HISTORY_PYRAMID_SLOTS];
+    bool dirty;
+    uint32_t last_persist_ts;
+    /* Oldest minute changed since the last persist (UINT32_MAX = none), samples in the on-disk log,
+     * and whether the log has to be rewritten (missing, version 1, imported or damaged). */
+    uint32_t persist_from_ts;
+    int log_samples;
+    bool log_compact;
+    /* First minute recorded live since the series was opened (UINT32_MAX = none yet), and the gap
+     * before it still to fetch from HA: [backfill_from_ts, backfill_until_ts), planned on first use. */
+    uint32_t live_from_ts;
+    uint32_t backfill_from_ts;
+    uint32_t backfill_until_ts;
+    bool backfill_planned;
+} ha_history_series_t;
+
+static const ha_history_level_t s_levels[HA_HISTORY_PYRAMID_LEVELS] = {
+    {300U, 0, HA_HISTORY_LEVEL_SLOTS(300U)},
+    {900U, HA_HISTORY_LEVEL_SLOTS(300U), HA_HISTORY_LEVEL_SLOTS(900U)},
+    {3600U, HA_HISTORY_LEVEL_SLOTS(300U) + HA_HISTORY_LEVEL_SLOTS(900U), HA_HISTORY_LEVEL_SLOTS(3600U)},
+};
+
+/* s_mutex guards the series table and every series in it. */
+static SemaphoreHandle_t s_mutex = NULL;
+static ha_history_series_t *s_series[APP_HA_HISTORY_MAX_SERIES];
+static size_t s_series_count = 0;
+/* Source of series revisions: a series tracked again never repeats a revision a graph has seen. */
+static uint32_t s_revision = 0;
+static bool s_dir_ready = false;
+static QueueHandle_t s_persist_queue = NULL;
+static TaskHandle_t s_persist_task = NULL;
+/* Jobs queued and not yet written; reopening a log waits for it to reach 0. */
+static uint32_t s_persist_pending = 0;
+/* Persist counters are bumped by the persist task, read by ha_history_get_stats. */
+static ha_history_stats_t s_stats = {0};
+
+static bool ha_history_state_is_unavailable(const char *state_text)
+{
+    if (state_text == NULL || state_text[0] == '\0') {
+        return true;
+    }
+    return strcmp(state_text, "unavailable") == 0 || strcmp(state_text, "unknown") == 0;
+}
+
+static bool ha_history_parse_float_relaxed(const char *text, float *out_value)
+{
+    if (text == NULL || out_value == NULL || text[0] == '\0') {
+        return false;
+    }
+
+    char buf[40] = {0};
+    size_t n = strnlen(text, sizeof(buf) - 1U);
+    for (size_t i = 0; i < n; i++) {
+        buf[i] = (text[i] == ',') ? '.' : text[i];
+    }
+    buf[n] = '\0';
+
+    char *end = NULL;
+    float parsed = strtof(buf, &end);
+    if (end == buf) {
+        return false;
+    }
+    *out_value = parsed;
+    return true;
+}
+
+/* Array index of sample i of the ring, 0 = oldest. */
+static int ha_history_index(const ha_history_series_t *series, int i)
+{
+    int idx = series->head + i;
+    return (idx >= HA_HISTORY_MAX_SAMPLES) ? (idx - HA_HISTORY_MAX_SAMPLES) : idx;
+}
+
+static const ha_history_sample_t *ha_history_at(const ha_history_series_t *series, int i)
+{
+    return &series->samples[ha_history_index(series, i)];
+}
+
+static const ha_history_sample_t *ha_history_newest(const ha_history_series_t *series)
+{
+    return ha_history_at(series, series->count - 1);
+}
+
+static void ha_history_drop_oldest(ha_history_series_t *series, int drop_count)
+{
+    if (drop_count <= 0 || series->count <= 0) {
+        return;
+    }
+    if (drop_count >= series->count) {
+        series->head = 0;
+        series->count = 0;
+        return;
+    }
+
+    series->head += drop_count;
+    if (series->head >= HA_HISTORY_MAX_SAMPLES) {
+        series->head -= HA_HISTORY_MAX_SAMPLES;
+    }
+    series->count -= drop_count;
+}
+
+static void ha_history_trim_retention(ha_history_series_t *series, uint32_t newest_bucket_ts)
+{
+    if (series->count <= 0 || newest_bucket_ts <= HA_HISTORY_RETENTION_SEC) {
+        return;
+    }
+
+    uint32_t keep_after = newest_bucket_ts - HA_HISTORY_RETENTION_SEC;
+    int drop = 0;
+    while (drop < series->count && ha_history_at(series, drop)->bucket_ts < keep_after) {
+        drop++;
+    }
+    ha_history_drop_oldest(series, drop);
+}
+
+/* Index of the first sample at or after ts. */
+static int ha_history_lower_bound(const ha_history_series_t *series, uint32_t ts)
+{
+    int lo = 0;
+    int hi = series->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (ha_history_at(series, mid)->bucket_ts < ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static ha_history_bucket_t *ha_history_pyramid_slot(
+    ha_history_series_t *series, const ha_history_level_t *level, uint32_t bucket_ts)
+{
+    return &series->pyramid[level->first_slot + (int)((bucket_ts / level->bucket_sec) % (uint32_t)level->slot_count)];
+}
+
+static void ha_history_bucket_add(ha_history_bucket_t *bucket, float value)
+{
+    if (bucket->count == 0U) {
+        bucket->min = value;
+        bucket->max = value;
+        bucket->sum = 0.0f;
+    } else {
+        if (value < bucket->min) {
+            bucket->min = value;
+        }
+        if (value > bucket->max) {
+            bucket->max = value;
+        }
+    }
+    bucket->sum += value;
+    bucket->count++;
+}
+
+/* Recomputes the buckets containing ts from the samples they cover (at most an hour's worth), so an
+ * updated last sample can lower a maximum as well as raise it. */
+static void ha_history_pyramid_update(ha_history_series_t *series, uint32_t ts)
+{
+    for (int l = 0; l < HA_HISTORY_PYRAMID_LEVELS; l++) {
+        const ha_history_level_t *level = &s_levels[l];
+        uint32_t bucket_ts = ts - (ts % level->bucket_sec);
+        ha_history_bucket_t *bucket = ha_history_pyramid_slot(series, level, bucket_ts);
+        memset(bucket, 0, sizeof(*bucket));
+        bucket->bucket_ts = bucket_ts;
+        for (int i = ha_history_lower_bound(series, bucket_ts);
+             i < series->count && ha_history_at(series, i)->bucket_ts < bucket_ts + level->bucket_sec; i++) {
+            ha_history_bucket_add(bucket, ha_history_at(series, i)->value);
+        }
+    }
+}
+
+static void ha_history_pyramid_rebuild(ha_history_series_t *series)
+{
+    memset(series->pyramid, 0, sizeof(series->pyramid));
+    for (int i = 0; i < series->count; i++) {
+        const ha_history_sample_t *sample = ha_history_at(series, i);
+        uint32_t ts = sample->bucket_ts;
+        for (int l = 0; l < HA_HISTORY_PYRAMID_LEVELS; l++) {
+            const ha_history_level_t *level = &s_levels[l];
+            uint32_t bucket_ts = ts - (ts % level->bucket_sec);
+            ha_history_bucket_t *bucket = ha_history_pyramid_slot(series, level, bucket_ts);
+            if (bucket->bucket_ts != bucket_ts) {
+                memset(bucket, 0, sizeof(*bucket));
+                bucket->bucket_ts = bucket_ts;
+            }
+            ha_history_bucket_add(bucket, sample->value);
+        }
+    }
+}
+
+static uint32_t ha_history_checksum(const ha_history_sample_t *samples, size_t count)
+{
+    /* FNV-1a over the raw samples. */
+    const uint8_t *bytes = (const uint8_t *)samples;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count * sizeof(ha_history_sample_t); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Copies count samples starting at logical index from, oldest first: the ring in up to two segments. */
+static void ha_history_copy(const ha_history_series_t *series, int from, int count, ha_history_sample_t *dst)
+{
+    int start = ha_history_index(series, from);
+    int first = HA_HISTORY_MAX_SAMPLES - start;
+    if (first > count) {
+        first = count;
+    }
+    if (first > 0) {
+        memcpy(dst, &series->samples[start], (size_t)first * sizeof(dst[0]));
+    }
+    if (count > first) {
+        memcpy(dst + first, series->samples, (size_t)(count - first) * sizeof(dst[0]));
+    }
+}
+
+/* Replays one logged sample: a later minute is appended, the newest minute is overwritten (it was
+ * logged again after an update), anything older was superseded. */
+static void ha_history_replay_sample(ha_history_series_t *series, const ha_history_sample_t *sample)
+{
+    if (series->count > 0) {
+        ha_history_sample_t *last = &series->samples[ha_history_index(series, series->count - 1)];
+        if (sample->bucket_ts == last->bucket_ts) {
+            last->value = sample->value;
+            return;
+        }
+        if (sample->bucket_ts < last->bucket_ts) {
+            return;
+        }
+    }
+    if (series->count >= HA_HISTORY_MAX_SAMPLES) {
+        ha_history_drop_oldest(series, 1);
+    }
+    series->samples[ha_history_index(series, series->count)] = *sample;
+    series->count++;
+}
+
+/* Reads a version 1 file (one flat sample array) or replays a version 2 chunk log. Chunks after a
+ * torn or corrupt one are ignored, and the log is rewritten on the next save. */
+static esp_err_t ha_history_load(ha_history_series_t *series, const char *path)
+{
+    series->head = 0;
+    series->count = 0;
+    series->log_samples = 0;
+    series->log_compact = true;
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ha_history_file_header_t header = {0};
+    size_t got = fread(&header, 1U, sizeof(header), f);
+    if (got != sizeof(header) || header.magic != HA_HISTORY_FILE_MAGIC ||
+        (header.version != HA_HISTORY_FILE_VERSION_FLAT && header.version != HA_HISTORY_FILE_VERSION) ||
+        header.count > (uint32_t)HA_HISTORY_MAX_SAMPLES) {
+        fclose(f);
+        return ESP_FAIL;
+    }
+
+    ha_history_sample_t *chunk = heap_caps_malloc(
+        HA_HISTORY_MAX_SAMPLES * sizeof(ha_history_sample_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (chunk == NULL) {
+        chunk = malloc(HA_HISTORY_MAX_SAMPLES * sizeof(ha_history_sample_t));
+    }
+    if (chunk == NULL) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = ESP_OK;
+    if (header.version == HA_HISTORY_FILE_VERSION_FLAT) {
+        /* Converted to a log by the first save. */
+        size_t count = (size_t)header.count;
+        if (fread(chunk, sizeof(chunk[0]), count, f) != count) {
+            err = ESP_FAIL;
+        }
+        for (size_t i = 0; err == ESP_OK && i < count; i++) {
+            if (i > 0U && chunk[i].bucket_ts <= chunk[i - 1U].bucket_ts) {
+                series->count = 0;
+                err = ESP_FAIL;
+                break;
+            }
+            ha_history_replay_sample(series, &chunk[i]);
+        }
+    } else {
+        bool torn = false;
+        ha_history_chunk_header_t chunk_header = {0};
+        while ((got = fread(&chunk_header, 1U, sizeof(chunk_header), f)) > 0U) {
+            size_t count = (size_t)chunk_header.count;
+            if (got != sizeof(chunk_header) || chunk_header.magic != HA_HISTORY_CHUNK_MAGIC ||
+                count > (size_t)HA_HISTORY_MAX_SAMPLES || fread(chunk, sizeof(chunk[0]), count, f) != count ||
+                ha_history_checksum(chunk, count) != chunk_header.checksum) {
+                torn = true;
+                break;
+            }
+            for (size_t i = 0; i < count; i++) {
+                ha_history_replay_sample(series, &chunk[i]);
+            }
+            series->log_samples += (int)count;
+        }
+        series->log_compact = torn;
+        if (torn) {
+            ESP_LOGW(TAG_HA_HISTORY, "log %s has a damaged tail, kept %d samples", path, series->count);
+        }
+    }
+    free(chunk);
+    fclose(f);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (series->count > 0) {
+        ha_history_trim_retention(series, ha_history_newest(series)->bucket_ts);
+    }
+    ha_history_pyramid_rebuild(series);
+    return ESP_OK;
+}
+
+static bool ha_history_write_chunk(FILE *f, const ha_history_sample_t *samples, int count, size_t *inout_bytes)
+{
+    ha_history_chunk_header_t chunk_header = {
+        .magic = HA_HISTORY_CHUNK_MAGIC,
+        .count = (uint32_t)count,
+        .checksum = ha_history_checksum(samples, (size_t)count),
+    };
+    if (fwrite(&chunk_header, sizeof(chunk_header), 1U, f) != 1U) {
+        return false;
+    }
+    *inout_bytes += sizeof(chunk_header);
+    if (count > 0 && fwrite(samples, sizeof(samples[0]), (size_t)count, f) != (size_t)count) {
+        return false;
+    }
+    *inout_bytes += (size_t)count * sizeof(samples[0]);
+    return true;
+}
+
+static bool ha_history_write_header(FILE *f, size_t *inout_bytes)
+{
+    ha_history_file_header_t header = {
+        .magic = HA_HISTORY_FILE_MAGIC,
+        .version = HA_HISTORY_FILE_VERSION,
+        .reserved = 0U,
+        .count = 0U,
+    };
+    if (fwrite(&header, sizeof(header), 1U, f) != 1U) {
+        return false;
+    }
+    *inout_bytes += sizeof(header);
+    return true;
+}
+
+/* A compaction writes a fresh log aside and renames it over the old one; a delta appends one chunk
+ * (to a new log if an earlier compaction never made it to flash). */
+static esp_err_t ha_history_write_job(const ha_history_persist_job_t *job, size_t *out_bytes)
+{
+    *out_bytes = 0;
+    if (!job->compact) {
+        struct stat st = {0};
+        bool fresh = stat(job->path, &st) != 0 || st.st_size == 0;
+        FILE *f = fopen(job->path, "ab");
+        if (f == NULL) {
+            return ESP_FAIL;
+        }
+        bool ok = !fresh || ha_history_write_header(f, out_bytes);
+        ok = ok && ha_history_write_chunk(f, job->samples, job->sample_count, out_bytes);
+        ok = (fclose(f) == 0) && ok;
+        return ok ? ESP_OK : ESP_FAIL;
+    }
+
+    char tmp_path[HA_HISTORY_PATH_MAX + 4];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", job->path);
+    FILE *f = fopen(tmp_path, "wb");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+    bool ok = ha_history_write_header(f, out_bytes) &&
+              ha_history_write_chunk(f, job->samples, job->sample_count, out_bytes);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, job->path) != 0) {
+        remove(tmp_path);
+        return ESP_FAIL;
+    }
+    if (job->legacy_path[0] != '\0') {
+        (void)remove(job->legacy_path);
+    }
+    return ESP_OK;
+}
+
+static void ha_history_account_job(const ha_history_persist_job_t *job, esp_err_t err, size_t written)
+{
+    __atomic_fetch_add(&s_stats.bytes_written, (uint64_t)written, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s_stats.full_rewrite_bytes,
+        (uint64_t)(sizeof(ha_history_file_header_t) + (size_t)job->history_count * sizeof(ha_history_sample_t)),
+        __ATOMIC_RELAXED);
+    if (err != ESP_OK) {
+        __atomic_fetch_add(&s_stats.write_failures, 1U, __ATOMIC_RELAXED);
+        ESP_LOGW(TAG_HA_HISTORY, "%s failed (%s, count=%d): %s", job->compact ? "compaction" : "append", job->path,
+            job->sample_count, esp_err_to_name(err));
+    } else {
+        __atomic_fetch_add(job->compact ? &s_stats.compactions : &s_stats.appends, 1U, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_stats.samples_written, (uint32_t)job->sample_count, __ATOMIC_RELAXED);
+    }
+}
+
+static void ha_history_persist_task(void *arg)
+{
+    (void)arg;
+    while (true) {
+        ha_history_persist_job_t *job = NULL;
+        if (xQueueReceive(s_persist_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (job == NULL) {
+            continue;
+        }
+
+        size_t written = 0;
+        esp_err_t err = ha_history_write_job(job, &written);
+        ha_history_account_job(job, err, written);
+        free(job);
+        __atomic_fetch_sub(&s_persist_pending, 1U, __ATOMIC_RELEASE);
+    }
+}
+
+static void ha_history_persist_start_once(void)
+{
+    if (s_persist_queue != NULL && s_persist_task != NULL) {
+        return;
+    }
+
+    if (s_persist_queue == NULL) {
+        s_persist_queue = xQueueCreate(HA_HISTORY_PERSIST_QUEUE_LEN, sizeof(ha_history_persist_job_t *));
+        if (s_persist_queue == NULL) {
+            ESP_LOGW(TAG_HA_HISTORY, "failed to create persist queue");
+            return;
+        }
+    }
+
+    if (s_persist_task == NULL) {
+        BaseType_t created = xTaskCreate(ha_history_persist_task, "ha_history", HA_HISTORY_PERSIST_TASK_STACK, NULL,
+            HA_HISTORY_PERSIST_TASK_PRIO, &s_persist_task);
+        if (created != pdPASS) {
+            ESP_LOGW(TAG_HA_HISTORY, "failed to start persist task");
+            vQueueDelete(s_persist_queue);
+            s_persist_queue = NULL;
+            return;
+        }
+    }
+}
+
+/* Blocks until the persist task has written every queued job, so the logs on flash are complete.
+ * Called without s_mutex. */
+static void ha_history_persist_drain(void)
+{
+    TickType_t waited = 0;
+    while (__atomic_load_n(&s_persist_pending, __ATOMIC_ACQUIRE) != 0U) {
+        if (waited >= pdMS_TO_TICKS(HA_HISTORY_DRAIN_TIMEOUT_MS)) {
+            ESP_LOGW(TAG_HA_HISTORY, "persist queue not drained after %d ms", HA_HISTORY_DRAIN_TIMEOUT_MS);
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+        waited += pdMS_TO_TICKS(10);
+    }
+}
+
+/* A job with the samples changed since the last persist as one log chunk, or the whole series when
+ * the log has to be rewritten or has grown past HA_HISTORY_LOG_MAX_SAMPLES. Called with s_mutex held;
+ * the series only counts them as persisted after ha_history_job_taken. */
+static ha_history_persist_job_t *ha_history_build_job(const ha_history_series_t *series)
+{
+    int from = ha_history_lower_bound(series, series->persist_from_ts);
+    bool compact = series->log_compact || (series->log_samples + (series->count - from)) > HA_HISTORY_LOG_MAX_SAMPLES;
+    if (compact) {
+        from = 0;
+    }
+    int count = series->count - from;
+
+    size_t job_size = sizeof(ha_history_persist_job_t) + (size_t)count * sizeof(ha_history_sample_t);
+    ha_history_persist_job_t *job = heap_caps_malloc(job_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (job == NULL) {
+        job = malloc(job_size);
+    }
+    if (job == NULL) {
+        ESP_LOGW(TAG_HA_HISTORY, "failed to allocate persist job");
+        return NULL;
+    }
+
+    memset(job, 0, sizeof(*job));
+    snprintf(job->path, sizeof(job->path), "%s", series->path);
+    if (compact) {
+        snprintf(job->legacy_path, sizeof(job->legacy_path), "%s", series->legacy_path);
+    }
+    job->compact = compact;
+    job->sample_count = count;
+    job->history_count = series->count;
+    ha_history_copy(series, from, count, job->samples);
+    return job;
+}
+
+static void ha_history_job_taken(ha_history_series_t *series, const ha_history_persist_job_t *job)
+{
+    series->log_samples = job->compact ? job->sample_count : (series->log_samples + job->sample_count);
+    series->log_compact = false;
+    series->persist_from_ts = UINT32_MAX;
+    if (job->compact) {
+        series->legacy_path[0] = '\0';
+    }
+}
+
+/* Queues the series' pending samples for the persist task. A full queue leaves the changes pending
+ * for the next attempt. Called with s_mutex held. */
+static bool ha_history_enqueue_persist(ha_history_series_t *series)
+{
+    ha_history_persist_start_once();
+    if (s_persist_queue == NULL) {
+        return false;
+    }
+
+    ha_history_persist_job_t *job = ha_history_build_job(series);
+    if (job == NULL) {
+        return false;
+    }
+    __atomic_fetch_add(&s_persist_pending, 1U, __ATOMIC_RELEASE);
+    if (xQueueSend(s_persist_queue, &job, 0) != pdTRUE) {
+        __atomic_fetch_sub(&s_persist_pending, 1U, __ATOMIC_RELEASE);
+        ESP_LOGW(TAG_HA_HISTORY, "persist queue full, retrying with the next save");
+        free(job);
+        return false;
+    }
+    ha_history_job_taken(series, job);
+    return true;
+}
+
+static void ha_history_try_persist(ha_history_series_t *series, uint32_t bucket_ts, bool force)
+{
+    if (series->path[0] == '\0' || !series->dirty) {
+        return;
+    }
+
+    if (!force) {
+        if (HA_HISTORY_SAVE_INTERVAL_SEC == 0U || bucket_ts == 0U) {
+            return;
+        }
+        if (series->last_persist_ts != 0U) {
+            uint32_t elapsed = (bucket_ts >= series->last_persist_ts) ? (bucket_ts - series->last_persist_ts) : 0U;
+            if (elapsed < HA_HISTORY_SAVE_INTERVAL_SEC) {
+                return;
+            }
+        }
+    }
+
+    if (ha_history_enqueue_persist(series)) {
+        series->dirty = false;
+        if (bucket_ts != 0U) {
+            series->last_persist_ts = bucket_ts;
+        } else if (series->count > 0) {
+            series->last_persist_ts = ha_history_newest(series)->bucket_ts;
+        }
+    }
+}
+
+static bool ha_history_append_or_update(ha_history_series_t *series, uint32_t bucket_ts, float value)
+{
+    if (series->count > 0) {
+        ha_history_sample_t *last = &series->samples[ha_history_index(series, series->count - 1)];
+        if (last->bucket_ts == bucket_ts) {
+            float delta = last->value - value;
+            if (delta < 0.0f) {
+                delta = -delta;
+            }
+            if (delta < 0.0001f) {
+                return false;
+            }
+            last->value = value;
+            ha_history_pyramid_update(series, bucket_ts);
+            if (bucket_ts < series->persist_from_ts) {
+                series->persist_from_ts = bucket_ts;
+            }
+            return true;
+        }
+        if (bucket_ts < last->bucket_ts) {
+            return false;
+        }
+    }
+
+    if (series->count >= HA_HISTORY_MAX_SAMPLES) {
+        ha_history_drop_oldest(series, 1);
+    }
+    ha_history_sample_t *slot = &series->samples[ha_history_index(series, series->count)];
+    slot->bucket_ts = bucket_ts;
+    slot->value = value;
+    series->count++;
+    ha_history_trim_retention(series, bucket_ts);
+    ha_history_pyramid_update(series, bucket_ts);
+    if (bucket_ts < series->persist_from_ts) {
+        series->persist_from_ts = bucket_ts;
+    }
+    return true;
+}
+
+static ha_history_series_t *ha_history_find_locked(ha_entity_handle_t entity)
+{
+    for (size_t i = 0; i < s_series_count; i++) {
+        if (s_series[i]->entity == entity) {
+            return s_series[i];
+        }
+    }
+    return NULL;
+}
+
+static bool ha_history_is_tracked(ha_entity_handle_t entity)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool tracked = ha_history_find_locked(entity) != NULL;
+    xSemaphoreGive(s_mutex);
+    return tracked;
+}
+
+static void ha_history_sanitize_name(const char *name, char *dst, size_t dst_size)
+{
+    size_t out = 0;
+    if (name != NULL) {
+        for (size_t i = 0; name[i] != '\0' && out < (dst_size - 1U); i++) {
+            unsigned char c = (unsigned char)name[i];
+            if (isalnum(c) || c == '_' || c == '-' || c == '.') {
+                dst[out++] = (char)c;
+            } else {
+                dst[out++] = '_';
+            }
+        }
+    }
+    dst[out] = '\0';
+}
+
+static bool ha_history_ensure_dir(void)
+{
+    if (s_dir_ready) {
+        return true;
+    }
+
+    struct stat st = {0};
+    if (stat(HA_HISTORY_DIR, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        (void)mkdir(HA_HISTORY_DIR, 0775);
+        if (stat(HA_HISTORY_DIR, &st) != 0 || !S_ISDIR(st.st_mode)) {
+            return false;
+        }
+    }
+    s_dir_ready = true;
+    return true;
+}
+
+/* Imports the per-widget log of the first graph widget showing the entity that still has one. */
+static bool ha_history_import_legacy(ha_history_series_t *series, const layout_compiled_t *layout)
+{
+    const char *entity_id = ha_entity_ids_str(series->entity);
+    for (uint16_t i = 0; i < layout->widget_count; i++) {
+        const layout_widget_def_t *def = &layout->widgets[i];
+        if (strcmp(def->type, "graph") != 0 || strcmp(def->entity_id, entity_id) != 0) {
+            continue;
+        }
+        char safe_id[APP_MAX_WIDGET_ID_LEN] = {0};
+        ha_history_sanitize_name(def->id, safe_id, sizeof(safe_id));
+        if (safe_id[0] == '\0') {
+            continue;
+        }
+        char legacy_path[HA_HISTORY_PATH_MAX];
+        snprintf(legacy_path, sizeof(legacy_path), "%s/%s.grph", HA_HISTORY_LEGACY_DIR, safe_id);
+        if (ha_history_load(series, legacy_path) == ESP_OK && series->count > 0) {
+            snprintf(series->legacy_path, sizeof(series->legacy_path), "%s", legacy_path);
+            series->log_compact = true;
+            series->log_samples = 0;
+            series->dirty = true;
+            ESP_LOGI(TAG_HA_HISTORY, "imported %d samples for %s from %s", series->count, entity_id, legacy_path);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Allocates a series and fills it from the entity's log, or from a legacy graph log if it has none
+ * yet. Runs without s_mutex: it reads flash. */
+static ha_history_series_t *ha_history_series_open(ha_entity_handle_t entity, const layout_compiled_t *layout)
+{
+    /* Samples and pyramid make a series about 20 KB: PSRAM preferred. */
+    ha_history_series_t *series = heap_caps_calloc(1, sizeof(*series), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (series == NULL) {
+        series = calloc(1, sizeof(*series));
+    }
+    if (series == NULL) {
+        return NULL;
+    }
+
+    series->entity = entity;
+    series->persist_from_ts = UINT32_MAX;
+    series->live_from_ts = UINT32_MAX;
+    series->log_compact = true;
+    if (ha_history_ensure_dir()) {
+        char safe_id[APP_MAX_ENTITY_ID_LEN] = {0};
+        ha_history_sanitize_name(ha_entity_ids_str(entity), safe_id, sizeof(safe_id));
+        snprintf(series->path, sizeof(series->path), "%s/%s.hlog", HA_HISTORY_DIR, safe_id);
+        esp_err_t err = ha_history_load(series, series->path);
+        if (err == ESP_ERR_NOT_FOUND) {
+            (void)ha_history_import_legacy(series, layout);
+        }
+    }
+    if (series->count > 0) {
+        series->last_persist_ts = ha_history_newest(series)->bucket_ts;
+    }
+    return series;
+}
+
+static bool ha_history_handles_contain(const ha_entity_handle_t *handles, size_t count, ha_entity_handle_t entity)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (handles[i] == entity) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t ha_history_init(void)
+{
+    if (s_mutex != NULL) {
+        return ESP_OK;
+    }
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ha_history_sync_layout(void)
+{
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    layout_compiled_t *layout = NULL;
+    esp_err_t err = layout_store_load_compiled(&layout);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ha_entity_handle_t wanted[APP_HA_HISTORY_MAX_SERIES];
+    size_t wanted_count = 0;
+    for (uint16_t i = 0; i < layout->widget_count; i++) {
+        const layout_widget_def_t *def = &layout->widgets[i];
+        if (strcmp(def->type, "graph") != 0 || def->entity_id[0] == '\0') {
+            continue;
+        }
+        ha_entity_handle_t entity = ha_entity_ids_intern(def->entity_id);
+        if (entity == HA_ENTITY_HANDLE_NONE || ha_history_handles_contain(wanted, wanted_count, entity)) {
+            continue;
+        }
+        if (wanted_count == APP_HA_HISTORY_MAX_SERIES) {
+            ESP_LOGW(TAG_HA_HISTORY, "more than %d graph entities, no history for %s", APP_HA_HISTORY_MAX_SERIES,
+                def->entity_id);
+            continue;
+        }
+        wanted[wanted_count++] = entity;
+    }
+
+    /* Dropped series are flushed on this task: behind the queued jobs, and before any log is read
+     * again below, so a graph removed and placed again reloads everything it had. */
+    ha_history_series_t *released[APP_HA_HISTORY_MAX_SERIES];
+    ha_history_persist_job_t *flushes[APP_HA_HISTORY_MAX_SERIES];
+    size_t released_count = 0;
+    size_t flush_count = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_series_count;) {
+        ha_history_series_t *series = s_series[i];
+        if (ha_history_handles_contain(wanted, wanted_count, series->entity)) {
+            i++;
+            continue;
+        }
+        /* No longer shown: the file stays for a later layout. */
+        if (series->path[0] != '\0' && series->dirty) {
+            ha_history_persist_job_t *job = ha_history_build_job(series);
+            if (job != NULL) {
+                ha_history_job_taken(series, job);
+                flushes[flush_count++] = job;
+            }
+        }
+        released[released_count++] = series;
+        s_series[i] = s_series[--s_series_count];
+    }
+    xSemaphoreGive(s_mutex);
+
+    bool need_open = false;
+    for (size_t i = 0; i < wanted_count && !need_open; i++) {
+        need_open = !ha_history_is_tracked(wanted[i]);
+    }
+    if (flush_count > 0U || need_open) {
+        ha_history_persist_drain();
+    }
+    for (size_t i = 0; i < flush_count; i++) {
+        size_t written = 0;
+        esp_err_t write_err = ha_history_write_job(flushes[i], &written);
+        ha_history_account_job(flushes[i], write_err, written);
+        free(flushes[i]);
+    }
+    for (size_t i = 0; i < released_count; i++) {
+        free(released[i]);
+    }
+
+    /* New series read flash before the lock is taken. */
+    ha_history_series_t *opened[APP_HA_HISTORY_MAX_SERIES] = {0};
+    for (size_t i = 0; i < wanted_count && need_open; i++) {
+        if (!ha_history_is_tracked(wanted[i])) {
+            opened[i] = ha_history_series_open(wanted[i], layout);
+            if (opened[i] == NULL) {
+                ESP_LOGW(TAG_HA_HISTORY, "no memory for the history of %s", ha_entity_ids_str(wanted[i]));
+            }
+        }
+    }
+    layout_compiled_free(layout);
+
+    ha_history_series_t *duplicates[APP_HA_HISTORY_MAX_SERIES];
+    size_t duplicate_count = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < wanted_count; i++) {
+        ha_history_series_t *series = opened[i];
+        if (series == NULL) {
+            continue;
+        }
+        if (ha_history_find_locked(series->entity) != NULL || s_series_count == APP_HA_HISTORY_MAX_SERIES) {
+            /* A concurrent sync got there first. */
+            duplicates[duplicate_count++] = series;
+            continue;
+        }
+        series->revision = ++s_revision;
+        s_series[s_series_count++] = series;
+        if (series->legacy_path[0] != '\0') {
+            ha_history_try_persist(series, 0U, true);
+        }
+    }
+    size_t tracked = s_series_count;
+    xSemaphoreGive(s_mutex);
+
+    for (size_t i = 0; i < duplicate_count; i++) {
+        free(duplicates[i]);
+    }
+    ESP_LOGI(TAG_HA_HISTORY, "tracking %u series", (unsigned)tracked);
+    return ESP_OK;
+}
+
+bool ha_history_parse_value(const char *state_text, float *out_value)
+{
+    return !ha_history_state_is_unavailable(state_text) && ha_history_parse_float_relaxed(state_text, out_value);
+}
+
+void ha_history_record_state(ha_entity_handle_t entity, const char *state_text)
+{
+    float value = 0.0f;
+    if (s_mutex == NULL || entity == HA_ENTITY_HANDLE_NONE || !ha_history_parse_value(state_text, &value)) {
+        return;
+    }
+    uint32_t bucket_ts = ha_history_now_bucket_ts();
+    if (bucket_ts == 0U) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ha_history_series_t *series = ha_history_find_locked(entity);
+    if (series != NULL && series->live_from_ts == UINT32_MAX) {
+        series->live_from_ts = bucket_ts;
+    }
+    if (series != NULL && ha_history_append_or_update(series, bucket_ts, value)) {
+        series->revision = ++s_revision;
+        series->dirty = true;
+        ha_history_try_persist(series, bucket_ts, false);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+/* Plans the series' backfill on first use: from its newest minute before the first live one (or
+ * the start of the retention span) up to that live minute, or to now if none came in yet. Returns
+ * whether a part of it is still to fetch. Called with s_mutex held. */
+static bool ha_history_backfill_pending(ha_history_series_t *series, uint32_t now_bucket_ts)
+{
+    if (!series->backfill_planned) {
+        uint32_t until = (series->live_from_ts != UINT32_MAX) ? series->live_from_ts : now_bucket_ts;
+        int before = ha_history_lower_bound(series, until) - 1;
+        uint32_t from = (before >= 0) ? (ha_history_at(series, before)->bucket_ts + HA_HISTORY_BUCKET_SEC) : 0U;
+        if (now_bucket_ts > HA_HISTORY_RETENTION_SEC && from < now_bucket_ts - HA_HISTORY_RETENTION_SEC) {
+            from = now_bucket_ts - HA_HISTORY_RETENTION_SEC;
+        }
+        series->backfill_from_ts = from;
+        series->backfill_until_ts = until;
+        series->backfill_planned = true;
+    }
+    return series->backfill_from_ts < series->backfill_until_ts;
+}
+
+bool ha_history_backfill_next(
+    uint32_t max_minutes, ha_entity_handle_t *out_entity, uint32_t *out_start_ts, uint32_t *out_end_ts)
+{
+    uint32_t now_bucket_ts = ha_history_now_bucket_ts();
+    if (s_mutex == NULL || now_bucket_ts == 0U || max_minutes == 0U || out_entity == NULL || out_start_ts == NULL ||
+        out_end_ts == NULL) {
+        return false;
+    }
+
+    bool found = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_series_count && !found; i++) {
+        ha_history_series_t *series = s_series[i];
+        if (!ha_history_backfill_pending(series, now_bucket_ts)) {
+            continue;
+        }
+        uint32_t end = series->backfill_from_ts + max_minutes * HA_HISTORY_BUCKET_SEC;
+        *out_entity = series->entity;
+        *out_start_ts = series->backfill_from_ts;
+        *out_end_ts = (end < series->backfill_until_ts) ? end : series->backfill_until_ts;
+        found = true;
+    }
+    xSemaphoreGive(s_mutex);
+    return found;
+}
+
+int ha_history_backfill_commit(ha_entity_handle_t entity, uint32_t start_ts, uint32_t end_ts,
+    const ha_history_point_t *points, size_t count)
+{
+    if (s_mutex == NULL || end_ts <= start_ts) {
+        return 0;
+    }
+    if (points == NULL) {
+        count = 0;
+    }
+
+    /* The series is merged into a scratch copy: at most a full ring plus one minute per slice minute. */
+    size_t slice_minutes = (end_ts - start_ts + HA_HISTORY_BUCKET_SEC - 1U) / HA_HISTORY_BUCKET_SEC;
+    size_t scratch_len = (size_t)HA_HISTORY_MAX_SAMPLES + slice_minutes;
+    ha_history_sample_t *scratch = NULL;
+    if (count > 0U) {
+        scratch = heap_caps_malloc(scratch_len * sizeof(*scratch), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (scratch == NULL) {
+            scratch = malloc(scratch_len * sizeof(*scratch));
+        }
+        if (scratch == NULL) {
+            /* Not committed: the slice is fetched again. */
+            ESP_LOGW(TAG_HA_HISTORY, "no memory to merge backfill of %s", ha_entity_ids_str(entity));
+            return 0;
+        }
+    }
+
+    int added = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ha_history_series_t *series = ha_history_find_locked(entity);
+    if (series == NULL || !series->backfill_planned || series->backfill_from_ts != start_ts) {
+        /* Released, or reopened and planned anew meanwhile. */
+        xSemaphoreGive(s_mutex);
+        free(scratch);
+        return 0;
+    }
+    series->backfill_from_ts = (end_ts < series->backfill_until_ts) ? end_ts : series->backfill_until_ts;
+    __atomic_fetch_add(&s_stats.backfill_slices, 1U, __ATOMIC_RELAXED);
+
+    if (scratch != NULL) {
+        /* Minutes the series already holds win; fetched points of one minute fold into the last. */
+        int first = ha_history_lower_bound(series, start_ts);
+        int after = ha_history_lower_bound(series, end_ts);
+        ha_history_copy(series, 0, first, scratch);
+        size_t n = (size_t)first;
+        int existing = first;
+        for (size_t p = 0; p < count; p++) {
+            uint32_t ts = points[p].ts - (points[p].ts % HA_HISTORY_BUCKET_SEC);
+            if (ts < start_ts) {
+                /* The state the slice starts with. */
+                ts = start_ts;
+            }
+            if (ts >= end_ts) {
+                break;
+            }
+            while (existing < after && ha_history_at(series, existing)->bucket_ts < ts) {
+                scratch[n++] = *ha_history_at(series, existing++);
+            }
+            if (existing < after && ha_history_at(series, existing)->bucket_ts == ts) {
+                continue;
+            }
+            if (n > 0U && scratch[n - 1U].bucket_ts == ts) {
+                scratch[n - 1U].value = points[p].value;
+                continue;
+            }
+            scratch[n].bucket_ts = ts;
+            scratch[n].value = points[p].value;
+            n++;
+            added++;
+        }
+        int rest = series->count - existing;
+        ha_history_copy(series, existing, rest, &scratch[n]);
+        n += (size_t)rest;
+
+        if (added > 0) {
+            size_t drop = (n > (size_t)HA_HISTORY_MAX_SAMPLES) ? (n - (size_t)HA_HISTORY_MAX_SAMPLES) : 0U;
+            memcpy(series->samples, &scratch[drop], (n - drop) * sizeof(*scratch));
+            series->head = 0;
+            series->count = (int)(n - drop);
+            ha_history_trim_retention(series, ha_history_newest(series)->bucket_ts);
+            ha_history_pyramid_rebuild(series);
+            /* Minutes went in before the logged ones: the log is rewritten, not appended to. */
+            series->log_compact = true;
+            series->dirty = true;
+            series->revision = ++s_revision;
+            __atomic_fetch_add(&s_stats.backfill_minutes, (uint32_t)added, __ATOMIC_RELAXED);
+        }
+    }
+    if (series->backfill_from_ts >= series->backfill_until_ts) {
+        ha_history_try_persist(series, 0U, true);
+    } else {
+        ha_history_try_persist(series, ha_history_now_bucket_ts(), false);
+    }
+    xSemaphoreGive(s_mutex);
+    free(scratch);
+    return added;
+}
+
+uint32_t ha_history_now_bucket_ts(void)
+{
+    time_t now = time(NULL);
+    if (now < 0 || (uint32_t)now < HA_HISTORY_VALID_EPOCH_MIN) {
+        return 0U;
+    }
+    uint32_t now_u = (uint32_t)now;
+    return now_u - (now_u % HA_HISTORY_BUCKET_SEC);
+}
+
+uint32_t ha_history_revision(ha_entity_handle_t entity)
+{
+    if (s_mutex == NULL) {
+        return 0U;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    const ha_history_series_t *series = ha_history_find_locked(entity);
+    uint32_t revision = (series != NULL) ? series->revision : 0U;
+    xSemaphoreGive(s_mutex);
+    return revision;
+}
+
+bool ha_history_span(ha_entity_handle_t entity, uint32_t *out_oldest_ts, uint32_t *out_newest_ts)
+{
+    if (s_mutex == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    const ha_history_series_t *series = ha_history_find_locked(entity);
+    bool found = series != NULL && series->count > 0;
+    if (found) {
+        if (out_oldest_ts != NULL) {
+            *out_oldest_ts = ha_history_at(series, 0)->bucket_ts;
+        }
+        if (out_newest_ts != NULL) {
+            *out_newest_ts = ha_history_newest(series)->bucket_ts;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return found;
+}
+
+bool ha_history_query(
+    ha_entity_handle_t entity, uint32_t start_ts, uint32_t window_sec, ha_history_slot_t *out_slots, int slot_count)
+{
+    if (s_mutex == NULL || out_slots == NULL || slot_count <= 0) {
+        return false;
+    }
+    memset(out_slots, 0, (size_t)slot_count * sizeof(out_slots[0]));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ha_history_series_t *series = ha_history_find_locked(entity);
+    if (series == NULL) {
+        xSemaphoreGive(s_mutex);
+        return false;
+    }
+
+    /* Coarsest pyramid level whose buckets still fit in a slot (NULL: the minute samples), so a slot
+     * aggregates a handful of entries whatever the window. */
+    uint32_t slot_sec = window_sec / (uint32_t)slot_count;
+    const ha_history_level_t *level = NULL;
+    for (int l = 0; l < HA_HISTORY_PYRAMID_LEVELS; l++) {
+        if (s_levels[l].bucket_sec <= slot_sec) {
+            level = &s_levels[l];
+        }
+    }
+    int sample_idx = (level == NULL) ? ha_history_lower_bound(series, start_ts) : 0;
+
+    for (int i = 0; i < slot_count; i++) {
+        uint32_t slot_start = start_ts + (uint32_t)(((uint64_t)window_sec * (uint64_t)i) / (uint64_t)slot_count);
+        uint32_t slot_end = start_ts + (uint32_t)(((uint64_t)window_sec * (uint64_t)(i + 1)) / (uint64_t)slot_count);
+        if (slot_end <= slot_start) {
+            slot_end = slot_start + 1U;
+        }
+        bool is_last_slot = (i == (slot_count - 1));
+
+        ha_history_bucket_t slot = {0};
+        if (level == NULL) {
+            while (sample_idx < series->count) {
+                const ha_history_sample_t *sample = ha_history_at(series, sample_idx);
+                uint32_t ts = sample->bucket_ts;
+                if (is_last_slot ? (ts > slot_end) : (ts >= slot_end)) {
+                    break;
+                }
+                if (ts >= slot_start) {
+                    ha_history_bucket_add(&slot, sample->value);
+                }
+                sample_idx++;
+            }
+        } else {
+            /* Buckets belong to the slot their start falls in. */
+            uint32_t sec = level->bucket_sec;
+            for (uint32_t b = ((slot_start + sec - 1U) / sec) * sec; is_last_slot ? (b <= slot_end) : (b < slot_end);
+                 b += sec) {
+                const ha_history_bucket_t *bucket = ha_history_pyramid_slot(series, level, b);
+                if (bucket->bucket_ts != b || bucket->count == 0U) {
+                    continue;
+                }
+                if (slot.count == 0U || bucket->min < slot.min) {
+                    slot.min = bucket->min;
+                }
+                if (slot.count == 0U || bucket->max > slot.max) {
+                    slot.max = bucket->max;
+                }
+                slot.sum += bucket->sum;
+                slot.count += bucket->count;
+            }
+        }
+
+        if (slot.count > 0U) {
+            out_slots[i].min = slot.min;
+            out_slots[i].max = slot.max;
+            out_slots[i].avg = slot.sum / (float)slot.count;
+            out_slots[i].count = slot.count;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return true;
+}
+
+void ha_history_get_stats(ha_history_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (s_mutex != NULL) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        out_stats->series = (uint32_t)s_series_count;
+        xSemaphoreGive(s_mutex);
+    }
+    out_stats->series_capacity = APP_HA_HISTORY_MAX_SERIES;
+    out_stats->series_bytes = out_stats->series * (uint32_t)sizeof(ha_history_series_t);
+    out_stats->appends = __atomic_load_n(&s_stats.appends, __ATOMIC_RELAXED);
+    out_stats->compactions = __atomic_load_n(&s_stats.compactions, __ATOMIC_RELAXED);
+    out_stats->write_failures = __atomic_load_n(&s_stats.write_failures, __ATOMIC_RELAXED);
+    out_stats->samples_written = __atomic_load_n(&s_stats.samples_written, __ATOMIC_RELAXED);
+    out_stats->bytes_written = __atomic_load_n(&s_stats.bytes_written, __ATOMIC_RELAXED);
+    out_stats->full_rewrite_bytes = __atomic_load_n(&s_stats.full_rewrite_bytes, __ATOMIC_RELAXED);
+    out_stats->backfill_slices = __atomic_load_n(&s_stats.backfill_slices, __ATOMIC_RELAXED);
+    out_stats->backfill_minutes = __atomic_load_n(&s_stats.backfill_minutes, __ATOMIC_RELAXED);
+}
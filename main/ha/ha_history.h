@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "ha/ha_entity_ids.h"
+
+/* One-minute history (24 h) of the entities graph widgets show, one series per entity. Series are
+ * fed by ha_model on every state change, persisted per entity under /littlefs/history, and outlive
+ * the widgets that draw them: graphs only query. Thread-safe. */
+
+typedef struct {
+    float min;
+    float max;
+    float avg;
+    /* Minute samples aggregated into the slot; 0 = no data. */
+    uint32_t count;
+} ha_history_slot_t;
+
+/* One recorded value, e.g. fetched from Home Assistant's recorder. */
+typedef struct {
+    uint32_t ts;
+    float value;
+} ha_history_point_t;
+
+/* Since boot: flash bytes handed to LittleFS for the history logs, next to what rewriting every
+ * series in full on each save would have cost. */
+typedef struct {
+    uint32_t series;
+    uint32_t series_capacity;
+    uint32_t series_bytes;
+    uint32_t appends;
+    uint32_t compactions;
+    uint32_t write_failures;
+    uint32_t samples_written;
+    uint64_t bytes_written;
+    uint64_t full_rewrite_bytes;
+    uint32_t backfill_slices;
+    uint32_t backfill_minutes;
+} ha_history_stats_t;
+
+esp_err_t ha_history_init(void);
+/* Tracks the entities of the stored layout's graph widgets: new ones load their log, dropped ones
+ * are flushed and released. Call after every layout save. */
+esp_err_t ha_history_sync_layout(void);
+/* Records a numeric state of a tracked entity in the current minute; anything else is ignored. */
+void ha_history_record_state(ha_entity_handle_t entity, const char *state_text);
+/* Numeric value of a state text as the history records it; false for unavailable/non-numeric. */
+bool ha_history_parse_value(const char *state_text, float *out_value);
+/* Next slice [*out_start_ts, *out_end_ts) of a series' gap before its first live sample (a reboot or
+ * a newly placed graph) to fetch from HA, at most max_minutes long. False while nothing is missing
+ * or the clock is not set. */
+bool ha_history_backfill_next(
+    uint32_t max_minutes, ha_entity_handle_t *out_entity, uint32_t *out_start_ts, uint32_t *out_end_ts);
+/* Merges the points fetched for a slice (ascending; folded to minutes, last one wins; minutes the
+ * series already holds are kept) and moves the entity's backfill past end_ts. A failed fetch
+ * commits no points. Returns the number of minutes added. */
+int ha_history_backfill_commit(ha_entity_handle_t entity, uint32_t start_ts, uint32_t end_ts,
+    const ha_history_point_t *points, size_t count);
+/* Start of the current minute, 0 while the clock is not set. */
+uint32_t ha_history_now_bucket_ts(void);
+/* Changes whenever the entity's series does; 0 for untracked entities. */
+uint32_t ha_history_revision(ha_entity_handle_t entity);
+/* Oldest and newest recorded minute; false if the series is empty or untracked. */
+bool ha_history_span(ha_entity_handle_t entity, uint32_t *out_oldest_ts, uint32_t *out_newest_ts);
+/* Aggregates [start_ts, start_ts + window_sec] into slot_count equal slots, each from the coarsest
+ * pyramid level that fits it. False if the entity is untracked. */
+bool ha_history_query(
+    ha_entity_handle_t entity, uint32_t start_ts, uint32_t window_sec, ha_history_slot_t *out_slots, int slot_count);
+void ha_history_get_stats(ha_history_stats_t *out_stats);
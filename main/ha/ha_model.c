@@ -11,14 +11,42 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "ha/ha_attr_arena.h"
+#include "ha/ha_entity_catalog.h"
+#include "ha/ha_history.h"
 #include "util/log_tags.h"
 
+/* Model slots are addressed directly by interned entity handle: s_*_slot_by_handle[handle] holds
+ * (array index + 1), 0 marks "not present". Only ha_model_reset clears entries. */
+#define HA_MODEL_SLOT_EMPTY 0U
+#define HA_MODEL_HANDLE_TABLE_LEN (APP_HA_ENTITY_ID_POOL_MAX + 1U)
+/* Size of the fixed per-state attributes_json[] field the arena replaced; kept for the memory report. */
+#define HA_MODEL_LEGACY_ATTRS_LEN 512U
+
+/* State slots are double-buffered and versioned so readers never take s_model_mutex.
+ * seq is even when idle and odd while a writer fills the inactive buffer; the active buffer is
+ * (seq >> 1) & 1. Writers (serialized by s_model_mutex) only ever touch the inactive buffer, and
+ * wait for borrowers that still pin it. Copy-out readers validate with a seqlock-style retry.
+ * Each buffer owns its attribute blob in the attribute arena (or points at a static literal). */
+typedef struct {
+    ha_state_t buf[2];
+    uint32_t seq;
+    uint16_t pins[2];
+    /* s_state_revision value of the change in the active buffer; stored after the buffer is published. */
+    uint32_t revision;
+} ha_model_state_slot_t;
+
 static SemaphoreHandle_t s_model_mutex = NULL;
 static ha_entity_info_t *s_entities = NULL;
 static size_t s_entity_count = 0;
-static ha_state_t *s_states = NULL;
+static ha_model_state_slot_t *s_states = NULL;
 static size_t s_state_count = 0;
 static uint32_t s_state_revision = 0;
+static uint16_t s_entity_slot_by_handle[HA_MODEL_HANDLE_TABLE_LEN] = {0};
+static uint16_t s_state_slot_by_handle[HA_MODEL_HANDLE_TABLE_LEN] = {0};
+static const char s_attrs_empty[] = "";
+static const char s_attrs_fallback[] = "{}";
 
 static void ha_model_free_buffers(void)
 {
@@ -34,6 +62,12 @@ static void ha_model_free_buffers(void)
     s_state_count = 0;
 }
 
+static void ha_model_clear_indexes(void)
+{
+    memset(s_entity_slot_by_handle, 0, sizeof(s_entity_slot_by_handle));
+    memset(s_state_slot_by_handle, 0, sizeof(s_state_slot_by_handle));
+}
+
 static void safe_copy_cstr(char *dst, size_t dst_size, const char *src)
 {
     if (dst == NULL || dst_size == 0) {
@@ -97,23 +131,117 @@ static void fill_domain(const char *entity_id, char *domain, size_t domain_len)
     domain[len] = '\0';
 }
 
+static const char *ha_state_attrs(const ha_state_t *state)
+{
+    return (state->attributes_json != NULL) ? state->attributes_json : s_attrs_empty;
+}
+
 static bool ha_state_equals(const ha_state_t *lhs, const ha_state_t *rhs)
 {
     if (lhs == NULL || rhs == NULL) {
         return false;
     }
 
-    return strncmp(lhs->entity_id, rhs->entity_id, sizeof(lhs->entity_id)) == 0 &&
+    return lhs->entity == rhs->entity &&
            strncmp(lhs->state, rhs->state, sizeof(lhs->state)) == 0 &&
-           strncmp(lhs->attributes_json, rhs->attributes_json, sizeof(lhs->attributes_json)) == 0 &&
+           strncmp(ha_state_attrs(lhs), ha_state_attrs(rhs), APP_HA_ATTRS_MAX_LEN) == 0 &&
            lhs->last_changed_unix_ms == rhs->last_changed_unix_ms;
 }
 
+static void ha_model_wait_unpinned(ha_model_state_slot_t *slot, uint32_t buf_idx)
+{
+    while (__atomic_load_n(&slot->pins[buf_idx], __ATOMIC_SEQ_CST) != 0) {
+        vTaskDelay(1);
+    }
+}
+
+static int find_state_index_lockfree(ha_entity_handle_t entity)
+{
+    if (entity == HA_ENTITY_HANDLE_NONE || entity >= HA_MODEL_HANDLE_TABLE_LEN) {
+        return -1;
+    }
+    uint16_t slot = __atomic_load_n(&s_state_slot_by_handle[entity], __ATOMIC_ACQUIRE);
+    return (slot == HA_MODEL_SLOT_EMPTY) ? -1 : (int)slot - 1;
+}
+
+/* Copy is torn once a writer has started on the buffer we read: that is the second writer
+ * after an even (idle) seq, or the first one after an odd (already writing) seq. */
+static bool ha_model_seq_still_valid(uint32_t seq_before, uint32_t seq_after)
+{
+    uint32_t allowed = ((seq_before & 1U) == 0U) ? 2U : 1U;
+    return (seq_after - seq_before) <= allowed;
+}
+
+static const char *ha_model_store_attrs_locked(const char *attrs)
+{
+    size_t len = strnlen(attrs, APP_HA_ATTRS_MAX_LEN);
+    if (len == 0) {
+        return s_attrs_empty;
+    }
+    const char *blob = (const char *)ha_attr_arena_store(attrs, len);
+    return (blob != NULL) ? blob : s_attrs_fallback;
+}
+
+static void ha_model_store_forecast_locked(ha_state_attrs_t *attrs)
+{
+    const ha_forecast_row_t *rows = NULL;
+    if (attrs->forecast != NULL && attrs->forecast_count > 0) {
+        rows = (const ha_forecast_row_t *)ha_attr_arena_store(
+            attrs->forecast, (size_t)attrs->forecast_count * sizeof(ha_forecast_row_t));
+    }
+    attrs->forecast = rows;
+    attrs->forecast_count = (rows != NULL) ? attrs->forecast_count : 0;
+}
+
+/* Copies handed out by value must not reference blobs the slot can recycle. */
+static void ha_model_detach_copy(ha_state_t *state)
+{
+    state->attributes_json = s_attrs_empty;
+    state->attrs.extracted = false;
+    state->attrs.forecast = NULL;
+    state->attrs.forecast_count = 0;
+}
+
+static void ha_model_publish_state_locked(ha_model_state_slot_t *slot, const ha_state_t *state)
+{
+    uint32_t seq = slot->seq;
+    uint32_t target = ((seq >> 1) & 1U) ^ 1U;
+    /* Announce the write first (odd seq), then check pins: borrowers pin first, then re-check seq. */
+    __atomic_store_n(&slot->seq, seq + 1U, __ATOMIC_SEQ_CST);
+    ha_model_wait_unpinned(slot, target);
+    ha_attr_arena_release(slot->buf[target].attributes_json);
+    ha_attr_arena_release(slot->buf[target].attrs.forecast);
+    slot->buf[target] = *state;
+    slot->buf[target].attributes_json = ha_model_store_attrs_locked(ha_state_attrs(state));
+    ha_model_store_forecast_locked(&slot->buf[target].attrs);
+    __atomic_store_n(&slot->seq, seq + 2U, __ATOMIC_RELEASE);
+}
+
+/* Called after the state is published, so a reader that sees the new revision also sees the state. */
+static void ha_model_bump_revision_locked(ha_model_state_slot_t *slot)
+{
+    uint32_t revision = __atomic_add_fetch(&s_state_revision, 1U, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->revision, revision, __ATOMIC_RELEASE);
+}
+
 esp_err_t ha_model_init(void)
 {
     if (s_model_mutex != NULL) {
         return ESP_OK;
     }
+    esp_err_t ids_err = ha_entity_ids_init();
+    if (ids_err != ESP_OK) {
+        return ids_err;
+    }
+    esp_err_t attrs_err = ha_attr_arena_init();
+    if (attrs_err != ESP_OK) {
+        ESP_LOGE(TAG_HA_MODEL, "Failed to allocate attribute arena");
+        return attrs_err;
+    }
+    esp_err_t catalog_err = ha_entity_catalog_init();
+    if (catalog_err != ESP_OK) {
+        return catalog_err;
+    }
     s_model_mutex = xSemaphoreCreateMutex();
     if (s_model_mutex == NULL) {
         return ESP_ERR_NO_MEM;
@@ -126,9 +254,11 @@ esp_err_t ha_model_init(void)
             (ha_entity_info_t *)heap_caps_calloc(APP_HA_MAX_ENTITIES, sizeof(ha_entity_info_t), MALLOC_CAP_8BIT);
     }
 
-    s_states = (ha_state_t *)heap_caps_calloc(APP_HA_MAX_STATES, sizeof(ha_state_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_states = (ha_model_state_slot_t *)heap_caps_calloc(
+        APP_HA_MAX_STATES, sizeof(ha_model_state_slot_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     if (s_states == NULL) {
-        s_states = (ha_state_t *)heap_caps_calloc(APP_HA_MAX_STATES, sizeof(ha_state_t), MALLOC_CAP_8BIT);
+        s_states = (ha_model_state_slot_t *)heap_caps_calloc(
+            APP_HA_MAX_STATES, sizeof(ha_model_state_slot_t), MALLOC_CAP_8BIT);
     }
 
     if (s_entities == NULL || s_states == NULL) {
@@ -139,8 +269,8 @@ esp_err_t ha_model_init(void)
         return ESP_ERR_NO_MEM;
     }
 
-    ESP_LOGI(TAG_HA_MODEL, "Model buffers ready (%u entities, %u states)",
-        (unsigned)APP_HA_MAX_ENTITIES, (unsigned)APP_HA_MAX_STATES);
+    ESP_LOGI(TAG_HA_MODEL, "Model buffers ready (%u entities, %u states, %u B attribute arena)",
+        (unsigned)APP_HA_MAX_ENTITIES, (unsigned)APP_HA_MAX_STATES, (unsigned)APP_HA_ATTR_ARENA_BYTES);
     return ESP_OK;
 }
 
@@ -150,42 +280,77 @@ void ha_model_reset(void)
         return;
     }
     xSemaphoreTake(s_model_mutex, portMAX_DELAY);
+    ha_model_clear_indexes();
+    for (size_t i = 0; i < s_state_count; i++) {
+        ha_model_state_slot_t *slot = &s_states[i];
+        /* Invalidate in-flight copy readers and drain borrowers before wiping the buffers. */
+        __atomic_store_n(&slot->seq, slot->seq + 5U, __ATOMIC_SEQ_CST);
+        ha_model_wait_unpinned(slot, 0);
+        ha_model_wait_unpinned(slot, 1);
+        memset(slot->buf, 0, sizeof(slot->buf));
+        __atomic_store_n(&slot->revision, 0U, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->seq, slot->seq + 1U, __ATOMIC_RELEASE);
+    }
+    /* No slot references a blob any more, so the arena is rewound instead of released block by block. */
+    ha_attr_arena_reset();
+    ha_entity_catalog_reset();
     memset(s_entities, 0, sizeof(ha_entity_info_t) * APP_HA_MAX_ENTITIES);
-    memset(s_states, 0, sizeof(ha_state_t) * APP_HA_MAX_STATES);
     s_entity_count = 0;
-    s_state_count = 0;
-    s_state_revision++;
+    __atomic_store_n(&s_state_count, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&s_state_revision, 1U, __ATOMIC_RELEASE);
     xSemaphoreGive(s_model_mutex);
 }
 
-static int find_entity_index(const char *entity_id)
+static int find_entity_index(ha_entity_handle_t entity)
 {
-    for (size_t i = 0; i < s_entity_count; i++) {
-        if (strncmp(s_entities[i].id, entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
-            return (int)i;
-        }
+    if (entity == HA_ENTITY_HANDLE_NONE || entity >= HA_MODEL_HANDLE_TABLE_LEN) {
+        return -1;
     }
-    return -1;
+    uint16_t slot = s_entity_slot_by_handle[entity];
+    return (slot == HA_MODEL_SLOT_EMPTY) ? -1 : (int)slot - 1;
 }
 
-static int find_state_index(const char *entity_id)
+static int find_state_index(ha_entity_handle_t entity)
 {
-    for (size_t i = 0; i < s_state_count; i++) {
-        if (strncmp(s_states[i].entity_id, entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
-            return (int)i;
-        }
+    if (entity == HA_ENTITY_HANDLE_NONE || entity >= HA_MODEL_HANDLE_TABLE_LEN) {
+        return -1;
+    }
+    uint16_t slot = s_state_slot_by_handle[entity];
+    return (slot == HA_MODEL_SLOT_EMPTY) ? -1 : (int)slot - 1;
+}
+
+static void append_entity_locked(const ha_entity_info_t *entity)
+{
+    s_entities[s_entity_count] = *entity;
+    s_entity_slot_by_handle[entity->entity] = (uint16_t)(s_entity_count + 1U);
+    s_entity_count++;
+}
+
+ha_entity_handle_t ha_model_intern_entity_id(const char *entity_id)
+{
+    if (s_model_mutex == NULL || entity_id == NULL || entity_id[0] == '\0') {
+        return HA_ENTITY_HANDLE_NONE;
     }
-    return -1;
+    ha_entity_handle_t entity = ha_entity_ids_find(entity_id);
+    if (entity != HA_ENTITY_HANDLE_NONE) {
+        return entity;
+    }
+
+    xSemaphoreTake(s_model_mutex, portMAX_DELAY);
+    bool has_room = (s_state_count < APP_HA_MAX_STATES) || (s_entity_count < APP_HA_MAX_ENTITIES);
+    xSemaphoreGive(s_model_mutex);
+    return has_room ? ha_entity_ids_intern(entity_id) : HA_ENTITY_HANDLE_NONE;
 }
 
 esp_err_t ha_model_upsert_entity(const ha_entity_info_t *entity)
 {
-    if (s_model_mutex == NULL || s_entities == NULL || entity == NULL || entity->id[0] == '\0') {
+    if (s_model_mutex == NULL || s_entities == NULL || entity == NULL || entity->entity == HA_ENTITY_HANDLE_NONE ||
+        entity->entity >= HA_MODEL_HANDLE_TABLE_LEN) {
         return ESP_ERR_INVALID_ARG;
     }
 
     xSemaphoreTake(s_model_mutex, portMAX_DELAY);
-    int idx = find_entity_index(entity->id);
+    int idx = find_entity_index(entity->entity);
     if (idx >= 0) {
         s_entities[idx] = *entity;
         xSemaphoreGive(s_model_mutex);
@@ -196,66 +361,178 @@ esp_err_t ha_model_upsert_entity(const ha_entity_info_t *entity)
         xSemaphoreGive(s_model_mutex);
         return ESP_ERR_NO_MEM;
     }
-    s_entities[s_entity_count++] = *entity;
+    append_entity_locked(entity);
     xSemaphoreGive(s_model_mutex);
     return ESP_OK;
 }
 
 esp_err_t ha_model_upsert_state(const ha_state_t *state)
 {
-    if (s_model_mutex == NULL || s_entities == NULL || s_states == NULL || state == NULL || state->entity_id[0] == '\0') {
+    return ha_model_upsert_state_changed(state, NULL);
+}
+
+esp_err_t ha_model_upsert_state_changed(const ha_state_t *state, bool *out_changed)
+{
+    if (out_changed != NULL) {
+        *out_changed = false;
+    }
+    if (s_model_mutex == NULL || s_entities == NULL || s_states == NULL || state == NULL ||
+        state->entity == HA_ENTITY_HANDLE_NONE || state->entity >= HA_MODEL_HANDLE_TABLE_LEN) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    /* Extract the typed attributes before taking the lock; this is the only parse per update. */
+    ha_state_t incoming = *state;
+    ha_forecast_row_t forecast_rows[HA_STATE_ATTRS_FORECAST_MAX];
+    if (!incoming.attrs.extracted) {
+        ha_state_attrs_from_json(
+            ha_state_attrs(&incoming), &incoming.attrs, forecast_rows, HA_STATE_ATTRS_FORECAST_MAX);
+    }
+    state = &incoming;
+
     xSemaphoreTake(s_model_mutex, portMAX_DELAY);
-    int idx = find_state_index(state->entity_id);
-    bool state_changed = false;
+    int idx = find_state_index(state->entity);
     if (idx >= 0) {
-        if (ha_state_equals(&s_states[idx], state)) {
+        ha_model_state_slot_t *slot = &s_states[idx];
+        if (ha_state_equals(&slot->buf[(slot->seq >> 1) & 1U], state)) {
             xSemaphoreGive(s_model_mutex);
             return ESP_OK;
         }
-        s_states[idx] = *state;
-        state_changed = true;
+        ha_model_publish_state_locked(slot, state);
+        ha_model_bump_revision_locked(slot);
     } else {
         if (s_state_count >= APP_HA_MAX_STATES) {
             xSemaphoreGive(s_model_mutex);
             return ESP_ERR_NO_MEM;
         }
-        s_states[s_state_count++] = *state;
-        state_changed = true;
+        ha_model_state_slot_t *slot = &s_states[s_state_count];
+        ha_model_publish_state_locked(slot, state);
+        ha_model_bump_revision_locked(slot);
+        __atomic_store_n(&s_state_count, s_state_count + 1U, __ATOMIC_RELEASE);
+        __atomic_store_n(&s_state_slot_by_handle[state->entity], (uint16_t)s_state_count, __ATOMIC_RELEASE);
     }
 
-    if (find_entity_index(state->entity_id) < 0 && s_entity_count < APP_HA_MAX_ENTITIES) {
+    if (s_entity_count < APP_HA_MAX_ENTITIES && find_entity_index(state->entity) < 0) {
+        const char *entity_id = ha_entity_ids_str(state->entity);
         ha_entity_info_t entity = {0};
-        safe_copy_cstr(entity.id, sizeof(entity.id), state->entity_id);
-        safe_copy_cstr(entity.name, sizeof(entity.name), state->entity_id);
-        fill_domain(state->entity_id, entity.domain, sizeof(entity.domain));
-        s_entities[s_entity_count++] = entity;
-    }
-
-    if (state_changed) {
-        s_state_revision++;
+        entity.entity = state->entity;
+        safe_copy_cstr(entity.name, sizeof(entity.name), entity_id);
+        fill_domain(entity_id, entity.domain, sizeof(entity.domain));
+        append_entity_locked(&entity);
     }
 
     xSemaphoreGive(s_model_mutex);
+    ha_history_record_state(state->entity, state->state);
+    if (out_changed != NULL) {
+        *out_changed = true;
+    }
     return ESP_OK;
 }
 
 bool ha_model_get_state(const char *entity_id, ha_state_t *out_state)
 {
-    if (s_model_mutex == NULL || s_states == NULL || entity_id == NULL || out_state == NULL) {
+    if (entity_id == NULL) {
         return false;
     }
-    bool found = false;
-    xSemaphoreTake(s_model_mutex, portMAX_DELAY);
-    int idx = find_state_index(entity_id);
-    if (idx >= 0) {
-        *out_state = s_states[idx];
-        found = true;
+    return ha_model_get_state_by_handle(ha_entity_ids_find(entity_id), out_state);
+}
+
+static bool ha_model_copy_slot(const ha_model_state_slot_t *slot, ha_state_t *out_state)
+{
+    while (true) {
+        uint32_t seq_before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        *out_state = slot->buf[(seq_before >> 1) & 1U];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t seq_after = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+        if (ha_model_seq_still_valid(seq_before, seq_after)) {
+            ha_model_detach_copy(out_state);
+            return out_state->entity != HA_ENTITY_HANDLE_NONE;
+        }
     }
-    xSemaphoreGive(s_model_mutex);
-    return found;
+}
+
+bool ha_model_get_state_by_handle(ha_entity_handle_t entity, ha_state_t *out_state)
+{
+    if (s_model_mutex == NULL || s_states == NULL || out_state == NULL) {
+        return false;
+    }
+    int idx = find_state_index_lockfree(entity);
+    if (idx < 0) {
+        return false;
+    }
+    return ha_model_copy_slot(&s_states[idx], out_state) && out_state->entity == entity;
+}
+
+static bool ha_model_borrow_slot(ha_model_state_slot_t *slot, ha_model_state_ref_t *out_ref)
+{
+    while (true) {
+        uint32_t seq_before = __atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST);
+        uint32_t buf_idx = (seq_before >> 1) & 1U;
+        __atomic_add_fetch(&slot->pins[buf_idx], 1U, __ATOMIC_SEQ_CST);
+        uint32_t seq_after = __atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST);
+        if (ha_model_seq_still_valid(seq_before, seq_after)) {
+            out_ref->state = &slot->buf[buf_idx];
+            out_ref->pin = &slot->pins[buf_idx];
+            return true;
+        }
+        __atomic_sub_fetch(&slot->pins[buf_idx], 1U, __ATOMIC_SEQ_CST);
+    }
+}
+
+bool ha_model_borrow_state(ha_entity_handle_t entity, ha_model_state_ref_t *out_ref)
+{
+    if (out_ref == NULL) {
+        return false;
+    }
+    out_ref->state = NULL;
+    out_ref->pin = NULL;
+    if (s_model_mutex == NULL || s_states == NULL) {
+        return false;
+    }
+    int idx = find_state_index_lockfree(entity);
+    if (idx < 0) {
+        return false;
+    }
+    ha_model_borrow_slot(&s_states[idx], out_ref);
+    if (out_ref->state->entity != entity) {
+        ha_model_release_state(out_ref);
+        return false;
+    }
+    return true;
+}
+
+void ha_model_release_state(ha_model_state_ref_t *ref)
+{
+    if (ref == NULL || ref->pin == NULL) {
+        return;
+    }
+    __atomic_sub_fetch(ref->pin, 1U, __ATOMIC_SEQ_CST);
+    ref->state = NULL;
+    ref->pin = NULL;
+}
+
+size_t ha_model_visit_states(ha_model_state_visit_fn_t visit, void *user_ctx)
+{
+    if (s_model_mutex == NULL || s_states == NULL || visit == NULL) {
+        return 0;
+    }
+
+    size_t visited = 0;
+    size_t count = __atomic_load_n(&s_state_count, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        ha_model_state_ref_t ref = {0};
+        ha_model_borrow_slot(&s_states[i], &ref);
+        bool keep_going = true;
+        if (ref.state->entity != HA_ENTITY_HANDLE_NONE) {
+            keep_going = visit(ref.state, user_ctx);
+            visited++;
+        }
+        ha_model_release_state(&ref);
+        if (!keep_going) {
+            break;
+        }
+    }
+    return visited;
 }
 
 size_t ha_model_list_entities(
@@ -273,7 +550,8 @@ size_t ha_model_list_entities(
             strncmp(domain_filter, entity->domain, sizeof(entity->domain)) != 0) {
             continue;
         }
-        if (!contains_case_insensitive(entity->id, search) && !contains_case_insensitive(entity->name, search)) {
+        if (!contains_case_insensitive(ha_entity_ids_str(entity->entity), search) &&
+            !contains_case_insensitive(entity->name, search)) {
             continue;
         }
         out_entities[written++] = *entity;
@@ -282,20 +560,85 @@ size_t ha_model_list_entities(
     return written;
 }
 
-size_t ha_model_list_states(ha_state_t *out_states, size_t max_out)
+bool ha_model_get_state_with_attrs(
+    ha_entity_handle_t entity, ha_state_t *out_state, char *attrs_buf, size_t attrs_buf_len)
 {
-    if (s_model_mutex == NULL || s_states == NULL || out_states == NULL || max_out == 0) {
-        return 0;
+    if (out_state == NULL || attrs_buf == NULL || attrs_buf_len == 0) {
+        return false;
     }
+    ha_model_state_ref_t ref = {0};
+    if (!ha_model_borrow_state(entity, &ref)) {
+        return false;
+    }
+    *out_state = *ref.state;
+    safe_copy_cstr(attrs_buf, attrs_buf_len, ref.state->attributes_json);
+    ha_model_release_state(&ref);
+    ha_model_detach_copy(out_state);
+    out_state->attributes_json = attrs_buf;
+    return true;
+}
 
-    size_t written = 0;
+void ha_model_get_memory_stats(ha_model_memory_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (s_model_mutex == NULL || s_states == NULL) {
+        return;
+    }
+
+    ha_attr_arena_stats_t arena = {0};
     xSemaphoreTake(s_model_mutex, portMAX_DELAY);
-    for (size_t i = 0; i < s_state_count && written < max_out; i++) {
-        out_states[written++] = s_states[i];
+    ha_attr_arena_get_stats(&arena);
+    for (size_t i = 0; i < s_state_count; i++) {
+        const ha_model_state_slot_t *slot = &s_states[i];
+        for (size_t b = 0; b < 2U; b++) {
+            const char *blob = slot->buf[b].attributes_json;
+            out_stats->attr_live_bytes += ha_attr_arena_owns(blob) ? ha_attr_arena_blob_len(blob) + 1U : 0U;
+            out_stats->attr_live_bytes += ha_attr_arena_blob_len(slot->buf[b].attrs.forecast);
+        }
+        size_t active_len = ha_attr_arena_blob_len(slot->buf[(slot->seq >> 1) & 1U].attributes_json);
+        if (active_len > out_stats->attr_largest_bytes) {
+            out_stats->attr_largest_bytes = active_len;
+        }
+        if (active_len >= HA_MODEL_LEGACY_ATTRS_LEN) {
+            out_stats->legacy_truncated_states++;
+        }
     }
+    out_stats->state_count = s_state_count;
     xSemaphoreGive(s_model_mutex);
 
-    return written;
+    out_stats->state_slot_bytes = APP_HA_MAX_STATES * sizeof(ha_model_state_slot_t);
+    out_stats->attr_arena_bytes = arena.capacity_bytes;
+    out_stats->attr_arena_carved_bytes = arena.carved_bytes;
+    out_stats->attr_block_bytes = arena.carved_bytes - arena.free_list_bytes;
+    out_stats->attr_alloc_failures = arena.alloc_failures;
+    out_stats->attr_merge_passes = arena.merge_passes;
+    /* Same slots with the old inline char attributes_json[512] instead of a pointer. */
+    out_stats->legacy_layout_bytes =
+        APP_HA_MAX_STATES * (sizeof(ha_model_state_slot_t) + 2U * (HA_MODEL_LEGACY_ATTRS_LEN - sizeof(char *)));
+}
+
+void ha_model_log_memory_report(const char *phase)
+{
+    ha_model_memory_stats_t stats = {0};
+    ha_model_get_memory_stats(&stats);
+    ESP_LOGI(TAG_HA_MODEL,
+        "mem[%s] states=%u slots=%uB attrs live=%uB blocks=%uB carved=%u/%uB largest=%uB fail=%u merges=%u | "
+        "fixed-512 layout=%uB (would truncate %u)",
+        (phase != NULL) ? phase : "n/a",
+        (unsigned)stats.state_count,
+        (unsigned)stats.state_slot_bytes,
+        (unsigned)stats.attr_live_bytes,
+        (unsigned)stats.attr_block_bytes,
+        (unsigned)stats.attr_arena_carved_bytes,
+        (unsigned)stats.attr_arena_bytes,
+        (unsigned)stats.attr_largest_bytes,
+        (unsigned)stats.attr_alloc_failures,
+        (unsigned)stats.attr_merge_passes,
+        (unsigned)stats.legacy_layout_bytes,
+        (unsigned)stats.legacy_truncated_states);
 }
 
 uint32_t ha_model_state_revision(void)
@@ -304,9 +647,40 @@ uint32_t ha_model_state_revision(void)
         return 0;
     }
 
-    uint32_t revision = 0;
-    xSemaphoreTake(s_model_mutex, portMAX_DELAY);
-    revision = s_state_revision;
-    xSemaphoreGive(s_model_mutex);
-    return revision;
+    return __atomic_load_n(&s_state_revision, __ATOMIC_ACQUIRE);
+}
+
+uint32_t ha_model_entity_revision(ha_entity_handle_t entity)
+{
+    int idx = find_state_index_lockfree(entity);
+    if (s_states == NULL || idx < 0) {
+        return 0;
+    }
+    return __atomic_load_n(&s_states[idx].revision, __ATOMIC_ACQUIRE);
+}
+
+size_t ha_model_changed_since(
+    uint32_t since_revision, size_t *io_cursor, ha_entity_handle_t *out_entities, size_t max_out)
+{
+    if (s_states == NULL || io_cursor == NULL || out_entities == NULL || max_out == 0U) {
+        return 0;
+    }
+    size_t count = 0;
+    size_t state_count = __atomic_load_n(&s_state_count, __ATOMIC_ACQUIRE);
+    size_t i = *io_cursor;
+    for (; i < state_count && count < max_out; i++) {
+        ha_model_state_slot_t *slot = &s_states[i];
+        uint32_t revision = __atomic_load_n(&slot->revision, __ATOMIC_ACQUIRE);
+        /* Wrap-safe "newer than"; 0 marks a slot that was never published. */
+        if (revision == 0U || (int32_t)(revision - since_revision) <= 0) {
+            continue;
+        }
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        ha_entity_handle_t entity = slot->buf[(seq >> 1) & 1U].entity;
+        if (entity != HA_ENTITY_HANDLE_NONE) {
+            out_entities[count++] = entity;
+        }
+    }
+    *io_cursor = i;
+    return count;
 }
@@ -10,9 +10,11 @@
 #include "esp_err.h"
 
 #include "app_config.h"
+#include "ha/ha_entity_ids.h"
+#include "ha/ha_state_attrs.h"
 
 typedef struct {
-    char id[APP_MAX_ENTITY_ID_LEN];
+    ha_entity_handle_t entity;
     char name[APP_MAX_NAME_LEN];
     char domain[APP_MAX_NAME_LEN];
     char unit[APP_MAX_UNIT_LEN];
@@ -22,18 +24,68 @@ typedef struct {
 } ha_entity_info_t;
 
 typedef struct {
-    char entity_id[APP_MAX_ENTITY_ID_LEN];
+    ha_entity_handle_t entity;
     char state[APP_MAX_STATE_LEN];
-    char attributes_json[APP_HA_ATTRS_MAX_LEN];
+    /* NUL-terminated JSON, never NULL for states handed out by the model. On upsert the model copies
+     * it into its own attribute arena, so producers may point it at a scratch buffer. */
+    const char *attributes_json;
+    /* Filled from attributes_json on upsert unless the producer sets attrs.extracted; forecast rows are
+     * copied into the model like the JSON. */
+    ha_state_attrs_t attrs;
     int64_t last_changed_unix_ms;
 } ha_state_t;
 
+/* Borrowed, read-only view of a state record. The record stays stable until released; writers of that
+ * entity wait on it, so keep borrows short (render one widget, serialize one item) and never block inside. */
+typedef struct {
+    const ha_state_t *state;
+    uint16_t *pin;
+} ha_model_state_ref_t;
+
+typedef bool (*ha_model_state_visit_fn_t)(const ha_state_t *state, void *user_ctx);
+
+typedef struct {
+    size_t state_count;
+    size_t state_slot_bytes;
+    size_t attr_arena_bytes;
+    size_t attr_arena_carved_bytes;
+    size_t attr_block_bytes;
+    size_t attr_live_bytes;
+    size_t attr_largest_bytes;
+    uint32_t attr_alloc_failures;
+    uint32_t attr_merge_passes;
+    size_t legacy_layout_bytes;
+    size_t legacy_truncated_states;
+} ha_model_memory_stats_t;
+
 esp_err_t ha_model_init(void);
 void ha_model_reset(void);
 esp_err_t ha_model_upsert_entity(const ha_entity_info_t *entity);
 esp_err_t ha_model_upsert_state(const ha_state_t *state);
+/* Same, and *out_changed tells whether anything was stored: false when the slot already held an equal state. */
+esp_err_t ha_model_upsert_state_changed(const ha_state_t *state, bool *out_changed);
+/* Interns entity_id only while the model still has room for it (keeps the pool bounded on big HA installs). */
+ha_entity_handle_t ha_model_intern_entity_id(const char *entity_id);
+/* Copy-out reads. The copy keeps the typed attrs but its attributes_json is "" and it has no forecast
+ * rows: blobs are only reachable through a borrow or ha_model_get_state_with_attrs(). */
 bool ha_model_get_state(const char *entity_id, ha_state_t *out_state);
+bool ha_model_get_state_by_handle(ha_entity_handle_t entity, ha_state_t *out_state);
+/* Copy-out including attributes; out_state->attributes_json points at attrs_buf. */
+bool ha_model_get_state_with_attrs(
+    ha_entity_handle_t entity, ha_state_t *out_state, char *attrs_buf, size_t attrs_buf_len);
+bool ha_model_borrow_state(ha_entity_handle_t entity, ha_model_state_ref_t *out_ref);
+void ha_model_release_state(ha_model_state_ref_t *ref);
+/* Lock-free walk over all states; each record is borrowed only for the duration of visit(). */
+size_t ha_model_visit_states(ha_model_state_visit_fn_t visit, void *user_ctx);
 uint32_t ha_model_state_revision(void);
+/* Revision of the entity's last state change (0 = no state). Revisions come from the global counter,
+ * so they only grow, across ha_model_reset too. */
+uint32_t ha_model_entity_revision(ha_entity_handle_t entity);
+/* Lock-free "changed since" walk: writes entities whose revision is newer than since_revision. Start with
+ * *io_cursor = 0 and call again until it returns 0. */
+size_t ha_model_changed_since(
+    uint32_t since_revision, size_t *io_cursor, ha_entity_handle_t *out_entities, size_t max_out);
 size_t ha_model_list_entities(
     const char *domain_filter, const char *search, ha_entity_info_t *out_entities, size_t max_out);
-size_t ha_model_list_states(ha_state_t *out_states, size_t max_out);
+void ha_model_get_memory_stats(ha_model_memory_stats_t *out_stats);
+void ha_model_log_memory_report(const char *phase);
@@ -0,0 +1,260 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_state_attrs.h"
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/json_scan.h"
+
+static bool ha_state_attrs_item_to_float(const cJSON *item, float *out)
+{
+    if (cJSON_IsNumber(item)) {
+        *out = (float)item->valuedouble;
+        return true;
+    }
+    if (!cJSON_IsString(item) || item->valuestring == NULL) {
+        return false;
+    }
+    const char *text = item->valuestring;
+    while (*text != '\0' && isspace((unsigned char)*text)) {
+        text++;
+    }
+    char *end = NULL;
+    float value = strtof(text, &end);
+    if (*text == '\0' || end == text) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static void ha_state_attrs_read_float(
+    const cJSON *obj, const char *key, uint16_t bit, float *out_value, uint16_t *io_present)
+{
+    if (ha_state_attrs_item_to_float(cJSON_GetObjectItemCaseSensitive(obj, key), out_value)) {
+        *io_present |= bit;
+    }
+}
+
+static void ha_state_attrs_read_string(const cJSON *obj, const char *key, char *dst, size_t dst_size)
+{
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    if (dst[0] == '\0' && cJSON_IsString(item) && item->valuestring != NULL) {
+        snprintf(dst, dst_size, "%s", item->valuestring);
+    }
+}
+
+static void ha_state_attrs_read_forecast_row(const cJSON *item, ha_forecast_row_t *row)
+{
+    memset(row, 0, sizeof(*row));
+    const cJSON *datetime = cJSON_GetObjectItemCaseSensitive(item, "datetime");
+    if (!cJSON_IsString(datetime) || datetime->valuestring == NULL) {
+        datetime = cJSON_GetObjectItemCaseSensitive(item, "date");
+    }
+    if (cJSON_IsString(datetime) && datetime->valuestring != NULL) {
+        snprintf(row->date, sizeof(row->date), "%.10s", datetime->valuestring);
+    }
+    row->has_high = ha_state_attrs_item_to_float(cJSON_GetObjectItemCaseSensitive(item, "temperature"), &row->high) ||
+                    ha_state_attrs_item_to_float(cJSON_GetObjectItemCaseSensitive(item, "native_temperature"), &row->high);
+    row->has_low = ha_state_attrs_item_to_float(cJSON_GetObjectItemCaseSensitive(item, "templow"), &row->low) ||
+                   ha_state_attrs_item_to_float(cJSON_GetObjectItemCaseSensitive(item, "native_templow"), &row->low);
+    ha_state_attrs_read_string(item, "condition", row->condition, sizeof(row->condition));
+}
+
+void ha_state_attrs_from_cjson(const cJSON *attrs, ha_state_attrs_t *out, ha_forecast_row_t *rows, size_t rows_cap)
+{
+    if (out == NULL) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->extracted = true;
+    out->humidity = -1;
+    if (!cJSON_IsObject(attrs)) {
+        return;
+    }
+
+    ha_state_attrs_read_float(attrs, "brightness_pct", HA_ATTR_BRIGHTNESS_PCT, &out->brightness_pct, &out->present);
+    ha_state_attrs_read_float(attrs, "brightness", HA_ATTR_BRIGHTNESS, &out->brightness, &out->present);
+    ha_state_attrs_read_float(attrs, "volume_level", HA_ATTR_VOLUME_LEVEL, &out->volume_level, &out->present);
+    ha_state_attrs_read_float(attrs, "temperature", HA_ATTR_TEMPERATURE, &out->temperature, &out->present);
+    ha_state_attrs_read_float(
+        attrs, "current_temperature", HA_ATTR_CURRENT_TEMPERATURE, &out->current_temperature, &out->present);
+    ha_state_attrs_read_float(
+        attrs, "native_temperature", HA_ATTR_NATIVE_TEMPERATURE, &out->native_temperature, &out->present);
+    float humidity = 0.0f;
+    if (ha_state_attrs_item_to_float(cJSON_GetObjectItemCaseSensitive(attrs, "humidity"), &humidity)) {
+        out->humidity = (int)humidity;
+        out->present |= HA_ATTR_HUMIDITY;
+    }
+
+    ha_state_attrs_read_string(attrs, "unit_of_measurement", out->unit, sizeof(out->unit));
+    ha_state_attrs_read_string(attrs, "temperature_unit", out->temperature_unit, sizeof(out->temperature_unit));
+    ha_state_attrs_read_string(attrs, "native_temperature_unit", out->temperature_unit, sizeof(out->temperature_unit));
+    ha_state_attrs_read_string(attrs, "hvac_action", out->hvac_action, sizeof(out->hvac_action));
+
+    const cJSON *forecast = cJSON_GetObjectItemCaseSensitive(attrs, "forecast");
+    if (rows == NULL || rows_cap == 0 || !cJSON_IsArray(forecast)) {
+        return;
+    }
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, forecast)
+    {
+        if (out->forecast_count >= rows_cap || out->forecast_count >= HA_STATE_ATTRS_FORECAST_MAX) {
+            break;
+        }
+        if (cJSON_IsObject(item)) {
+            ha_state_attrs_read_forecast_row(item, &rows[out->forecast_count++]);
+        }
+    }
+    out->forecast = (out->forecast_count > 0) ? rows : NULL;
+}
+
+/* Text variant: one pass over the attribute object with the allocation-free scanner, so callers
+ * holding only serialized attributes (diff-applied updates, copy-ins) do not build a cJSON tree. */
+static bool ha_state_attrs_span_to_float(const json_span_t *span, float *out)
+{
+    char text[32];
+    if (span->type == JSON_SPAN_NUMBER) {
+        if (span->len >= sizeof(text)) {
+            return false;
+        }
+        memcpy(text, span->ptr, span->len);
+        text[span->len] = '\0';
+        *out = strtof(text, NULL);
+        return true;
+    }
+    if (!json_span_copy_string(span, text, sizeof(text))) {
+        return false;
+    }
+    const char *start = text;
+    while (*start != '\0' && isspace((unsigned char)*start)) {
+        start++;
+    }
+    char *end = NULL;
+    float value = strtof(start, &end);
+    if (*start == '\0' || end == start) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static bool ha_state_attrs_span_get_float(const json_span_t *obj, const char *key, float *out)
+{
+    json_span_t value = {0};
+    return json_scan_object_get(obj, key, &value) && ha_state_attrs_span_to_float(&value, out);
+}
+
+static void ha_state_attrs_span_read_forecast_row(const json_span_t *item, ha_forecast_row_t *row)
+{
+    memset(row, 0, sizeof(*row));
+    json_span_t value = {0};
+    char date[32];
+    if ((json_scan_object_get(item, "datetime", &value) && value.type == JSON_SPAN_STRING) ||
+        (json_scan_object_get(item, "date", &value) && value.type == JSON_SPAN_STRING)) {
+        (void)json_span_copy_string(&value, date, sizeof(date));
+        snprintf(row->date, sizeof(row->date), "%.10s", date);
+    }
+    row->has_high = ha_state_attrs_span_get_float(item, "temperature", &row->high) ||
+                    ha_state_attrs_span_get_float(item, "native_temperature", &row->high);
+    row->has_low = ha_state_attrs_span_get_float(item, "templow", &row->low) ||
+                   ha_state_attrs_span_get_float(item, "native_templow", &row->low);
+    if (json_scan_object_get(item, "condition", &value)) {
+        (void)json_span_copy_string(&value, row->condition, sizeof(row->condition));
+    }
+}
+
+static void ha_state_attrs_span_read_string(const json_span_t *value, char *dst, size_t dst_size)
+{
+    if (dst[0] == '\0' && value->type == JSON_SPAN_STRING) {
+        (void)json_span_copy_string(value, dst, dst_size);
+    }
+}
+
+bool ha_state_attrs_from_json(const char *json, ha_state_attrs_t *out, ha_forecast_row_t *rows, size_t rows_cap)
+{
+    if (out == NULL) {
+        return false;
+    }
+    memset(out, 0, sizeof(*out));
+    out->extracted = true;
+    out->humidity = -1;
+
+    json_span_t attrs = {0};
+    if (json == NULL || !json_scan_value(json, strlen(json), &attrs) || attrs.type != JSON_SPAN_OBJECT) {
+        return false;
+    }
+
+    static const struct {
+        const char *key;
+        uint16_t bit;
+        size_t offset;
+    } float_fields[] = {
+        {"brightness_pct", HA_ATTR_BRIGHTNESS_PCT, offsetof(ha_state_attrs_t, brightness_pct)},
+        {"brightness", HA_ATTR_BRIGHTNESS, offsetof(ha_state_attrs_t, brightness)},
+        {"volume_level", HA_ATTR_VOLUME_LEVEL, offsetof(ha_state_attrs_t, volume_level)},
+        {"temperature", HA_ATTR_TEMPERATURE, offsetof(ha_state_attrs_t, temperature)},
+        {"current_temperature", HA_ATTR_CURRENT_TEMPERATURE, offsetof(ha_state_attrs_t, current_temperature)},
+        {"native_temperature", HA_ATTR_NATIVE_TEMPERATURE, offsetof(ha_state_attrs_t, native_temperature)},
+    };
+
+    /* temperature_unit wins over native_temperature_unit regardless of member order. */
+    json_span_t native_temperature_unit = {0};
+    json_span_t forecast = {0};
+    json_scan_iter_t it;
+    json_span_t key = {0};
+    json_span_t value = {0};
+    json_scan_iter_begin(&it, &attrs);
+    while (json_scan_object_next(&it, &key, &value)) {
+        bool matched = false;
+        for (size_t i = 0; i < sizeof(float_fields) / sizeof(float_fields[0]); i++) {
+            if (json_span_equals(&key, float_fields[i].key)) {
+                float *field = (float *)((char *)out + float_fields[i].offset);
+                if (ha_state_attrs_span_to_float(&value, field)) {
+                    out->present |= float_fields[i].bit;
+                }
+                matched = true;
+                break;
+            }
+        }
+        if (matched) {
+            continue;
+        }
+        if (json_span_equals(&key, "humidity")) {
+            float humidity = 0.0f;
+            if (ha_state_attrs_span_to_float(&value, &humidity)) {
+                out->humidity = (int)humidity;
+                out->present |= HA_ATTR_HUMIDITY;
+            }
+        } else if (json_span_equals(&key, "unit_of_measurement")) {
+            ha_state_attrs_span_read_string(&value, out->unit, sizeof(out->unit));
+        } else if (json_span_equals(&key, "temperature_unit")) {
+            out->temperature_unit[0] = '\0';
+            ha_state_attrs_span_read_string(&value, out->temperature_unit, sizeof(out->temperature_unit));
+        } else if (json_span_equals(&key, "native_temperature_unit")) {
+            native_temperature_unit = value;
+        } else if (json_span_equals(&key, "hvac_action")) {
+            ha_state_attrs_span_read_string(&value, out->hvac_action, sizeof(out->hvac_action));
+        } else if (json_span_equals(&key, "forecast")) {
+            forecast = value;
+        }
+    }
+    ha_state_attrs_span_read_string(&native_temperature_unit, out->temperature_unit, sizeof(out->temperature_unit));
+
+    if (rows != NULL && rows_cap > 0 && forecast.type == JSON_SPAN_ARRAY) {
+        json_scan_iter_begin(&it, &forecast);
+        while (out->forecast_count < rows_cap && out->forecast_count < HA_STATE_ATTRS_FORECAST_MAX &&
+               json_scan_array_next(&it, &value)) {
+            if (value.type == JSON_SPAN_OBJECT) {
+                ha_state_attrs_span_read_forecast_row(&value, &rows[out->forecast_count++]);
+            }
+        }
+        out->forecast = (out->forecast_count > 0) ? rows : NULL;
+    }
+    return !it.failed;
+}
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cJSON.h"
+
+#include "app_config.h"
+
+/* Typed view of the attributes widgets actually render, extracted once when a state is ingested
+ * so the UI never has to parse attributes_json. Numeric fields accept numbers and numeric strings. */
+#define HA_STATE_ATTRS_FORECAST_MAX 5
+
+#define HA_ATTR_BRIGHTNESS_PCT (1U << 0)
+#define HA_ATTR_BRIGHTNESS (1U << 1)
+#define HA_ATTR_VOLUME_LEVEL (1U << 2)
+#define HA_ATTR_TEMPERATURE (1U << 3)
+#define HA_ATTR_CURRENT_TEMPERATURE (1U << 4)
+#define HA_ATTR_NATIVE_TEMPERATURE (1U << 5)
+#define HA_ATTR_HUMIDITY (1U << 6)
+
+typedef struct {
+    char date[12]; /* "YYYY-MM-DD" from datetime/date, "" if missing */
+    char condition[24];
+    bool has_high;
+    bool has_low;
+    float high;
+    float low;
+} ha_forecast_row_t;
+
+typedef struct {
+    bool extracted; /* producer already filled the record from the same attributes */
+    uint16_t present; /* HA_ATTR_* bits for the numeric fields below */
+    float brightness_pct;
+    float brightness;
+    float volume_level;
+    float temperature;
+    float current_temperature;
+    float native_temperature;
+    int humidity;
+    char unit[APP_MAX_UNIT_LEN];
+    char temperature_unit[12];
+    char hvac_action[24];
+    uint8_t forecast_count;
+    const ha_forecast_row_t *forecast;
+} ha_state_attrs_t;
+
+/* Both fill out (forecast rows go to rows[0..rows_cap), out->forecast points at rows).
+ * The text variant scans the JSON in place and does not allocate. */
+void ha_state_attrs_from_cjson(const cJSON *attrs, ha_state_attrs_t *out, ha_forecast_row_t *rows, size_t rows_cap);
+bool ha_state_attrs_from_json(const char *json, ha_state_attrs_t *out, ha_forecast_row_t *rows, size_t rows_cap);
@@ -0,0 +1,251 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_ws_rx_pool.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define HA_WS_RX_SLAB_SIZE ((size_t)APP_HA_WS_RX_SLAB_SIZE)
+#define HA_WS_RX_SLAB_COUNT ((uint16_t)APP_HA_WS_RX_SLAB_COUNT)
+
+_Static_assert(APP_HA_WS_RX_SLAB_COUNT > 0 && APP_HA_WS_RX_SLAB_COUNT < UINT16_MAX, "slab count must fit uint16_t");
+
+/* Consumers release in FIFO order in practice (queue order), but aborted reservations and evictions
+ * may free runs out of order, so each run keeps a busy flag and the tail only advances over freed runs. */
+typedef struct {
+    char *base;
+    uint16_t head;
+    uint16_t tail;
+    uint16_t used;
+    uint16_t run_span[HA_WS_RX_SLAB_COUNT];
+    bool run_busy[HA_WS_RX_SLAB_COUNT];
+    ha_ws_rx_pool_stats_t stats;
+    SemaphoreHandle_t mutex;
+} ha_ws_rx_pool_t;
+
+static ha_ws_rx_pool_t s_pool = {0};
+
+static uint16_t ha_ws_rx_pool_slabs_for(size_t len)
+{
+    return (uint16_t)((len + 1U + HA_WS_RX_SLAB_SIZE - 1U) / HA_WS_RX_SLAB_SIZE);
+}
+
+esp_err_t ha_ws_rx_pool_init(void)
+{
+    if (s_pool.base != NULL) {
+        return ESP_OK;
+    }
+    size_t bytes = HA_WS_RX_SLAB_SIZE * HA_WS_RX_SLAB_COUNT;
+    char *base = (char *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (base == NULL) {
+        base = (char *)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    if (base == NULL || mutex == NULL) {
+        heap_caps_free(base);
+        if (mutex != NULL) {
+            vSemaphoreDelete(mutex);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    memset(&s_pool, 0, sizeof(s_pool));
+    s_pool.base = base;
+    s_pool.mutex = mutex;
+    s_pool.stats.slab_size = (uint32_t)HA_WS_RX_SLAB_SIZE;
+    s_pool.stats.slab_count = HA_WS_RX_SLAB_COUNT;
+    return ESP_OK;
+}
+
+void ha_ws_rx_pool_deinit(void)
+{
+    if (s_pool.base == NULL) {
+        return;
+    }
+    heap_caps_free(s_pool.base);
+    vSemaphoreDelete(s_pool.mutex);
+    memset(&s_pool, 0, sizeof(s_pool));
+}
+
+bool ha_ws_rx_pool_fits(size_t len)
+{
+    return len <= APP_HA_WS_RX_MAX_MESSAGE_LEN && ha_ws_rx_pool_slabs_for(len) <= HA_WS_RX_SLAB_COUNT;
+}
+
+/* Free space is [head, tail) when head < tail, else [head, end) followed by [0, tail). */
+static bool ha_ws_rx_pool_find_locked(uint16_t need, uint16_t *out_span, uint16_t *out_data_slab)
+{
+    if (s_pool.used == 0U) {
+        s_pool.head = 0;
+        s_pool.tail = 0;
+    }
+    if (s_pool.used == HA_WS_RX_SLAB_COUNT) {
+        return false;
+    }
+    if (s_pool.head < s_pool.tail) {
+        if ((uint16_t)(s_pool.tail - s_pool.head) < need) {
+            return false;
+        }
+        *out_span = need;
+        *out_data_slab = s_pool.head;
+        return true;
+    }
+    uint16_t to_end = (uint16_t)(HA_WS_RX_SLAB_COUNT - s_pool.head);
+    if (to_end >= need) {
+        *out_span = need;
+        *out_data_slab = s_pool.head;
+        return true;
+    }
+    if (s_pool.tail >= need) {
+        *out_span = (uint16_t)(to_end + need);
+        *out_data_slab = 0;
+        return true;
+    }
+    return false;
+}
+
+bool ha_ws_rx_pool_reserve(size_t len, ha_ws_rx_lease_t *out_lease)
+{
+    if (out_lease == NULL || s_pool.base == NULL || !ha_ws_rx_pool_fits(len)) {
+        return false;
+    }
+    uint16_t need = ha_ws_rx_pool_slabs_for(len);
+    uint16_t span = 0;
+    uint16_t data_slab = 0;
+
+    xSemaphoreTake(s_pool.mutex, portMAX_DELAY);
+    bool found = ha_ws_rx_pool_find_locked(need, &span, &data_slab);
+    if (found) {
+        uint16_t first = s_pool.head;
+        s_pool.run_span[first] = span;
+        s_pool.run_busy[first] = true;
+        s_pool.head = (uint16_t)((first + span) % HA_WS_RX_SLAB_COUNT);
+        s_pool.used = (uint16_t)(s_pool.used + span);
+        s_pool.stats.reserved_total++;
+        s_pool.stats.messages_in_flight++;
+        s_pool.stats.slabs_in_use = s_pool.used;
+        if (s_pool.used > s_pool.stats.slabs_high_water) {
+            s_pool.stats.slabs_high_water = s_pool.used;
+        }
+        out_lease->data = s_pool.base + ((size_t)data_slab * HA_WS_RX_SLAB_SIZE);
+        out_lease->data[0] = '\0';
+        out_lease->first_slab = first;
+        out_lease->slab_span = span;
+    } else {
+        s_pool.stats.reserve_failures++;
+    }
+    xSemaphoreGive(s_pool.mutex);
+    return found;
+}
+
+/* First slab of the newest run, the one ending at head. Called with the mutex held and used > 0. */
+static uint16_t ha_ws_rx_pool_newest_locked(void)
+{
+    uint16_t run = s_pool.tail;
+    uint16_t walked = s_pool.run_span[run];
+    while (walked < s_pool.used) {
+        run = (uint16_t)((run + s_pool.run_span[run]) % HA_WS_RX_SLAB_COUNT);
+        walked = (uint16_t)(walked + s_pool.run_span[run]);
+    }
+    return run;
+}
+
+void ha_ws_rx_pool_release(ha_ws_rx_lease_t *lease)
+{
+    if (lease == NULL || lease->data == NULL || s_pool.base == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_pool.mutex, portMAX_DELAY);
+    uint16_t first = lease->first_slab;
+    if (first < HA_WS_RX_SLAB_COUNT && s_pool.run_busy[first]) {
+        s_pool.run_busy[first] = false;
+        s_pool.stats.messages_in_flight--;
+        while (s_pool.used > 0U && !s_pool.run_busy[s_pool.tail]) {
+            uint16_t span = s_pool.run_span[s_pool.tail];
+            s_pool.used = (uint16_t)(s_pool.used - span);
+            s_pool.tail = (uint16_t)((s_pool.tail + span) % HA_WS_RX_SLAB_COUNT);
+        }
+        /* Freed runs at the newest end (aborted frames, evicted queue ends) go straight back to the
+         * head, so a frame held at the tail does not pin them. */
+        while (s_pool.used > 0U) {
+            uint16_t newest = ha_ws_rx_pool_newest_locked();
+            if (s_pool.run_busy[newest]) {
+                break;
+            }
+            s_pool.head = newest;
+            s_pool.used = (uint16_t)(s_pool.used - s_pool.run_span[newest]);
+        }
+        s_pool.stats.slabs_in_use = s_pool.used;
+    }
+    xSemaphoreGive(s_pool.mutex);
+    memset(lease, 0, sizeof(*lease));
+}
+
+bool ha_ws_rx_pool_eviction_can_fit(const ha_ws_rx_lease_t *oldest_queued, size_t len)
+{
+    if (oldest_queued == NULL || s_pool.base == NULL || !ha_ws_rx_pool_fits(len)) {
+        return false;
+    }
+    uint16_t need = ha_ws_rx_pool_slabs_for(len);
+    xSemaphoreTake(s_pool.mutex, portMAX_DELAY);
+    bool can_fit = true;
+    if (s_pool.used > 0U && oldest_queued->first_slab != s_pool.tail) {
+        /* The tail run is held elsewhere: at best every other run goes, leaving the space beside it. */
+        uint16_t tail = s_pool.tail;
+        uint16_t span = s_pool.run_span[tail];
+        uint16_t end = (uint16_t)((tail + span) % HA_WS_RX_SLAB_COUNT);
+        if (span >= HA_WS_RX_SLAB_COUNT) {
+            can_fit = false;
+        } else if (end < tail) {
+            can_fit = (uint16_t)(tail - end) >= need;
+        } else {
+            can_fit = (uint16_t)(HA_WS_RX_SLAB_COUNT - end) >= need || tail >= need;
+        }
+    }
+    xSemaphoreGive(s_pool.mutex);
+    return can_fit;
+}
+
+static void ha_ws_rx_pool_bump(uint32_t *counter)
+{
+    if (s_pool.mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_pool.mutex, portMAX_DELAY);
+    (*counter)++;
+    xSemaphoreGive(s_pool.mutex);
+}
+
+void ha_ws_rx_pool_note_drop_oldest(void)
+{
+    ha_ws_rx_pool_bump(&s_pool.stats.dropped_oldest);
+}
+
+void ha_ws_rx_pool_note_drop_full(void)
+{
+    ha_ws_rx_pool_bump(&s_pool.stats.dropped_full);
+}
+
+void ha_ws_rx_pool_note_drop_oversize(void)
+{
+    ha_ws_rx_pool_bump(&s_pool.stats.dropped_oversize);
+}
+
+void ha_ws_rx_pool_get_stats(ha_ws_rx_pool_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    memset(out_stats, 0, sizeof(*out_stats));
+    if (s_pool.mutex == NULL) {
+        out_stats->slab_size = (uint32_t)HA_WS_RX_SLAB_SIZE;
+        out_stats->slab_count = HA_WS_RX_SLAB_COUNT;
+        return;
+    }
+    xSemaphoreTake(s_pool.mutex, portMAX_DELAY);
+    *out_stats = s_pool.stats;
+    xSemaphoreGive(s_pool.mutex);
+}
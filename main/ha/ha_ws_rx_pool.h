@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "app_config.h"
+
+/* Fixed ring of receive slabs shared by the websocket callback (producer) and the HA task (consumer).
+ * A message reserves a run of consecutive slabs sized from the frame's payload length, fragments are
+ * copied straight into it, and the run is handed over by reference until the consumer releases it.
+ * Runs never wrap, so every message is one contiguous, NUL-terminated buffer. Thread-safe. */
+typedef struct {
+    char *data;
+    uint16_t first_slab;
+    uint16_t slab_span; /* slabs held, including any tail padding skipped to stay contiguous */
+} ha_ws_rx_lease_t;
+
+typedef struct {
+    uint32_t slab_size;
+    uint32_t slab_count;
+    uint32_t slabs_in_use;
+    uint32_t slabs_high_water;
+    uint32_t messages_in_flight;
+    uint32_t reserved_total;
+    uint32_t reserve_failures; /* pool momentarily full (slab pressure) */
+    uint32_t dropped_oldest;   /* queued messages evicted to make room for newer ones */
+    uint32_t dropped_full;     /* messages dropped because no slabs could be freed */
+    uint32_t dropped_oversize; /* frames larger than the pool or APP_HA_WS_RX_MAX_MESSAGE_LEN */
+} ha_ws_rx_pool_stats_t;
+
+esp_err_t ha_ws_rx_pool_init(void);
+void ha_ws_rx_pool_deinit(void);
+/* Reserves room for len bytes plus NUL; false when the pool cannot hold it right now. */
+bool ha_ws_rx_pool_reserve(size_t len, ha_ws_rx_lease_t *out_lease);
+void ha_ws_rx_pool_release(ha_ws_rx_lease_t *lease);
+/* Whether evicting queued frames, oldest_queued first, can ever make room for len bytes: false when
+ * the tail run is held by the consumer and the space beside it is too short. */
+bool ha_ws_rx_pool_eviction_can_fit(const ha_ws_rx_lease_t *oldest_queued, size_t len);
+bool ha_ws_rx_pool_fits(size_t len);
+void ha_ws_rx_pool_note_drop_oldest(void);
+void ha_ws_rx_pool_note_drop_full(void);
+void ha_ws_rx_pool_note_drop_oversize(void);
+void ha_ws_rx_pool_get_stats(ha_ws_rx_pool_stats_t *out_stats);
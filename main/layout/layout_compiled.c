@@ -0,0 +1,572 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "layout/layout_compiled.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "esp_app_desc.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "util/log_tags.h"
+
+#define LAYOUT_COMPILED_MAGIC 0x54594C42u /* "BLYT" */
+#define LAYOUT_COMPILED_FORMAT_VERSION 1U
+#define LAYOUT_COMPILED_BUILD_ID_LEN 8U
+#define LAYOUT_COMPILED_MAX_ENTITIES (APP_MAX_WIDGETS_TOTAL * 2U)
+
+/* On-disk blob: this header, then pages[page_count], widgets[widget_count],
+ * widget_page[widget_count] and entity_ids[entity_count], all in native layout. */
+typedef struct {
+    uint32_t magic;
+    uint16_t format_version;
+    uint16_t header_size;
+    uint16_t page_def_size;
+    uint16_t widget_def_size;
+    uint16_t entity_id_len;
+    uint16_t page_count;
+    uint16_t widget_count;
+    uint16_t entity_count;
+    uint32_t entity_signature;
+    uint8_t need_weather_forecast;
+    uint8_t reserved[3];
+    /* Leading bytes of the firmware's ELF SHA-256: the clamping rules and struct layouts are code. */
+    uint8_t build_id[LAYOUT_COMPILED_BUILD_ID_LEN];
+    uint32_t payload_checksum;
+} layout_compiled_header_t;
+
+typedef struct {
+    int min_w;
+    int min_h;
+    int max_w;
+    int max_h;
+} layout_size_limits_t;
+
+static uint32_t layout_compiled_fnv1a(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void layout_compiled_build_id(uint8_t out[LAYOUT_COMPILED_BUILD_ID_LEN])
+{
+    const esp_app_desc_t *desc = esp_app_get_description();
+    memcpy(out, desc->app_elf_sha256, LAYOUT_COMPILED_BUILD_ID_LEN);
+}
+
+static layout_compiled_t *layout_compiled_alloc(size_t widget_count, size_t entity_count)
+{
+    size_t size = sizeof(layout_compiled_t) + (widget_count * sizeof(layout_widget_def_t)) +
+                  (widget_count * sizeof(uint16_t)) + (entity_count * (size_t)APP_MAX_ENTITY_ID_LEN);
+    layout_compiled_t *layout = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (layout == NULL) {
+        layout = heap_caps_calloc(1, size, MALLOC_CAP_8BIT);
+    }
+    if (layout == NULL) {
+        return NULL;
+    }
+    layout->widgets = (layout_widget_def_t *)(layout + 1);
+    layout->widget_page = (uint16_t *)(layout->widgets + widget_count);
+    layout->entity_ids = (char *)(layout->widget_page + widget_count);
+    return layout;
+}
+
+void layout_compiled_free(layout_compiled_t *layout)
+{
+    heap_caps_free(layout);
+}
+
+esp_err_t layout_compiled_clone(const layout_compiled_t *layout, layout_compiled_t **out_layout)
+{
+    if (layout == NULL || out_layout == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    layout_compiled_t *copy = layout_compiled_alloc(layout->widget_count, layout->entity_count);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    layout_widget_def_t *widgets = copy->widgets;
+    uint16_t *widget_page = copy->widget_page;
+    char *entity_ids = copy->entity_ids;
+    *copy = *layout;
+    copy->widgets = widgets;
+    copy->widget_page = widget_page;
+    copy->entity_ids = entity_ids;
+    memcpy(widgets, layout->widgets, (size_t)layout->widget_count * sizeof(layout_widget_def_t));
+    memcpy(widget_page, layout->widget_page, (size_t)layout->widget_count * sizeof(uint16_t));
+    memcpy(entity_ids, layout->entity_ids, (size_t)layout->entity_count * APP_MAX_ENTITY_ID_LEN);
+    *out_layout = copy;
+    return ESP_OK;
+}
+
+const char *layout_compiled_entity_id_at(const layout_compiled_t *layout, uint16_t index)
+{
+    if (layout == NULL || index >= layout->entity_count) {
+        return NULL;
+    }
+    return layout->entity_ids + ((size_t)index * APP_MAX_ENTITY_ID_LEN);
+}
+
+static layout_size_limits_t layout_compiled_size_limits(const char *type)
+{
+    layout_size_limits_t limits = {
+        .min_w = 60,
+        .min_h = 60,
+        .max_w = APP_CONTENT_BOX_WIDTH,
+        .max_h = APP_CONTENT_BOX_HEIGHT,
+    };
+
+    if (type == NULL) {
+        return limits;
+    }
+
+    if (strcmp(type, "sensor") == 0) {
+        limits.min_w = 120;
+        limits.min_h = 80;
+    } else if (strcmp(type, "button") == 0) {
+        limits.min_w = 100;
+        limits.min_h = 100;
+        limits.max_w = 480;
+        limits.max_h = 320;
+    } else if (strcmp(type, "slider") == 0) {
+        limits.min_w = 100;
+        limits.min_h = 100;
+    } else if (strcmp(type, "graph") == 0) {
+        limits.min_w = 220;
+        limits.min_h = 140;
+    } else if (strcmp(type, "empty_tile") == 0) {
+        limits.min_w = 120;
+        limits.min_h = 80;
+    } else if (strcmp(type, "light_tile") == 0) {
+        limits.min_w = 180;
+        limits.min_h = 180;
+        limits.max_w = 480;
+        limits.max_h = 480;
+    } else if (strcmp(type, "heating_tile") == 0) {
+        limits.min_w = 220;
+        limits.min_h = 200;
+        limits.max_w = 480;
+        limits.max_h = 480;
+    } else if (strcmp(type, "weather_tile") == 0) {
+        limits.min_w = 220;
+        limits.min_h = 200;
+        limits.max_w = 480;
+        limits.max_h = 480;
+    } else if (strcmp(type, "weather_3day") == 0) {
+        limits.min_w = 260;
+        limits.min_h = 220;
+        limits.max_w = 640;
+        limits.max_h = 420;
+    }
+
+    if (limits.max_w > APP_CONTENT_BOX_WIDTH) {
+        limits.max_w = APP_CONTENT_BOX_WIDTH;
+    }
+    if (limits.max_h > APP_CONTENT_BOX_HEIGHT) {
+        limits.max_h = APP_CONTENT_BOX_HEIGHT;
+    }
+    return limits;
+}
+
+static void layout_compiled_clamp_widget_rect(layout_widget_def_t *def)
+{
+    if (def == NULL) {
+        return;
+    }
+
+    layout_size_limits_t limits = layout_compiled_size_limits(def->type);
+
+    if (def->w < limits.min_w) {
+        def->w = limits.min_w;
+    }
+    if (def->h < limits.min_h) {
+        def->h = limits.min_h;
+    }
+    if (def->w > limits.max_w) {
+        def->w = limits.max_w;
+    }
+    if (def->h > limits.max_h) {
+        def->h = limits.max_h;
+    }
+
+    if (def->x < 0) {
+        def->x = 0;
+    }
+    if (def->y < 0) {
+        def->y = 0;
+    }
+
+    if (def->x + def->w > APP_CONTENT_BOX_WIDTH) {
+        def->x = APP_CONTENT_BOX_WIDTH - def->w;
+    }
+    if (def->y + def->h > APP_CONTENT_BOX_HEIGHT) {
+        def->y = APP_CONTENT_BOX_HEIGHT - def->h;
+    }
+
+    if (def->x < 0) {
+        def->x = 0;
+    }
+    if (def->y < 0) {
+        def->y = 0;
+    }
+}
+
+static bool layout_compiled_widget_from_json(cJSON *widget_json, layout_widget_def_t *out)
+{
+    cJSON *id = cJSON_GetObjectItemCaseSensitive(widget_json, "id");
+    cJSON *type = cJSON_GetObjectItemCaseSensitive(widget_json, "type");
+    cJSON *title = cJSON_GetObjectItemCaseSensitive(widget_json, "title");
+    cJSON *entity_id = cJSON_GetObjectItemCaseSensitive(widget_json, "entity_id");
+    cJSON *secondary_entity_id = cJSON_GetObjectItemCaseSensitive(widget_json, "secondary_entity_id");
+    cJSON *slider_direction = cJSON_GetObjectItemCaseSensitive(widget_json, "slider_direction");
+    cJSON *slider_accent_color = cJSON_GetObjectItemCaseSensitive(widget_json, "slider_accent_color");
+    cJSON *button_accent_color = cJSON_GetObjectItemCaseSensitive(widget_json, "button_accent_color");
+    cJSON *button_mode = cJSON_GetObjectItemCaseSensitive(widget_json, "button_mode");
+    cJSON *graph_line_color = cJSON_GetObjectItemCaseSensitive(widget_json, "graph_line_color");
+    cJSON *graph_point_count = cJSON_GetObjectItemCaseSensitive(widget_json, "graph_point_count");
+    cJSON *graph_time_window_min = cJSON_GetObjectItemCaseSensitive(widget_json, "graph_time_window_min");
+    cJSON *rect = cJSON_GetObjectItemCaseSensitive(widget_json, "rect");
+    if (!cJSON_IsString(id) || !cJSON_IsString(type) || !cJSON_IsObject(rect)) {
+        return false;
+    }
+
+    const bool requires_entity = (strcmp(type->valuestring, "empty_tile") != 0);
+    if (requires_entity && !cJSON_IsString(entity_id)) {
+        return false;
+    }
+
+    cJSON *x = cJSON_GetObjectItemCaseSensitive(rect, "x");
+    cJSON *y = cJSON_GetObjectItemCaseSensitive(rect, "y");
+    cJSON *w = cJSON_GetObjectItemCaseSensitive(rect, "w");
+    cJSON *h = cJSON_GetObjectItemCaseSensitive(rect, "h");
+    if (!cJSON_IsNumber(x) || !cJSON_IsNumber(y) || !cJSON_IsNumber(w) || !cJSON_IsNumber(h)) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    snprintf(out->id, sizeof(out->id), "%s", id->valuestring);
+    snprintf(out->type, sizeof(out->type), "%s", type->valuestring);
+    snprintf(out->title, sizeof(out->title), "%s", cJSON_IsString(title) ? title->valuestring : id->valuestring);
+    if (cJSON_IsString(entity_id) && entity_id->valuestring != NULL) {
+        snprintf(out->entity_id, sizeof(out->entity_id), "%s", entity_id->valuestring);
+    }
+    if (cJSON_IsString(secondary_entity_id) && secondary_entity_id->valuestring != NULL) {
+        snprintf(out->secondary_entity_id, sizeof(out->secondary_entity_id), "%s", secondary_entity_id->valuestring);
+    }
+    if (cJSON_IsString(slider_direction) && slider_direction->valuestring != NULL) {
+        snprintf(out->slider_direction, sizeof(out->slider_direction), "%s", slider_direction->valuestring);
+    }
+    if (cJSON_IsString(slider_accent_color) && slider_accent_color->valuestring != NULL) {
+        snprintf(out->slider_accent_color, sizeof(out->slider_accent_color), "%s", slider_accent_color->valuestring);
+    }
+    if (cJSON_IsString(button_accent_color) && button_accent_color->valuestring != NULL) {
+        snprintf(out->button_accent_color, sizeof(out->button_accent_color), "%s", button_accent_color->valuestring);
+    }
+    if (cJSON_IsString(button_mode) && button_mode->valuestring != NULL) {
+        snprintf(out->button_mode, sizeof(out->button_mode), "%s", button_mode->valuestring);
+    }
+    if (cJSON_IsString(graph_line_color) && graph_line_color->valuestring != NULL) {
+        snprintf(out->graph_line_color, sizeof(out->graph_line_color), "%s", graph_line_color->valuestring);
+    }
+    if (cJSON_IsNumber(graph_point_count)) {
+        out->graph_point_count = graph_point_count->valueint;
+    }
+    if (cJSON_IsNumber(graph_time_window_min)) {
+        out->graph_time_window_min = graph_time_window_min->valueint;
+    }
+    out->x = x->valueint;
+    out->y = y->valueint;
+    out->w = w->valueint;
+    out->h = h->valueint;
+    layout_compiled_clamp_widget_rect(out);
+    return true;
+}
+
+static bool layout_compiled_is_background_widget_type(const char *type)
+{
+    return type != NULL && strcmp(type, "empty_tile") == 0;
+}
+
+/* Pages without an id or beyond APP_MAX_PAGES are dropped, as the page bar could not show them. */
+static bool layout_compiled_page_usable(cJSON *page, cJSON **out_widgets)
+{
+    cJSON *page_id = cJSON_GetObjectItemCaseSensitive(page, "id");
+    cJSON *widgets = cJSON_GetObjectItemCaseSensitive(page, "widgets");
+    if (!cJSON_IsString(page_id) || page_id->valuestring[0] == '\0' || !cJSON_IsArray(widgets)) {
+        return false;
+    }
+    *out_widgets = widgets;
+    return true;
+}
+
+static void layout_compiled_add_entity(layout_compiled_t *layout, size_t capacity, const char *entity_id)
+{
+    if (entity_id[0] == '\0' || layout->entity_count >= capacity) {
+        return;
+    }
+    for (uint16_t i = 0; i < layout->entity_count; i++) {
+        if (strncmp(layout_compiled_entity_id_at(layout, i), entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
+            return;
+        }
+    }
+    char *dst = layout->entity_ids + ((size_t)layout->entity_count * APP_MAX_ENTITY_ID_LEN);
+    snprintf(dst, APP_MAX_ENTITY_ID_LEN, "%s", entity_id);
+    layout->entity_count++;
+}
+
+static int layout_compiled_entity_id_cmp(const void *lhs, const void *rhs)
+{
+    return strncmp((const char *)lhs, (const char *)rhs, APP_MAX_ENTITY_ID_LEN);
+}
+
+static uint32_t layout_compiled_entity_signature(const layout_compiled_t *layout)
+{
+    if (layout->entity_count == 0) {
+        return 0;
+    }
+    size_t bytes = (size_t)layout->entity_count * APP_MAX_ENTITY_ID_LEN;
+    char *sorted = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (sorted == NULL) {
+        sorted = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    if (sorted == NULL) {
+        return 0;
+    }
+    memcpy(sorted, layout->entity_ids, bytes);
+    qsort(sorted, layout->entity_count, APP_MAX_ENTITY_ID_LEN, layout_compiled_entity_id_cmp);
+
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < layout->entity_count; i++) {
+        const char *entry = sorted + ((size_t)i * APP_MAX_ENTITY_ID_LEN);
+        hash = layout_compiled_fnv1a(hash, entry, strnlen(entry, APP_MAX_ENTITY_ID_LEN));
+        hash = layout_compiled_fnv1a(hash, "\xff", 1U); /* delimiter against concatenation ambiguity */
+    }
+    heap_caps_free(sorted);
+    return hash;
+}
+
+esp_err_t layout_compiled_from_json(const char *json, layout_compiled_t **out_layout)
+{
+    if (json == NULL || out_layout == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_layout = NULL;
+
+    cJSON *root = cJSON_Parse(json);
+    if (root == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cJSON *pages = cJSON_GetObjectItemCaseSensitive(root, "pages");
+    if (!cJSON_IsArray(pages)) {
+        cJSON_Delete(root);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Size the block by the widget arrays; rejected widgets only leave a little slack. */
+    int page_count = cJSON_GetArraySize(pages);
+    size_t widget_capacity = 0;
+    size_t usable_pages = 0;
+    for (int p = 0; p < page_count && usable_pages < APP_MAX_PAGES; p++) {
+        cJSON *widgets = NULL;
+        if (layout_compiled_page_usable(cJSON_GetArrayItem(pages, p), &widgets)) {
+            widget_capacity += (size_t)cJSON_GetArraySize(widgets);
+            usable_pages++;
+        }
+    }
+    if (widget_capacity > APP_MAX_WIDGETS_TOTAL) {
+        widget_capacity = APP_MAX_WIDGETS_TOTAL;
+    }
+    size_t entity_capacity = widget_capacity * 2U;
+
+    layout_compiled_t *layout = layout_compiled_alloc(widget_capacity, entity_capacity);
+    if (layout == NULL) {
+        cJSON_Delete(root);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int p = 0; p < page_count && layout->page_count < APP_MAX_PAGES; p++) {
+        cJSON *page = cJSON_GetArrayItem(pages, p);
+        cJSON *widgets = NULL;
+        if (!layout_compiled_page_usable(page, &widgets)) {
+            continue;
+        }
+        cJSON *page_id = cJSON_GetObjectItemCaseSensitive(page, "id");
+        cJSON *page_title = cJSON_GetObjectItemCaseSensitive(page, "title");
+
+        uint16_t page_index = layout->page_count;
+        layout_page_def_t *page_def = &layout->pages[page_index];
+        snprintf(page_def->id, sizeof(page_def->id), "%s", page_id->valuestring);
+        snprintf(page_def->title, sizeof(page_def->title), "%s",
+            (cJSON_IsString(page_title) && page_title->valuestring[0] != '\0') ? page_title->valuestring
+                                                                              : page_id->valuestring);
+        page_def->widget_begin = layout->widget_count;
+
+        /* Background tiles first: definition order is creation order, so they stay below the rest. */
+        int widget_count = cJSON_GetArraySize(widgets);
+        for (int pass = 0; pass < 2; pass++) {
+            const bool background_pass = (pass == 0);
+            for (int w = 0; w < widget_count && layout->widget_count < widget_capacity; w++) {
+                layout_widget_def_t *def = &layout->widgets[layout->widget_count];
+                if (!layout_compiled_widget_from_json(cJSON_GetArrayItem(widgets, w), def)) {
+                    continue;
+                }
+                if (layout_compiled_is_background_widget_type(def->type) != background_pass) {
+                    continue;
+                }
+                if (strcmp(def->type, "weather_3day") == 0) {
+                    layout->need_weather_forecast = true;
+                }
+                layout_compiled_add_entity(layout, entity_capacity, def->entity_id);
+                layout_compiled_add_entity(layout, entity_capacity, def->secondary_entity_id);
+                layout->widget_page[layout->widget_count] = page_index;
+                layout->widget_count++;
+            }
+        }
+        page_def->widget_end = layout->widget_count;
+        layout->page_count++;
+    }
+    cJSON_Delete(root);
+
+    layout->entity_signature = layout_compiled_entity_signature(layout);
+    *out_layout = layout;
+    return ESP_OK;
+}
+
+esp_err_t layout_compiled_write(const layout_compiled_t *layout, const char *path)
+{
+    if (layout == NULL || path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const void *sections[] = {layout->pages, layout->widgets, layout->widget_page, layout->entity_ids};
+    const size_t section_sizes[] = {
+        (size_t)layout->page_count * sizeof(layout_page_def_t),
+        (size_t)layout->widget_count * sizeof(layout_widget_def_t),
+        (size_t)layout->widget_count * sizeof(uint16_t),
+        (size_t)layout->entity_count * APP_MAX_ENTITY_ID_LEN,
+    };
+    layout_compiled_header_t header = {
+        .magic = LAYOUT_COMPILED_MAGIC,
+        .format_version = LAYOUT_COMPILED_FORMAT_VERSION,
+        .header_size = sizeof(layout_compiled_header_t),
+        .page_def_size = sizeof(layout_page_def_t),
+        .widget_def_size = sizeof(layout_widget_def_t),
+        .entity_id_len = APP_MAX_ENTITY_ID_LEN,
+        .page_count = layout->page_count,
+        .widget_count = layout->widget_count,
+        .entity_count = layout->entity_count,
+        .entity_signature = layout->entity_signature,
+        .need_weather_forecast = layout->need_weather_forecast ? 1U : 0U,
+        .payload_checksum = 2166136261u,
+    };
+    layout_compiled_build_id(header.build_id);
+    for (size_t i = 0; i < 4U; i++) {
+        header.payload_checksum = layout_compiled_fnv1a(header.payload_checksum, sections[i], section_sizes[i]);
+    }
+
+    /* Written aside and renamed, so a reader never sees a half-written blob. */
+    char tmp_path[64];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *f = fopen(tmp_path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG_LAYOUT, "Cannot open compiled layout for writing: %s", tmp_path);
+        return ESP_FAIL;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1U, f) == 1U;
+    for (size_t i = 0; ok && i < 4U; i++) {
+        ok = section_sizes[i] == 0U || fwrite(sections[i], section_sizes[i], 1U, f) == 1U;
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        ESP_LOGE(TAG_LAYOUT, "Failed to write compiled layout");
+        remove(tmp_path);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t layout_compiled_read(const char *path, layout_compiled_t **out_layout)
+{
+    if (path == NULL || out_layout == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_layout = NULL;
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    layout_compiled_header_t header = {0};
+    if (fread(&header, sizeof(header), 1U, f) != 1U) {
+        fclose(f);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t build_id[LAYOUT_COMPILED_BUILD_ID_LEN];
+    layout_compiled_build_id(build_id);
+    if (header.magic != LAYOUT_COMPILED_MAGIC || header.format_version != LAYOUT_COMPILED_FORMAT_VERSION ||
+        header.header_size != sizeof(layout_compiled_header_t) || header.page_def_size != sizeof(layout_page_def_t) ||
+        header.widget_def_size != sizeof(layout_widget_def_t) || header.entity_id_len != APP_MAX_ENTITY_ID_LEN ||
+        memcmp(header.build_id, build_id, sizeof(build_id)) != 0) {
+        fclose(f);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header.page_count > APP_MAX_PAGES || header.widget_count > APP_MAX_WIDGETS_TOTAL ||
+        header.entity_count > LAYOUT_COMPILED_MAX_ENTITIES) {
+        fclose(f);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    layout_compiled_t *layout = layout_compiled_alloc(header.widget_count, header.entity_count);
+    if (layout == NULL) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+    layout->page_count = header.page_count;
+    layout->widget_count = header.widget_count;
+    layout->entity_count = header.entity_count;
+    layout->entity_signature = header.entity_signature;
+    layout->need_weather_forecast = header.need_weather_forecast != 0U;
+
+    void *sections[] = {layout->pages, layout->widgets, layout->widget_page, layout->entity_ids};
+    const size_t section_sizes[] = {
+        (size_t)layout->page_count * sizeof(layout_page_def_t),
+        (size_t)layout->widget_count * sizeof(layout_widget_def_t),
+        (size_t)layout->widget_count * sizeof(uint16_t),
+        (size_t)layout->entity_count * APP_MAX_ENTITY_ID_LEN,
+    };
+    uint32_t checksum = 2166136261u;
+    bool ok = true;
+    for (size_t i = 0; ok && i < 4U; i++) {
+        ok = section_sizes[i] == 0U || fread(sections[i], section_sizes[i], 1U, f) == 1U;
+        checksum = layout_compiled_fnv1a(checksum, sections[i], section_sizes[i]);
+    }
+    ok = ok && fgetc(f) == EOF;
+    fclose(f);
+    if (!ok) {
+        layout_compiled_free(layout);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (checksum != header.payload_checksum) {
+        layout_compiled_free(layout);
+        return ESP_ERR_INVALID_CRC;
+    }
+    for (uint16_t p = 0; p < layout->page_count; p++) {
+        const layout_page_def_t *page = &layout->pages[p];
+        if (page->widget_begin > page->widget_end || page->widget_end > layout->widget_count) {
+            layout_compiled_free(layout);
+            return ESP_ERR_INVALID_CRC;
+        }
+    }
+
+    *out_layout = layout;
+    return ESP_OK;
+}
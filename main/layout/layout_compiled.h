@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "app_config.h"
+
+/* A layout compiled from its JSON source: widget definitions clamped to the content box and grouped
+ * per page (background tiles first), plus the entity_ids they reference. The UI builds from it and
+ * the HA client subscribes from it; the JSON stays the editor's source of truth. */
+
+typedef struct {
+    char id[APP_MAX_WIDGET_ID_LEN];
+    char type[16];
+    char title[APP_MAX_NAME_LEN];
+    char entity_id[APP_MAX_ENTITY_ID_LEN];
+    char secondary_entity_id[APP_MAX_ENTITY_ID_LEN];
+    char slider_direction[APP_MAX_UI_OPTION_LEN];
+    char slider_accent_color[APP_MAX_COLOR_STR_LEN];
+    char button_accent_color[APP_MAX_COLOR_STR_LEN];
+    char button_mode[APP_MAX_UI_OPTION_LEN];
+    char graph_line_color[APP_MAX_COLOR_STR_LEN];
+    int graph_point_count;
+    int graph_time_window_min;
+    int x;
+    int y;
+    int w;
+    int h;
+} layout_widget_def_t;
+
+typedef struct {
+    char id[APP_MAX_PAGE_ID_LEN];
+    char title[APP_MAX_NAME_LEN];
+    uint16_t widget_begin;
+    uint16_t widget_end;
+} layout_page_def_t;
+
+typedef struct {
+    uint16_t page_count;
+    uint16_t widget_count;
+    uint16_t entity_count;
+    bool need_weather_forecast;
+    /* FNV-1a over the sorted entity_ids: equal signatures, equal entity sets. */
+    uint32_t entity_signature;
+    /* Widgets of page p occupy widgets[widget_begin, widget_end); widget_page maps back. */
+    layout_page_def_t pages[APP_MAX_PAGES];
+    layout_widget_def_t *widgets;
+    uint16_t *widget_page;
+    /* Unique entity_ids in first-use order, APP_MAX_ENTITY_ID_LEN stride. */
+    char *entity_ids;
+} layout_compiled_t;
+
+/* Each layout is one heap block (PSRAM preferred); release it with layout_compiled_free. */
+esp_err_t layout_compiled_from_json(const char *json, layout_compiled_t **out_layout);
+/* Loads a blob written by layout_compiled_write. A blob from another firmware build, or a damaged
+ * one, reads as ESP_ERR_INVALID_VERSION / ESP_ERR_INVALID_CRC and has to be compiled again. */
+esp_err_t layout_compiled_read(const char *path, layout_compiled_t **out_layout);
+esp_err_t layout_compiled_write(const layout_compiled_t *layout, const char *path);
+esp_err_t layout_compiled_clone(const layout_compiled_t *layout, layout_compiled_t **out_layout);
+void layout_compiled_free(layout_compiled_t *layout);
+const char *layout_compiled_entity_id_at(const layout_compiled_t *layout, uint16_t index);
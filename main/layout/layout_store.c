@@ -8,6 +8,8 @@
 #include <string.h>
 
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #include "app_config.h"
 #include "layout/layout_validate.h"
@@ -33,12 +35,24 @@ static const char *s_default_layout =
     "]"
     "}";
 
-esp_err_t layout_store_save(const char *json)
+static SemaphoreHandle_t s_mutex = NULL;
+static layout_compiled_t *s_current = NULL;
+
+static void layout_store_set_current(layout_compiled_t *compiled)
 {
-    if (json == NULL) {
-        return ESP_ERR_INVALID_ARG;
+    if (s_mutex != NULL) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+    layout_compiled_t *previous = s_current;
+    s_current = compiled;
+    if (s_mutex != NULL) {
+        xSemaphoreGive(s_mutex);
     }
+    layout_compiled_free(previous);
+}
 
+static esp_err_t layout_store_write_json(const char *json)
+{
     FILE *f = fopen(APP_LAYOUT_PATH, "wb");
     if (f == NULL) {
         ESP_LOGE(TAG_LAYOUT, "Cannot open layout file for writing: %s", APP_LAYOUT_PATH);
@@ -58,6 +72,43 @@ esp_err_t layout_store_save(const char *json)
     return ESP_OK;
 }
 
+/* Compiles json, optionally writes it as the new source, caches the compiled blob and makes it
+ * current. A failed blob write only costs a JSON compile on the next boot. */
+static esp_err_t layout_store_install(const char *json, bool write_json)
+{
+    layout_compiled_t *compiled = NULL;
+    esp_err_t err = layout_compiled_from_json(json, &compiled);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG_LAYOUT, "Layout does not compile: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    if (write_json) {
+        /* Drop the blob first: it must never outlive the JSON it was compiled from. */
+        remove(APP_LAYOUT_COMPILED_PATH);
+        err = layout_store_write_json(json);
+        if (err != ESP_OK) {
+            layout_compiled_free(compiled);
+            return err;
+        }
+    }
+    if (layout_compiled_write(compiled, APP_LAYOUT_COMPILED_PATH) != ESP_OK) {
+        ESP_LOGW(TAG_LAYOUT, "Compiled layout not cached, next boot compiles the JSON again");
+    }
+    ESP_LOGI(TAG_LAYOUT, "Compiled layout: %u widgets on %u pages, %u entities",
+        (unsigned)compiled->widget_count, (unsigned)compiled->page_count, (unsigned)compiled->entity_count);
+    layout_store_set_current(compiled);
+    return ESP_OK;
+}
+
+esp_err_t layout_store_save(const char *json)
+{
+    if (json == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return layout_store_install(json, true);
+}
+
 esp_err_t layout_store_load(char **json_out)
 {
     if (json_out == NULL) {
@@ -103,10 +154,81 @@ const char *layout_store_default_json(void)
     return s_default_layout;
 }
 
+esp_err_t layout_store_load_compiled(layout_compiled_t **out_layout)
+{
+    if (out_layout == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_layout = NULL;
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (s_mutex != NULL) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        if (s_current != NULL) {
+            err = layout_compiled_clone(s_current, out_layout);
+        }
+        xSemaphoreGive(s_mutex);
+    }
+    if (err == ESP_ERR_NOT_FOUND) {
+        err = layout_compiled_from_json(s_default_layout, out_layout);
+    }
+    return err;
+}
+
+size_t layout_store_copy_entity_ids(
+    char *entity_ids, size_t max_count, bool *out_need_weather_forecast, uint32_t *out_signature)
+{
+    size_t count = 0;
+    bool need_weather_forecast = false;
+    uint32_t signature = 0;
+    if (s_mutex != NULL) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        if (s_current != NULL) {
+            count = (s_current->entity_count < max_count) ? s_current->entity_count : max_count;
+            if (entity_ids != NULL && count > 0U) {
+                memcpy(entity_ids, s_current->entity_ids, count * APP_MAX_ENTITY_ID_LEN);
+            }
+            need_weather_forecast = s_current->need_weather_forecast;
+            signature = s_current->entity_signature;
+        }
+        xSemaphoreGive(s_mutex);
+    }
+    if (entity_ids == NULL) {
+        count = 0;
+    }
+    if (out_need_weather_forecast != NULL) {
+        *out_need_weather_forecast = need_weather_forecast;
+    }
+    if (out_signature != NULL) {
+        *out_signature = signature;
+    }
+    return count;
+}
+
 esp_err_t layout_store_init(void)
 {
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Normal boot: one read of the compiled blob, no JSON parse. */
+    layout_compiled_t *compiled = NULL;
+    esp_err_t err = layout_compiled_read(APP_LAYOUT_COMPILED_PATH, &compiled);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG_LAYOUT, "Loaded compiled layout: %u widgets on %u pages, %u entities",
+            (unsigned)compiled->widget_count, (unsigned)compiled->page_count, (unsigned)compiled->entity_count);
+        layout_store_set_current(compiled);
+        return ESP_OK;
+    }
+    if (err != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG_LAYOUT, "Compiled layout unusable (%s), compiling from JSON", esp_err_to_name(err));
+    }
+
     char *existing = NULL;
-    esp_err_t err = layout_store_load(&existing);
+    err = layout_store_load(&existing);
     if (err != ESP_OK || existing == NULL) {
         ESP_LOGW(TAG_LAYOUT, "Layout file missing or invalid, writing defaults");
         return layout_store_save(s_default_layout);
@@ -114,18 +236,20 @@ esp_err_t layout_store_init(void)
 
     layout_validation_result_t *validation = calloc(1, sizeof(layout_validation_result_t));
     if (validation == NULL) {
-        free(existing);
         ESP_LOGW(TAG_LAYOUT, "Validation allocation failed, preserving existing layout");
+        layout_store_install(existing, false);
+        free(existing);
         return ESP_OK;
     }
 
     bool valid = layout_validate_json(existing, validation);
     free(validation);
-    free(existing);
 
-    if (valid) {
+    if (valid && layout_store_install(existing, false) == ESP_OK) {
+        free(existing);
         return ESP_OK;
     }
+    free(existing);
 
     ESP_LOGW(TAG_LAYOUT, "Stored layout failed validation, writing defaults");
     return layout_store_save(s_default_layout);
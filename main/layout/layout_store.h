@@ -3,9 +3,23 @@
  */
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "esp_err.h"
 
+#include "layout/layout_compiled.h"
+
+/* The JSON file is the editor's source of truth; every save also compiles it, and the compiled
+ * layout is what boot loads and what the UI and HA client consume. */
 esp_err_t layout_store_init(void);
 esp_err_t layout_store_load(char **json_out);
 esp_err_t layout_store_save(const char *json);
 const char *layout_store_default_json(void);
+/* Private copy of the current compiled layout; release it with layout_compiled_free. */
+esp_err_t layout_store_load_compiled(layout_compiled_t **out_layout);
+/* Copies up to max_count entity_ids of the current layout (first-use order, APP_MAX_ENTITY_ID_LEN
+ * stride). Returns the number copied; out parameters may be NULL. */
+size_t layout_store_copy_entity_ids(
+    char *entity_ids, size_t max_count, bool *out_need_weather_forecast, uint32_t *out_signature);
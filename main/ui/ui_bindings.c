@@ -10,12 +10,14 @@
 #include <inttypes.h>
 #include <limits.h>
 
+#include "esp_heap_caps.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 
 #include "app_config.h"
 #include "app_events.h"
 #include "ha/ha_client.h"
+#include "ha/ha_entity_ids.h"
 #include "ha/ha_model.h"
 #include "ha/ha_services.h"
 
@@ -25,48 +27,27 @@ static const char *TAG = "ui_bindings";
 
 typedef struct {
     bool used;
-    char entity_id[APP_MAX_ENTITY_ID_LEN];
+    ha_entity_handle_t entity;
     int64_t last_cmd_ms;
     bool last_target_known;
     bool last_target_on;
 } ui_bindings_cmd_debounce_t;
 
 static ui_bindings_cmd_debounce_t s_power_cmd_debounce[UI_BINDINGS_CMD_DEBOUNCE_SLOTS];
+/* Attribute copy for optimistic updates; taps only arrive on the LVGL task, so one buffer is enough. */
+static char *s_optimistic_attrs_buf = NULL;
 
-static void ui_bindings_publish_state_changed_event(const char *entity_id)
+static void ui_bindings_publish_state_changed_event(ha_entity_handle_t entity)
 {
-    if (entity_id == NULL || entity_id[0] == '\0') {
+    if (entity == HA_ENTITY_HANDLE_NONE) {
         return;
     }
 
-    app_event_t event = {.type = EV_HA_STATE_CHANGED};
-    strlcpy(event.data.ha_state_changed.entity_id, entity_id, sizeof(event.data.ha_state_changed.entity_id));
-    if (!app_events_publish(&event, pdMS_TO_TICKS(5))) {
-        ESP_LOGW(TAG, "failed to enqueue optimistic state event for %s", entity_id);
-    } else {
+    /* User lane: the touch feedback is drained ahead of any pending HA burst. */
+    app_events_mark_user_state_dirty(entity);
 #if APP_HA_ROUTE_TRACE_LOG
-        ESP_LOGI(TAG, "route panel_touch->panel entity=%s source=optimistic", entity_id);
+    ESP_LOGI(TAG, "route panel_touch->panel entity=%s source=optimistic", ha_entity_ids_str(entity));
 #endif
-    }
-}
-
-static void ui_bindings_apply_optimistic_power_state(const char *entity_id, bool on)
-{
-    if (entity_id == NULL || entity_id[0] == '\0') {
-        return;
-    }
-
-    ha_state_t state = {0};
-    if (!ha_model_get_state(entity_id, &state)) {
-        strlcpy(state.entity_id, entity_id, sizeof(state.entity_id));
-        strlcpy(state.attributes_json, "{}", sizeof(state.attributes_json));
-    }
-
-    strlcpy(state.state, on ? "on" : "off", sizeof(state.state));
-    state.last_changed_unix_ms = esp_timer_get_time() / 1000;
-    if (ha_model_upsert_state(&state) == ESP_OK) {
-        ui_bindings_publish_state_changed_event(entity_id);
-    }
 }
 
 static void ui_bindings_apply_optimistic_state_text(const char *entity_id, const char *state_text)
@@ -75,24 +56,45 @@ static void ui_bindings_apply_optimistic_state_text(const char *entity_id, const
         return;
     }
 
+    /* Keep the current attributes; the model copies them back into its own arena on upsert. */
+    if (s_optimistic_attrs_buf == NULL) {
+        s_optimistic_attrs_buf = (char *)heap_caps_malloc(APP_HA_ATTRS_MAX_LEN, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_optimistic_attrs_buf == NULL) {
+            s_optimistic_attrs_buf = (char *)heap_caps_malloc(APP_HA_ATTRS_MAX_LEN, MALLOC_CAP_8BIT);
+        }
+        if (s_optimistic_attrs_buf == NULL) {
+            return;
+        }
+    }
+    char *attrs_json = s_optimistic_attrs_buf;
     ha_state_t state = {0};
-    if (!ha_model_get_state(entity_id, &state)) {
-        strlcpy(state.entity_id, entity_id, sizeof(state.entity_id));
-        strlcpy(state.attributes_json, "{}", sizeof(state.attributes_json));
+    if (!ha_model_get_state_with_attrs(ha_entity_ids_find(entity_id), &state, attrs_json, APP_HA_ATTRS_MAX_LEN)) {
+        state.entity = ha_model_intern_entity_id(entity_id);
+        strlcpy(attrs_json, "{}", APP_HA_ATTRS_MAX_LEN);
+        state.attributes_json = attrs_json;
     }
 
     strlcpy(state.state, state_text, sizeof(state.state));
     state.last_changed_unix_ms = esp_timer_get_time() / 1000;
     if (ha_model_upsert_state(&state) == ESP_OK) {
-        ui_bindings_publish_state_changed_event(entity_id);
+        ui_bindings_publish_state_changed_event(state.entity);
     }
 }
 
+static void ui_bindings_apply_optimistic_power_state(const char *entity_id, bool on)
+{
+    ui_bindings_apply_optimistic_state_text(entity_id, on ? "on" : "off");
+}
+
 static bool ui_bindings_allow_power_command_now(const char *entity_id, bool target_known, bool target_on)
 {
     if (entity_id == NULL || entity_id[0] == '\0') {
         return false;
     }
+    ha_entity_handle_t entity = ha_entity_ids_intern(entity_id);
+    if (entity == HA_ENTITY_HANDLE_NONE) {
+        return true;
+    }
 
     int64_t now_ms = esp_timer_get_time() / 1000;
     int free_idx = -1;
@@ -107,7 +109,7 @@ static bool ui_bindings_allow_power_command_now(const char *entity_id, bool targ
             continue;
         }
 
-        if (strncmp(s_power_cmd_debounce[i].entity_id, entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
+        if (s_power_cmd_debounce[i].entity == entity) {
             int64_t age_ms = now_ms - s_power_cmd_debounce[i].last_cmd_ms;
             bool duplicate_target =
                 target_known &&
@@ -135,7 +137,7 @@ static bool ui_bindings_allow_power_command_now(const char *entity_id, bool targ
     s_power_cmd_debounce[slot].last_cmd_ms = now_ms;
     s_power_cmd_debounce[slot].last_target_known = target_known;
     s_power_cmd_debounce[slot].last_target_on = target_on;
-    strlcpy(s_power_cmd_debounce[slot].entity_id, entity_id, sizeof(s_power_cmd_debounce[slot].entity_id));
+    s_power_cmd_debounce[slot].entity = entity;
     return true;
 }
 
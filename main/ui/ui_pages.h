@@ -9,7 +9,11 @@
 
 #include "lvgl.h"
 
+/* Called from ui_pages_show_index (display lock held) after the new page is unhidden. */
+typedef void (*ui_pages_show_cb_t)(uint16_t index);
+
 void ui_pages_init(void);
+void ui_pages_set_show_cb(ui_pages_show_cb_t cb);
 void ui_pages_reset(void);
 lv_obj_t *ui_pages_add(const char *page_id, const char *title);
 bool ui_pages_show(const char *page_id);
@@ -8,39 +8,97 @@
 #include <string.h>
 #include <time.h>
 
-#include "cJSON.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 
 #include "app_config.h"
 #include "app_events.h"
 #include "drivers/display_init.h"
 #include "ha/ha_client.h"
+#include "ha/ha_entity_ids.h"
 #include "ha/ha_model.h"
 #include "layout/layout_store.h"
 #include "net/wifi_mgr.h"
 #include "ui/fonts/mdi_font_registry.h"
 #include "ui/ui_pages.h"
 #include "ui/ui_widget_factory.h"
+#include "ui/ui_widget_pool.h"
 #include "ui/theme/theme_default.h"
 #include "util/log_tags.h"
 
-#define UI_MODEL_RECONCILE_INTERVAL_MS 1000
+/* Dirty entities applied per frame batch; the rest stay marked for the next frame. */
+#define UI_DIRTY_BATCH_MAX 32U
+#define UI_TOPBAR_REFRESH_INTERVAL_MS 1000
+/* Batches are applied just before LVGL's next refresh; the lead covers the batch itself. */
+#define UI_FRAME_PERIOD_US ((int64_t)LV_DEF_REFR_PERIOD * 1000)
+#define UI_FRAME_LEAD_MIN_US 1000
+#define UI_FRAME_LOCK_TIMEOUT_MS 50
 
+/* Reverse index entity -> widget slot, sorted by (entity, widget_index). Rebuilt on every layout load. */
+typedef struct {
+    ha_entity_handle_t entity;
+    uint16_t widget_index;
+    bool is_primary;
+    /* ha_model_entity_revision last applied to this widget, 0 = not rendered from a state yet. */
+    uint32_t rendered_revision;
+    /* Missing entity not yet shown as unavailable (hidden page, or never rendered): the page
+     * catch-up marks it if the entity is still missing. */
+    bool pending_unavailable;
+} ui_runtime_binding_t;
+
+/* The compiled layout on screen; the static empty one until the first load. A reload applies the next
+ * compiled layout over it and frees it. */
+static layout_compiled_t s_empty_layout = {0};
+static layout_compiled_t *s_layout = &s_empty_layout;
+/* s_widgets[i] only has an object tree while its page is resident. */
 static ui_widget_instance_t s_widgets[APP_MAX_WIDGETS_TOTAL];
-static size_t s_widget_count = 0;
+/* Only widgets on s_visible_page receive state applies. */
+static int32_t s_visible_page = -1;
+static lv_obj_t *s_page_containers[APP_MAX_PAGES];
+/* Scratch for the incremental reload: old<->new widget index maps (-1 = none). */
+static int16_t s_diff_old_to_new[APP_MAX_WIDGETS_TOTAL];
+static int16_t s_diff_new_to_old[APP_MAX_WIDGETS_TOTAL];
+/* Show sequence of each resident page, 0 = not materialized; the lowest is evicted first. */
+static uint32_t s_page_shown_seq[APP_MAX_PAGES];
+static uint32_t s_page_seq = 0;
+/* Widget index a page's build resumes at; widget_end once every tree of the page was built. */
+static uint16_t s_page_build_next[APP_MAX_PAGES];
+/* The visible page still has trees to build; the UI task builds the next slice each frame. */
+static bool s_build_pending = false;
+static bool s_first_dashboard_logged = false;
+static ui_runtime_binding_t s_bindings[APP_MAX_WIDGETS_TOTAL * 2];
+static size_t s_binding_count = 0;
 static TaskHandle_t s_ui_task = NULL;
 static bool s_initialized = false;
 static int64_t s_last_topbar_refresh_ms = 0;
-static int64_t s_last_model_reconcile_ms = 0;
-static uint32_t s_last_model_revision = 0;
-static bool s_model_reconcile_pending = false;
+/* ha_model_state_revision at the last reconcile; ha_model_changed_since starts from here. */
+static uint32_t s_reconciled_revision = 0;
 static bool s_pending_state_reconcile = false;
 static bool s_pending_topbar_refresh = false;
-static uint32_t s_deferred_event_count = 0;
-static int64_t s_deferred_event_log_ms = 0;
+static bool s_pending_layout_reload = false;
+static bool s_pending_navigate = false;
+static char s_pending_navigate_page[APP_MAX_PAGE_ID_LEN];
+/* Frame sync: written by the LVGL task (refresh start), read by the UI task. */
+static int64_t s_lvgl_refr_start_us = 0;
+static int64_t s_batch_cost_us = UI_FRAME_LEAD_MIN_US;
+/* Oldest mark covered by the last batch; the next LVGL refresh completes the latency sample.
+ * Only touched with the display lock held (UI batch or LVGL refresh event). */
+static int64_t s_latency_mark_us = 0;
+static int64_t s_latency_batch_end_us = 0;
+static SemaphoreHandle_t s_stats_mutex = NULL;
+static ui_runtime_stats_t s_stats = {
+    .bucket_le_ms = {4, 8, 16, 33, 50, 100, 200, 500, UINT16_MAX},
+};
+static uint64_t s_latency_total_ms = 0;
+/* Bumped under the display lock (UI task or LVGL nav callbacks), read by ui_runtime_get_stats. */
+static uint32_t s_hidden_deferred = 0;
+static uint32_t s_page_catchups = 0;
+static uint32_t s_resident_pages = 0;
+static uint32_t s_materialized_widgets = 0;
 typedef struct {
     bool valid;
     int minute;
@@ -58,117 +116,6 @@ static ui_topbar_cache_t s_topbar_cache = {0};
 static lv_obj_t *s_weather_icon_overlay = NULL;
 #endif
 
-typedef struct {
-    int min_w;
-    int min_h;
-    int max_w;
-    int max_h;
-} ui_widget_size_limits_t;
-
-static ui_widget_size_limits_t ui_runtime_widget_size_limits(const char *type)
-{
-    ui_widget_size_limits_t limits = {
-        .min_w = 60,
-        .min_h = 60,
-        .max_w = APP_CONTENT_BOX_WIDTH,
-        .max_h = APP_CONTENT_BOX_HEIGHT,
-    };
-
-    if (type == NULL) {
-        return limits;
-    }
-
-    if (strcmp(type, "sensor") == 0) {
-        limits.min_w = 120;
-        limits.min_h = 80;
-    } else if (strcmp(type, "button") == 0) {
-        limits.min_w = 100;
-        limits.min_h = 100;
-        limits.max_w = 480;
-        limits.max_h = 320;
-    } else if (strcmp(type, "slider") == 0) {
-        limits.min_w = 100;
-        limits.min_h = 100;
-    } else if (strcmp(type, "graph") == 0) {
-        limits.min_w = 220;
-        limits.min_h = 140;
-    } else if (strcmp(type, "empty_tile") == 0) {
-        limits.min_w = 120;
-        limits.min_h = 80;
-    } else if (strcmp(type, "light_tile") == 0) {
-        limits.min_w = 180;
-        limits.min_h = 180;
-        limits.max_w = 480;
-        limits.max_h = 480;
-    } else if (strcmp(type, "heating_tile") == 0) {
-        limits.min_w = 220;
-        limits.min_h = 200;
-        limits.max_w = 480;
-        limits.max_h = 480;
-    } else if (strcmp(type, "weather_tile") == 0) {
-        limits.min_w = 220;
-        limits.min_h = 200;
-        limits.max_w = 480;
-        limits.max_h = 480;
-    } else if (strcmp(type, "weather_3day") == 0) {
-        limits.min_w = 260;
-        limits.min_h = 220;
-        limits.max_w = 640;
-        limits.max_h = 420;
-    }
-
-    if (limits.max_w > APP_CONTENT_BOX_WIDTH) {
-        limits.max_w = APP_CONTENT_BOX_WIDTH;
-    }
-    if (limits.max_h > APP_CONTENT_BOX_HEIGHT) {
-        limits.max_h = APP_CONTENT_BOX_HEIGHT;
-    }
-    return limits;
-}
-
-static void ui_runtime_clamp_widget_rect(ui_widget_def_t *def)
-{
-    if (def == NULL) {
-        return;
-    }
-
-    ui_widget_size_limits_t limits = ui_runtime_widget_size_limits(def->type);
-
-    if (def->w < limits.min_w) {
-        def->w = limits.min_w;
-    }
-    if (def->h < limits.min_h) {
-        def->h = limits.min_h;
-    }
-    if (def->w > limits.max_w) {
-        def->w = limits.max_w;
-    }
-    if (def->h > limits.max_h) {
-        def->h = limits.max_h;
-    }
-
-    if (def->x < 0) {
-        def->x = 0;
-    }
-    if (def->y < 0) {
-        def->y = 0;
-    }
-
-    if (def->x + def->w > APP_CONTENT_BOX_WIDTH) {
-        def->x = APP_CONTENT_BOX_WIDTH - def->w;
-    }
-    if (def->y + def->h > APP_CONTENT_BOX_HEIGHT) {
-        def->y = APP_CONTENT_BOX_HEIGHT - def->h;
-    }
-
-    if (def->x < 0) {
-        def->x = 0;
-    }
-    if (def->y < 0) {
-        def->y = 0;
-    }
-}
-
 static void ui_runtime_refresh_topbar(void)
 {
     time_t now = time(NULL);
@@ -238,351 +185,918 @@ static void ui_runtime_show_weather_icon_overlay(void)
 #endif
 }
 
-static void ui_runtime_apply_entity_state_ex(const char *entity_id, bool mark_unavailable_if_missing)
+static int ui_runtime_binding_cmp(const void *lhs, const void *rhs)
 {
-    if (entity_id == NULL || entity_id[0] == '\0') {
-        return;
+    const ui_runtime_binding_t *a = (const ui_runtime_binding_t *)lhs;
+    const ui_runtime_binding_t *b = (const ui_runtime_binding_t *)rhs;
+    if (a->entity != b->entity) {
+        return (a->entity < b->entity) ? -1 : 1;
+    }
+    if (a->widget_index != b->widget_index) {
+        return (a->widget_index < b->widget_index) ? -1 : 1;
     }
+    return 0;
+}
 
-    ha_state_t state = {0};
-    bool found = ha_model_get_state(entity_id, &state);
-    for (size_t i = 0; i < s_widget_count; i++) {
-        bool is_primary = (strncmp(entity_id, s_widgets[i].entity_id, APP_MAX_ENTITY_ID_LEN) == 0);
-        bool is_secondary = (s_widgets[i].secondary_entity_id[0] != '\0') &&
-                            (strncmp(entity_id, s_widgets[i].secondary_entity_id, APP_MAX_ENTITY_ID_LEN) == 0);
-        if (!is_primary && !is_secondary) {
-            continue;
+/* Adds the bindings of a freshly built widget; the caller re-sorts. The other bindings keep their
+ * rendered_revision; new ones start unrendered, so the page catch-up applies them (or marks them
+ * unavailable). */
+static void ui_runtime_bind_widget(uint16_t index)
+{
+    ha_entity_handle_t primary = s_widgets[index].entity;
+    ha_entity_handle_t secondary = s_widgets[index].secondary_entity;
+    if (primary != HA_ENTITY_HANDLE_NONE) {
+        s_bindings[s_binding_count++] = (ui_runtime_binding_t){
+            .entity = primary,
+            .widget_index = index,
+            .is_primary = true,
+            .pending_unavailable = true,
+        };
+    }
+    if (secondary != HA_ENTITY_HANDLE_NONE && secondary != primary) {
+        s_bindings[s_binding_count++] = (ui_runtime_binding_t){
+            .entity = secondary,
+            .widget_index = index,
+            .is_primary = false,
+        };
+    }
+}
+
+static void ui_runtime_unbind_page(uint16_t page)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < s_binding_count; i++) {
+        if (s_layout->widget_page[s_bindings[i].widget_index] != page) {
+            s_bindings[kept++] = s_bindings[i];
         }
-        if (found) {
-            ui_widget_factory_apply_state(&s_widgets[i], &state);
-        } else if (is_primary && mark_unavailable_if_missing) {
-            ui_widget_factory_mark_unavailable(&s_widgets[i]);
+    }
+    s_binding_count = kept;
+}
+
+static size_t ui_runtime_bindings_lower_bound(ha_entity_handle_t entity)
+{
+    size_t lo = 0;
+    size_t hi = s_binding_count;
+    while (lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2U);
+        if (s_bindings[mid].entity < entity) {
+            lo = mid + 1U;
+        } else {
+            hi = mid;
         }
     }
+    return lo;
 }
 
-static void ui_runtime_apply_entity_state(const char *entity_id)
+static bool ui_runtime_widget_visible(uint16_t widget_index)
 {
-    ui_runtime_apply_entity_state_ex(entity_id, true);
+    return s_visible_page >= 0 && s_layout->widget_page[widget_index] == (uint16_t)s_visible_page;
 }
 
-static void ui_runtime_apply_all_states(void)
+/* Applies the model state of bindings[begin..end) (all bound to the same entity). With skip_rendered,
+ * bindings that already show the entity's current revision are left alone. Widgets on hidden pages
+ * are skipped; their stale rendered_revision is what ui_runtime_catch_up_page picks up later. */
+static void ui_runtime_apply_binding_range(
+    size_t begin, size_t end, bool mark_unavailable_if_missing, bool skip_rendered)
 {
-    for (size_t i = 0; i < s_widget_count; i++) {
-        ui_runtime_apply_entity_state(s_widgets[i].entity_id);
-        if (s_widgets[i].secondary_entity_id[0] != '\0' &&
-            strncmp(s_widgets[i].secondary_entity_id, s_widgets[i].entity_id, APP_MAX_ENTITY_ID_LEN) != 0) {
-            ui_runtime_apply_entity_state(s_widgets[i].secondary_entity_id);
+    if (begin >= end) {
+        return;
+    }
+
+    /* Read before the borrow: a write landing in between renders newer data under an older tag,
+     * which only costs one extra apply later. */
+    uint32_t revision = ha_model_entity_revision(s_bindings[begin].entity);
+    if (skip_rendered && revision != 0U) {
+        size_t stale = begin;
+        while (stale < end && s_bindings[stale].rendered_revision == revision) {
+            stale++;
+        }
+        if (stale == end) {
+            return;
         }
     }
+
+    /* Borrow instead of copying the (large) state record; held only while the widgets are updated. */
+    ha_model_state_ref_t ref = {0};
+    bool found = ha_model_borrow_state(s_bindings[begin].entity, &ref);
+    uint32_t deferred = 0;
+    for (size_t i = begin; i < end; i++) {
+        ui_runtime_binding_t *binding = &s_bindings[i];
+        ui_widget_instance_t *widget = &s_widgets[binding->widget_index];
+        if (!ui_runtime_widget_visible(binding->widget_index)) {
+            if (found ? binding->rendered_revision != revision
+                      : (binding->is_primary && mark_unavailable_if_missing)) {
+                binding->pending_unavailable = !found;
+                deferred++;
+            }
+            continue;
+        }
+        if (found) {
+            if (skip_rendered && binding->rendered_revision == revision) {
+                continue;
+            }
+            ui_widget_factory_apply_state(widget, ref.state);
+            binding->rendered_revision = revision;
+            binding->pending_unavailable = false;
+        } else if (binding->is_primary && mark_unavailable_if_missing) {
+            ui_widget_factory_mark_unavailable(widget);
+            binding->rendered_revision = 0;
+            binding->pending_unavailable = false;
+        }
+    }
+    ha_model_release_state(&ref);
+    if (deferred > 0U) {
+        __atomic_fetch_add(&s_hidden_deferred, deferred, __ATOMIC_RELAXED);
+    }
 }
 
-static void ui_runtime_apply_all_states_preserve_missing(void)
+/* Brings the bindings of the now visible page up to date: states that changed while hidden are
+ * applied once, entities that vanished meanwhile are marked unavailable. */
+static void ui_runtime_catch_up_page(void)
 {
-    for (size_t i = 0; i < s_widget_count; i++) {
-        ui_runtime_apply_entity_state_ex(s_widgets[i].entity_id, false);
-        if (s_widgets[i].secondary_entity_id[0] != '\0' &&
-            strncmp(s_widgets[i].secondary_entity_id, s_widgets[i].entity_id, APP_MAX_ENTITY_ID_LEN) != 0) {
-            ui_runtime_apply_entity_state_ex(s_widgets[i].secondary_entity_id, false);
+    uint32_t caught_up = 0;
+    size_t begin = 0;
+    while (begin < s_binding_count) {
+        ha_entity_handle_t entity = s_bindings[begin].entity;
+        size_t end = begin + 1U;
+        while (end < s_binding_count && s_bindings[end].entity == entity) {
+            end++;
         }
+
+        uint32_t revision = ha_model_entity_revision(entity);
+        bool stale = false;
+        for (size_t i = begin; i < end && !stale; i++) {
+            const ui_runtime_binding_t *binding = &s_bindings[i];
+            stale = ui_runtime_widget_visible(binding->widget_index) &&
+                    (binding->pending_unavailable || (revision != 0U && binding->rendered_revision != revision));
+        }
+        if (stale) {
+            ha_model_state_ref_t ref = {0};
+            bool found = ha_model_borrow_state(entity, &ref);
+            for (size_t i = begin; i < end; i++) {
+                ui_runtime_binding_t *binding = &s_bindings[i];
+                if (!ui_runtime_widget_visible(binding->widget_index)) {
+                    continue;
+                }
+                ui_widget_instance_t *widget = &s_widgets[binding->widget_index];
+                if (found && binding->rendered_revision != revision) {
+                    ui_widget_factory_apply_state(widget, ref.state);
+                    binding->rendered_revision = revision;
+                    caught_up++;
+                } else if (!found && binding->pending_unavailable && binding->is_primary) {
+                    ui_widget_factory_mark_unavailable(widget);
+                    binding->rendered_revision = 0;
+                    caught_up++;
+                }
+                binding->pending_unavailable = false;
+            }
+            ha_model_release_state(&ref);
+        }
+        begin = end;
+    }
+    if (caught_up > 0U) {
+        __atomic_fetch_add(&s_page_catchups, caught_up, __ATOMIC_RELAXED);
     }
 }
 
-static bool ui_runtime_widget_from_json(cJSON *widget_json, ui_widget_def_t *out)
+static void ui_runtime_update_residency_stats(void)
 {
-    cJSON *id = cJSON_GetObjectItemCaseSensitive(widget_json, "id");
-    cJSON *type = cJSON_GetObjectItemCaseSensitive(widget_json, "type");
-    cJSON *title = cJSON_GetObjectItemCaseSensitive(widget_json, "title");
-    cJSON *entity_id = cJSON_GetObjectItemCaseSensitive(widget_json, "entity_id");
-    cJSON *secondary_entity_id = cJSON_GetObjectItemCaseSensitive(widget_json, "secondary_entity_id");
-    cJSON *slider_direction = cJSON_GetObjectItemCaseSensitive(widget_json, "slider_direction");
-    cJSON *slider_accent_color = cJSON_GetObjectItemCaseSensitive(widget_json, "slider_accent_color");
-    cJSON *button_accent_color = cJSON_GetObjectItemCaseSensitive(widget_json, "button_accent_color");
-    cJSON *button_mode = cJSON_GetObjectItemCaseSensitive(widget_json, "button_mode");
-    cJSON *graph_line_color = cJSON_GetObjectItemCaseSensitive(widget_json, "graph_line_color");
-    cJSON *graph_point_count = cJSON_GetObjectItemCaseSensitive(widget_json, "graph_point_count");
-    cJSON *graph_time_window_min = cJSON_GetObjectItemCaseSensitive(widget_json, "graph_time_window_min");
-    cJSON *rect = cJSON_GetObjectItemCaseSensitive(widget_json, "rect");
-    if (!cJSON_IsString(id) || !cJSON_IsString(type) || !cJSON_IsObject(rect)) {
-        return false;
+    uint32_t pages = 0;
+    for (size_t p = 0; p < APP_MAX_PAGES; p++) {
+        pages += (s_page_shown_seq[p] != 0U) ? 1U : 0U;
     }
+    uint32_t widgets = 0;
+    for (size_t i = 0; i < s_layout->widget_count; i++) {
+        widgets += (s_widgets[i].obj != NULL) ? 1U : 0U;
+    }
+    __atomic_store_n(&s_resident_pages, pages, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_materialized_widgets, widgets, __ATOMIC_RELAXED);
+}
 
-    const bool requires_entity = (strcmp(type->valuestring, "empty_tile") != 0);
-    if (requires_entity && !cJSON_IsString(entity_id)) {
-        return false;
+/* Definition order is z-order, so background tiles stay below the rest; a no-op for children
+ * already in place. */
+static void ui_runtime_restore_page_order(uint16_t page)
+{
+    int32_t z = 0;
+    for (uint16_t i = s_layout->pages[page].widget_begin; i < s_layout->pages[page].widget_end; i++) {
+        if (s_widgets[i].obj != NULL) {
+            lv_obj_move_to_index(s_widgets[i].obj, z++);
+        }
     }
+}
 
-    cJSON *x = cJSON_GetObjectItemCaseSensitive(rect, "x");
-    cJSON *y = cJSON_GetObjectItemCaseSensitive(rect, "y");
-    cJSON *w = cJSON_GetObjectItemCaseSensitive(rect, "w");
-    cJSON *h = cJSON_GetObjectItemCaseSensitive(rect, "h");
-    if (!cJSON_IsNumber(x) || !cJSON_IsNumber(y) || !cJSON_IsNumber(w) || !cJSON_IsNumber(h)) {
-        return false;
+/* Builds the page's missing widget trees, adopting parked trees with an equal definition where
+ * possible, and binds them. Stops once deadline_us has passed (0 = no deadline), after at least one
+ * tree; the next call resumes there. Trees built off the visible page start hidden. Returns the
+ * number of widgets built. */
+static uint32_t ui_runtime_materialize_page(uint16_t page, int64_t deadline_us)
+{
+    const layout_page_def_t *def = &s_layout->pages[page];
+    lv_obj_t *container = s_page_containers[page];
+    uint32_t built = 0;
+    uint16_t i = (s_page_build_next[page] > def->widget_begin) ? s_page_build_next[page] : def->widget_begin;
+    for (; i < def->widget_end && container != NULL; i++) {
+        if (s_widgets[i].obj != NULL) {
+            continue;
+        }
+        if (built > 0U && deadline_us != 0 && esp_timer_get_time() >= deadline_us) {
+            break;
+        }
+        if (!ui_widget_pool_take(&s_layout->widgets[i], container, &s_widgets[i]) &&
+            ui_widget_factory_create(&s_layout->widgets[i], container, &s_widgets[i]) != ESP_OK) {
+            memset(&s_widgets[i], 0, sizeof(s_widgets[i]));
+            continue;
+        }
+        if ((int32_t)page != s_visible_page) {
+            ui_widget_factory_set_visible(&s_widgets[i], false);
+        }
+        ui_runtime_bind_widget(i);
+        built++;
+    }
+    s_page_build_next[page] = (container != NULL) ? i : def->widget_end;
+    if (built > 0U) {
+        qsort(s_bindings, s_binding_count, sizeof(s_bindings[0]), ui_runtime_binding_cmp);
+        ui_runtime_restore_page_order(page);
     }
+    if ((int32_t)page == s_visible_page) {
+        __atomic_store_n(&s_build_pending, s_page_build_next[page] < def->widget_end, __ATOMIC_RELAXED);
+    }
+    return built;
+}
 
-    memset(out, 0, sizeof(*out));
-    snprintf(out->id, sizeof(out->id), "%s", id->valuestring);
-    snprintf(out->type, sizeof(out->type), "%s", type->valuestring);
-    snprintf(out->title, sizeof(out->title), "%s", cJSON_IsString(title) ? title->valuestring : id->valuestring);
-    if (cJSON_IsString(entity_id) && entity_id->valuestring != NULL) {
-        snprintf(out->entity_id, sizeof(out->entity_id), "%s", entity_id->valuestring);
+static void ui_runtime_evict_page(uint16_t page)
+{
+    ui_runtime_unbind_page(page);
+    for (uint16_t i = s_layout->pages[page].widget_begin; i < s_layout->pages[page].widget_end; i++) {
+        if (s_widgets[i].obj == NULL) {
+            continue;
+        }
+        ui_widget_pool_park(&s_layout->widgets[i], &s_widgets[i]);
+        memset(&s_widgets[i], 0, sizeof(s_widgets[i]));
     }
-    if (cJSON_IsString(secondary_entity_id) && secondary_entity_id->valuestring != NULL) {
-        snprintf(out->secondary_entity_id, sizeof(out->secondary_entity_id), "%s", secondary_entity_id->valuestring);
+    s_page_shown_seq[page] = 0;
+    s_page_build_next[page] = 0;
+}
+
+static int32_t ui_runtime_least_recent_page(int32_t except_page)
+{
+    int32_t lru = -1;
+    for (int32_t p = 0; p < APP_MAX_PAGES; p++) {
+        if (p == except_page || s_page_shown_seq[p] == 0U) {
+            continue;
+        }
+        if (lru < 0 || (int32_t)(s_page_shown_seq[p] - s_page_shown_seq[lru]) < 0) {
+            lru = p;
+        }
     }
-    if (cJSON_IsString(slider_direction) && slider_direction->valuestring != NULL) {
-        snprintf(out->slider_direction, sizeof(out->slider_direction), "%s", slider_direction->valuestring);
+    return lru;
+}
+
+/* Materializes page on first visit, evicting least recently shown pages beyond the resident bound.
+ * Trees beyond one build slice are left to the UI task's next frames. */
+static void ui_runtime_touch_page(uint16_t page)
+{
+    if (s_page_shown_seq[page] == 0U) {
+        uint32_t resident = 0;
+        for (size_t p = 0; p < APP_MAX_PAGES; p++) {
+            resident += (s_page_shown_seq[p] != 0U) ? 1U : 0U;
+        }
+        while (resident >= APP_UI_RESIDENT_PAGES_MAX) {
+            int32_t lru = ui_runtime_least_recent_page(page);
+            if (lru < 0) {
+                break;
+            }
+            ui_runtime_evict_page((uint16_t)lru);
+            resident--;
+        }
     }
-    if (cJSON_IsString(slider_accent_color) && slider_accent_color->valuestring != NULL) {
-        snprintf(out->slider_accent_color, sizeof(out->slider_accent_color), "%s", slider_accent_color->valuestring);
+    ui_runtime_materialize_page(page, esp_timer_get_time() + (int64_t)APP_UI_LAYOUT_BUILD_SLICE_MS * 1000);
+    s_page_seq++;
+    if (s_page_seq == 0U) {
+        s_page_seq = 1U;
     }
-    if (cJSON_IsString(button_accent_color) && button_accent_color->valuestring != NULL) {
-        snprintf(out->button_accent_color, sizeof(out->button_accent_color), "%s", button_accent_color->valuestring);
+    s_page_shown_seq[page] = s_page_seq;
+    ui_runtime_update_residency_stats();
+    if (__atomic_load_n(&s_build_pending, __ATOMIC_RELAXED) && s_ui_task != NULL) {
+        xTaskNotifyGive(s_ui_task);
     }
-    if (cJSON_IsString(button_mode) && button_mode->valuestring != NULL) {
-        snprintf(out->button_mode, sizeof(out->button_mode), "%s", button_mode->valuestring);
+}
+
+/* ui_pages show hook: runs for nav taps (LVGL task) and runtime navigation alike, lock held. */
+static void ui_runtime_page_shown_cb(uint16_t index)
+{
+    int32_t previous = s_visible_page;
+    if (index >= APP_MAX_PAGES) {
+        return;
     }
-    if (cJSON_IsString(graph_line_color) && graph_line_color->valuestring != NULL) {
-        snprintf(out->graph_line_color, sizeof(out->graph_line_color), "%s", graph_line_color->valuestring);
+    s_visible_page = index;
+    for (size_t i = 0; i < s_layout->widget_count; i++) {
+        /* Before the first show every widget counts as visible (created with timers running). */
+        bool was_visible = (previous < 0) || s_layout->widget_page[i] == (uint16_t)previous;
+        bool now_visible = s_layout->widget_page[i] == index;
+        if (was_visible != now_visible) {
+            ui_widget_factory_set_visible(&s_widgets[i], now_visible);
+        }
     }
-    if (cJSON_IsNumber(graph_point_count)) {
-        out->graph_point_count = graph_point_count->valueint;
+    /* After the transitions: trees built now are created running, as the page is visible. */
+    ui_runtime_touch_page(index);
+    ui_runtime_catch_up_page();
+}
+
+static void ui_runtime_apply_entity_state_ex(
+    ha_entity_handle_t entity, bool mark_unavailable_if_missing, bool skip_rendered)
+{
+    if (entity == HA_ENTITY_HANDLE_NONE) {
+        return;
     }
-    if (cJSON_IsNumber(graph_time_window_min)) {
-        out->graph_time_window_min = graph_time_window_min->valueint;
+
+    size_t begin = ui_runtime_bindings_lower_bound(entity);
+    size_t end = begin;
+    while (end < s_binding_count && s_bindings[end].entity == entity) {
+        end++;
     }
-    out->x = x->valueint;
-    out->y = y->valueint;
-    out->w = w->valueint;
-    out->h = h->valueint;
-    ui_runtime_clamp_widget_rect(out);
-    return true;
+    ui_runtime_apply_binding_range(begin, end, mark_unavailable_if_missing, skip_rendered);
 }
 
-static bool ui_runtime_is_background_widget_type(const char *type)
+static void ui_runtime_apply_entity_state(ha_entity_handle_t entity)
 {
-    return type != NULL && strcmp(type, "empty_tile") == 0;
+    ui_runtime_apply_entity_state_ex(entity, true, false);
 }
 
-esp_err_t ui_runtime_load_layout(const char *layout_json)
+/* Reconcile after (re)sync: walks only entities whose revision moved since the last reconcile and
+ * re-applies the bindings that have not rendered it yet. Entities missing from the model keep what
+ * their widgets show (initial/partial sync). Returns the number of changed entities visited. */
+static size_t ui_runtime_reconcile_changed_states(void)
 {
-    if (!s_initialized || layout_json == NULL) {
-        return ESP_ERR_INVALID_STATE;
+    uint32_t target_revision = ha_model_state_revision();
+    ha_entity_handle_t batch[UI_DIRTY_BATCH_MAX];
+    size_t cursor = 0;
+    size_t visited = 0;
+    size_t count = 0;
+    while ((count = ha_model_changed_since(s_reconciled_revision, &cursor, batch, UI_DIRTY_BATCH_MAX)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            ui_runtime_apply_entity_state_ex(batch[i], false, true);
+        }
+        visited += count;
     }
+    s_reconciled_revision = target_revision;
+    return visited;
+}
 
-    cJSON *root = cJSON_Parse(layout_json);
-    if (root == NULL) {
-        return ESP_ERR_INVALID_ARG;
+static void ui_runtime_adopt_layout(layout_compiled_t *next)
+{
+    layout_compiled_t *previous = s_layout;
+    s_layout = next;
+    if (previous != &s_empty_layout) {
+        layout_compiled_free(previous);
     }
-    cJSON *pages = cJSON_GetObjectItemCaseSensitive(root, "pages");
-    if (!cJSON_IsArray(pages)) {
-        cJSON_Delete(root);
-        return ESP_ERR_INVALID_ARG;
+}
+
+/* Same pages in the same order, with the same titles, as the live page set. */
+static bool ui_runtime_same_pages(const layout_compiled_t *a, const layout_compiled_t *b)
+{
+    if (a->page_count == 0U || a->page_count != b->page_count || ui_pages_count() != a->page_count) {
+        return false;
+    }
+    for (uint16_t p = 0; p < a->page_count; p++) {
+        if (strcmp(a->pages[p].id, b->pages[p].id) != 0 || strcmp(a->pages[p].title, b->pages[p].title) != 0) {
+            return false;
+        }
     }
+    return true;
+}
 
-    if (!display_lock(0)) {
-        cJSON_Delete(root);
-        return ESP_ERR_TIMEOUT;
+/* Replaces the page set with next: every live tree is parked, the pages are recreated and
+ * page 0 is shown, which builds its first slice and renders the initial states. */
+static void ui_runtime_apply_layout_full(layout_compiled_t *next)
+{
+    /* Park the live trees before ui_pages_reset cleans the screen, least recently shown page first,
+     * so the visible page's trees are the last the pool would drop. */
+    for (int32_t lru = ui_runtime_least_recent_page(-1); lru >= 0; lru = ui_runtime_least_recent_page(-1)) {
+        ui_runtime_evict_page((uint16_t)lru);
     }
 
     s_topbar_cache.valid = false;
     ui_pages_reset();
     memset(s_widgets, 0, sizeof(s_widgets));
-    s_widget_count = 0;
-
-    int page_count = cJSON_GetArraySize(pages);
-    for (int p = 0; p < page_count; p++) {
-        cJSON *page = cJSON_GetArrayItem(pages, p);
-        cJSON *page_id = cJSON_GetObjectItemCaseSensitive(page, "id");
-        cJSON *page_title = cJSON_GetObjectItemCaseSensitive(page, "title");
-        cJSON *widgets = cJSON_GetObjectItemCaseSensitive(page, "widgets");
-        if (!cJSON_IsString(page_id) || !cJSON_IsArray(widgets)) {
+    memset(s_page_containers, 0, sizeof(s_page_containers));
+    memset(s_page_build_next, 0, sizeof(s_page_build_next));
+    __atomic_store_n(&s_build_pending, false, __ATOMIC_RELAXED);
+    s_binding_count = 0;
+    s_visible_page = -1;
+    ui_runtime_adopt_layout(next);
+
+    for (uint16_t p = 0; p < s_layout->page_count; p++) {
+        /* Object trees are built when the page is first shown. */
+        s_page_containers[p] = ui_pages_add(s_layout->pages[p].id, s_layout->pages[p].title);
+    }
+    ui_widget_pool_retain(s_layout->widgets, s_layout->widget_count);
+
+    uint32_t target_revision = ha_model_state_revision();
+    if (ui_pages_count() > 0) {
+        ui_pages_show_index(0);
+    }
+    s_reconciled_revision = target_revision;
+}
+
+typedef struct {
+    uint32_t kept;
+    uint32_t moved;
+    uint32_t rebuilt;
+    uint32_t added;
+    uint32_t removed;
+} ui_runtime_layout_diff_t;
+
+/* A reload prepared without the display lock. With next_widgets set it is applied incrementally:
+ * the index maps are in s_diff_old_to_new / s_diff_new_to_old, and reordered pages had kept widgets
+ * change their relative order. */
+typedef struct {
+    layout_compiled_t *layout;
+    ui_widget_instance_t *next_widgets;
+    bool page_reordered[APP_MAX_PAGES];
+    ui_runtime_layout_diff_t diff;
+} ui_runtime_layout_plan_t;
+
+/* Phase one of a reload, definitions only (no LVGL calls): if next keeps the page set, widgets are
+ * matched by id within their page and those with an unchanged definition kept. Otherwise, or if the
+ * scratch instance table cannot be allocated, the plan stays a full rebuild. */
+static void ui_runtime_plan_layout(ui_runtime_layout_plan_t *plan)
+{
+    const layout_compiled_t *old_plan = s_layout;
+    const layout_compiled_t *new_plan = plan->layout;
+    if (!ui_runtime_same_pages(old_plan, new_plan)) {
+        return;
+    }
+    plan->next_widgets =
+        heap_caps_calloc(APP_MAX_WIDGETS_TOTAL, sizeof(*plan->next_widgets), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (plan->next_widgets == NULL) {
+        plan->next_widgets = heap_caps_calloc(APP_MAX_WIDGETS_TOTAL, sizeof(*plan->next_widgets), MALLOC_CAP_8BIT);
+    }
+    if (plan->next_widgets == NULL) {
+        return;
+    }
+
+    ui_runtime_layout_diff_t *diff = &plan->diff;
+    for (size_t o = 0; o < old_plan->widget_count; o++) {
+        s_diff_old_to_new[o] = -1;
+    }
+    for (uint16_t p = 0; p < new_plan->page_count; p++) {
+        const layout_page_def_t *old_page = &old_plan->pages[p];
+        const layout_page_def_t *new_page = &new_plan->pages[p];
+        for (uint16_t n = new_page->widget_begin; n < new_page->widget_end; n++) {
+            s_diff_new_to_old[n] = -1;
+            for (uint16_t o = old_page->widget_begin; o < old_page->widget_end; o++) {
+                if (s_diff_old_to_new[o] < 0 && strcmp(old_plan->widgets[o].id, new_plan->widgets[n].id) == 0) {
+                    s_diff_old_to_new[o] = (int16_t)n;
+                    s_diff_new_to_old[n] = (int16_t)o;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint16_t o = 0; o < old_plan->widget_count; o++) {
+        const ui_widget_def_t *old_def = &old_plan->widgets[o];
+        int16_t n = s_diff_old_to_new[o];
+        if (n < 0) {
+            diff->removed++;
+        } else if (!ui_widget_pool_def_matches(old_def, &new_plan->widgets[n])) {
+            s_diff_new_to_old[n] = -1;
+            s_diff_old_to_new[o] = -1;
+            diff->rebuilt++;
+        } else if (old_def->x != new_plan->widgets[n].x || old_def->y != new_plan->widgets[n].y) {
+            diff->moved++;
+        } else {
+            diff->kept++;
+        }
+    }
+    diff->added = (uint32_t)new_plan->widget_count - diff->kept - diff->moved - diff->rebuilt;
+
+    for (uint16_t p = 0; p < new_plan->page_count; p++) {
+        int16_t last_old = -1;
+        for (uint16_t n = new_plan->pages[p].widget_begin; n < new_plan->pages[p].widget_end; n++) {
+            if (s_diff_new_to_old[n] < 0) {
+                continue;
+            }
+            plan->page_reordered[p] = plan->page_reordered[p] || s_diff_new_to_old[n] < last_old;
+            last_old = s_diff_new_to_old[n];
+        }
+    }
+}
+
+/* Phase two of an incremental reload, display lock held: kept widgets stay live (moved ones only
+ * get a new position) with their bindings and rendered revisions, changed and removed ones are
+ * parked. The visible page builds what is missing within the slice ending at deadline_us; hidden
+ * resident pages build it when shown. A widget moved to another page is adopted again from the pool. */
+static void ui_runtime_apply_layout_diff(ui_runtime_layout_plan_t *plan, int64_t deadline_us)
+{
+    const layout_compiled_t *old_plan = s_layout;
+    const layout_compiled_t *new_plan = plan->layout;
+    ui_widget_instance_t *next_widgets = plan->next_widgets;
+    for (uint16_t o = 0; o < old_plan->widget_count; o++) {
+        const ui_widget_def_t *old_def = &old_plan->widgets[o];
+        int16_t n = s_diff_old_to_new[o];
+        if (n < 0) {
+            if (s_widgets[o].obj != NULL) {
+                ui_widget_pool_park(old_def, &s_widgets[o]);
+            }
             continue;
         }
+        const ui_widget_def_t *new_def = &new_plan->widgets[n];
+        next_widgets[n] = s_widgets[o];
+        if (next_widgets[n].obj != NULL && (old_def->x != new_def->x || old_def->y != new_def->y)) {
+            lv_obj_set_pos(next_widgets[n].obj, new_def->x, new_def->y);
+        }
+    }
 
-        lv_obj_t *page_container = ui_pages_add(
-            page_id->valuestring, cJSON_IsString(page_title) ? page_title->valuestring : page_id->valuestring);
-        if (page_container == NULL) {
+    /* Bindings follow their widget to its new index; those of parked widgets go. */
+    size_t bound = 0;
+    for (size_t b = 0; b < s_binding_count; b++) {
+        int16_t n = s_diff_old_to_new[s_bindings[b].widget_index];
+        if (n < 0) {
             continue;
         }
+        s_bindings[bound] = s_bindings[b];
+        s_bindings[bound].widget_index = (uint16_t)n;
+        bound++;
+    }
+    s_binding_count = bound;
+    qsort(s_bindings, s_binding_count, sizeof(s_bindings[0]), ui_runtime_binding_cmp);
 
-        int widget_count = cJSON_GetArraySize(widgets);
-        for (int pass = 0; pass < 2; pass++) {
-            const bool background_pass = (pass == 0);
-            for (int w = 0; w < widget_count; w++) {
-                if (s_widget_count >= APP_MAX_WIDGETS_TOTAL) {
-                    break;
-                }
-                ui_widget_def_t def = {0};
-                if (!ui_runtime_widget_from_json(cJSON_GetArrayItem(widgets, w), &def)) {
-                    continue;
-                }
-                bool is_background = ui_runtime_is_background_widget_type(def.type);
-                if (is_background != background_pass) {
-                    continue;
-                }
-                esp_err_t err = ui_widget_factory_create(&def, page_container, &s_widgets[s_widget_count]);
-                if (err == ESP_OK) {
-                    s_widget_count++;
-                }
-            }
+    memcpy(s_widgets, next_widgets, sizeof(s_widgets));
+    free(next_widgets);
+    plan->next_widgets = NULL;
+    ui_runtime_adopt_layout(plan->layout);
+    ui_widget_pool_retain(s_layout->widgets, s_layout->widget_count);
+
+    for (uint16_t p = 0; p < s_layout->page_count; p++) {
+        s_page_build_next[p] = 0;
+        if (s_page_shown_seq[p] != 0U && plan->page_reordered[p]) {
+            ui_runtime_restore_page_order(p);
         }
     }
+    if (s_visible_page >= 0 && s_page_shown_seq[s_visible_page] != 0U) {
+        ui_runtime_materialize_page((uint16_t)s_visible_page, deadline_us);
+        ui_runtime_catch_up_page();
+    }
+    ui_runtime_update_residency_stats();
+}
 
-    cJSON_Delete(root);
+static void ui_runtime_record_layout_lock(int64_t held_us, bool build_slice)
+{
+    uint32_t held_ms = (uint32_t)((held_us + 500) / 1000);
+    xSemaphoreTake(s_stats_mutex, portMAX_DELAY);
+    if (build_slice) {
+        s_stats.layout_build_slices++;
+    } else {
+        s_stats.layout_lock_last_ms = held_ms;
+    }
+    if (held_ms > s_stats.layout_lock_max_ms) {
+        s_stats.layout_lock_max_ms = held_ms;
+    }
+    xSemaphoreGive(s_stats_mutex);
+}
 
-    if (ui_pages_count() > 0) {
-        ui_pages_show_index(0);
+/* Takes ownership of layout and puts it on screen. Matching runs before the display lock is taken;
+ * the lock only covers swapping object trees and the first build slice of the visible page. */
+static esp_err_t ui_runtime_apply_layout(layout_compiled_t *layout, int64_t started_us)
+{
+    ui_runtime_layout_plan_t plan = {.layout = layout};
+    ui_runtime_plan_layout(&plan);
+    if (!display_lock(0)) {
+        free(plan.next_widgets);
+        layout_compiled_free(layout);
+        return ESP_ERR_TIMEOUT;
+    }
+    int64_t locked_us = esp_timer_get_time();
+    ui_widget_pool_stats_t pool_before = {0};
+    ui_widget_pool_get_stats(&pool_before);
+
+    /* Editor saves usually keep the page set; then only the widgets that differ are touched. */
+    bool incremental = plan.next_widgets != NULL;
+    if (incremental) {
+        ui_runtime_apply_layout_diff(&plan, locked_us + (int64_t)APP_UI_LAYOUT_BUILD_SLICE_MS * 1000);
+    } else {
+        ui_runtime_apply_layout_full(layout);
     }
-    ui_runtime_apply_all_states();
     ui_runtime_refresh_topbar();
+    int64_t done_us = esp_timer_get_time();
     display_unlock();
-    ESP_LOGI(TAG_UI, "Layout loaded: %u widgets", (unsigned)s_widget_count);
+
+    ui_runtime_record_layout_lock(done_us - locked_us, false);
+    if ((done_us - locked_us) > (int64_t)APP_UI_LAYOUT_LOCK_BUDGET_MS * 1000) {
+        ESP_LOGW(TAG_UI, "Layout swap held the display lock %lld ms (budget %d ms)",
+            (long long)((done_us - locked_us) / 1000), APP_UI_LAYOUT_LOCK_BUDGET_MS);
+    }
+    if (incremental) {
+        ESP_LOGI(TAG_UI,
+            "Layout updated in %lld ms (display lock %lld ms): %u kept, %u moved, %u rebuilt, %u added, "
+            "%u removed, %u entity bindings",
+            (long long)((done_us - started_us) / 1000), (long long)((done_us - locked_us) / 1000),
+            (unsigned)plan.diff.kept, (unsigned)plan.diff.moved, (unsigned)plan.diff.rebuilt,
+            (unsigned)plan.diff.added, (unsigned)plan.diff.removed, (unsigned)s_binding_count);
+        return ESP_OK;
+    }
+
+    ui_widget_pool_stats_t pool_after = {0};
+    ui_widget_pool_get_stats(&pool_after);
+    ESP_LOGI(TAG_UI,
+        "Layout loaded in %lld ms (display lock %lld ms): %u widgets on %u pages, %u materialized "
+        "(%u adopted from pool), %u entity bindings",
+        (long long)((done_us - started_us) / 1000), (long long)((done_us - locked_us) / 1000),
+        (unsigned)s_layout->widget_count, (unsigned)ui_pages_count(),
+        (unsigned)__atomic_load_n(&s_materialized_widgets, __ATOMIC_RELAXED),
+        (unsigned)(pool_after.hits - pool_before.hits), (unsigned)s_binding_count);
+    if (!s_first_dashboard_logged) {
+        s_first_dashboard_logged = true;
+        ESP_LOGI(TAG_UI, "Time to first dashboard: %lld ms after boot", (long long)(done_us / 1000));
+    }
     return ESP_OK;
 }
 
+esp_err_t ui_runtime_load_layout(const char *layout_json)
+{
+    if (!s_initialized || layout_json == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t started_us = esp_timer_get_time();
+    layout_compiled_t *layout = NULL;
+    esp_err_t err = layout_compiled_from_json(layout_json, &layout);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return ui_runtime_apply_layout(layout, started_us);
+}
+
 esp_err_t ui_runtime_reload_layout(void)
 {
-    char *json = NULL;
-    esp_err_t err = layout_store_load(&json);
-    if (err != ESP_OK || json == NULL) {
-        json = strdup(layout_store_default_json());
-        if (json == NULL) {
-            return ESP_ERR_NO_MEM;
-        }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
     }
-    err = ui_runtime_load_layout(json);
-    free(json);
-    return err;
+
+    /* The store hands out the compiled layout; no JSON is read or parsed here. */
+    int64_t started_us = esp_timer_get_time();
+    layout_compiled_t *layout = NULL;
+    esp_err_t err = layout_store_load_compiled(&layout);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return ui_runtime_apply_layout(layout, started_us);
 }
 
-static void ui_runtime_handle_event(const app_event_t *event)
+static void ui_runtime_stats_record_latency(int64_t latency_us)
 {
-    if (event == NULL) {
+    uint32_t latency_ms = (uint32_t)((latency_us + 500) / 1000);
+    size_t bucket = 0;
+    while (bucket + 1U < UI_RUNTIME_LATENCY_BUCKETS && latency_ms > s_stats.bucket_le_ms[bucket]) {
+        bucket++;
+    }
+    xSemaphoreTake(s_stats_mutex, portMAX_DELAY);
+    s_stats.latency_buckets[bucket]++;
+    s_stats.latency_samples++;
+    s_latency_total_ms += latency_ms;
+    if (latency_ms > s_stats.latency_max_ms) {
+        s_stats.latency_max_ms = latency_ms;
+    }
+    xSemaphoreGive(s_stats_mutex);
+}
+
+/* LVGL task, display lock held. */
+static void ui_runtime_display_refr_cb(lv_event_t *e)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        __atomic_store_n(&s_lvgl_refr_start_us, now_us, __ATOMIC_RELEASE);
         return;
     }
+    if (s_latency_mark_us != 0) {
+        ui_runtime_stats_record_latency(now_us - s_latency_mark_us);
+        s_latency_mark_us = 0;
+    }
+}
 
-    bool needs_lock = (event->type != EV_LAYOUT_UPDATED);
-    if (needs_lock && !display_lock(0)) {
-        if (event->type == EV_HA_STATE_CHANGED || event->type == EV_HA_CONNECTED) {
+/* Queued (non-state) events only set pending work; everything is applied in the next frame batch. */
+static void ui_runtime_collect_events(void)
+{
+    app_event_t event = {0};
+    while (app_events_receive(&event, 0)) {
+        switch (event.type) {
+        case EV_HA_CONNECTED:
+            /* During initial/partial HA sync we may temporarily miss some entities.
+             * The reconcile only touches changed entities and preserves widgets whose entity is missing. */
             s_pending_state_reconcile = true;
             s_pending_topbar_refresh = true;
-        } else if (event->type == EV_HA_DISCONNECTED) {
+            break;
+        case EV_HA_DISCONNECTED:
             s_pending_topbar_refresh = true;
+            break;
+        case EV_LAYOUT_UPDATED:
+            s_pending_layout_reload = true;
+            break;
+        case EV_UI_NAVIGATE:
+            snprintf(s_pending_navigate_page, sizeof(s_pending_navigate_page), "%s", event.data.navigate.page_id);
+            s_pending_navigate = true;
+            break;
+        case EV_HA_STATE_CHANGED:
+        case EV_NONE:
+        default:
+            break;
         }
+    }
+}
 
-        s_deferred_event_count++;
-        int64_t now_ms = esp_timer_get_time() / 1000;
-        if ((now_ms - s_deferred_event_log_ms) >= 5000) {
-            ESP_LOGW(TAG_UI, "Deferred UI event processing due to display lock contention (deferred=%u)",
-                (unsigned)s_deferred_event_count);
-            s_deferred_event_log_ms = now_ms;
-            s_deferred_event_count = 0;
-        }
+/* Sleeps until just before LVGL's next refresh so the batch lands in that frame without contending
+ * with the render. When LVGL is idle (refresh timer paused) the batch runs immediately. */
+static void ui_runtime_wait_frame_slot(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    int64_t refr_start_us = __atomic_load_n(&s_lvgl_refr_start_us, __ATOMIC_ACQUIRE);
+    if (refr_start_us == 0 || (now_us - refr_start_us) >= UI_FRAME_PERIOD_US) {
         return;
     }
+    int64_t lead_us = (s_batch_cost_us > UI_FRAME_LEAD_MIN_US) ? s_batch_cost_us : UI_FRAME_LEAD_MIN_US;
+    int64_t wait_us = (refr_start_us + UI_FRAME_PERIOD_US - lead_us) - now_us;
+    TickType_t wait_ticks = pdMS_TO_TICKS(wait_us / 1000);
+    if (wait_ticks > 0) {
+        vTaskDelay(wait_ticks);
+    }
+}
 
-    switch (event->type) {
-    case EV_HA_STATE_CHANGED:
-        ui_runtime_apply_entity_state(event->data.ha_state_changed.entity_id);
+/* One display_lock hold per frame: navigation, full reconcile or dirty entities, and the topbar. */
+static void ui_runtime_run_frame(int64_t now_ms)
+{
+    if (s_pending_layout_reload) {
+        /* Takes the display lock itself and applies every state after the rebuild. */
+        s_pending_layout_reload = false;
+        ui_runtime_reload_layout();
+        s_pending_state_reconcile = false;
+    }
+
+    bool topbar_due = s_pending_topbar_refresh ||
+                      (now_ms - s_last_topbar_refresh_ms) >= UI_TOPBAR_REFRESH_INTERVAL_MS;
+    bool has_dirty = app_events_has_dirty_states();
+    bool build_pending = __atomic_load_n(&s_build_pending, __ATOMIC_RELAXED);
+    if (!topbar_due && !has_dirty && !s_pending_state_reconcile && !s_pending_navigate && !build_pending) {
+        return;
+    }
+
+    ui_runtime_wait_frame_slot();
+    if (!display_lock(UI_FRAME_LOCK_TIMEOUT_MS)) {
+        xSemaphoreTake(s_stats_mutex, portMAX_DELAY);
+        s_stats.lock_timeouts++;
+        xSemaphoreGive(s_stats_mutex);
+        return;
+    }
+    int64_t batch_start_us = esp_timer_get_time();
+
+    if (s_pending_navigate) {
+        ui_pages_show(s_pending_navigate_page);
+        s_pending_navigate = false;
+    }
+
+    ha_entity_handle_t batch[UI_DIRTY_BATCH_MAX];
+    int64_t oldest_mark_us = 0;
+    size_t applied = 0;
+    if (has_dirty) {
+        applied = app_events_take_dirty_states(batch, UI_DIRTY_BATCH_MAX, &oldest_mark_us);
+        for (size_t i = 0; i < applied; i++) {
+            ui_runtime_apply_entity_state(batch[i]);
 #if APP_HA_ROUTE_TRACE_LOG
-        ESP_LOGI(TAG_UI, "route panel->ui entity=%s", event->data.ha_state_changed.entity_id);
+            ESP_LOGI(TAG_UI, "route panel->ui entity=%s", ha_entity_ids_str(batch[i]));
 #endif
-        break;
-    case EV_HA_CONNECTED:
-        ui_runtime_refresh_topbar();
-        /* During initial/partial HA sync we may temporarily miss some entities.
-         * Preserve currently rendered widgets instead of forcing unavailable. */
-        ui_runtime_apply_all_states_preserve_missing();
-        break;
-    case EV_HA_DISCONNECTED:
+        }
+    }
+    bool reconcile = s_pending_state_reconcile;
+    size_t reconciled = 0;
+    if (reconcile) {
+        /* Runs after the dirty batch, so entities it just rendered are skipped by revision. */
+        reconciled = ui_runtime_reconcile_changed_states();
+        s_pending_state_reconcile = false;
+    }
+    if (s_latency_mark_us != 0 && (batch_start_us - s_latency_batch_end_us) > 2 * UI_FRAME_PERIOD_US) {
+        /* The previous batch changed nothing visible, so LVGL never refreshed for it. */
+        s_latency_mark_us = 0;
+    }
+    if (oldest_mark_us != 0 && (s_latency_mark_us == 0 || oldest_mark_us < s_latency_mark_us)) {
+        s_latency_mark_us = oldest_mark_us;
+    }
+    /* Next build slice of the visible page; a nav tap may have changed it since the check above. */
+    bool build_slice = __atomic_load_n(&s_build_pending, __ATOMIC_RELAXED) && s_visible_page >= 0;
+    if (build_slice) {
+        int64_t deadline_us = esp_timer_get_time() + (int64_t)APP_UI_LAYOUT_BUILD_SLICE_MS * 1000;
+        if (ui_runtime_materialize_page((uint16_t)s_visible_page, deadline_us) > 0U) {
+            ui_runtime_update_residency_stats();
+            ui_runtime_catch_up_page();
+        }
+    }
+
+    if (topbar_due) {
         ui_runtime_refresh_topbar();
-        break;
-    case EV_LAYOUT_UPDATED:
-        ui_runtime_reload_layout();
-        break;
-    case EV_UI_NAVIGATE:
-        ui_pages_show(event->data.navigate.page_id);
-        break;
-    case EV_NONE:
-    default:
-        break;
+        s_pending_topbar_refresh = false;
+        s_last_topbar_refresh_ms = now_ms;
     }
 
-    if (needs_lock) {
-        display_unlock();
+    s_latency_batch_end_us = esp_timer_get_time();
+    int64_t cost_us = s_latency_batch_end_us - batch_start_us;
+    display_unlock();
+
+    /* Smoothed batch cost feeds the frame-slot lead (capped at half a frame). */
+    s_batch_cost_us = (s_batch_cost_us * 7 + cost_us) / 8;
+    if (s_batch_cost_us > UI_FRAME_PERIOD_US / 2) {
+        s_batch_cost_us = UI_FRAME_PERIOD_US / 2;
+    }
+    xSemaphoreTake(s_stats_mutex, portMAX_DELAY);
+    s_stats.frames++;
+    s_stats.entities_applied += (uint32_t)applied;
+    if (reconcile) {
+        s_stats.reconciles++;
+        s_stats.reconcile_entities += (uint32_t)reconciled;
+    }
+    xSemaphoreGive(s_stats_mutex);
+    if (build_slice) {
+        ui_runtime_record_layout_lock(cost_us, true);
     }
 }
 
 static void ui_runtime_task(void *arg)
 {
     (void)arg;
+    app_events_set_listener(xTaskGetCurrentTaskHandle());
     while (true) {
-        app_event_t event = {0};
-        while (app_events_receive(&event, 0)) {
-            ui_runtime_handle_event(&event);
-        }
-
+        ui_runtime_collect_events();
         int64_t now_ms = esp_timer_get_time() / 1000;
-        uint32_t model_revision = ha_model_state_revision();
-        if (model_revision != s_last_model_revision) {
-            s_last_model_revision = model_revision;
-            s_model_reconcile_pending = true;
-        }
+        ui_runtime_run_frame(now_ms);
 
-        if ((s_pending_state_reconcile || s_pending_topbar_refresh) && display_lock(20)) {
-            if (s_pending_topbar_refresh) {
-                ui_runtime_refresh_topbar();
-                s_pending_topbar_refresh = false;
-            }
-            if (s_pending_state_reconcile) {
-                /* Reconcile all states after lock contention so UI never stays stale. */
-                ui_runtime_apply_all_states_preserve_missing();
-                s_pending_state_reconcile = false;
-            }
-            display_unlock();
-        }
-
-        if (s_model_reconcile_pending && (now_ms - s_last_model_reconcile_ms) >= UI_MODEL_RECONCILE_INTERVAL_MS &&
-            display_lock(20)) {
-            /* Protect against missed per-entity events under burst: periodically reconcile from model snapshot. */
-            ui_runtime_apply_all_states_preserve_missing();
-            display_unlock();
-            s_model_reconcile_pending = false;
-            s_last_model_reconcile_ms = now_ms;
+        if (app_events_has_dirty_states() || s_pending_state_reconcile || s_pending_topbar_refresh ||
+            s_pending_navigate || __atomic_load_n(&s_build_pending, __ATOMIC_RELAXED)) {
+            /* Work left (batch limit or lock timeout): continue with the next frame. */
+            vTaskDelay(1);
+            continue;
         }
-
-        if ((now_ms - s_last_topbar_refresh_ms) >= 1000) {
-            if (display_lock(20)) {
-                ui_runtime_refresh_topbar();
-                display_unlock();
-                s_last_topbar_refresh_ms = now_ms;
-            }
+        /* Event-driven: sleep until a state is marked dirty or an event is queued, at the latest
+         * when the topbar clock is due. */
+        int64_t until_topbar_ms = (s_last_topbar_refresh_ms + UI_TOPBAR_REFRESH_INTERVAL_MS) - now_ms;
+        if (until_topbar_ms < 1) {
+            until_topbar_ms = 1;
         }
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(until_topbar_ms));
+    }
+}
 
-        vTaskDelay(pdMS_TO_TICKS(20));
+void ui_runtime_get_stats(ui_runtime_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
     }
+    if (s_stats_mutex == NULL) {
+        memset(out_stats, 0, sizeof(*out_stats));
+        return;
+    }
+    xSemaphoreTake(s_stats_mutex, portMAX_DELAY);
+    *out_stats = s_stats;
+    out_stats->hidden_deferred = __atomic_load_n(&s_hidden_deferred, __ATOMIC_RELAXED);
+    out_stats->page_catchups = __atomic_load_n(&s_page_catchups, __ATOMIC_RELAXED);
+    out_stats->resident_pages = __atomic_load_n(&s_resident_pages, __ATOMIC_RELAXED);
+    out_stats->materialized_widgets = __atomic_load_n(&s_materialized_widgets, __ATOMIC_RELAXED);
+    out_stats->latency_avg_ms =
+        (s_stats.latency_samples > 0U) ? (uint32_t)(s_latency_total_ms / s_stats.latency_samples) : 0U;
+    xSemaphoreGive(s_stats_mutex);
 }
 
 esp_err_t ui_runtime_init(void)
 {
+    if (s_stats_mutex == NULL) {
+        s_stats_mutex = xSemaphoreCreateMutex();
+        if (s_stats_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
     if (!display_lock(0)) {
         return ESP_ERR_TIMEOUT;
     }
+    esp_err_t pool_err = ui_widget_pool_init();
+    if (pool_err != ESP_OK) {
+        display_unlock();
+        return pool_err;
+    }
     s_topbar_cache.valid = false;
     theme_default_init();
     ui_pages_init();
+    ui_pages_set_show_cb(ui_runtime_page_shown_cb);
     ui_runtime_show_weather_icon_overlay();
     ui_runtime_refresh_topbar();
+    lv_display_t *display = lv_display_get_default();
+    if (display != NULL) {
+        lv_display_add_event_cb(display, ui_runtime_display_refr_cb, LV_EVENT_REFR_START, NULL);
+        lv_display_add_event_cb(display, ui_runtime_display_refr_cb, LV_EVENT_REFR_READY, NULL);
+    }
     display_unlock();
     s_last_topbar_refresh_ms = esp_timer_get_time() / 1000;
-    s_last_model_reconcile_ms = s_last_topbar_refresh_ms;
-    s_last_model_revision = ha_model_state_revision();
-    s_model_reconcile_pending = false;
     s_pending_state_reconcile = false;
     s_pending_topbar_refresh = false;
-    s_deferred_event_count = 0;
-    s_deferred_event_log_ms = 0;
+    s_pending_layout_reload = false;
+    s_pending_navigate = false;
     s_initialized = true;
     return ESP_OK;
 }
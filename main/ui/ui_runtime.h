@@ -3,9 +3,41 @@
  */
 #pragma once
 
+#include <stdint.h>
+
 #include "esp_err.h"
 
+#define UI_RUNTIME_LATENCY_BUCKETS 9
+
+/* Frame batching counters plus a histogram of state-mark -> rendered-frame latency
+ * (optimistic tap feedback and HA updates alike). bucket_le_ms[i] is the inclusive upper bound
+ * of latency_buckets[i]; the last bucket is open-ended (UINT16_MAX). */
+typedef struct {
+    uint32_t frames;
+    uint32_t lock_timeouts;
+    uint32_t entities_applied;
+    uint32_t reconciles;
+    uint32_t reconcile_entities;
+    /* Widget applies deferred because their page was hidden, and those caught up on page show. */
+    uint32_t hidden_deferred;
+    uint32_t page_catchups;
+    /* Pages with materialized widget trees (LRU-bounded) and the widgets they hold. */
+    uint32_t resident_pages;
+    uint32_t materialized_widgets;
+    /* Display lock held by the last layout swap, the longest layout hold (swap or a later build
+     * slice), and the build slices run after swaps and page shows. */
+    uint32_t layout_lock_last_ms;
+    uint32_t layout_lock_max_ms;
+    uint32_t layout_build_slices;
+    uint32_t latency_samples;
+    uint32_t latency_max_ms;
+    uint32_t latency_avg_ms;
+    uint16_t bucket_le_ms[UI_RUNTIME_LATENCY_BUCKETS];
+    uint32_t latency_buckets[UI_RUNTIME_LATENCY_BUCKETS];
+} ui_runtime_stats_t;
+
 esp_err_t ui_runtime_init(void);
 esp_err_t ui_runtime_load_layout(const char *layout_json);
 esp_err_t ui_runtime_reload_layout(void);
 esp_err_t ui_runtime_start(void);
+void ui_runtime_get_stats(ui_runtime_stats_t *out_stats);
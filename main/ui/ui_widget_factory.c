@@ -7,36 +7,95 @@
 #include <string.h>
 
 esp_err_t w_sensor_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_sensor_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_sensor_mark_unavailable(ui_widget_instance_t *instance);
+bool w_sensor_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_sensor_mark_unavailable(ui_widget_instance_t *instance);
+void w_sensor_set_visible(ui_widget_instance_t *instance, bool visible);
 
 esp_err_t w_button_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_button_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_button_mark_unavailable(ui_widget_instance_t *instance);
+bool w_button_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_button_mark_unavailable(ui_widget_instance_t *instance);
 
 esp_err_t w_slider_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_slider_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_slider_mark_unavailable(ui_widget_instance_t *instance);
+bool w_slider_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_slider_mark_unavailable(ui_widget_instance_t *instance);
 
 esp_err_t w_graph_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_graph_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_graph_mark_unavailable(ui_widget_instance_t *instance);
+bool w_graph_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_graph_mark_unavailable(ui_widget_instance_t *instance);
+void w_graph_set_visible(ui_widget_instance_t *instance, bool visible);
 
 esp_err_t w_empty_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_empty_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_empty_tile_mark_unavailable(ui_widget_instance_t *instance);
+bool w_empty_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_empty_tile_mark_unavailable(ui_widget_instance_t *instance);
 
 esp_err_t w_light_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_light_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_light_tile_mark_unavailable(ui_widget_instance_t *instance);
+bool w_light_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_light_tile_mark_unavailable(ui_widget_instance_t *instance);
 
 esp_err_t w_heating_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_heating_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_heating_tile_mark_unavailable(ui_widget_instance_t *instance);
+bool w_heating_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_heating_tile_mark_unavailable(ui_widget_instance_t *instance);
 
 esp_err_t w_weather_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
-void w_weather_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
-void w_weather_tile_mark_unavailable(ui_widget_instance_t *instance);
+bool w_weather_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
+bool w_weather_tile_mark_unavailable(ui_widget_instance_t *instance);
+void w_weather_tile_set_visible(ui_widget_instance_t *instance, bool visible);
+
+/* Apply hooks return true when they changed something on screen and false when the state matched the
+ * widget's last rendered view-model (no LVGL call, no invalidation). */
+static const char *const s_kind_names[UI_WIDGET_KIND_COUNT] = {
+    [UI_WIDGET_KIND_NONE] = "none",
+    [UI_WIDGET_KIND_SENSOR] = "sensor",
+    [UI_WIDGET_KIND_BUTTON] = "button",
+    [UI_WIDGET_KIND_SLIDER] = "slider",
+    [UI_WIDGET_KIND_GRAPH] = "graph",
+    [UI_WIDGET_KIND_EMPTY_TILE] = "empty_tile",
+    [UI_WIDGET_KIND_LIGHT_TILE] = "light_tile",
+    [UI_WIDGET_KIND_HEATING_TILE] = "heating_tile",
+    [UI_WIDGET_KIND_WEATHER_TILE] = "weather_tile",
+};
+
+/* Only touched with the display lock held; readers copy with relaxed atomics. */
+static ui_widget_render_counter_t s_render_counters[UI_WIDGET_KIND_COUNT];
+
+static ui_widget_kind_t ui_widget_kind_from_type(const char *type)
+{
+    if (strcmp(type, "sensor") == 0) {
+        return UI_WIDGET_KIND_SENSOR;
+    }
+    if (strcmp(type, "button") == 0) {
+        return UI_WIDGET_KIND_BUTTON;
+    }
+    if (strcmp(type, "slider") == 0) {
+        return UI_WIDGET_KIND_SLIDER;
+    }
+    if (strcmp(type, "graph") == 0) {
+        return UI_WIDGET_KIND_GRAPH;
+    }
+    if (strcmp(type, "empty_tile") == 0) {
+        return UI_WIDGET_KIND_EMPTY_TILE;
+    }
+    if (strcmp(type, "light_tile") == 0) {
+        return UI_WIDGET_KIND_LIGHT_TILE;
+    }
+    if (strcmp(type, "heating_tile") == 0) {
+        return UI_WIDGET_KIND_HEATING_TILE;
+    }
+    if (strcmp(type, "weather_tile") == 0 || strcmp(type, "weather_3day") == 0) {
+        return UI_WIDGET_KIND_WEATHER_TILE;
+    }
+    return UI_WIDGET_KIND_NONE;
+}
+
+static void ui_widget_factory_count_render(ui_widget_kind_t kind, bool performed)
+{
+    ui_widget_render_counter_t *counter = &s_render_counters[kind];
+    if (performed) {
+        __atomic_store_n(&counter->performed, counter->performed + 1U, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(&counter->skipped, counter->skipped + 1U, __ATOMIC_RELAXED);
+    }
+}
 
 esp_err_t ui_widget_factory_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance)
 {
@@ -48,8 +107,8 @@ esp_err_t ui_widget_factory_create(const ui_widget_def_t *def, lv_obj_t *parent,
     snprintf(out_instance->id, sizeof(out_instance->id), "%s", def->id);
     snprintf(out_instance->type, sizeof(out_instance->type), "%s", def->type);
     snprintf(out_instance->title, sizeof(out_instance->title), "%s", def->title);
-    snprintf(out_instance->entity_id, sizeof(out_instance->entity_id), "%s", def->entity_id);
-    snprintf(out_instance->secondary_entity_id, sizeof(out_instance->secondary_entity_id), "%s", def->secondary_entity_id);
+    out_instance->entity = ha_entity_ids_intern(def->entity_id);
+    out_instance->secondary_entity = ha_entity_ids_intern(def->secondary_entity_id);
     snprintf(out_instance->slider_direction, sizeof(out_instance->slider_direction), "%s", def->slider_direction);
     snprintf(out_instance->slider_accent_color, sizeof(out_instance->slider_accent_color), "%s", def->slider_accent_color);
     snprintf(out_instance->button_accent_color, sizeof(out_instance->button_accent_color), "%s", def->button_accent_color);
@@ -59,29 +118,29 @@ esp_err_t ui_widget_factory_create(const ui_widget_def_t *def, lv_obj_t *parent,
     out_instance->graph_time_window_min = def->graph_time_window_min;
     out_instance->ctx = NULL;
 
-    if (strcmp(def->type, "sensor") == 0) {
+    out_instance->kind = ui_widget_kind_from_type(def->type);
+
+    switch (out_instance->kind) {
+    case UI_WIDGET_KIND_SENSOR:
         return w_sensor_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "button") == 0) {
+    case UI_WIDGET_KIND_BUTTON:
         return w_button_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "slider") == 0) {
+    case UI_WIDGET_KIND_SLIDER:
         return w_slider_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "graph") == 0) {
+    case UI_WIDGET_KIND_GRAPH:
         return w_graph_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "empty_tile") == 0) {
+    case UI_WIDGET_KIND_EMPTY_TILE:
         return w_empty_tile_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "light_tile") == 0) {
+    case UI_WIDGET_KIND_LIGHT_TILE:
         return w_light_tile_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "heating_tile") == 0) {
+    case UI_WIDGET_KIND_HEATING_TILE:
         return w_heating_tile_create(def, parent, out_instance);
-    }
-    if (strcmp(def->type, "weather_tile") == 0 || strcmp(def->type, "weather_3day") == 0) {
+    case UI_WIDGET_KIND_WEATHER_TILE:
         return w_weather_tile_create(def, parent, out_instance);
+    case UI_WIDGET_KIND_NONE:
+    case UI_WIDGET_KIND_COUNT:
+    default:
+        break;
     }
     return ESP_ERR_NOT_SUPPORTED;
 }
@@ -91,23 +150,38 @@ void ui_widget_factory_apply_state(ui_widget_instance_t *instance, const ha_stat
     if (instance == NULL || instance->obj == NULL || state == NULL) {
         return;
     }
-    if (strcmp(instance->type, "sensor") == 0) {
-        w_sensor_apply_state(instance, state);
-    } else if (strcmp(instance->type, "button") == 0) {
-        w_button_apply_state(instance, state);
-    } else if (strcmp(instance->type, "slider") == 0) {
-        w_slider_apply_state(instance, state);
-    } else if (strcmp(instance->type, "graph") == 0) {
-        w_graph_apply_state(instance, state);
-    } else if (strcmp(instance->type, "empty_tile") == 0) {
-        w_empty_tile_apply_state(instance, state);
-    } else if (strcmp(instance->type, "light_tile") == 0) {
-        w_light_tile_apply_state(instance, state);
-    } else if (strcmp(instance->type, "heating_tile") == 0) {
-        w_heating_tile_apply_state(instance, state);
-    } else if (strcmp(instance->type, "weather_tile") == 0 || strcmp(instance->type, "weather_3day") == 0) {
-        w_weather_tile_apply_state(instance, state);
+    bool performed = false;
+    switch (instance->kind) {
+    case UI_WIDGET_KIND_SENSOR:
+        performed = w_sensor_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_BUTTON:
+        performed = w_button_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_SLIDER:
+        performed = w_slider_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_GRAPH:
+        performed = w_graph_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_EMPTY_TILE:
+        performed = w_empty_tile_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_LIGHT_TILE:
+        performed = w_light_tile_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_HEATING_TILE:
+        performed = w_heating_tile_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_WEATHER_TILE:
+        performed = w_weather_tile_apply_state(instance, state);
+        break;
+    case UI_WIDGET_KIND_NONE:
+    case UI_WIDGET_KIND_COUNT:
+    default:
+        return;
     }
+    ui_widget_factory_count_render(instance->kind, performed);
 }
 
 void ui_widget_factory_mark_unavailable(ui_widget_instance_t *instance)
@@ -115,21 +189,73 @@ void ui_widget_factory_mark_unavailable(ui_widget_instance_t *instance)
     if (instance == NULL || instance->obj == NULL) {
         return;
     }
-    if (strcmp(instance->type, "sensor") == 0) {
-        w_sensor_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "button") == 0) {
-        w_button_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "slider") == 0) {
-        w_slider_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "graph") == 0) {
-        w_graph_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "empty_tile") == 0) {
-        w_empty_tile_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "light_tile") == 0) {
-        w_light_tile_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "heating_tile") == 0) {
-        w_heating_tile_mark_unavailable(instance);
-    } else if (strcmp(instance->type, "weather_tile") == 0 || strcmp(instance->type, "weather_3day") == 0) {
-        w_weather_tile_mark_unavailable(instance);
+    bool performed = false;
+    switch (instance->kind) {
+    case UI_WIDGET_KIND_SENSOR:
+        performed = w_sensor_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_BUTTON:
+        performed = w_button_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_SLIDER:
+        performed = w_slider_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_GRAPH:
+        performed = w_graph_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_EMPTY_TILE:
+        performed = w_empty_tile_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_LIGHT_TILE:
+        performed = w_light_tile_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_HEATING_TILE:
+        performed = w_heating_tile_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_WEATHER_TILE:
+        performed = w_weather_tile_mark_unavailable(instance);
+        break;
+    case UI_WIDGET_KIND_NONE:
+    case UI_WIDGET_KIND_COUNT:
+    default:
+        return;
+    }
+    ui_widget_factory_count_render(instance->kind, performed);
+}
+
+void ui_widget_factory_set_visible(ui_widget_instance_t *instance, bool visible)
+{
+    if (instance == NULL || instance->obj == NULL) {
+        return;
+    }
+    switch (instance->kind) {
+    case UI_WIDGET_KIND_SENSOR:
+        w_sensor_set_visible(instance, visible);
+        break;
+    case UI_WIDGET_KIND_GRAPH:
+        w_graph_set_visible(instance, visible);
+        break;
+    case UI_WIDGET_KIND_WEATHER_TILE:
+        w_weather_tile_set_visible(instance, visible);
+        break;
+    default:
+        /* No background work of their own; LVGL already skips drawing hidden pages. */
+        break;
+    }
+}
+
+const char *ui_widget_factory_kind_name(ui_widget_kind_t kind)
+{
+    return (kind < UI_WIDGET_KIND_COUNT) ? s_kind_names[kind] : "none";
+}
+
+void ui_widget_factory_get_render_stats(ui_widget_render_counter_t out_counters[UI_WIDGET_KIND_COUNT])
+{
+    if (out_counters == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < UI_WIDGET_KIND_COUNT; i++) {
+        out_counters[i].performed = __atomic_load_n(&s_render_counters[i].performed, __ATOMIC_RELAXED);
+        out_counters[i].skipped = __atomic_load_n(&s_render_counters[i].skipped, __ATOMIC_RELAXED);
     }
 }
@@ -9,33 +9,38 @@
 #include "lvgl.h"
 
 #include "app_config.h"
+#include "ha/ha_entity_ids.h"
 #include "ha/ha_model.h"
+#include "layout/layout_compiled.h"
 
+typedef enum {
+    UI_WIDGET_KIND_NONE = 0,
+    UI_WIDGET_KIND_SENSOR,
+    UI_WIDGET_KIND_BUTTON,
+    UI_WIDGET_KIND_SLIDER,
+    UI_WIDGET_KIND_GRAPH,
+    UI_WIDGET_KIND_EMPTY_TILE,
+    UI_WIDGET_KIND_LIGHT_TILE,
+    UI_WIDGET_KIND_HEATING_TILE,
+    UI_WIDGET_KIND_WEATHER_TILE,
+    UI_WIDGET_KIND_COUNT,
+} ui_widget_kind_t;
+
+/* Per widget type: applies that touched LVGL vs. applies that matched the last rendered view-model. */
 typedef struct {
-    char id[APP_MAX_WIDGET_ID_LEN];
-    char type[16];
-    char title[APP_MAX_NAME_LEN];
-    char entity_id[APP_MAX_ENTITY_ID_LEN];
-    char secondary_entity_id[APP_MAX_ENTITY_ID_LEN];
-    char slider_direction[APP_MAX_UI_OPTION_LEN];
-    char slider_accent_color[APP_MAX_COLOR_STR_LEN];
-    char button_accent_color[APP_MAX_COLOR_STR_LEN];
-    char button_mode[APP_MAX_UI_OPTION_LEN];
-    char graph_line_color[APP_MAX_COLOR_STR_LEN];
-    int graph_point_count;
-    int graph_time_window_min;
-    int x;
-    int y;
-    int w;
-    int h;
-} ui_widget_def_t;
+    uint32_t performed;
+    uint32_t skipped;
+} ui_widget_render_counter_t;
+
+/* Widgets are built from compiled layout definitions. */
+typedef layout_widget_def_t ui_widget_def_t;
 
 typedef struct {
     char id[APP_MAX_WIDGET_ID_LEN];
     char type[16];
     char title[APP_MAX_NAME_LEN];
-    char entity_id[APP_MAX_ENTITY_ID_LEN];
-    char secondary_entity_id[APP_MAX_ENTITY_ID_LEN];
+    ha_entity_handle_t entity;
+    ha_entity_handle_t secondary_entity;
     char slider_direction[APP_MAX_UI_OPTION_LEN];
     char slider_accent_color[APP_MAX_COLOR_STR_LEN];
     char button_accent_color[APP_MAX_COLOR_STR_LEN];
@@ -43,6 +48,7 @@ typedef struct {
     char graph_line_color[APP_MAX_COLOR_STR_LEN];
     int graph_point_count;
     int graph_time_window_min;
+    ui_widget_kind_t kind;
     void *ctx;
     lv_obj_t *obj;
 } ui_widget_instance_t;
@@ -50,3 +56,8 @@ typedef struct {
 esp_err_t ui_widget_factory_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
 void ui_widget_factory_apply_state(ui_widget_instance_t *instance, const ha_state_t *state);
 void ui_widget_factory_mark_unavailable(ui_widget_instance_t *instance);
+/* Page visibility change: widgets pause their own timers/animations while their page is hidden. */
+void ui_widget_factory_set_visible(ui_widget_instance_t *instance, bool visible);
+const char *ui_widget_factory_kind_name(ui_widget_kind_t kind);
+/* Snapshot of the render counters, indexed by ui_widget_kind_t. */
+void ui_widget_factory_get_render_stats(ui_widget_render_counter_t out_counters[UI_WIDGET_KIND_COUNT]);
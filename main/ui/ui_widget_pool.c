@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ui/ui_widget_pool.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "util/log_tags.h"
+
+typedef struct {
+    bool used;
+    uint32_t parked_seq;
+    ui_widget_def_t def;
+    ui_widget_instance_t instance;
+} ui_widget_pool_entry_t;
+
+static ui_widget_pool_entry_t *s_entries = NULL;
+/* Off-screen parent: a screen that is never loaded, so parked trees are neither drawn nor deleted
+ * when ui_pages cleans the active screen. */
+static lv_obj_t *s_park_screen = NULL;
+static uint32_t s_park_seq = 0;
+/* Written with the display lock held, read lock-free by diagnostics. */
+static ui_widget_pool_stats_t s_stats = {
+    .capacity = APP_UI_WIDGET_POOL_MAX,
+};
+
+static void ui_widget_pool_bump(uint32_t *counter, int32_t delta)
+{
+    __atomic_store_n(counter, *counter + (uint32_t)delta, __ATOMIC_RELAXED);
+}
+
+/* Everything a widget builds from, except its position inside the page. */
+bool ui_widget_pool_def_matches(const ui_widget_def_t *a, const ui_widget_def_t *b)
+{
+    return a->w == b->w && a->h == b->h && a->graph_point_count == b->graph_point_count &&
+           a->graph_time_window_min == b->graph_time_window_min && strcmp(a->type, b->type) == 0 &&
+           strcmp(a->id, b->id) == 0 && strcmp(a->title, b->title) == 0 &&
+           strcmp(a->entity_id, b->entity_id) == 0 && strcmp(a->secondary_entity_id, b->secondary_entity_id) == 0 &&
+           strcmp(a->slider_direction, b->slider_direction) == 0 &&
+           strcmp(a->slider_accent_color, b->slider_accent_color) == 0 &&
+           strcmp(a->button_accent_color, b->button_accent_color) == 0 &&
+           strcmp(a->button_mode, b->button_mode) == 0 && strcmp(a->graph_line_color, b->graph_line_color) == 0;
+}
+
+static void ui_widget_pool_discard(ui_widget_pool_entry_t *entry)
+{
+    if (entry->instance.obj != NULL) {
+        /* LV_EVENT_DELETE frees the widget ctx. */
+        lv_obj_delete(entry->instance.obj);
+    }
+    memset(entry, 0, sizeof(*entry));
+    ui_widget_pool_bump(&s_stats.parked, -1);
+    ui_widget_pool_bump(&s_stats.discarded, 1);
+}
+
+esp_err_t ui_widget_pool_init(void)
+{
+    if (s_entries == NULL) {
+        s_entries = heap_caps_calloc(APP_UI_WIDGET_POOL_MAX, sizeof(*s_entries), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_entries == NULL) {
+            s_entries = heap_caps_calloc(APP_UI_WIDGET_POOL_MAX, sizeof(*s_entries), MALLOC_CAP_8BIT);
+        }
+        if (s_entries == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_park_screen == NULL) {
+        s_park_screen = lv_obj_create(NULL);
+        if (s_park_screen == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+bool ui_widget_pool_take(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance)
+{
+    if (s_entries == NULL || def == NULL || parent == NULL || out_instance == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < APP_UI_WIDGET_POOL_MAX; i++) {
+        ui_widget_pool_entry_t *entry = &s_entries[i];
+        if (!entry->used || !ui_widget_pool_def_matches(&entry->def, def)) {
+            continue;
+        }
+        *out_instance = entry->instance;
+        lv_obj_set_parent(out_instance->obj, parent);
+        lv_obj_set_pos(out_instance->obj, def->x, def->y);
+        ui_widget_factory_set_visible(out_instance, true);
+        memset(entry, 0, sizeof(*entry));
+        ui_widget_pool_bump(&s_stats.parked, -1);
+        ui_widget_pool_bump(&s_stats.hits, 1);
+        return true;
+    }
+    ui_widget_pool_bump(&s_stats.misses, 1);
+    return false;
+}
+
+void ui_widget_pool_park(const ui_widget_def_t *def, ui_widget_instance_t *instance)
+{
+    if (instance == NULL || instance->obj == NULL) {
+        return;
+    }
+    if (s_entries == NULL || s_park_screen == NULL || def == NULL) {
+        lv_obj_delete(instance->obj);
+        return;
+    }
+
+    ui_widget_pool_entry_t *slot = NULL;
+    ui_widget_pool_entry_t *oldest = NULL;
+    for (size_t i = 0; i < APP_UI_WIDGET_POOL_MAX; i++) {
+        ui_widget_pool_entry_t *entry = &s_entries[i];
+        if (!entry->used) {
+            slot = entry;
+            break;
+        }
+        if (oldest == NULL || (int32_t)(entry->parked_seq - oldest->parked_seq) < 0) {
+            oldest = entry;
+        }
+    }
+    if (slot == NULL) {
+        ui_widget_pool_discard(oldest);
+        slot = oldest;
+    }
+
+    ui_widget_factory_set_visible(instance, false);
+    lv_obj_set_parent(instance->obj, s_park_screen);
+    slot->used = true;
+    slot->parked_seq = ++s_park_seq;
+    slot->def = *def;
+    slot->instance = *instance;
+    ui_widget_pool_bump(&s_stats.parked, 1);
+}
+
+void ui_widget_pool_retain(const ui_widget_def_t *defs, size_t count)
+{
+    if (s_entries == NULL) {
+        return;
+    }
+    size_t before = s_stats.parked;
+    for (size_t i = 0; i < APP_UI_WIDGET_POOL_MAX; i++) {
+        ui_widget_pool_entry_t *entry = &s_entries[i];
+        if (!entry->used) {
+            continue;
+        }
+        bool wanted = false;
+        for (size_t d = 0; d < count && !wanted; d++) {
+            wanted = ui_widget_pool_def_matches(&entry->def, &defs[d]);
+        }
+        if (!wanted) {
+            ui_widget_pool_discard(entry);
+        }
+    }
+    if (before != s_stats.parked) {
+        ESP_LOGD(TAG_UI, "Widget pool: dropped %u trees the new layout cannot reuse",
+            (unsigned)(before - s_stats.parked));
+    }
+}
+
+void ui_widget_pool_get_stats(ui_widget_pool_stats_t *out_stats)
+{
+    if (out_stats == NULL) {
+        return;
+    }
+    out_stats->parked = __atomic_load_n(&s_stats.parked, __ATOMIC_RELAXED);
+    out_stats->capacity = s_stats.capacity;
+    out_stats->hits = __atomic_load_n(&s_stats.hits, __ATOMIC_RELAXED);
+    out_stats->misses = __atomic_load_n(&s_stats.misses, __ATOMIC_RELAXED);
+    out_stats->discarded = __atomic_load_n(&s_stats.discarded, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "ui/ui_widget_factory.h"
+
+/* Parked widget object trees in one flat pool. A tree leaves the screen on page eviction or layout
+ * reload and is only adopted again by a def equal to its own except for position (same widget id,
+ * type, size and options), so unchanged widgets are moved instead of rebuilt. All calls need the
+ * display lock. */
+
+typedef struct {
+    uint32_t parked;
+    uint32_t capacity;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t discarded;
+} ui_widget_pool_stats_t;
+
+esp_err_t ui_widget_pool_init(void);
+/* True when a tree built from a can serve b: every field equal except x/y. */
+bool ui_widget_pool_def_matches(const ui_widget_def_t *a, const ui_widget_def_t *b);
+/* Adopts a parked tree whose def differs from def only in x/y: re-parented, moved and resumed. */
+bool ui_widget_pool_take(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget_instance_t *out_instance);
+/* Pauses and parks instance (built from def); the oldest parked tree is deleted when full. */
+void ui_widget_pool_park(const ui_widget_def_t *def, ui_widget_instance_t *instance);
+/* Deletes parked trees that no def in defs[0..count) can adopt. */
+void ui_widget_pool_retain(const ui_widget_def_t *defs, size_t count);
+void ui_widget_pool_get_stats(ui_widget_pool_stats_t *out_stats);
@@ -35,6 +35,9 @@ typedef struct {
     bool suppress_event;
     bool is_on;
     bool unavailable;
+    /* What button_apply_visual last drew (is_on/unavailable above plus the status text). */
+    bool rendered_valid;
+    char rendered_status[APP_MAX_STATE_LEN];
 } w_button_ctx_t;
 
 static const uint32_t W_BUTTON_SWITCH_TRACK_OFF_HEX = 0x3A3E43;
@@ -527,6 +530,14 @@ static void button_apply_visual(lv_obj_t *card, w_button_ctx_t *ctx, bool is_on,
             ctx->state_label,
             button_translate_status_text(status_text != NULL ? status_text : (is_on ? "ON" : "OFF")));
     }
+    snprintf(ctx->rendered_status, sizeof(ctx->rendered_status), "%s", (status_text != NULL) ? status_text : "");
+    ctx->rendered_valid = true;
+}
+
+static bool button_view_matches(const w_button_ctx_t *ctx, bool is_on, bool unavailable, const char *status_text)
+{
+    return ctx->rendered_valid && ctx->is_on == is_on && ctx->unavailable == unavailable &&
+           strncmp(ctx->rendered_status, (status_text != NULL) ? status_text : "", sizeof(ctx->rendered_status)) == 0;
 }
 
 static const char *button_status_text_for_state(const w_button_ctx_t *ctx, const ha_state_t *state, bool is_on, bool unavailable)
@@ -716,33 +727,38 @@ esp_err_t w_button_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widge
     return ESP_OK;
 }
 
-void w_button_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_button_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
 
     w_button_ctx_t *ctx = (w_button_ctx_t *)instance->ctx;
     if (ctx == NULL) {
-        return;
+        return false;
     }
 
     const bool unavailable = state_is_unavailable(state->state);
     const bool is_on = state_is_on(state->state);
     const char *status_text = button_status_text_for_state(ctx, state, is_on, unavailable);
+    if (button_view_matches(ctx, is_on, unavailable, status_text)) {
+        return false;
+    }
     button_apply_visual(instance->obj, ctx, is_on, unavailable, status_text);
+    return true;
 }
 
-void w_button_mark_unavailable(ui_widget_instance_t *instance)
+bool w_button_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
 
     w_button_ctx_t *ctx = (w_button_ctx_t *)instance->ctx;
-    if (ctx == NULL) {
-        return;
+    if (ctx == NULL || button_view_matches(ctx, false, true, "unavailable")) {
+        return false;
     }
 
     button_apply_visual(instance->obj, ctx, false, true, "unavailable");
+    return true;
 }
@@ -43,13 +43,15 @@ esp_err_t w_empty_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_w
     return ESP_OK;
 }
 
-void w_empty_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_empty_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     (void)instance;
     (void)state;
+    return false;
 }
 
-void w_empty_tile_mark_unavailable(ui_widget_instance_t *instance)
+bool w_empty_tile_mark_unavailable(ui_widget_instance_t *instance)
 {
     (void)instance;
+    return false;
 }
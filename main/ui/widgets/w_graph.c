@@ -3,23 +3,15 @@
  */
 #include "ui/ui_widget_factory.h"
 
-#include <ctype.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <time.h>
 
-#include "cJSON.h"
 #include "esp_err.h"
-#include "esp_heap_caps.h"
-#include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-#include "freertos/task.h"
 
+#include "ha/ha_history.h"
 #include "ui/fonts/app_text_fonts.h"
 #include "ui/ui_i18n.h"
 #include "ui/theme/theme_default.h"
@@ -32,56 +24,24 @@
 #define GRAPH_TIME_WINDOW_MIN_MAX 1440
 #define GRAPH_DEFAULT_TIME_WINDOW_MIN 120
 
-#define GRAPH_HISTORY_BUCKET_SEC 60U
-#define GRAPH_HISTORY_RETENTION_MIN 1440U
-#define GRAPH_HISTORY_RETENTION_SEC (GRAPH_HISTORY_RETENTION_MIN * 60U)
-#define GRAPH_HISTORY_MAX_SAMPLES ((int)(GRAPH_HISTORY_RETENTION_SEC / GRAPH_HISTORY_BUCKET_SEC))
-#define GRAPH_HISTORY_SAVE_INTERVAL_SEC 120U
-#define GRAPH_HISTORY_PERSIST_QUEUE_LEN 4U
-#define GRAPH_HISTORY_PERSIST_TASK_STACK 4096
-#define GRAPH_HISTORY_PERSIST_TASK_PRIO 2
-
-#define GRAPH_HISTORY_FILE_MAGIC 0x47525048U
-#define GRAPH_HISTORY_FILE_VERSION 1U
-#define GRAPH_HISTORY_DIR "/littlefs/graphs"
-#define GRAPH_HISTORY_PATH_MAX 128
-
 #define GRAPH_VALUE_SCALE 10
-#define GRAPH_VALID_EPOCH_MIN 1609459200U
-
-typedef struct {
-    uint32_t bucket_ts;
-    float value;
-} graph_sample_t;
-
-typedef struct {
-    uint32_t magic;
-    uint16_t version;
-    uint16_t reserved;
-    uint32_t count;
-} graph_history_file_header_t;
-
-typedef struct {
-    char history_path[GRAPH_HISTORY_PATH_MAX];
-    int history_count;
-    uint32_t bucket_ts;
-    graph_sample_t history[GRAPH_HISTORY_MAX_SAMPLES];
-} graph_history_persist_job_t;
 
+/* A view of the entity's ha_history series: the widget keeps only what it draws. */
 typedef struct {
     lv_obj_t *card;
     lv_obj_t *title_label;
     lv_obj_t *value_label;
     lv_obj_t *meta_label;
     lv_obj_t *chart;
+    /* Average line drawn over a dimmer min/max band. */
     lv_chart_series_t *series;
+    lv_chart_series_t *band_max_series;
+    lv_chart_series_t *band_min_series;
 
     char unit[16];
-    char history_path[GRAPH_HISTORY_PATH_MAX];
-    graph_sample_t history[GRAPH_HISTORY_MAX_SAMPLES];
-    int history_count;
-    bool history_dirty;
-    uint32_t last_persist_bucket_ts;
+    ha_entity_handle_t entity;
+    /* Series revision the chart was last drawn from. */
+    uint32_t history_revision;
 
     int configured_point_count;
     int point_count;
@@ -92,10 +52,8 @@ typedef struct {
     bool unavailable;
 } w_graph_ctx_t;
 
-static const char *TAG = "w_graph";
-static bool s_graph_history_dir_ready = false;
-static QueueHandle_t s_graph_persist_queue = NULL;
-static TaskHandle_t s_graph_persist_task = NULL;
+/* Slots of the chart being rebuilt; charts are only rebuilt on the LVGL task. */
+static ha_history_slot_t s_graph_slots[GRAPH_POINTS_MAX];
 
 static bool graph_state_is_unavailable(const char *state_text)
 {
@@ -258,374 +216,19 @@ static int graph_clamp_time_window_min(int configured)
     return configured;
 }
 
-static bool graph_is_epoch_valid(time_t epoch)
-{
-    if (epoch < 0) {
-        return false;
-    }
-    return (uint32_t)epoch >= GRAPH_VALID_EPOCH_MIN;
-}
-
-static uint32_t graph_current_bucket_ts(void)
-{
-    time_t now = time(NULL);
-    if (!graph_is_epoch_valid(now)) {
-        return 0U;
-    }
-    uint32_t now_u = (uint32_t)now;
-    return now_u - (now_u % GRAPH_HISTORY_BUCKET_SEC);
-}
-
 static uint32_t graph_display_now_bucket_ts(const w_graph_ctx_t *ctx)
 {
-    uint32_t now_bucket = graph_current_bucket_ts();
+    uint32_t now_bucket = ha_history_now_bucket_ts();
     if (now_bucket != 0U) {
         return now_bucket;
     }
-    if (ctx != NULL && ctx->history_count > 0) {
-        return ctx->history[ctx->history_count - 1].bucket_ts;
+    uint32_t newest = 0U;
+    if (ctx != NULL && ha_history_span(ctx->entity, NULL, &newest)) {
+        return newest;
     }
     return 0U;
 }
 
-static void graph_sanitize_widget_id(const char *widget_id, char *dst, size_t dst_size)
-{
-    if (dst == NULL || dst_size == 0) {
-        return;
-    }
-
-    size_t out = 0;
-    if (widget_id != NULL) {
-        for (size_t i = 0; widget_id[i] != '\0' && out < (dst_size - 1U); i++) {
-            unsigned char c = (unsigned char)widget_id[i];
-            if (isalnum(c) || c == '_' || c == '-') {
-                dst[out++] = (char)c;
-            } else {
-                dst[out++] = '_';
-            }
-        }
-    }
-
-    if (out == 0U) {
-        snprintf(dst, dst_size, "graph");
-    } else {
-        dst[out] = '\0';
-    }
-}
-
-static bool graph_ensure_history_dir(void)
-{
-    if (s_graph_history_dir_ready) {
-        return true;
-    }
-
-    struct stat st = {0};
-    if (stat(GRAPH_HISTORY_DIR, &st) == 0 && S_ISDIR(st.st_mode)) {
-        s_graph_history_dir_ready = true;
-        return true;
-    }
-
-    (void)mkdir(GRAPH_HISTORY_DIR, 0775);
-    if (stat(GRAPH_HISTORY_DIR, &st) == 0 && S_ISDIR(st.st_mode)) {
-        s_graph_history_dir_ready = true;
-        return true;
-    }
-
-    return false;
-}
-
-static void graph_build_history_path(const char *widget_id, char *dst, size_t dst_size)
-{
-    if (dst == NULL || dst_size == 0) {
-        return;
-    }
-    dst[0] = '\0';
-
-    if (!graph_ensure_history_dir()) {
-        return;
-    }
-
-    char safe_id[APP_MAX_WIDGET_ID_LEN] = {0};
-    graph_sanitize_widget_id(widget_id, safe_id, sizeof(safe_id));
-    snprintf(dst, dst_size, "%s/%s.grph", GRAPH_HISTORY_DIR, safe_id);
-}
-
-static void graph_history_drop_oldest(w_graph_ctx_t *ctx, int drop_count)
-{
-    if (ctx == NULL || drop_count <= 0 || ctx->history_count <= 0) {
-        return;
-    }
-    if (drop_count >= ctx->history_count) {
-        ctx->history_count = 0;
-        return;
-    }
-
-    memmove(ctx->history,
-        ctx->history + drop_count,
-        (size_t)(ctx->history_count - drop_count) * sizeof(ctx->history[0]));
-    ctx->history_count -= drop_count;
-}
-
-static void graph_history_trim_retention(w_graph_ctx_t *ctx, uint32_t newest_bucket_ts)
-{
-    if (ctx == NULL || ctx->history_count <= 0 || newest_bucket_ts == 0U) {
-        return;
-    }
-    if (newest_bucket_ts <= GRAPH_HISTORY_RETENTION_SEC) {
-        return;
-    }
-
-    uint32_t keep_after = newest_bucket_ts - GRAPH_HISTORY_RETENTION_SEC;
-    int drop = 0;
-    while (drop < ctx->history_count && ctx->history[drop].bucket_ts < keep_after) {
-        drop++;
-    }
-    graph_history_drop_oldest(ctx, drop);
-}
-
-static esp_err_t graph_history_load(w_graph_ctx_t *ctx)
-{
-    if (ctx == NULL || ctx->history_path[0] == '\0') {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    FILE *f = fopen(ctx->history_path, "rb");
-    if (f == NULL) {
-        return ESP_ERR_NOT_FOUND;
-    }
-
-    graph_history_file_header_t header = {0};
-    size_t got = fread(&header, 1U, sizeof(header), f);
-    if (got != sizeof(header) || header.magic != GRAPH_HISTORY_FILE_MAGIC ||
-        header.version != GRAPH_HISTORY_FILE_VERSION ||
-        header.count > (uint32_t)GRAPH_HISTORY_MAX_SAMPLES) {
-        fclose(f);
-        return ESP_FAIL;
-    }
-
-    size_t count = (size_t)header.count;
-    if (count > 0U) {
-        got = fread(ctx->history, sizeof(ctx->history[0]), count, f);
-        if (got != count) {
-            fclose(f);
-            ctx->history_count = 0;
-            return ESP_FAIL;
-        }
-    }
-    fclose(f);
-
-    ctx->history_count = (int)count;
-    for (int i = 1; i < ctx->history_count; i++) {
-        if (ctx->history[i].bucket_ts <= ctx->history[i - 1].bucket_ts) {
-            ctx->history_count = 0;
-            return ESP_FAIL;
-        }
-    }
-    if (ctx->history_count > 0) {
-        graph_history_trim_retention(ctx, ctx->history[ctx->history_count - 1].bucket_ts);
-    }
-    return ESP_OK;
-}
-
-static esp_err_t graph_history_save_buffer(const char *history_path, const graph_sample_t *history, int history_count)
-{
-    if (history_path == NULL || history_path[0] == '\0' || history_count < 0 || history_count > GRAPH_HISTORY_MAX_SAMPLES) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    FILE *f = fopen(history_path, "wb");
-    if (f == NULL) {
-        return ESP_FAIL;
-    }
-
-    graph_history_file_header_t header = {
-        .magic = GRAPH_HISTORY_FILE_MAGIC,
-        .version = GRAPH_HISTORY_FILE_VERSION,
-        .reserved = 0U,
-        .count = (uint32_t)history_count,
-    };
-
-    size_t written = fwrite(&header, 1U, sizeof(header), f);
-    if (written != sizeof(header)) {
-        fclose(f);
-        return ESP_FAIL;
-    }
-
-    if (history_count > 0) {
-        written = fwrite(history, sizeof(graph_sample_t), (size_t)history_count, f);
-        if (written != (size_t)history_count) {
-            fclose(f);
-            return ESP_FAIL;
-        }
-    }
-
-    fclose(f);
-    return ESP_OK;
-}
-
-static void graph_persist_task(void *arg)
-{
-    (void)arg;
-    while (true) {
-        graph_history_persist_job_t *job = NULL;
-        if (xQueueReceive(s_graph_persist_queue, &job, portMAX_DELAY) != pdTRUE) {
-            continue;
-        }
-        if (job == NULL) {
-            continue;
-        }
-
-        esp_err_t err = graph_history_save_buffer(job->history_path, job->history, job->history_count);
-        if (err != ESP_OK) {
-            ESP_LOGW(TAG, "async history save failed (%s, count=%d): %s",
-                job->history_path, job->history_count, esp_err_to_name(err));
-        }
-        free(job);
-    }
-}
-
-static void graph_persist_start_once(void)
-{
-    if (s_graph_persist_queue != NULL && s_graph_persist_task != NULL) {
-        return;
-    }
-
-    if (s_graph_persist_queue == NULL) {
-        s_graph_persist_queue = xQueueCreate(GRAPH_HISTORY_PERSIST_QUEUE_LEN, sizeof(graph_history_persist_job_t *));
-        if (s_graph_persist_queue == NULL) {
-            ESP_LOGW(TAG, "failed to create graph persist queue");
-            return;
-        }
-    }
-
-    if (s_graph_persist_task == NULL) {
-        BaseType_t created = xTaskCreate(graph_persist_task, "graph_persist", GRAPH_HISTORY_PERSIST_TASK_STACK, NULL,
-            GRAPH_HISTORY_PERSIST_TASK_PRIO, &s_graph_persist_task);
-        if (created != pdPASS) {
-            ESP_LOGW(TAG, "failed to start graph persist task");
-            vQueueDelete(s_graph_persist_queue);
-            s_graph_persist_queue = NULL;
-            return;
-        }
-    }
-}
-
-static bool graph_history_enqueue_persist(const w_graph_ctx_t *ctx, uint32_t bucket_ts)
-{
-    if (ctx == NULL || ctx->history_path[0] == '\0') {
-        return false;
-    }
-
-    graph_persist_start_once();
-    if (s_graph_persist_queue == NULL) {
-        return false;
-    }
-
-    graph_history_persist_job_t *job =
-        heap_caps_malloc(sizeof(graph_history_persist_job_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (job == NULL) {
-        job = malloc(sizeof(graph_history_persist_job_t));
-    }
-    if (job == NULL) {
-        ESP_LOGW(TAG, "failed to allocate graph persist job");
-        return false;
-    }
-
-    memset(job, 0, sizeof(*job));
-    snprintf(job->history_path, sizeof(job->history_path), "%s", ctx->history_path);
-    job->bucket_ts = bucket_ts;
-    job->history_count = ctx->history_count;
-    if (job->history_count > GRAPH_HISTORY_MAX_SAMPLES) {
-        job->history_count = GRAPH_HISTORY_MAX_SAMPLES;
-    }
-    if (job->history_count > 0) {
-        memcpy(job->history, ctx->history, (size_t)job->history_count * sizeof(job->history[0]));
-    }
-
-    if (xQueueSend(s_graph_persist_queue, &job, 0) != pdTRUE) {
-        graph_history_persist_job_t *dropped = NULL;
-        if (xQueueReceive(s_graph_persist_queue, &dropped, 0) == pdTRUE && dropped != NULL) {
-            free(dropped);
-        }
-        if (xQueueSend(s_graph_persist_queue, &job, 0) != pdTRUE) {
-            ESP_LOGW(TAG, "graph persist queue full, dropping snapshot");
-            free(job);
-            return false;
-        }
-    }
-
-    return true;
-}
-
-static void graph_history_try_persist(w_graph_ctx_t *ctx, uint32_t bucket_ts, bool force)
-{
-    if (ctx == NULL || ctx->history_path[0] == '\0' || !ctx->history_dirty) {
-        return;
-    }
-
-    if (!force) {
-        if (GRAPH_HISTORY_SAVE_INTERVAL_SEC == 0U || bucket_ts == 0U) {
-            return;
-        }
-
-        if (ctx->last_persist_bucket_ts != 0U) {
-            uint32_t elapsed = (bucket_ts >= ctx->last_persist_bucket_ts) ? (bucket_ts - ctx->last_persist_bucket_ts) : 0U;
-            if (elapsed < GRAPH_HISTORY_SAVE_INTERVAL_SEC) {
-                return;
-            }
-        }
-    }
-
-    if (graph_history_enqueue_persist(ctx, bucket_ts)) {
-        ctx->history_dirty = false;
-        if (bucket_ts != 0U) {
-            ctx->last_persist_bucket_ts = bucket_ts;
-        } else if (ctx->history_count > 0) {
-            ctx->last_persist_bucket_ts = ctx->history[ctx->history_count - 1].bucket_ts;
-        }
-    }
-}
-
-static bool graph_history_append_or_update(w_graph_ctx_t *ctx, uint32_t bucket_ts, float value, bool *out_appended)
-{
-    if (out_appended != NULL) {
-        *out_appended = false;
-    }
-    if (ctx == NULL || bucket_ts == 0U) {
-        return false;
-    }
-
-    if (ctx->history_count > 0) {
-        graph_sample_t *last = &ctx->history[ctx->history_count - 1];
-        if (last->bucket_ts == bucket_ts) {
-            float delta = last->value - value;
-            if (delta < 0.0f) {
-                delta = -delta;
-            }
-            if (delta < 0.0001f) {
-                return false;
-            }
-            last->value = value;
-            return true;
-        }
-        if (bucket_ts < last->bucket_ts) {
-            return false;
-        }
-    }
-
-    if (ctx->history_count >= GRAPH_HISTORY_MAX_SAMPLES) {
-        graph_history_drop_oldest(ctx, 1);
-    }
-    ctx->history[ctx->history_count].bucket_ts = bucket_ts;
-    ctx->history[ctx->history_count].value = value;
-    ctx->history_count++;
-    graph_history_trim_retention(ctx, bucket_ts);
-    if (out_appended != NULL) {
-        *out_appended = true;
-    }
-    return true;
-}
-
 static int graph_desired_point_count(const w_graph_ctx_t *ctx)
 {
     if (ctx == NULL || ctx->card == NULL) {
@@ -644,25 +247,26 @@ static int graph_desired_point_count(const w_graph_ctx_t *ctx)
     return desired;
 }
 
+
 static int graph_max_history_offset_min(const w_graph_ctx_t *ctx, uint32_t now_bucket_ts)
 {
-    if (ctx == NULL || ctx->history_count <= 0 || now_bucket_ts == 0U) {
+    uint32_t oldest = 0U;
+    if (ctx == NULL || now_bucket_ts == 0U || !ha_history_span(ctx->entity, &oldest, NULL)) {
         return 0;
     }
-
-    uint32_t oldest = ctx->history[0].bucket_ts;
     if (now_bucket_ts <= oldest) {
         return 0;
     }
 
     uint32_t delta = now_bucket_ts - oldest;
     int max_offset = (int)(delta / 60U);
-    if (max_offset > (int)GRAPH_HISTORY_RETENTION_MIN) {
-        max_offset = (int)GRAPH_HISTORY_RETENTION_MIN;
+    if (max_offset > (int)APP_HA_HISTORY_RETENTION_MIN) {
+        max_offset = (int)APP_HA_HISTORY_RETENTION_MIN;
     }
     return max_offset;
 }
 
+
 static int graph_pan_step_min(const w_graph_ctx_t *ctx)
 {
     if (ctx == NULL) {
@@ -703,7 +307,8 @@ static void graph_rebuild_chart(w_graph_ctx_t *ctx)
     graph_format_duration(window_text, sizeof(window_text), ctx->time_window_min);
     graph_format_duration(offset_text, sizeof(offset_text), ctx->history_offset_min);
 
-    if (now_bucket == 0U || ctx->history_count <= 0) {
+    ctx->history_revision = ha_history_revision(ctx->entity);
+    if (now_bucket == 0U || !ha_history_span(ctx->entity, NULL, NULL)) {
         lv_obj_add_flag(ctx->chart, LV_OBJ_FLAG_HIDDEN);
         char meta_text[64] = {0};
         snprintf(meta_text, sizeof(meta_text), "%s | %s", ui_i18n_get("graph.no_history", "no history"), window_text);
@@ -715,56 +320,37 @@ static void graph_rebuild_chart(w_graph_ctx_t *ctx)
     uint32_t offset_sec = (uint32_t)ctx->history_offset_min * 60U;
     uint32_t end_ts = (now_bucket > offset_sec) ? (now_bucket - offset_sec) : 0U;
     uint32_t start_ts = (end_ts > window_sec) ? (end_ts - window_sec) : 0U;
-
-    for (int i = 0; i < ctx->point_count; i++) {
-        lv_chart_set_value_by_id(ctx->chart, ctx->series, (uint32_t)i, LV_CHART_POINT_NONE);
-    }
-
-    int history_idx = 0;
-    while (history_idx < ctx->history_count && ctx->history[history_idx].bucket_ts < start_ts) {
-        history_idx++;
-    }
+    (void)ha_history_query(ctx->entity, start_ts, window_sec, s_graph_slots, ctx->point_count);
 
     bool has_values = false;
     float min_v = 0.0f;
     float max_v = 0.0f;
 
     for (int i = 0; i < ctx->point_count; i++) {
-        uint32_t slot_start = start_ts + (uint32_t)(((uint64_t)window_sec * (uint64_t)i) / (uint64_t)ctx->point_count);
-        uint32_t slot_end = start_ts + (uint32_t)(((uint64_t)window_sec * (uint64_t)(i + 1)) / (uint64_t)ctx->point_count);
-        if (slot_end <= slot_start) {
-            slot_end = slot_start + 1U;
+        const ha_history_slot_t *slot = &s_graph_slots[i];
+        if (slot->count == 0U) {
+            lv_chart_set_value_by_id(ctx->chart, ctx->series, (uint32_t)i, LV_CHART_POINT_NONE);
+            lv_chart_set_value_by_id(ctx->chart, ctx->band_max_series, (uint32_t)i, LV_CHART_POINT_NONE);
+            lv_chart_set_value_by_id(ctx->chart, ctx->band_min_series, (uint32_t)i, LV_CHART_POINT_NONE);
+            continue;
         }
-        bool is_last_slot = (i == (ctx->point_count - 1));
-
-        bool slot_has_value = false;
-        float slot_value = 0.0f;
-
-        while (history_idx < ctx->history_count) {
-            uint32_t ts = ctx->history[history_idx].bucket_ts;
-            if (is_last_slot ? (ts > slot_end) : (ts >= slot_end)) {
-                break;
+        lv_chart_set_value_by_id(ctx->chart, ctx->series, (uint32_t)i, graph_scaled_value(slot->avg));
+        /* The band only shows where the slot's extremes differ from its average line. */
+        bool band = graph_scaled_value(slot->max) != graph_scaled_value(slot->min);
+        lv_chart_set_value_by_id(ctx->chart, ctx->band_max_series, (uint32_t)i,
+            band ? graph_scaled_value(slot->max) : LV_CHART_POINT_NONE);
+        lv_chart_set_value_by_id(ctx->chart, ctx->band_min_series, (uint32_t)i,
+            band ? graph_scaled_value(slot->min) : LV_CHART_POINT_NONE);
+        if (!has_values) {
+            min_v = slot->min;
+            max_v = slot->max;
+            has_values = true;
+        } else {
+            if (slot->min < min_v) {
+                min_v = slot->min;
             }
-            if (ts >= slot_start) {
-                slot_has_value = true;
-                slot_value = ctx->history[history_idx].value;
-            }
-            history_idx++;
-        }
-
-        if (slot_has_value) {
-            lv_chart_set_value_by_id(ctx->chart, ctx->series, (uint32_t)i, graph_scaled_value(slot_value));
-            if (!has_values) {
-                min_v = slot_value;
-                max_v = slot_value;
-                has_values = true;
-            } else {
-                if (slot_value < min_v) {
-                    min_v = slot_value;
-                }
-                if (slot_value > max_v) {
-                    max_v = slot_value;
-                }
+            if (slot->max > max_v) {
+                max_v = slot->max;
             }
         }
     }
@@ -943,7 +529,6 @@ static void w_graph_event_cb(lv_event_t *event)
 
     lv_event_code_t code = lv_event_get_code(event);
     if (code == LV_EVENT_DELETE) {
-        graph_history_try_persist(ctx, graph_display_now_bucket_ts(ctx), true);
         free(ctx);
     } else if (code == LV_EVENT_SIZE_CHANGED) {
         graph_apply_layout(ctx);
@@ -1014,9 +599,8 @@ esp_err_t w_graph_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget
     ctx->value_label = value;
     ctx->meta_label = meta;
     ctx->chart = chart;
-    ctx->history_count = 0;
-    ctx->history_dirty = false;
-    ctx->last_persist_bucket_ts = 0U;
+    ctx->entity = ha_entity_ids_intern(def->entity_id);
+    ctx->history_revision = 0U;
     ctx->configured_point_count = graph_clamp_point_count(def->graph_point_count);
     ctx->point_count = (ctx->configured_point_count > 0) ? ctx->configured_point_count : GRAPH_DEFAULT_POINT_COUNT;
     ctx->time_window_min = graph_clamp_time_window_min(def->graph_time_window_min);
@@ -1028,17 +612,14 @@ esp_err_t w_graph_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget
     }
     ctx->unavailable = true;
     ctx->unit[0] = '\0';
-    graph_build_history_path(def->id, ctx->history_path, sizeof(ctx->history_path));
-    if (ctx->history_path[0] != '\0') {
-        (void)graph_history_load(ctx);
-        if (ctx->history_count > 0) {
-            ctx->last_persist_bucket_ts = ctx->history[ctx->history_count - 1].bucket_ts;
-        }
-    }
 
     lv_chart_set_point_count(chart, (uint32_t)ctx->point_count);
+    /* Series are drawn in the order added: the band first, the average line on top. */
+    lv_color_t band_color = lv_color_mix(ctx->line_color, lv_color_hex(APP_UI_COLOR_CARD_BG_OFF), LV_OPA_40);
+    ctx->band_max_series = lv_chart_add_series(chart, band_color, LV_CHART_AXIS_PRIMARY_Y);
+    ctx->band_min_series = lv_chart_add_series(chart, band_color, LV_CHART_AXIS_PRIMARY_Y);
     ctx->series = lv_chart_add_series(chart, ctx->line_color, LV_CHART_AXIS_PRIMARY_Y);
-    if (ctx->series == NULL) {
+    if (ctx->series == NULL || ctx->band_max_series == NULL || ctx->band_min_series == NULL) {
         free(ctx);
         lv_obj_del(card);
         return ESP_ERR_NO_MEM;
@@ -1056,37 +637,39 @@ esp_err_t w_graph_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widget
     return ESP_OK;
 }
 
-void w_graph_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+static bool graph_set_value_text(w_graph_ctx_t *ctx, const char *text)
+{
+    const char *current = lv_label_get_text(ctx->value_label);
+    if (current != NULL && strcmp(current, text) == 0) {
+        return false;
+    }
+    lv_label_set_text(ctx->value_label, text);
+    return true;
+}
+
+bool w_graph_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
 
     w_graph_ctx_t *ctx = (w_graph_ctx_t *)instance->ctx;
     if (ctx == NULL) {
-        return;
+        return false;
     }
 
     bool was_unavailable = ctx->unavailable;
 
     if (graph_state_is_unavailable(state->state)) {
+        if (was_unavailable) {
+            return false;
+        }
         graph_apply_unavailable(ctx);
-        return;
+        return true;
     }
 
-    const char *unit = NULL;
-    cJSON *attrs = cJSON_Parse(state->attributes_json);
-    if (attrs != NULL) {
-        cJSON *unit_item = cJSON_GetObjectItemCaseSensitive(attrs, "unit_of_measurement");
-        if (cJSON_IsString(unit_item) && unit_item->valuestring != NULL) {
-            unit = unit_item->valuestring;
-        }
-    }
-    if (unit != NULL && unit[0] != '\0') {
-        snprintf(ctx->unit, sizeof(ctx->unit), "%s", unit);
-    }
-    if (attrs != NULL) {
-        cJSON_Delete(attrs);
+    if (state->attrs.unit[0] != '\0') {
+        snprintf(ctx->unit, sizeof(ctx->unit), "%s", state->attrs.unit);
     }
 
     float numeric = 0.0f;
@@ -1094,39 +677,50 @@ void w_graph_apply_state(ui_widget_instance_t *instance, const ha_state_t *state
     ctx->unavailable = false;
 
     if (!parsed) {
-        lv_label_set_text(ctx->value_label, state->state);
+        bool rendered = graph_set_value_text(ctx, state->state);
         if (was_unavailable) {
             graph_rebuild_chart(ctx);
+            rendered = true;
         }
-        return;
+        return rendered;
     }
 
     char value_text[48] = {0};
     graph_format_value(value_text, sizeof(value_text), numeric, ctx->unit);
-    lv_label_set_text(ctx->value_label, value_text);
-
-    uint32_t bucket_ts = graph_current_bucket_ts();
-    bool history_changed = graph_history_append_or_update(ctx, bucket_ts, numeric, NULL);
-    if (history_changed) {
-        ctx->history_dirty = true;
-        graph_history_try_persist(ctx, bucket_ts, false);
-    }
+    bool rendered = graph_set_value_text(ctx, value_text);
 
+    /* ha_model recorded the sample before this widget was marked dirty. */
+    bool history_changed = ha_history_revision(ctx->entity) != ctx->history_revision;
     if (was_unavailable || history_changed) {
         graph_rebuild_chart(ctx);
+        rendered = true;
     }
+    return rendered;
 }
 
-void w_graph_mark_unavailable(ui_widget_instance_t *instance)
+bool w_graph_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
 
     w_graph_ctx_t *ctx = (w_graph_ctx_t *)instance->ctx;
-    if (ctx == NULL) {
-        return;
+    if (ctx == NULL || ctx->unavailable) {
+        return false;
     }
 
     graph_apply_unavailable(ctx);
+    return true;
+}
+
+void w_graph_set_visible(ui_widget_instance_t *instance, bool visible)
+{
+    w_graph_ctx_t *ctx = (instance != NULL) ? (w_graph_ctx_t *)instance->ctx : NULL;
+    if (ctx == NULL || !visible) {
+        return;
+    }
+    /* History can grow without a state change (backfill), which the page catch-up does not see. */
+    if (ha_history_revision(ctx->entity) != ctx->history_revision) {
+        graph_rebuild_chart(ctx);
+    }
 }
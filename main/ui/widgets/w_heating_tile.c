@@ -8,7 +8,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "cJSON.h"
 
 #include "ui/fonts/app_text_fonts.h"
 #include "ui/ui_bindings.h"
@@ -27,6 +26,15 @@
 #define HEATING_TARGET_FONT APP_FONT_TEXT_16
 #endif
 
+/* The subset of ctx that heating_apply_visual turns into pixels. */
+typedef struct {
+    bool is_on;
+    float target_temp;
+    float current_temp;
+    bool has_current_temp;
+    char status_text[32];
+} heating_view_t;
+
 typedef struct {
     char climate_entity_id[APP_MAX_ENTITY_ID_LEN];
     char sensor_entity_id[APP_MAX_ENTITY_ID_LEN];
@@ -41,6 +49,8 @@ typedef struct {
     lv_obj_t *target_label;
     lv_obj_t *actual_label;
     lv_obj_t *status_label;
+    heating_view_t rendered;
+    bool rendered_valid;
 } w_heating_tile_ctx_t;
 
 typedef struct {
@@ -141,25 +151,17 @@ static void heating_extract_climate_values(const ha_state_t *state, heating_valu
     out->status_text[0] = '\0';
     bool has_target_temp = false;
 
-    cJSON *attrs = cJSON_Parse(state->attributes_json);
-    if (attrs != NULL) {
-        cJSON *temperature = cJSON_GetObjectItemCaseSensitive(attrs, "temperature");
-        if (cJSON_IsNumber(temperature)) {
-            out->target_temp = (float)temperature->valuedouble;
-            has_target_temp = true;
-        }
-
-        cJSON *current_temperature = cJSON_GetObjectItemCaseSensitive(attrs, "current_temperature");
-        if (cJSON_IsNumber(current_temperature)) {
-            out->current_temp = (float)current_temperature->valuedouble;
-            out->has_current_temp = true;
-        }
-
-        cJSON *hvac_action = cJSON_GetObjectItemCaseSensitive(attrs, "hvac_action");
-        if (cJSON_IsString(hvac_action) && hvac_action->valuestring != NULL && hvac_action->valuestring[0] != '\0') {
-            heating_copy_text(out->status_text, sizeof(out->status_text), hvac_action->valuestring);
-        }
-        cJSON_Delete(attrs);
+    const ha_state_attrs_t *attrs = &state->attrs;
+    if ((attrs->present & HA_ATTR_TEMPERATURE) != 0U) {
+        out->target_temp = attrs->temperature;
+        has_target_temp = true;
+    }
+    if ((attrs->present & HA_ATTR_CURRENT_TEMPERATURE) != 0U) {
+        out->current_temp = attrs->current_temperature;
+        out->has_current_temp = true;
+    }
+    if (attrs->hvac_action[0] != '\0') {
+        heating_copy_text(out->status_text, sizeof(out->status_text), attrs->hvac_action);
     }
 
     if (!has_target_temp) {
@@ -190,15 +192,9 @@ static bool heating_extract_sensor_temp(const ha_state_t *state, float *out_temp
         return true;
     }
 
-    cJSON *attrs = cJSON_Parse(state->attributes_json);
-    if (attrs != NULL) {
-        cJSON *value = cJSON_GetObjectItemCaseSensitive(attrs, "temperature");
-        if (cJSON_IsNumber(value)) {
-            *out_temp = clamp_temp((float)value->valuedouble);
-            cJSON_Delete(attrs);
-            return true;
-        }
-        cJSON_Delete(attrs);
+    if ((state->attrs.present & HA_ATTR_TEMPERATURE) != 0U) {
+        *out_temp = clamp_temp(state->attrs.temperature);
+        return true;
     }
 
     return false;
@@ -386,6 +382,26 @@ static void heating_apply_visual(lv_obj_t *card, w_heating_tile_ctx_t *ctx, bool
     heating_set_actual_label(actual_label, has_current_temp, current_temp, allow_status_fallback ? status_text : "");
     heating_set_status_label(status_label, is_on, status_text);
     heating_apply_layout(card, ctx);
+
+    ctx->rendered.is_on = is_on;
+    ctx->rendered.target_temp = target_temp;
+    ctx->rendered.current_temp = current_temp;
+    ctx->rendered.has_current_temp = has_current_temp;
+    heating_copy_text(ctx->rendered.status_text, sizeof(ctx->rendered.status_text), status_text);
+    ctx->rendered_valid = true;
+}
+
+static bool heating_view_matches_ctx(const w_heating_tile_ctx_t *ctx)
+{
+    const heating_view_t *view = &ctx->rendered;
+    if (!ctx->rendered_valid || view->is_on != ctx->is_on || view->target_temp != ctx->target_temp ||
+        view->has_current_temp != ctx->has_current_temp) {
+        return false;
+    }
+    if (ctx->has_current_temp && view->current_temp != ctx->current_temp) {
+        return false;
+    }
+    return strncmp(view->status_text, ctx->status_text, sizeof(view->status_text)) == 0;
 }
 
 static void heating_apply_from_ctx(lv_obj_t *card, const w_heating_tile_ctx_t *ctx)
@@ -439,6 +455,10 @@ static void w_heating_tile_arc_event_cb(lv_event_t *event)
     int value = (arc != NULL) ? lv_arc_get_value(arc) : 20;
 
     heating_set_target_label((ctx != NULL) ? ctx->target_label : NULL, (float)value);
+    if (ctx != NULL) {
+        /* The label now shows the dragged value; force the next state to redraw. */
+        ctx->rendered_valid = false;
+    }
 
     if (code == LV_EVENT_RELEASED) {
         if (ctx != NULL) {
@@ -554,18 +574,18 @@ esp_err_t w_heating_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui
     return ESP_OK;
 }
 
-void w_heating_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_heating_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
 
     w_heating_tile_ctx_t *ctx = (w_heating_tile_ctx_t *)instance->ctx;
     if (ctx == NULL) {
-        return;
+        return false;
     }
 
-    if (strncmp(state->entity_id, ctx->climate_entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
+    if (state->entity == instance->entity) {
         heating_values_t values = {0};
         heating_extract_climate_values(state, &values);
         ctx->is_on = heating_state_is_on(state->state);
@@ -575,8 +595,7 @@ void w_heating_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t
             ctx->has_current_temp = values.has_current_temp;
             ctx->current_temp = values.current_temp;
         }
-    } else if (ctx->sensor_entity_id[0] != '\0' &&
-               strncmp(state->entity_id, ctx->sensor_entity_id, APP_MAX_ENTITY_ID_LEN) == 0) {
+    } else if (instance->secondary_entity != HA_ENTITY_HANDLE_NONE && state->entity == instance->secondary_entity) {
         float sensor_temp = 0.0f;
         bool ok = heating_extract_sensor_temp(state, &sensor_temp);
         ctx->has_current_temp = ok;
@@ -584,16 +603,20 @@ void w_heating_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t
             ctx->current_temp = sensor_temp;
         }
     } else {
-        return;
+        return false;
     }
 
+    if (heating_view_matches_ctx(ctx)) {
+        return false;
+    }
     heating_apply_from_ctx(instance->obj, ctx);
+    return true;
 }
 
-void w_heating_tile_mark_unavailable(ui_widget_instance_t *instance)
+bool w_heating_tile_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
 
     w_heating_tile_ctx_t *ctx = (w_heating_tile_ctx_t *)instance->ctx;
@@ -601,8 +624,11 @@ void w_heating_tile_mark_unavailable(ui_widget_instance_t *instance)
         ctx->is_on = false;
         ctx->has_current_temp = false;
         heating_copy_text(ctx->status_text, sizeof(ctx->status_text), "unavailable");
+        if (heating_view_matches_ctx(ctx)) {
+            return false;
+        }
         heating_apply_from_ctx(instance->obj, ctx);
-        return;
+        return true;
     }
 
     w_heating_tile_ctx_t fallback = {0};
@@ -618,4 +644,5 @@ void w_heating_tile_mark_unavailable(ui_widget_instance_t *instance)
     fallback.actual_label = lv_obj_get_child(instance->obj, 4);
     fallback.status_label = lv_obj_get_child(instance->obj, 5);
     heating_apply_visual(instance->obj, &fallback, true);
+    return true;
 }
@@ -10,7 +10,6 @@
 #include <inttypes.h>
 #include <string.h>
 
-#include "cJSON.h"
 #include "esp_log.h"
 
 #include "ui/fonts/app_text_fonts.h"
@@ -19,12 +18,21 @@
 #include "ui/ui_i18n.h"
 #include "ui/theme/theme_default.h"
 
+typedef struct {
+    bool is_on;
+    bool unavailable;
+    int brightness;
+} light_view_t;
+
 typedef struct {
     char entity_id[APP_MAX_ENTITY_ID_LEN];
     bool is_on;
     int brightness;
     bool unavailable;
     lv_coord_t configured_min_dim;
+    /* What light_apply_visual last drew; state applies that match it are skipped. */
+    light_view_t rendered;
+    bool rendered_valid;
 } w_light_tile_ctx_t;
 
 #define ICON_CP_MDI_LIGHTBULB_ON 0xF06E8U
@@ -174,23 +182,17 @@ static void light_set_value_label(lv_obj_t *label, int value)
 static int light_extract_brightness_percent(const ha_state_t *state, bool is_on)
 {
     int value = -1;
-    cJSON *attrs = cJSON_Parse(state->attributes_json);
-    if (attrs != NULL) {
-        cJSON *brightness_pct = cJSON_GetObjectItemCaseSensitive(attrs, "brightness_pct");
-        cJSON *brightness = cJSON_GetObjectItemCaseSensitive(attrs, "brightness");
-        if (cJSON_IsNumber(brightness_pct)) {
-            value = (int)brightness_pct->valuedouble;
-        } else if (cJSON_IsNumber(brightness)) {
-            int raw_255 = (int)brightness->valuedouble;
-            if (raw_255 < 0) {
-                raw_255 = 0;
-            }
-            if (raw_255 > 255) {
-                raw_255 = 255;
-            }
-            value = (raw_255 * 100 + 127) / 255;
+    if ((state->attrs.present & HA_ATTR_BRIGHTNESS_PCT) != 0U) {
+        value = (int)state->attrs.brightness_pct;
+    } else if ((state->attrs.present & HA_ATTR_BRIGHTNESS) != 0U) {
+        int raw_255 = (int)state->attrs.brightness;
+        if (raw_255 < 0) {
+            raw_255 = 0;
+        }
+        if (raw_255 > 255) {
+            raw_255 = 255;
         }
-        cJSON_Delete(attrs);
+        value = (raw_255 * 100 + 127) / 255;
     }
     if (value < 0) {
         value = is_on ? 100 : 0;
@@ -453,7 +455,13 @@ static void light_position_icon_between_state_and_title(lv_obj_t *card, lv_coord
     lv_obj_align(icon, LV_ALIGN_TOP_MID, 0, y);
 }
 
-static void light_apply_visual(lv_obj_t *card, const w_light_tile_ctx_t *ctx, bool is_on, int brightness, const char *status_text)
+static bool light_view_matches(const w_light_tile_ctx_t *ctx, bool is_on, int brightness, bool unavailable)
+{
+    return ctx != NULL && ctx->rendered_valid && ctx->rendered.is_on == is_on &&
+           ctx->rendered.brightness == brightness && ctx->rendered.unavailable == unavailable;
+}
+
+static void light_apply_visual(lv_obj_t *card, w_light_tile_ctx_t *ctx, bool is_on, int brightness, const char *status_text)
 {
     if (card == NULL) {
         return;
@@ -493,6 +501,14 @@ static void light_apply_visual(lv_obj_t *card, const w_light_tile_ctx_t *ctx, bo
     lv_label_set_text(w.icon, light_icon_text_for_font(icon_font));
     lv_label_set_text(w.state_label, light_translate_status(status_text != NULL ? status_text : (is_on ? "ON" : "OFF")));
     light_position_icon_between_state_and_title(card, layout->icon_gap, layout->icon_bias_y);
+    if (ctx != NULL) {
+        ctx->rendered = (light_view_t){
+            .is_on = is_on,
+            .unavailable = (status_text != NULL && strcmp(status_text, "unavailable") == 0),
+            .brightness = brightness,
+        };
+        ctx->rendered_valid = true;
+    }
 }
 
 static void w_light_tile_card_event_cb(lv_event_t *event)
@@ -560,6 +576,8 @@ static void w_light_tile_slider_event_cb(lv_event_t *event)
     if (code == LV_EVENT_VALUE_CHANGED) {
         if (ctx != NULL) {
             ctx->brightness = clamp_percent(value);
+            /* The knob moved without light_apply_visual; the next state must redraw. */
+            ctx->rendered_valid = false;
         }
         light_set_value_label(value_label, value);
         return;
@@ -673,32 +691,40 @@ esp_err_t w_light_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_w
     return ESP_OK;
 }
 
-void w_light_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_light_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
     bool is_on = light_state_is_on(state->state);
     int brightness = light_extract_brightness_percent(state, is_on);
     w_light_tile_ctx_t *ctx = (w_light_tile_ctx_t *)instance->ctx;
+    if (light_view_matches(ctx, is_on, brightness, false)) {
+        return false;
+    }
     if (ctx != NULL) {
         ctx->is_on = is_on;
         ctx->brightness = brightness;
         ctx->unavailable = false;
     }
     light_apply_visual(instance->obj, ctx, is_on, brightness, is_on ? "ON" : "OFF");
+    return true;
 }
 
-void w_light_tile_mark_unavailable(ui_widget_instance_t *instance)
+bool w_light_tile_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
     w_light_tile_ctx_t *ctx = (w_light_tile_ctx_t *)instance->ctx;
+    if (light_view_matches(ctx, false, 0, true)) {
+        return false;
+    }
     if (ctx != NULL) {
         ctx->is_on = false;
         ctx->brightness = 0;
         ctx->unavailable = true;
     }
     light_apply_visual(instance->obj, ctx, false, 0, "unavailable");
+    return true;
 }
@@ -8,7 +8,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "cJSON.h"
 #include "esp_timer.h"
 
 #include "ui/fonts/app_text_fonts.h"
@@ -78,6 +77,9 @@ typedef struct {
     bool has_timestamp;
     bool unavailable;
     lv_timer_t *age_timer;
+    /* Value text last drawn; unavailable/last_update_ms above complete the view. */
+    bool rendered_valid;
+    char rendered_value[96];
 } w_sensor_ctx_t;
 
 static bool sensor_state_is_unavailable(const char *state_text)
@@ -236,6 +238,8 @@ static void sensor_apply_unavailable(w_sensor_ctx_t *ctx)
     sensor_set_value_text(ctx, ui_i18n_get("common.unavailable", "unavailable"));
     sensor_update_age_label(ctx);
     sensor_apply_layout(ctx);
+    ctx->rendered_value[0] = '\0';
+    ctx->rendered_valid = true;
 }
 
 static void sensor_age_timer_cb(lv_timer_t *timer)
@@ -333,40 +337,36 @@ esp_err_t w_sensor_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widge
     return ESP_OK;
 }
 
-void w_sensor_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_sensor_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
 
     w_sensor_ctx_t *ctx = (w_sensor_ctx_t *)instance->ctx;
     if (ctx == NULL) {
-        return;
+        return false;
     }
 
     if (sensor_state_is_unavailable(state->state)) {
+        if (ctx->rendered_valid && ctx->unavailable) {
+            return false;
+        }
         sensor_apply_unavailable(ctx);
-        return;
+        return true;
     }
 
     char value_text[96] = {0};
-    const char *unit = NULL;
-    cJSON *attrs = cJSON_Parse(state->attributes_json);
-    if (attrs != NULL) {
-        cJSON *unit_item = cJSON_GetObjectItemCaseSensitive(attrs, "unit_of_measurement");
-        if (cJSON_IsString(unit_item) && unit_item->valuestring != NULL) {
-            unit = unit_item->valuestring;
-        }
-    }
-
-    if (unit != NULL && unit[0] != '\0') {
+    const char *unit = state->attrs.unit;
+    if (unit[0] != '\0') {
         snprintf(value_text, sizeof(value_text), "%s %s", state->state, unit);
     } else {
         snprintf(value_text, sizeof(value_text), "%s", state->state);
     }
 
-    if (attrs != NULL) {
-        cJSON_Delete(attrs);
+    if (ctx->rendered_valid && !ctx->unavailable && ctx->last_update_ms == state->last_changed_unix_ms &&
+        strcmp(ctx->rendered_value, value_text) == 0) {
+        return false;
     }
 
     ctx->unavailable = false;
@@ -376,18 +376,38 @@ void w_sensor_apply_state(ui_widget_instance_t *instance, const ha_state_t *stat
     sensor_set_value_text(ctx, value_text);
     sensor_update_age_label(ctx);
     sensor_apply_layout(ctx);
+    snprintf(ctx->rendered_value, sizeof(ctx->rendered_value), "%s", value_text);
+    ctx->rendered_valid = true;
+    return true;
 }
 
-void w_sensor_mark_unavailable(ui_widget_instance_t *instance)
+bool w_sensor_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
 
     w_sensor_ctx_t *ctx = (w_sensor_ctx_t *)instance->ctx;
-    if (ctx == NULL) {
-        return;
+    if (ctx == NULL || (ctx->rendered_valid && ctx->unavailable)) {
+        return false;
     }
 
     sensor_apply_unavailable(ctx);
+    return true;
+}
+
+void w_sensor_set_visible(ui_widget_instance_t *instance, bool visible)
+{
+    w_sensor_ctx_t *ctx = (instance != NULL) ? (w_sensor_ctx_t *)instance->ctx : NULL;
+    if (ctx == NULL || ctx->age_timer == NULL) {
+        return;
+    }
+    if (!visible) {
+        lv_timer_pause(ctx->age_timer);
+        return;
+    }
+    /* The age text went stale while paused; refresh now instead of waiting a full period. */
+    sensor_update_age_label(ctx);
+    lv_timer_reset(ctx->age_timer);
+    lv_timer_resume(ctx->age_timer);
 }
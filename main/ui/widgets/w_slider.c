@@ -9,7 +9,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "cJSON.h"
 
 #include "ui/fonts/app_text_fonts.h"
 #include "ui/theme/theme_default.h"
@@ -40,6 +39,12 @@ typedef struct {
     bool dragging;
     bool suppress_event;
     int last_sent_value;
+    /* What slider_apply_visual last drew. */
+    bool rendered_valid;
+    bool rendered_dragging;
+    int rendered_value;
+    bool rendered_is_on;
+    bool rendered_unavailable;
 } w_slider_ctx_t;
 
 static const uint32_t W_SLIDER_FILL_OFF_HEX = 0x8C98A4;
@@ -120,42 +125,33 @@ static int slider_extract_percent_value(const ha_state_t *state, bool *out_has_n
         return value;
     }
 
-    cJSON *attrs = cJSON_Parse(state->attributes_json);
-    if (attrs != NULL) {
-        cJSON *brightness_pct = cJSON_GetObjectItemCaseSensitive(attrs, "brightness_pct");
-        cJSON *brightness = cJSON_GetObjectItemCaseSensitive(attrs, "brightness");
-        cJSON *volume_level = cJSON_GetObjectItemCaseSensitive(attrs, "volume_level");
-        if (cJSON_IsNumber(brightness_pct)) {
-            value = clamp_percent((int)(brightness_pct->valuedouble + 0.5));
-            if (out_has_numeric != NULL) {
-                *out_has_numeric = true;
-            }
-        } else if (cJSON_IsNumber(brightness)) {
-            int raw_255 = (int)(brightness->valuedouble + 0.5);
-            if (raw_255 < 0) {
-                raw_255 = 0;
-            }
-            if (raw_255 > 255) {
-                raw_255 = 255;
-            }
-            value = (raw_255 * 100 + 127) / 255;
-            if (out_has_numeric != NULL) {
-                *out_has_numeric = true;
-            }
-        } else if (cJSON_IsNumber(volume_level)) {
-            double normalized = volume_level->valuedouble;
-            if (normalized < 0.0) {
-                normalized = 0.0;
-            }
-            if (normalized > 1.0) {
-                normalized = 1.0;
-            }
-            value = clamp_percent((int)(normalized * 100.0 + 0.5));
-            if (out_has_numeric != NULL) {
-                *out_has_numeric = true;
-            }
+    const ha_state_attrs_t *attrs = &state->attrs;
+    bool has_numeric = true;
+    if ((attrs->present & HA_ATTR_BRIGHTNESS_PCT) != 0U) {
+        value = clamp_percent((int)(attrs->brightness_pct + 0.5f));
+    } else if ((attrs->present & HA_ATTR_BRIGHTNESS) != 0U) {
+        int raw_255 = (int)(attrs->brightness + 0.5f);
+        if (raw_255 < 0) {
+            raw_255 = 0;
+        }
+        if (raw_255 > 255) {
+            raw_255 = 255;
+        }
+        value = (raw_255 * 100 + 127) / 255;
+    } else if ((attrs->present & HA_ATTR_VOLUME_LEVEL) != 0U) {
+        float normalized = attrs->volume_level;
+        if (normalized < 0.0f) {
+            normalized = 0.0f;
         }
-        cJSON_Delete(attrs);
+        if (normalized > 1.0f) {
+            normalized = 1.0f;
+        }
+        value = clamp_percent((int)(normalized * 100.0f + 0.5f));
+    } else {
+        has_numeric = false;
+    }
+    if (out_has_numeric != NULL) {
+        *out_has_numeric = has_numeric;
     }
 
     if (out_has_numeric != NULL && *out_has_numeric) {
@@ -475,6 +471,19 @@ static void slider_apply_visual(w_slider_ctx_t *ctx)
     lv_label_set_text(
         ctx->state_label,
         slider_translate_status_text(ctx->unavailable ? "unavailable" : (ctx->is_on ? "ON" : "OFF")));
+
+    ctx->rendered_value = ctx->value;
+    ctx->rendered_is_on = ctx->is_on;
+    ctx->rendered_unavailable = ctx->unavailable;
+    ctx->rendered_dragging = ctx->dragging;
+    ctx->rendered_valid = true;
+}
+
+static bool slider_view_matches(const w_slider_ctx_t *ctx, int value, bool is_on, bool unavailable)
+{
+    /* A state arriving mid-drag must still end the drag visually, so never skip then. */
+    return ctx->rendered_valid && !ctx->dragging && !ctx->rendered_dragging && ctx->rendered_value == value &&
+           ctx->rendered_is_on == is_on && ctx->rendered_unavailable == unavailable;
 }
 
 static void w_slider_event_cb(lv_event_t *event)
@@ -616,47 +625,54 @@ esp_err_t w_slider_create(const ui_widget_def_t *def, lv_obj_t *parent, ui_widge
     return ESP_OK;
 }
 
-void w_slider_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_slider_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
 
     w_slider_ctx_t *ctx = (w_slider_ctx_t *)instance->ctx;
     if (ctx == NULL) {
-        return;
+        return false;
     }
 
     if (slider_state_is_unavailable(state->state)) {
+        if (slider_view_matches(ctx, 0, false, true)) {
+            return false;
+        }
         ctx->value = 0;
         ctx->is_on = false;
         ctx->unavailable = true;
         ctx->dragging = false;
         slider_apply_visual(ctx);
-        return;
+        return true;
     }
 
     bool has_numeric = false;
     int value = slider_extract_percent_value(state, &has_numeric);
     bool on_from_text = slider_state_is_on_text(state->state);
     bool is_on = has_numeric ? (value > 0 || on_from_text) : on_from_text;
+    if (slider_view_matches(ctx, clamp_percent(value), is_on, false)) {
+        return false;
+    }
 
     ctx->value = clamp_percent(value);
     ctx->is_on = is_on;
     ctx->unavailable = false;
     ctx->dragging = false;
     slider_apply_visual(ctx);
+    return true;
 }
 
-void w_slider_mark_unavailable(ui_widget_instance_t *instance)
+bool w_slider_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
 
     w_slider_ctx_t *ctx = (w_slider_ctx_t *)instance->ctx;
-    if (ctx == NULL) {
-        return;
+    if (ctx == NULL || slider_view_matches(ctx, 0, false, true)) {
+        return false;
     }
 
     ctx->value = 0;
@@ -664,4 +680,5 @@ void w_slider_mark_unavailable(ui_widget_instance_t *instance)
     ctx->unavailable = true;
     ctx->dragging = false;
     slider_apply_visual(ctx);
+    return true;
 }
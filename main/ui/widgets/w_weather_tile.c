@@ -11,7 +11,6 @@
 #include <stdint.h>
 #include <time.h>
 
-#include "cJSON.h"
 #include "esp_log.h"
 
 #include "ui/fonts/app_text_fonts.h"
@@ -146,6 +145,12 @@ typedef struct {
     uint32_t last_icon_cp;
     const lv_font_t *last_icon_font;
     char last_condition_text[32];
+    /* Inputs of the last weather_render call; a repeat with identical inputs is skipped. */
+    bool rendered_valid;
+    bool rendered_available;
+    uint32_t rendered_icon_cp;
+    char rendered_condition_text[32];
+    weather_values_t rendered_values;
 } w_weather_tile_ctx_t;
 
 #ifndef APP_UI_WEATHER_ICON_ALLOW_72
@@ -368,36 +373,6 @@ static bool weather_parse_int_token(const char *text, int *out)
     return true;
 }
 
-static bool weather_json_item_to_float(cJSON *item, float *out)
-{
-    if (item == NULL || out == NULL) {
-        return false;
-    }
-    if (cJSON_IsNumber(item)) {
-        *out = (float)item->valuedouble;
-        return true;
-    }
-    if (cJSON_IsString(item) && item->valuestring != NULL) {
-        return weather_parse_float_token(item->valuestring, out);
-    }
-    return false;
-}
-
-static bool weather_json_item_to_int(cJSON *item, int *out)
-{
-    if (item == NULL || out == NULL) {
-        return false;
-    }
-    if (cJSON_IsNumber(item)) {
-        *out = item->valueint;
-        return true;
-    }
-    if (cJSON_IsString(item) && item->valuestring != NULL) {
-        return weather_parse_int_token(item->valuestring, out);
-    }
-    return false;
-}
-
 static const char *weather_find_json_key(const char *json, const char *key)
 {
     if (json == NULL || key == NULL || key[0] == '\0') {
@@ -1203,31 +1178,25 @@ static void weather_extract_values(const ha_state_t *state, bool want_forecast,
     weather_humanize_condition(state->state, out->condition, sizeof(out->condition));
 
     const char *attrs_json = state->attributes_json;
-    cJSON *attrs = cJSON_Parse(attrs_json);
-    if (attrs != NULL) {
-        cJSON *temperature = cJSON_GetObjectItemCaseSensitive(attrs, "temperature");
-        cJSON *current_temperature = cJSON_GetObjectItemCaseSensitive(attrs, "current_temperature");
-        cJSON *native_temperature = cJSON_GetObjectItemCaseSensitive(attrs, "native_temperature");
-        if (weather_json_item_to_float(temperature, &out->temp) ||
-            weather_json_item_to_float(current_temperature, &out->temp) ||
-            weather_json_item_to_float(native_temperature, &out->temp)) {
-            out->has_temp = true;
-        }
-
-        cJSON *unit = cJSON_GetObjectItemCaseSensitive(attrs, "temperature_unit");
-        if (cJSON_IsString(unit) && unit->valuestring != NULL && unit->valuestring[0] != '\0') {
-            weather_copy_text(out->unit, sizeof(out->unit), unit->valuestring);
-        } else {
-            cJSON *native_unit = cJSON_GetObjectItemCaseSensitive(attrs, "native_temperature_unit");
-            if (cJSON_IsString(native_unit) && native_unit->valuestring != NULL && native_unit->valuestring[0] != '\0') {
-                weather_copy_text(out->unit, sizeof(out->unit), native_unit->valuestring);
-            }
-        }
-
-        cJSON *humidity = cJSON_GetObjectItemCaseSensitive(attrs, "humidity");
-        weather_json_item_to_int(humidity, &out->humidity);
+    const ha_state_attrs_t *attrs = &state->attrs;
+    if ((attrs->present & HA_ATTR_TEMPERATURE) != 0U) {
+        out->temp = attrs->temperature;
+        out->has_temp = true;
+    } else if ((attrs->present & HA_ATTR_CURRENT_TEMPERATURE) != 0U) {
+        out->temp = attrs->current_temperature;
+        out->has_temp = true;
+    } else if ((attrs->present & HA_ATTR_NATIVE_TEMPERATURE) != 0U) {
+        out->temp = attrs->native_temperature;
+        out->has_temp = true;
+    }
+    if (attrs->temperature_unit[0] != '\0') {
+        weather_copy_text(out->unit, sizeof(out->unit), attrs->temperature_unit);
+    }
+    if ((attrs->present & HA_ATTR_HUMIDITY) != 0U) {
+        out->humidity = attrs->humidity;
     }
 
+    /* Raw scans below only matter if the attributes could not be parsed into the typed record. */
     if (!out->has_temp && attrs_json != NULL && attrs_json[0] != '\0') {
         if (weather_extract_raw_number_attr(attrs_json, "temperature", &out->temp) ||
             weather_extract_raw_number_attr(attrs_json, "current_temperature", &out->temp) ||
@@ -1260,93 +1229,55 @@ static void weather_extract_values(const ha_state_t *state, bool want_forecast,
         }
     }
 
-    if (want_forecast) {
-        cJSON *forecast = (attrs != NULL) ? cJSON_GetObjectItemCaseSensitive(attrs, "forecast") : NULL;
-        if (cJSON_IsArray(forecast)) {
-            int count = cJSON_GetArraySize(forecast);
-            int out_idx = 0;
-            for (int i = 0; i < count && out_idx < 3; i++) {
-                cJSON *item = cJSON_GetArrayItem(forecast, i);
-                if (!cJSON_IsObject(item)) {
-                    continue;
-                }
-
-                cJSON *datetime = cJSON_GetObjectItemCaseSensitive(item, "datetime");
-                if (!cJSON_IsString(datetime) || datetime->valuestring == NULL) {
-                    datetime = cJSON_GetObjectItemCaseSensitive(item, "date");
-                }
-                bool is_today = cJSON_IsString(datetime) && datetime->valuestring != NULL &&
-                                weather_datetime_is_today(datetime->valuestring);
-
-                bool has_high = false;
-                float high_temp = 0.0f;
-                cJSON *high = cJSON_GetObjectItemCaseSensitive(item, "temperature");
-                if (!weather_json_item_to_float(high, &high_temp)) {
-                    high = cJSON_GetObjectItemCaseSensitive(item, "native_temperature");
-                }
-                if (weather_json_item_to_float(high, &high_temp)) {
-                    has_high = true;
-                }
+    if (want_forecast && attrs->forecast != NULL) {
+        int out_idx = 0;
+        for (uint8_t i = 0; i < attrs->forecast_count && out_idx < 3; i++) {
+            const ha_forecast_row_t *row = &attrs->forecast[i];
+            bool is_today = row->date[0] != '\0' && weather_datetime_is_today(row->date);
 
-                bool has_low = false;
-                float low_temp = 0.0f;
-                cJSON *low = cJSON_GetObjectItemCaseSensitive(item, "templow");
-                if (!weather_json_item_to_float(low, &low_temp)) {
-                    low = cJSON_GetObjectItemCaseSensitive(item, "native_templow");
-                }
-                if (weather_json_item_to_float(low, &low_temp)) {
-                    has_low = true;
-                }
-
-                cJSON *condition = cJSON_GetObjectItemCaseSensitive(item, "condition");
-                char condition_key[32] = {0};
-                char condition_human[sizeof(out->forecast[0].condition)] = {0};
-                if (cJSON_IsString(condition) && condition->valuestring != NULL) {
-                    weather_normalize_condition_key(condition->valuestring, condition_key, sizeof(condition_key));
-                    weather_humanize_condition(condition->valuestring, condition_human, sizeof(condition_human));
-                }
-
-                if (is_today) {
-                    if (has_high) {
-                        out->today_high_temp = high_temp;
-                        out->today_has_high = true;
-                    }
-                    if (has_low) {
-                        out->today_low_temp = low_temp;
-                        out->today_has_low = true;
-                    }
-                    if (condition_key[0] != '\0') {
-                        weather_copy_text(out->today_condition_key, sizeof(out->today_condition_key), condition_key);
-                    }
-                    continue;
-                }
+            char condition_key[32] = {0};
+            char condition_human[sizeof(out->forecast[0].condition)] = {0};
+            if (row->condition[0] != '\0') {
+                weather_normalize_condition_key(row->condition, condition_key, sizeof(condition_key));
+                weather_humanize_condition(row->condition, condition_human, sizeof(condition_human));
+            }
 
-                weather_forecast_t *slot = &out->forecast[out_idx];
-                slot->valid = true;
-                if (cJSON_IsString(datetime) && datetime->valuestring != NULL) {
-                    weather_day_from_datetime(datetime->valuestring, slot->day, sizeof(slot->day));
-                }
-                if (has_high) {
-                    slot->has_high = true;
-                    slot->high_temp = high_temp;
+            if (is_today) {
+                if (row->has_high) {
+                    out->today_high_temp = row->high;
+                    out->today_has_high = true;
                 }
-                if (has_low) {
-                    slot->has_low = true;
-                    slot->low_temp = low_temp;
+                if (row->has_low) {
+                    out->today_low_temp = row->low;
+                    out->today_has_low = true;
                 }
                 if (condition_key[0] != '\0') {
-                    weather_copy_text(slot->condition_key, sizeof(slot->condition_key), condition_key);
+                    weather_copy_text(out->today_condition_key, sizeof(out->today_condition_key), condition_key);
                 }
-                if (condition_human[0] != '\0') {
-                    weather_copy_text(slot->condition, sizeof(slot->condition), condition_human);
-                }
-                out_idx++;
+                continue;
             }
-        }
-    }
 
-    if (attrs != NULL) {
-        cJSON_Delete(attrs);
+            weather_forecast_t *slot = &out->forecast[out_idx];
+            slot->valid = true;
+            if (row->date[0] != '\0') {
+                weather_day_from_datetime(row->date, slot->day, sizeof(slot->day));
+            }
+            if (row->has_high) {
+                slot->has_high = true;
+                slot->high_temp = row->high;
+            }
+            if (row->has_low) {
+                slot->has_low = true;
+                slot->low_temp = row->low;
+            }
+            if (condition_key[0] != '\0') {
+                weather_copy_text(slot->condition_key, sizeof(slot->condition_key), condition_key);
+            }
+            if (condition_human[0] != '\0') {
+                weather_copy_text(slot->condition, sizeof(slot->condition), condition_human);
+            }
+            out_idx++;
+        }
     }
 }
 
@@ -2160,6 +2091,28 @@ static void weather_render_3day(lv_obj_t *card, w_weather_tile_ctx_t *ctx, const
     }
 }
 
+static void weather_remember_render(w_weather_tile_ctx_t *ctx, const weather_values_t *values, bool available)
+{
+    ctx->rendered_available = available && values != NULL;
+    ctx->rendered_icon_cp = ctx->last_icon_cp;
+    weather_copy_text(ctx->rendered_condition_text, sizeof(ctx->rendered_condition_text), ctx->last_condition_text);
+    if (ctx->rendered_available) {
+        memcpy(&ctx->rendered_values, values, sizeof(ctx->rendered_values));
+    }
+    ctx->rendered_valid = true;
+}
+
+static bool weather_render_matches(const w_weather_tile_ctx_t *ctx, const weather_values_t *values, bool available)
+{
+    bool is_available = available && values != NULL;
+    if (!ctx->rendered_valid || ctx->rendered_available != is_available || ctx->rendered_icon_cp != ctx->last_icon_cp ||
+        strcmp(ctx->rendered_condition_text, ctx->last_condition_text) != 0) {
+        return false;
+    }
+    /* weather_extract_values starts from a zeroed struct, so equal inputs compare equal bytewise. */
+    return !is_available || memcmp(&ctx->rendered_values, values, sizeof(ctx->rendered_values)) == 0;
+}
+
 static void weather_render(lv_obj_t *card, w_weather_tile_ctx_t *ctx, const weather_values_t *values, bool available)
 {
     if (card == NULL || ctx == NULL) {
@@ -2503,24 +2456,25 @@ esp_err_t w_weather_tile_create(const ui_widget_def_t *def, lv_obj_t *parent, ui
     out_instance->ctx = ctx;
     out_instance->obj = card;
     weather_render(card, ctx, NULL, false);
+    weather_remember_render(ctx, NULL, false);
     return ESP_OK;
 }
 
-void w_weather_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
+bool w_weather_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t *state)
 {
     if (instance == NULL || instance->obj == NULL || state == NULL) {
-        return;
+        return false;
     }
 
     /* Weather tile is driven by its primary weather entity only.
      * Secondary entity updates (if configured) must not override icon/condition rendering. */
-    if (strncmp(state->entity_id, instance->entity_id, APP_MAX_ENTITY_ID_LEN) != 0) {
-        return;
+    if (state->entity != instance->entity) {
+        return false;
     }
 
     w_weather_tile_ctx_t *ctx = (w_weather_tile_ctx_t *)instance->ctx;
     if (ctx == NULL) {
-        return;
+        return false;
     }
 
     /* Deterministic icon behavior:
@@ -2533,17 +2487,42 @@ void w_weather_tile_apply_state(ui_widget_instance_t *instance, const ha_state_t
     if (ctx->last_condition_text[0] == '\0' && weather_has_alpha(values.condition)) {
         weather_copy_text(ctx->last_condition_text, sizeof(ctx->last_condition_text), values.condition);
     }
+    if (weather_render_matches(ctx, &values, true)) {
+        return false;
+    }
     weather_render(instance->obj, ctx, &values, true);
+    weather_remember_render(ctx, &values, true);
+    return true;
 }
 
-void w_weather_tile_mark_unavailable(ui_widget_instance_t *instance)
+bool w_weather_tile_mark_unavailable(ui_widget_instance_t *instance)
 {
     if (instance == NULL || instance->obj == NULL) {
-        return;
+        return false;
     }
     w_weather_tile_ctx_t *ctx = (w_weather_tile_ctx_t *)instance->ctx;
-    if (ctx == NULL) {
-        return;
+    if (ctx == NULL || weather_render_matches(ctx, NULL, false)) {
+        return false;
     }
     weather_render(instance->obj, ctx, NULL, false);
+    weather_remember_render(ctx, NULL, false);
+    return true;
+}
+
+void w_weather_tile_set_visible(ui_widget_instance_t *instance, bool visible)
+{
+    w_weather_tile_ctx_t *ctx = (instance != NULL) ? (w_weather_tile_ctx_t *)instance->ctx : NULL;
+    if (ctx == NULL || ctx->lottie_icon == NULL) {
+        return;
+    }
+    /* The Lottie animation keeps rasterizing frames into its buffer even under a hidden parent. */
+    lv_anim_t *anim = lv_lottie_get_anim(ctx->lottie_icon);
+    if (anim == NULL) {
+        return;
+    }
+    if (visible) {
+        lv_anim_resume(anim);
+    } else {
+        lv_anim_pause(anim);
+    }
 }
@@ -0,0 +1,491 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "util/json_scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Stands in for escapes that do not decode to a valid, non-NUL code point. */
+#define JSON_SPAN_REPLACEMENT_CHAR 0xFFFDU
+
+static size_t json_scan_skip_ws(const char *text, size_t len, size_t pos)
+{
+    while (pos < len && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+        pos++;
+    }
+    return pos;
+}
+
+/* Returns the index just past the closing quote of the string opening at text[pos]. */
+static bool json_scan_string_end(const char *text, size_t len, size_t pos, size_t *out_end)
+{
+    for (size_t i = pos + 1U; i < len; i++) {
+        if (text[i] == '\\') {
+            i++;
+        } else if (text[i] == '"') {
+            *out_end = i + 1U;
+            return true;
+        } else if (text[i] == '\0') {
+            return false;
+        }
+    }
+    return false;
+}
+
+/* Skips a container by bracket matching; strings are skipped whole so brackets inside them do not count. */
+static bool json_scan_container_end(const char *text, size_t len, size_t pos, size_t *out_end)
+{
+    char stack[JSON_SCAN_MAX_DEPTH];
+    size_t depth = 0;
+    for (size_t i = pos; i < len; i++) {
+        char c = text[i];
+        if (c == '"') {
+            size_t end = 0;
+            if (!json_scan_string_end(text, len, i, &end)) {
+                return false;
+            }
+            i = end - 1U;
+        } else if (c == '{' || c == '[') {
+            if (depth >= JSON_SCAN_MAX_DEPTH) {
+                return false;
+            }
+            stack[depth++] = (c == '{') ? '}' : ']';
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || stack[depth - 1U] != c) {
+                return false;
+            }
+            if (--depth == 0) {
+                *out_end = i + 1U;
+                return true;
+            }
+        } else if (c == '\0') {
+            return false;
+        }
+    }
+    return false;
+}
+
+static bool json_scan_literal(const char *text, size_t len, size_t pos, const char *literal, size_t *out_end)
+{
+    size_t n = strlen(literal);
+    if (len - pos < n || memcmp(text + pos, literal, n) != 0) {
+        return false;
+    }
+    *out_end = pos + n;
+    return true;
+}
+
+static bool json_scan_value_at(const char *text, size_t len, size_t pos, json_span_t *out_value, size_t *out_end)
+{
+    pos = json_scan_skip_ws(text, len, pos);
+    if (pos >= len) {
+        return false;
+    }
+
+    size_t end = 0;
+    json_span_type_t type = JSON_SPAN_INVALID;
+    char c = text[pos];
+    if (c == '{' || c == '[') {
+        type = (c == '{') ? JSON_SPAN_OBJECT : JSON_SPAN_ARRAY;
+        if (!json_scan_container_end(text, len, pos, &end)) {
+            return false;
+        }
+    } else if (c == '"') {
+        if (!json_scan_string_end(text, len, pos, &end)) {
+            return false;
+        }
+        out_value->ptr = text + pos + 1U;
+        out_value->len = end - pos - 2U;
+        out_value->type = JSON_SPAN_STRING;
+        *out_end = end;
+        return true;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        type = JSON_SPAN_NUMBER;
+        end = pos + 1U;
+        while (end < len && (strchr("0123456789+-.eE", text[end]) != NULL) && text[end] != '\0') {
+            end++;
+        }
+    } else if (json_scan_literal(text, len, pos, "true", &end)) {
+        type = JSON_SPAN_TRUE;
+    } else if (json_scan_literal(text, len, pos, "false", &end)) {
+        type = JSON_SPAN_FALSE;
+    } else if (json_scan_literal(text, len, pos, "null", &end)) {
+        type = JSON_SPAN_NULL;
+    } else {
+        return false;
+    }
+
+    out_value->ptr = text + pos;
+    out_value->len = end - pos;
+    out_value->type = type;
+    *out_end = end;
+    return true;
+}
+
+bool json_scan_value(const char *text, size_t len, json_span_t *out_value)
+{
+    size_t end = 0;
+    if (text == NULL || out_value == NULL) {
+        return false;
+    }
+    return json_scan_value_at(text, len, 0, out_value, &end);
+}
+
+bool json_scan_iter_begin(json_scan_iter_t *it, const json_span_t *container)
+{
+    if (it == NULL || container == NULL ||
+        (container->type != JSON_SPAN_OBJECT && container->type != JSON_SPAN_ARRAY) || container->len < 2U) {
+        return false;
+    }
+    it->buf = container->ptr;
+    it->len = container->len - 1U; /* stop before the closing bracket */
+    it->pos = 1U;
+    it->first = true;
+    it->failed = false;
+    it->close = (container->type == JSON_SPAN_OBJECT) ? '}' : ']';
+    return true;
+}
+
+/* Consumes the separator before the next member; false at the end of the container. */
+static bool json_scan_iter_advance(json_scan_iter_t *it)
+{
+    it->pos = json_scan_skip_ws(it->buf, it->len, it->pos);
+    if (it->pos >= it->len) {
+        return false;
+    }
+    if (!it->first) {
+        if (it->buf[it->pos] != ',') {
+            it->failed = true;
+            return false;
+        }
+        it->pos++;
+    }
+    it->first = false;
+    return true;
+}
+
+bool json_scan_object_next(json_scan_iter_t *it, json_span_t *out_key, json_span_t *out_value)
+{
+    if (it == NULL || it->failed || it->close != '}' || !json_scan_iter_advance(it)) {
+        return false;
+    }
+
+    json_span_t key = {0};
+    size_t end = 0;
+    if (!json_scan_value_at(it->buf, it->len, it->pos, &key, &end) || key.type != JSON_SPAN_STRING) {
+        it->failed = true;
+        return false;
+    }
+    end = json_scan_skip_ws(it->buf, it->len, end);
+    if (end >= it->len || it->buf[end] != ':') {
+        it->failed = true;
+        return false;
+    }
+
+    json_span_t value = {0};
+    if (!json_scan_value_at(it->buf, it->len, end + 1U, &value, &it->pos)) {
+        it->failed = true;
+        return false;
+    }
+    if (out_key != NULL) {
+        *out_key = key;
+    }
+    if (out_value != NULL) {
+        *out_value = value;
+    }
+    return true;
+}
+
+bool json_scan_array_next(json_scan_iter_t *it, json_span_t *out_value)
+{
+    if (it == NULL || it->failed || it->close != ']' || !json_scan_iter_advance(it)) {
+        return false;
+    }
+    json_span_t value = {0};
+    if (!json_scan_value_at(it->buf, it->len, it->pos, &value, &it->pos)) {
+        it->failed = true;
+        return false;
+    }
+    if (out_value != NULL) {
+        *out_value = value;
+    }
+    return true;
+}
+
+bool json_scan_object_get(const json_span_t *object, const char *key, json_span_t *out_value)
+{
+    json_scan_iter_t it;
+    if (key == NULL || !json_scan_iter_begin(&it, object)) {
+        return false;
+    }
+    json_span_t member_key = {0};
+    json_span_t member_value = {0};
+    while (json_scan_object_next(&it, &member_key, &member_value)) {
+        if (json_span_equals(&member_key, key)) {
+            if (out_value != NULL) {
+                *out_value = member_value;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool json_span_equals(const json_span_t *span, const char *text)
+{
+    if (span == NULL || text == NULL || span->type != JSON_SPAN_STRING) {
+        return false;
+    }
+    size_t n = strlen(text);
+    return span->len == n && memcmp(span->ptr, text, n) == 0;
+}
+
+bool json_span_is_true(const json_span_t *span)
+{
+    return span != NULL && span->type == JSON_SPAN_TRUE;
+}
+
+bool json_span_to_u32(const json_span_t *span, uint32_t *out_value)
+{
+    if (span == NULL || out_value == NULL || span->type != JSON_SPAN_NUMBER || span->len == 0 || span->len > 20U) {
+        return false;
+    }
+    char digits[24];
+    memcpy(digits, span->ptr, span->len);
+    digits[span->len] = '\0';
+    double value = strtod(digits, NULL);
+    if (value < 0.0 || value > (double)UINT32_MAX) {
+        return false;
+    }
+    *out_value = (uint32_t)value;
+    return true;
+}
+
+static int json_span_hex(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/* The four hex digits of a \\u escape starting at span->ptr[pos]. */
+static bool json_span_hex4(const json_span_t *span, size_t pos, uint32_t *out_cp)
+{
+    uint32_t cp = 0;
+    for (size_t k = 0; k < 4U; k++) {
+        int h = (pos + k < span->len) ? json_span_hex(span->ptr[pos + k]) : -1;
+        if (h < 0) {
+            return false;
+        }
+        cp = (cp << 4) | (uint32_t)h;
+    }
+    *out_cp = cp;
+    return true;
+}
+
+bool json_span_copy_string(const json_span_t *span, char *dst, size_t dst_size)
+{
+    if (dst == NULL || dst_size == 0) {
+        return false;
+    }
+    dst[0] = '\0';
+    if (span == NULL || span->type != JSON_SPAN_STRING) {
+        return false;
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < span->len; i++) {
+        char c = span->ptr[i];
+        char utf8[4];
+        size_t n = 1;
+        utf8[0] = c;
+        if (c == '\\' && i + 1U < span->len) {
+            char esc = span->ptr[++i];
+            switch (esc) {
+            case 'n': utf8[0] = '\n'; break;
+            case 't': utf8[0] = '\t'; break;
+            case 'r': utf8[0] = '\r'; break;
+            case 'b': utf8[0] = '\b'; break;
+            case 'f': utf8[0] = '\f'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!json_span_hex4(span, i + 1U, &cp)) {
+                    dst[out] = '\0';
+                    return false;
+                }
+                i += 4U;
+                if (cp >= 0xD800U && cp <= 0xDBFFU) {
+                    /* A high surrogate only counts with the low one right after it. */
+                    uint32_t lo = 0;
+                    if (i + 2U < span->len && span->ptr[i + 1U] == '\\' && span->ptr[i + 2U] == 'u' &&
+                        json_span_hex4(span, i + 3U, &lo) && lo >= 0xDC00U && lo <= 0xDFFFU) {
+                        cp = 0x10000U + ((cp - 0xD800U) << 10) + (lo - 0xDC00U);
+                        i += 6U;
+                    } else {
+                        cp = JSON_SPAN_REPLACEMENT_CHAR;
+                    }
+                } else if ((cp >= 0xDC00U && cp <= 0xDFFFU) || cp == 0U) {
+                    /* Lone low surrogate, or a NUL that would cut the copy short. */
+                    cp = JSON_SPAN_REPLACEMENT_CHAR;
+                }
+                if (cp < 0x80U) {
+                    utf8[0] = (char)cp;
+                } else if (cp < 0x800U) {
+                    utf8[0] = (char)(0xC0U | (cp >> 6));
+                    utf8[1] = (char)(0x80U | (cp & 0x3FU));
+                    n = 2;
+                } else if (cp < 0x10000U) {
+                    utf8[0] = (char)(0xE0U | (cp >> 12));
+                    utf8[1] = (char)(0x80U | ((cp >> 6) & 0x3FU));
+                    utf8[2] = (char)(0x80U | (cp & 0x3FU));
+                    n = 3;
+                } else {
+                    utf8[0] = (char)(0xF0U | (cp >> 18));
+                    utf8[1] = (char)(0x80U | ((cp >> 12) & 0x3FU));
+                    utf8[2] = (char)(0x80U | ((cp >> 6) & 0x3FU));
+                    utf8[3] = (char)(0x80U | (cp & 0x3FU));
+                    n = 4;
+                }
+                break;
+            }
+            default: utf8[0] = esc; break;
+            }
+        }
+        if (out + n >= dst_size) {
+            dst[out] = '\0';
+            return false;
+        }
+        memcpy(dst + out, utf8, n);
+        out += n;
+    }
+    dst[out] = '\0';
+    return true;
+}
+
+static bool json_span_raw_equals(const json_span_t *a, const json_span_t *b)
+{
+    return a->len == b->len && memcmp(a->ptr, b->ptr, a->len) == 0;
+}
+
+static bool json_scan_object_has_key(const json_span_t *object, const json_span_t *key)
+{
+    json_scan_iter_t it;
+    json_span_t member_key = {0};
+    if (object == NULL || !json_scan_iter_begin(&it, object)) {
+        return false;
+    }
+    while (json_scan_object_next(&it, &member_key, NULL)) {
+        if (json_span_raw_equals(&member_key, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool json_scan_array_has_string(const json_span_t *array, const json_span_t *text)
+{
+    json_scan_iter_t it;
+    json_span_t item = {0};
+    if (array == NULL || !json_scan_iter_begin(&it, array)) {
+        return false;
+    }
+    while (json_scan_array_next(&it, &item)) {
+        if (item.type == JSON_SPAN_STRING && json_span_raw_equals(&item, text)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool json_scan_emit_member(char *out, size_t out_size, size_t *io_len, const json_span_t *key,
+    const json_span_t *value)
+{
+    size_t value_len = 0;
+    const char *value_raw = json_span_raw(value, &value_len);
+    size_t need = (*io_len > 1U ? 1U : 0U) + key->len + 3U + value_len;
+    if (*io_len + need + 2U > out_size) {
+        return false;
+    }
+    char *dst = out + *io_len;
+    if (*io_len > 1U) {
+        *dst++ = ',';
+    }
+    *dst++ = '"';
+    memcpy(dst, key->ptr, key->len);
+    dst += key->len;
+    *dst++ = '"';
+    *dst++ = ':';
+    memcpy(dst, value_raw, value_len);
+    *io_len += need;
+    return true;
+}
+
+bool json_scan_merge_object(const char *base, size_t base_len, const json_span_t *plus, const json_span_t *minus_keys,
+    char *out, size_t out_size)
+{
+    if (out == NULL || out_size < 3U) {
+        return false;
+    }
+    if ((plus != NULL && plus->type != JSON_SPAN_OBJECT) || (minus_keys != NULL && minus_keys->type != JSON_SPAN_ARRAY)) {
+        return false;
+    }
+
+    size_t len = 1;
+    out[0] = '{';
+    json_scan_iter_t it;
+    json_span_t key = {0};
+    json_span_t value = {0};
+    json_span_t base_span = {0};
+    if (base != NULL && base_len > 0U) {
+        if (!json_scan_value(base, base_len, &base_span) || base_span.type != JSON_SPAN_OBJECT) {
+            return false;
+        }
+        json_scan_iter_begin(&it, &base_span);
+        while (json_scan_object_next(&it, &key, &value)) {
+            if (json_scan_object_has_key(plus, &key) || json_scan_array_has_string(minus_keys, &key)) {
+                continue;
+            }
+            if (!json_scan_emit_member(out, out_size, &len, &key, &value)) {
+                return false;
+            }
+        }
+        if (it.failed) {
+            return false;
+        }
+    }
+    if (plus != NULL) {
+        json_scan_iter_begin(&it, plus);
+        while (json_scan_object_next(&it, &key, &value)) {
+            if (!json_scan_emit_member(out, out_size, &len, &key, &value)) {
+                return false;
+            }
+        }
+        if (it.failed) {
+            return false;
+        }
+    }
+    out[len++] = '}';
+    out[len] = '\0';
+    return true;
+}
+
+const char *json_span_raw(const json_span_t *span, size_t *out_len)
+{
+    if (span == NULL || out_len == NULL) {
+        return NULL;
+    }
+    if (span->type == JSON_SPAN_STRING) {
+        *out_len = span->len + 2U;
+        return span->ptr - 1;
+    }
+    *out_len = span->len;
+    return span->ptr;
+}
@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Allocation-free pull scanner over a complete JSON text. It never builds a DOM: callers walk
+ * objects/arrays and get byte spans for keys and values, skip what they do not need, and only
+ * materialize (e.g. with cJSON_ParseWithLength) the spans they keep. */
+#define JSON_SCAN_MAX_DEPTH 32
+
+typedef enum {
+    JSON_SPAN_INVALID = 0,
+    JSON_SPAN_OBJECT,
+    JSON_SPAN_ARRAY,
+    JSON_SPAN_STRING,
+    JSON_SPAN_NUMBER,
+    JSON_SPAN_TRUE,
+    JSON_SPAN_FALSE,
+    JSON_SPAN_NULL,
+} json_span_type_t;
+
+/* For strings, ptr/len cover the raw contents between the quotes (escapes not decoded). */
+typedef struct {
+    const char *ptr;
+    size_t len;
+    json_span_type_t type;
+} json_span_t;
+
+typedef struct {
+    const char *buf;
+    size_t len;
+    size_t pos;
+    bool first;
+    bool failed;
+    char close;
+} json_scan_iter_t;
+
+/* Classifies and bounds the value at the start of text (leading whitespace allowed). */
+bool json_scan_value(const char *text, size_t len, json_span_t *out_value);
+/* Start iterating an object/array span (as returned by json_scan_value). */
+bool json_scan_iter_begin(json_scan_iter_t *it, const json_span_t *container);
+/* Next member; returns false at the end or on malformed input (it->failed). */
+bool json_scan_object_next(json_scan_iter_t *it, json_span_t *out_key, json_span_t *out_value);
+bool json_scan_array_next(json_scan_iter_t *it, json_span_t *out_value);
+/* Looks up a direct member of an object span by key (linear, no allocation). */
+bool json_scan_object_get(const json_span_t *object, const char *key, json_span_t *out_value);
+
+bool json_span_equals(const json_span_t *span, const char *text);
+bool json_span_is_true(const json_span_t *span);
+bool json_span_to_u32(const json_span_t *span, uint32_t *out_value);
+/* Decodes a string span into dst as UTF-8 (always NUL-terminated); surrogate pairs are combined,
+ * lone surrogates and \u0000 become U+FFFD. False if it did not fit or an escape is malformed. */
+bool json_span_copy_string(const json_span_t *span, char *dst, size_t dst_size);
+/* Writes base with the members of plus set (replacing same-named keys) and the keys listed in
+ * minus_keys (array of strings) removed, as compact JSON into out. Values are copied verbatim, so
+ * nothing is parsed into a tree. plus/minus_keys may be NULL; base may be NULL/empty ("{}"). */
+bool json_scan_merge_object(const char *base, size_t base_len, const json_span_t *plus, const json_span_t *minus_keys,
+    char *out, size_t out_size);
+/* Full text of a value including quotes/brackets, for handing to cJSON_ParseWithLength. */
+const char *json_span_raw(const json_span_t *span, size_t *out_len);
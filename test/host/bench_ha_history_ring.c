@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "host_bench.h"
+
+/* The ring helpers are static, so the module is compiled into the benchmark. */
+#include "ha/ha_history.c"
+
+/* Steady state of a graph series: the 24 h history is full and every new minute drops the oldest one.
+ * Compares the ring (head advance) with the memmove it replaced, then times the whole
+ * ha_history_append_or_update including the pyramid update. */
+
+esp_err_t layout_store_load_compiled(layout_compiled_t **out_layout)
+{
+    *out_layout = NULL;
+    return ESP_ERR_NOT_FOUND;
+}
+
+void layout_compiled_free(layout_compiled_t *layout)
+{
+    (void)layout;
+}
+
+#define BENCH_T0 1800000000U
+
+/* Storage part of ha_history_append_or_update: overflow drop, write through the ring index, trim. */
+static void ring_append_trim(ha_history_series_t *series, uint32_t ts, float value)
+{
+    if (series->count >= HA_HISTORY_MAX_SAMPLES) {
+        ha_history_drop_oldest(series, 1);
+    }
+    ha_history_sample_t *slot = &series->samples[ha_history_index(series, series->count)];
+    slot->bucket_ts = ts;
+    slot->value = value;
+    series->count++;
+    ha_history_trim_retention(series, ts);
+}
+
+/* The flat-array version the ring replaced: samples[0] is the oldest and drops shift the rest down. */
+typedef struct {
+    ha_history_sample_t samples[HA_HISTORY_MAX_SAMPLES];
+    int count;
+} flat_history_t;
+
+static void flat_drop_oldest(flat_history_t *h, int drop)
+{
+    memmove(&h->samples[0], &h->samples[drop], (size_t)(h->count - drop) * sizeof(h->samples[0]));
+    h->count -= drop;
+}
+
+static void flat_append_trim(flat_history_t *h, uint32_t ts, float value)
+{
+    if (h->count >= HA_HISTORY_MAX_SAMPLES) {
+        flat_drop_oldest(h, 1);
+    }
+    h->samples[h->count].bucket_ts = ts;
+    h->samples[h->count].value = value;
+    h->count++;
+    uint32_t keep_after = ts - HA_HISTORY_RETENTION_SEC;
+    int drop = 0;
+    while (drop < h->count && h->samples[drop].bucket_ts < keep_after) {
+        drop++;
+    }
+    if (drop > 0) {
+        flat_drop_oldest(h, drop);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int appends = host_bench_quick(argc, argv) ? 20000 : 2000000;
+    ha_history_series_t *ring = calloc(1, sizeof(*ring));
+    ha_history_series_t *full = calloc(1, sizeof(*full));
+    flat_history_t *flat = calloc(1, sizeof(*flat));
+    if (ring == NULL || full == NULL || flat == NULL) {
+        return EXIT_FAILURE;
+    }
+    full->persist_from_ts = UINT32_MAX;
+
+    uint32_t ts = BENCH_T0;
+    for (int i = 0; i < HA_HISTORY_MAX_SAMPLES; i++, ts += HA_HISTORY_BUCKET_SEC) {
+        ring_append_trim(ring, ts, (float)i);
+        flat_append_trim(flat, ts, (float)i);
+        (void)ha_history_append_or_update(full, ts, (float)i);
+    }
+    uint32_t start_ts = ts;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < appends; i++) {
+        flat_append_trim(flat, start_ts + (uint32_t)i * HA_HISTORY_BUCKET_SEC, (float)(i & 1023));
+    }
+    int64_t flat_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < appends; i++) {
+        ring_append_trim(ring, start_ts + (uint32_t)i * HA_HISTORY_BUCKET_SEC, (float)(i & 1023));
+    }
+    int64_t ring_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < appends; i++) {
+        (void)ha_history_append_or_update(full, start_ts + (uint32_t)i * HA_HISTORY_BUCKET_SEC, (float)(i & 1023));
+    }
+    int64_t full_us = esp_timer_get_time() - start;
+
+    printf("%d appends into a full %d-sample history, retention trim after each:\n", appends, HA_HISTORY_MAX_SAMPLES);
+    host_bench_report_ns("memmove append+trim", (uint64_t)appends, flat_us);
+    host_bench_report_ns("ring append+trim", (uint64_t)appends, ring_us);
+    host_bench_report_ns("append_or_update (+pyramid)", (uint64_t)appends, full_us);
+
+    /* All three hold the same samples in the same order. */
+    int failures = 0;
+    failures += ring->count != HA_HISTORY_MAX_SAMPLES || flat->count != HA_HISTORY_MAX_SAMPLES ||
+                full->count != HA_HISTORY_MAX_SAMPLES;
+    for (int i = 0; failures == 0 && i < HA_HISTORY_MAX_SAMPLES; i++) {
+        const ha_history_sample_t *a = ha_history_at(ring, i);
+        const ha_history_sample_t *b = ha_history_at(full, i);
+        failures += a->bucket_ts != flat->samples[i].bucket_ts || a->value != flat->samples[i].value ||
+                    b->bucket_ts != a->bucket_ts || b->value != a->value;
+    }
+    if (failures != 0) {
+        fprintf(stderr, "ring and flat histories differ\n");
+    }
+    free(ring);
+    free(full);
+    free(flat);
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "ha/ha_model.h"
+#include "host_bench.h"
+
+/* Burst of state updates across a full model: every round upserts each entity once and reads it back
+ * by entity id, the way the WS import and the UI refresh hit the hash index. */
+
+#define BENCH_ENTITIES APP_HA_MAX_STATES
+
+static char s_ids[BENCH_ENTITIES][APP_MAX_ENTITY_ID_LEN];
+
+int main(int argc, char **argv)
+{
+    int rounds = host_bench_quick(argc, argv) ? 10 : 200;
+    if (ha_model_init() != ESP_OK) {
+        return EXIT_FAILURE;
+    }
+    static const char *const domains[] = {"sensor", "light", "switch", "binary_sensor"};
+    for (int i = 0; i < BENCH_ENTITIES; i++) {
+        snprintf(s_ids[i], sizeof(s_ids[i]), "%s.bench_entity_%03d", domains[i % 4], i);
+    }
+
+    int failures = 0;
+    int64_t upsert_us = 0;
+    int64_t get_us = 0;
+    for (int round = 0; round < rounds; round++) {
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < BENCH_ENTITIES; i++) {
+            ha_state_t state = {0};
+            state.entity = ha_model_intern_entity_id(s_ids[i]);
+            snprintf(state.state, sizeof(state.state), "%d", round * 1000 + i);
+            state.attributes_json = "{\"unit_of_measurement\":\"W\"}";
+            state.last_changed_unix_ms = round;
+            failures += ha_model_upsert_state(&state) != ESP_OK;
+        }
+        int64_t mid = esp_timer_get_time();
+        for (int i = 0; i < BENCH_ENTITIES; i++) {
+            ha_state_t out = {0};
+            char expected[16];
+            snprintf(expected, sizeof(expected), "%d", round * 1000 + i);
+            failures += !ha_model_get_state(s_ids[i], &out) || strcmp(out.state, expected) != 0;
+        }
+        int64_t end = esp_timer_get_time();
+        upsert_us += mid - start;
+        get_us += end - mid;
+    }
+
+    uint64_t ops = (uint64_t)rounds * BENCH_ENTITIES;
+    host_bench_report_ns("upsert (intern + write)", ops, upsert_us);
+    host_bench_report_ns("get_state by entity id", ops, get_us);
+    printf("  %d entities x %d rounds: %.2f M lookups/s\n", BENCH_ENTITIES, rounds,
+        (get_us > 0) ? (double)ops / (double)get_us : 0.0);
+    if (failures != 0) {
+        fprintf(stderr, "%d wrong or failed operations\n", failures);
+    }
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
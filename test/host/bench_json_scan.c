@@ -0,0 +1,181 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_timer.h"
+#include "host_bench.h"
+#include "host_heap_trace.h"
+#include "util/json_scan.h"
+
+/* Walks the same synthetic frames the client streams (there is no captured HA traffic in the tree):
+ * a subscribe_entities "c" burst and a get_states result where only some states are kept. Reports
+ * throughput and the heap the scanner used, which must stay at zero. */
+
+#define BENCH_BURST_ENTITIES 180
+#define BENCH_GET_STATES 600
+#define BENCH_KEEP_EVERY 8
+
+static size_t build_burst(char *buf, size_t size)
+{
+    size_t len = (size_t)snprintf(buf, size, "{\"id\":7,\"type\":\"event\",\"event\":{\"c\":{");
+    for (int i = 0; i < BENCH_BURST_ENTITIES; i++) {
+        len += (size_t)snprintf(buf + len, size - len,
+            "%s\"light.room_%03d\":{\"+\":{\"s\":\"%s\",\"a\":{\"brightness\":%d,\"rgb_color\":[255,%d,0],"
+            "\"friendly_name\":\"Room \\u00e9 %d\"},\"lc\":1700000000.%03d},\"-\":{\"a\":[\"effect_list\"]}}",
+            (i == 0) ? "" : ",", i, (i & 1) ? "on" : "off", i % 255, i % 200, i, i);
+    }
+    len += (size_t)snprintf(buf + len, size - len, "}}}");
+    return len;
+}
+
+static size_t build_get_states(char *buf, size_t size)
+{
+    size_t len = (size_t)snprintf(buf, size, "{\"id\":3,\"type\":\"result\",\"success\":true,\"result\":[");
+    for (int i = 0; i < BENCH_GET_STATES; i++) {
+        len += (size_t)snprintf(buf + len, size - len,
+            "%s{\"entity_id\":\"sensor.probe_%03d\",\"state\":\"%d.%d\",\"attributes\":{"
+            "\"unit_of_measurement\":\"\\u00b0C\",\"device_class\":\"temperature\",\"state_class\":\"measurement\","
+            "\"friendly_name\":\"Probe %d\"},\"last_changed\":\"2026-01-01T00:00:00+00:00\","
+            "\"last_updated\":\"2026-01-01T00:00:00+00:00\",\"context\":{\"id\":\"01HX%08d\",\"parent_id\":null,"
+            "\"user_id\":null}}",
+            (i == 0) ? "" : ",", i, 20 + i % 10, i % 10, i, i);
+    }
+    len += (size_t)snprintf(buf + len, size - len, "]}");
+    return len;
+}
+
+/* Mirrors the client's "c" handling: entity id copy, "+s" copy and an attribute merge per entity. */
+static size_t walk_burst(const char *frame, size_t len, char *merge_buf, size_t merge_size)
+{
+    json_span_t root = {0};
+    json_span_t event = {0};
+    json_span_t changed = {0};
+    if (!json_scan_value(frame, len, &root) || !json_scan_object_get(&root, "event", &event) ||
+        !json_scan_object_get(&event, "c", &changed)) {
+        return 0;
+    }
+    static const char base[] = "{\"brightness\":1,\"color_mode\":\"rgb\",\"effect_list\":[\"a\",\"b\"],"
+                               "\"friendly_name\":\"Room\"}";
+    size_t applied = 0;
+    json_scan_iter_t it;
+    json_span_t key = {0};
+    json_span_t entry = {0};
+    json_scan_iter_begin(&it, &changed);
+    while (json_scan_object_next(&it, &key, &entry)) {
+        char entity_id[64];
+        char state[32];
+        json_span_t plus = {0};
+        json_span_t minus = {0};
+        json_span_t value = {0};
+        json_span_t attrs = {0};
+        json_span_t minus_keys = {0};
+        if (!json_span_copy_string(&key, entity_id, sizeof(entity_id)) || !json_scan_object_get(&entry, "+", &plus)) {
+            continue;
+        }
+        if (json_scan_object_get(&plus, "s", &value)) {
+            (void)json_span_copy_string(&value, state, sizeof(state));
+        }
+        (void)json_scan_object_get(&plus, "a", &attrs);
+        if (json_scan_object_get(&entry, "-", &minus)) {
+            (void)json_scan_object_get(&minus, "a", &minus_keys);
+        }
+        if (json_scan_merge_object(base, sizeof(base) - 1U, attrs.type == JSON_SPAN_OBJECT ? &attrs : NULL,
+                minus_keys.type == JSON_SPAN_ARRAY ? &minus_keys : NULL, merge_buf, merge_size)) {
+            applied++;
+        }
+    }
+    return applied;
+}
+
+/* Mirrors ha_client_stream_get_states_result: read each entity_id, keep one in BENCH_KEEP_EVERY. */
+static size_t walk_get_states(const char *frame, size_t len)
+{
+    json_span_t root = {0};
+    json_span_t result = {0};
+    if (!json_scan_value(frame, len, &root) || !json_scan_object_get(&root, "result", &result)) {
+        return 0;
+    }
+    size_t kept = 0;
+    size_t index = 0;
+    json_scan_iter_t it;
+    json_span_t state = {0};
+    json_scan_iter_begin(&it, &result);
+    while (json_scan_array_next(&it, &state)) {
+        json_span_t id = {0};
+        char entity_id[64];
+        json_span_t attrs = {0};
+        json_span_t name = {0};
+        char friendly[64];
+        if (!json_scan_object_get(&state, "entity_id", &id) || !json_span_copy_string(&id, entity_id, sizeof(entity_id))) {
+            continue;
+        }
+        if ((index++ % BENCH_KEEP_EVERY) == 0U) {
+            size_t raw_len = 0;
+            kept += (json_span_raw(&state, &raw_len) != NULL && raw_len > 0U) ? 1U : 0U;
+        } else if (json_scan_object_get(&state, "attributes", &attrs) &&
+                   json_scan_object_get(&attrs, "friendly_name", &name)) {
+            (void)json_span_copy_string(&name, friendly, sizeof(friendly));
+        }
+    }
+    return kept;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = host_bench_quick(argc, argv) ? 20 : 2000;
+    size_t frame_size = 256U * 1024U;
+    char *burst = malloc(frame_size);
+    char *states = malloc(frame_size);
+    char *merge_buf = malloc(4096);
+    if (burst == NULL || states == NULL || merge_buf == NULL) {
+        return EXIT_FAILURE;
+    }
+    size_t burst_len = build_burst(burst, frame_size);
+    size_t states_len = build_get_states(states, frame_size);
+    int failures = 0;
+
+    host_heap_trace_reset();
+    size_t applied = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        applied += walk_burst(burst, burst_len, merge_buf, 4096);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    host_heap_trace_t trace = host_heap_trace_get();
+    host_bench_report_mbps("subscribe_entities burst", burst_len, iterations, elapsed);
+    printf("  %d entities, %u applied per pass, heap allocs=%llu peak=%zu B\n", BENCH_BURST_ENTITIES,
+        (unsigned)(applied / (size_t)iterations), (unsigned long long)trace.alloc_calls, trace.peak_bytes);
+    failures += (applied != (size_t)iterations * BENCH_BURST_ENTITIES) || trace.alloc_calls != 0U;
+
+    host_heap_trace_reset();
+    size_t kept = 0;
+    start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        kept += walk_get_states(states, states_len);
+    }
+    elapsed = esp_timer_get_time() - start;
+    trace = host_heap_trace_get();
+    host_bench_report_mbps("get_states result", states_len, iterations, elapsed);
+    printf("  %d states, %u kept per pass, heap allocs=%llu peak=%zu B\n", BENCH_GET_STATES,
+        (unsigned)(kept / (size_t)iterations), (unsigned long long)trace.alloc_calls, trace.peak_bytes);
+    failures += (kept != (size_t)iterations * (BENCH_GET_STATES / BENCH_KEEP_EVERY)) || trace.alloc_calls != 0U;
+
+    /* Bracket matching alone, as run on every frame before anything is read from it. */
+    json_span_t span = {0};
+    bool valid = true;
+    start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        valid = valid && json_scan_value(states, states_len, &span);
+    }
+    elapsed = esp_timer_get_time() - start;
+    host_bench_report_mbps("validate only", states_len, iterations, elapsed);
+    failures += !valid;
+
+    free(burst);
+    free(states);
+    free(merge_buf);
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Benchmarks run a short pass under ctest (--quick) and the full iteration count when run by hand. */
+static inline bool host_bench_quick(int argc, char **argv)
+{
+    return argc > 1 && strcmp(argv[1], "--quick") == 0;
+}
+
+static inline void host_bench_report_mbps(const char *name, size_t bytes, int iterations, int64_t elapsed_us)
+{
+    double seconds = (elapsed_us > 0) ? (double)elapsed_us / 1e6 : 1e-6;
+    printf("%-28s %8.1f MB/s  (%zu B x %d in %.3f s)\n", name, (double)bytes * iterations / seconds / 1e6, bytes,
+        iterations, seconds);
+}
+
+static inline void host_bench_report_ns(const char *name, uint64_t ops, int64_t elapsed_us)
+{
+    double ns = (ops > 0U) ? (double)elapsed_us * 1000.0 / (double)ops : 0.0;
+    printf("%-28s %8.1f ns/op  (%llu ops)\n", name, ns, (unsigned long long)ops);
+}
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Minimal assertion helpers for the host tests: a failed CHECK reports and counts, and
+ * HOST_TEST_RESULT() turns the count into the process exit status for ctest. */
+static int s_host_test_failures = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            s_host_test_failures++;                                                 \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQ_U(actual, expected)                                                              \
+    do {                                                                                          \
+        unsigned long long a_ = (unsigned long long)(actual);                                     \
+        unsigned long long e_ = (unsigned long long)(expected);                                   \
+        if (a_ != e_) {                                                                           \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s = %llu, expected %llu\n", __FILE__, __LINE__, \
+                #actual, a_, e_);                                                                 \
+            s_host_test_failures++;                                                               \
+        }                                                                                         \
+    } while (0)
+
+#define HOST_TEST_RESULT()                                                   \
+    (s_host_test_failures == 0 ? (printf("ok\n"), EXIT_SUCCESS)              \
+                               : (fprintf(stderr, "%d failure(s)\n", s_host_test_failures), EXIT_FAILURE))
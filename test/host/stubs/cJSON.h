@@ -0,0 +1,37 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+/* Node layout and the read accessors ha_state_attrs needs to link. The host targets never parse into
+ * a tree, so there is no parser or printer here. */
+typedef int cJSON_bool;
+
+#define cJSON_Invalid (0)
+#define cJSON_False (1 << 0)
+#define cJSON_True (1 << 1)
+#define cJSON_NULL (1 << 2)
+#define cJSON_Number (1 << 3)
+#define cJSON_String (1 << 4)
+#define cJSON_Array (1 << 5)
+#define cJSON_Object (1 << 6)
+
+typedef struct cJSON {
+    struct cJSON *next;
+    struct cJSON *prev;
+    struct cJSON *child;
+    int type;
+    char *valuestring;
+    int valueint;
+    double valuedouble;
+    char *string;
+} cJSON;
+
+#define cJSON_ArrayForEach(element, array) \
+    for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+
+cJSON *cJSON_GetObjectItemCaseSensitive(const cJSON *const object, const char *const string);
+cJSON_bool cJSON_IsNumber(const cJSON *const item);
+cJSON_bool cJSON_IsString(const cJSON *const item);
+cJSON_bool cJSON_IsArray(const cJSON *const item);
+cJSON_bool cJSON_IsObject(const cJSON *const item);
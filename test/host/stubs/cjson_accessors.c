@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <string.h>
+
+#include "cJSON.h"
+
+cJSON *cJSON_GetObjectItemCaseSensitive(const cJSON *const object, const char *const string)
+{
+    if (object == NULL || string == NULL) {
+        return NULL;
+    }
+    for (cJSON *item = object->child; item != NULL; item = item->next) {
+        if (item->string != NULL && strcmp(item->string, string) == 0) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+cJSON_bool cJSON_IsNumber(const cJSON *const item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_Number;
+}
+
+cJSON_bool cJSON_IsString(const cJSON *const item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_String;
+}
+
+cJSON_bool cJSON_IsArray(const cJSON *const item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_Array;
+}
+
+cJSON_bool cJSON_IsObject(const cJSON *const item)
+{
+    return item != NULL && (item->type & 0xFF) == cJSON_Object;
+}
@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_SPIRAM (1U << 10)
+#define MALLOC_CAP_8BIT (1U << 2)
+#define MALLOC_CAP_INTERNAL (1U << 11)
+#define MALLOC_CAP_DEFAULT (1U << 12)
+
+/* Backed by the host allocator (host_stubs.c); caps are ignored. */
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdio.h>
+
+/* Warnings and errors go to stderr so failing cases keep their context; info and below are compiled
+ * (arguments stay used and format-checked) but never printed. */
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOG_QUIET(tag, fmt, ...)                                  \
+    do {                                                              \
+        if (0) {                                                      \
+            fprintf(stderr, "%s: " fmt "\n", tag, ##__VA_ARGS__);     \
+        }                                                             \
+    } while (0)
+#define ESP_LOGI(tag, fmt, ...) ESP_LOG_QUIET(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOG_QUIET(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_LOG_QUIET(tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,9 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdint.h>
+
+/* Monotonic microseconds (host_stubs.c). */
+int64_t esp_timer_get_time(void);
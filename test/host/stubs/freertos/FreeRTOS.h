@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stdint.h>
+
+/* Single-threaded host stand-ins: the tests drive producer and consumer from one thread. */
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define portMAX_DELAY 0xffffffffU
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+/* Task creation fails on the host, like the queues in freertos/queue.h. */
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio,
+    TaskHandle_t *out_handle);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "ha/ha_entity_catalog.h"
+#include "ha/ha_history.h"
+
+/* ha_model's calls into the editor catalog and the LittleFS-backed history are no-ops on the host. */
+esp_err_t ha_entity_catalog_init(void)
+{
+    return ESP_OK;
+}
+
+void ha_entity_catalog_reset(void)
+{
+}
+
+void ha_history_record_state(ha_entity_handle_t entity, const char *state_text)
+{
+    (void)entity;
+    (void)state_text;
+}
@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include "host_heap_trace.h"
+
+#include <malloc.h>
+
+/* Provided by the linker for -Wl,--wrap=<symbol>. */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static host_heap_trace_t s_trace = {0};
+
+static void host_heap_trace_add(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    s_trace.alloc_calls++;
+    s_trace.live_bytes += malloc_usable_size(ptr);
+    if (s_trace.live_bytes > s_trace.peak_bytes) {
+        s_trace.peak_bytes = s_trace.live_bytes;
+    }
+}
+
+static void host_heap_trace_sub(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    size_t bytes = malloc_usable_size(ptr);
+    s_trace.live_bytes = (bytes < s_trace.live_bytes) ? s_trace.live_bytes - bytes : 0;
+}
+
+void host_heap_trace_reset(void)
+{
+    s_trace.alloc_calls = 0;
+    s_trace.live_bytes = 0;
+    s_trace.peak_bytes = 0;
+}
+
+host_heap_trace_t host_heap_trace_get(void)
+{
+    return s_trace;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    host_heap_trace_add(ptr);
+    return ptr;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    void *ptr = __real_calloc(n, size);
+    host_heap_trace_add(ptr);
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    host_heap_trace_sub(ptr);
+    void *moved = __real_realloc(ptr, size);
+    host_heap_trace_add(moved != NULL ? moved : ptr);
+    return moved;
+}
+
+void __wrap_free(void *ptr)
+{
+    host_heap_trace_sub(ptr);
+    __real_free(ptr);
+}
@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap accounting for targets linked with host_heap_trace (malloc/calloc/realloc/free wrapped at
+ * link time). Counts every allocation made from the code under test since the last reset. */
+typedef struct {
+    uint64_t alloc_calls;
+    size_t live_bytes;
+    size_t peak_bytes;
+} host_heap_trace_t;
+
+void host_heap_trace_reset(void);
+host_heap_trace_t host_heap_trace_get(void);
@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <string.h>
+
+#include "ha/ha_attr_arena.h"
+#include "host_test.h"
+
+#define SMALL_LEN 20U /* header + blob + NUL lands in the 32-byte class */
+
+static char s_payload[APP_HA_ATTRS_MAX_LEN];
+
+static ha_attr_arena_stats_t stats(void)
+{
+    ha_attr_arena_stats_t out = {0};
+    ha_attr_arena_get_stats(&out);
+    return out;
+}
+
+/* Small blobs fill the whole arena and are then released: a full-size blob only fits after the
+ * free 32-byte blocks are merged back into bigger ones. */
+static void test_merge_after_small_blobs(void)
+{
+    static const void *blobs[APP_HA_ATTR_ARENA_BYTES / 32U];
+    size_t count = 0;
+    while (count < sizeof(blobs) / sizeof(blobs[0])) {
+        char tagged[SMALL_LEN];
+        memcpy(tagged, s_payload, sizeof(tagged));
+        snprintf(tagged, sizeof(tagged), "%05u", (unsigned)count);
+        blobs[count] = ha_attr_arena_store(tagged, SMALL_LEN);
+        if (blobs[count] == NULL) {
+            break;
+        }
+        count++;
+    }
+    CHECK_EQ_U(count, APP_HA_ATTR_ARENA_BYTES / 32U);
+    CHECK_EQ_U(stats().carved_bytes, APP_HA_ATTR_ARENA_BYTES);
+
+    /* Keep every 64th blob so the freed runs stay 2016 bytes long: none fits a 4 KiB blob on its own. */
+    for (size_t i = 0; i < count; i++) {
+        if (i % 64U != 63U) {
+            ha_attr_arena_release(blobs[i]);
+            blobs[i] = NULL;
+        }
+    }
+    uint32_t failures = stats().alloc_failures;
+    CHECK(ha_attr_arena_store(s_payload, 1500) != NULL);
+    CHECK_EQ_U(stats().merge_passes, 1);
+    CHECK(ha_attr_arena_store(s_payload, APP_HA_ATTRS_MAX_LEN) == NULL);
+    CHECK_EQ_U(stats().alloc_failures, failures + 1U);
+    /* Live blobs never move. */
+    for (size_t i = 63; i < count; i += 64U) {
+        char expected[8];
+        snprintf(expected, sizeof(expected), "%05u", (unsigned)i);
+        CHECK(strcmp((const char *)blobs[i], expected) == 0);
+    }
+
+    /* Dropping the pinned blobs lets the next merge rejoin whole runs, and the tail goes back to the
+     * bump pointer. */
+    for (size_t i = 0; i < count; i++) {
+        ha_attr_arena_release(blobs[i]);
+    }
+    const void *big = ha_attr_arena_store(s_payload, APP_HA_ATTRS_MAX_LEN);
+    CHECK(big != NULL);
+    CHECK_EQ_U(ha_attr_arena_blob_len(big), APP_HA_ATTRS_MAX_LEN);
+    CHECK(stats().carved_bytes < APP_HA_ATTR_ARENA_BYTES);
+}
+
+int main(void)
+{
+    memset(s_payload, 'x', sizeof(s_payload));
+    CHECK(ha_attr_arena_init() == ESP_OK);
+    test_merge_after_small_blobs();
+    return HOST_TEST_RESULT();
+}
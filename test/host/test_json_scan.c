@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <string.h>
+
+#include "host_test.h"
+#include "util/json_scan.h"
+
+static json_span_t scan(const char *text)
+{
+    json_span_t span = {0};
+    if (!json_scan_value(text, strlen(text), &span)) {
+        span.type = JSON_SPAN_INVALID;
+    }
+    return span;
+}
+
+/* Decodes the JSON string literal text (quotes included) into out. */
+static bool decode(const char *text, char *out, size_t out_size)
+{
+    json_span_t span = scan(text);
+    return span.type == JSON_SPAN_STRING && json_span_copy_string(&span, out, out_size);
+}
+
+static void test_value_types(void)
+{
+    CHECK_EQ_U(scan("  {\"a\":1} ").type, JSON_SPAN_OBJECT);
+    CHECK_EQ_U(scan("[1,2]").type, JSON_SPAN_ARRAY);
+    CHECK_EQ_U(scan("\"x\"").type, JSON_SPAN_STRING);
+    CHECK_EQ_U(scan("-12.5e3").type, JSON_SPAN_NUMBER);
+    CHECK_EQ_U(scan("true").type, JSON_SPAN_TRUE);
+    CHECK_EQ_U(scan("false").type, JSON_SPAN_FALSE);
+    CHECK_EQ_U(scan("null").type, JSON_SPAN_NULL);
+
+    json_span_t str = scan("\"a\\\"b\"");
+    CHECK_EQ_U(str.len, 4);
+    CHECK(memcmp(str.ptr, "a\\\"b", 4) == 0);
+
+    size_t raw_len = 0;
+    json_span_t obj = scan(" {\"k\": [1, {\"n\": null}]} tail");
+    const char *raw = json_span_raw(&obj, &raw_len);
+    CHECK(raw != NULL && raw_len == strlen("{\"k\": [1, {\"n\": null}]}"));
+    CHECK(raw != NULL && raw[0] == '{' && raw[raw_len - 1U] == '}');
+}
+
+static void test_escapes(void)
+{
+    char out[32];
+    CHECK(decode("\"q\\\"b\\\\s\\/\\b\\f\\n\\r\\t\"", out, sizeof(out)));
+    CHECK(strcmp(out, "q\"b\\s/\b\f\n\r\t") == 0);
+    CHECK(decode("\"\\u00e9\\u20AC\"", out, sizeof(out)));
+    CHECK(strcmp(out, "\xC3\xA9\xE2\x82\xAC") == 0);
+    /* Surrogate pair: one 4-byte sequence, not two 3-byte halves (CESU-8). */
+    CHECK(decode("\"\\uD83D\\uDE00\"", out, sizeof(out)));
+    CHECK(strcmp(out, "\xF0\x9F\x98\x80") == 0);
+    /* Lone surrogates and NUL become U+FFFD instead of cutting the copy short. */
+    CHECK(decode("\"a\\uD83Db\"", out, sizeof(out)));
+    CHECK(strcmp(out, "a\xEF\xBF\xBD" "b") == 0);
+    CHECK(decode("\"\\uDE00\"", out, sizeof(out)));
+    CHECK(strcmp(out, "\xEF\xBF\xBD") == 0);
+    CHECK(decode("\"x\\u0000y\"", out, sizeof(out)));
+    CHECK(strcmp(out, "x\xEF\xBF\xBDy") == 0);
+    /* High surrogate followed by a non-surrogate escape keeps the second code point. */
+    CHECK(decode("\"\\uD83D\\u0041\"", out, sizeof(out)));
+    CHECK(strcmp(out, "\xEF\xBF\xBD" "A") == 0);
+
+    CHECK(!decode("\"\\u12G4\"", out, sizeof(out)));
+    CHECK(!decode("\"\\u12\"", out, sizeof(out)));
+    /* Other escapes are lenient: the escaped character is kept. */
+    CHECK(decode("\"\\x\"", out, sizeof(out)));
+    CHECK(strcmp(out, "x") == 0);
+}
+
+static void test_copy_truncation(void)
+{
+    char out[8];
+    CHECK(decode("\"1234567\"", out, sizeof(out)));
+    CHECK(strcmp(out, "1234567") == 0);
+    memset(out, 'z', sizeof(out));
+    CHECK(!decode("\"12345678\"", out, sizeof(out)));
+    CHECK(memchr(out, '\0', sizeof(out)) != NULL);
+    /* A multi-byte sequence that does not fit is not split. */
+    char small[4];
+    memset(small, 'z', sizeof(small));
+    CHECK(!decode("\"ab\\u20AC\"", small, sizeof(small)));
+    CHECK(memchr(small, '\0', sizeof(small)) != NULL);
+    CHECK(strlen(small) <= 2U);
+}
+
+static void test_truncated_input(void)
+{
+    static const char *const truncated[] = {
+        "{\"a\":[1,2", "[1,2,", "\"abc", "\"ab\\", "{\"a\"", "{\"a\":", "tru", "nul", "", "   ",
+    };
+    for (size_t i = 0; i < sizeof(truncated) / sizeof(truncated[0]); i++) {
+        json_span_t span = {0};
+        bool ok = json_scan_value(truncated[i], strlen(truncated[i]), &span);
+        if (ok) {
+            fprintf(stderr, "accepted truncated input: '%s'\n", truncated[i]);
+        }
+        CHECK(!ok);
+    }
+    /* The length bounds the scan even when the buffer continues. */
+    const char *text = "{\"a\":1}";
+    json_span_t span = {0};
+    CHECK(!json_scan_value(text, 5, &span));
+    CHECK(json_scan_value(text, 7, &span));
+
+    CHECK_EQ_U(scan("[1,]").type, JSON_SPAN_ARRAY); /* bracket matching only bounds the span */
+    json_scan_iter_t it;
+    json_span_t value = {0};
+    json_span_t bad = scan("[1,}");
+    CHECK_EQ_U(bad.type, JSON_SPAN_INVALID);
+    json_span_t mismatched = scan("{\"a\":[1}]");
+    CHECK_EQ_U(mismatched.type, JSON_SPAN_INVALID);
+
+    /* Iterating a malformed member list stops and flags the iterator. */
+    json_span_t obj = scan("{\"a\" 1}");
+    CHECK(json_scan_iter_begin(&it, &obj));
+    json_span_t key = {0};
+    CHECK(!json_scan_object_next(&it, &key, &value));
+    CHECK(it.failed);
+}
+
+static void test_nesting_limit(void)
+{
+    char text[2 * (JSON_SCAN_MAX_DEPTH + 1) + 1];
+    for (size_t depth = JSON_SCAN_MAX_DEPTH; depth <= JSON_SCAN_MAX_DEPTH + 1U; depth++) {
+        memset(text, '[', depth);
+        memset(text + depth, ']', depth);
+        text[2U * depth] = '\0';
+        json_span_t span = {0};
+        bool ok = json_scan_value(text, 2U * depth, &span);
+        CHECK(ok == (depth <= JSON_SCAN_MAX_DEPTH));
+    }
+}
+
+static void test_iteration_and_lookup(void)
+{
+    json_span_t obj = scan("{\"id\": \"light.kitchen\", \"on\": true, \"n\": 42, \"big\": 4294967296, "
+                           "\"list\": [\"a\", 2, {\"x\": 1}], \"esc\\\"key\": 7}");
+    CHECK_EQ_U(obj.type, JSON_SPAN_OBJECT);
+
+    json_scan_iter_t it;
+    json_span_t key = {0};
+    json_span_t value = {0};
+    size_t members = 0;
+    CHECK(json_scan_iter_begin(&it, &obj));
+    while (json_scan_object_next(&it, &key, &value)) {
+        members++;
+    }
+    CHECK(!it.failed);
+    CHECK_EQ_U(members, 6);
+
+    CHECK(json_scan_object_get(&obj, "id", &value));
+    CHECK(json_span_equals(&value, "light.kitchen"));
+    CHECK(!json_span_equals(&value, "light.kitche"));
+    CHECK(json_scan_object_get(&obj, "on", &value) && json_span_is_true(&value));
+    uint32_t n = 0;
+    CHECK(json_scan_object_get(&obj, "n", &value) && json_span_to_u32(&value, &n) && n == 42U);
+    CHECK(json_scan_object_get(&obj, "big", &value) && !json_span_to_u32(&value, &n));
+    CHECK(!json_scan_object_get(&obj, "missing", &value));
+    CHECK(!json_scan_object_get(&obj, "x", &value)); /* nested keys are not direct members */
+
+    json_span_t list = {0};
+    CHECK(json_scan_object_get(&obj, "list", &list) && list.type == JSON_SPAN_ARRAY);
+    size_t items = 0;
+    CHECK(json_scan_iter_begin(&it, &list));
+    while (json_scan_array_next(&it, &value)) {
+        items++;
+    }
+    CHECK(!it.failed);
+    CHECK_EQ_U(items, 3);
+}
+
+static bool merge(const char *base, const char *plus, const char *minus, char *out, size_t out_size)
+{
+    json_span_t plus_span = {0};
+    json_span_t minus_span = {0};
+    if (plus != NULL) {
+        plus_span = scan(plus);
+    }
+    if (minus != NULL) {
+        minus_span = scan(minus);
+    }
+    return json_scan_merge_object(base, base != NULL ? strlen(base) : 0, plus != NULL ? &plus_span : NULL,
+        minus != NULL ? &minus_span : NULL, out, out_size);
+}
+
+static void test_merge_object(void)
+{
+    char out[128];
+    CHECK(merge("{\"brightness\": 10, \"effect_list\": [\"a\", \"b\"], \"mode\": \"x\"}",
+        "{\"brightness\": 200, \"rgb_color\": [255, 0, 0]}", "[\"effect_list\"]", out, sizeof(out)));
+    CHECK(strcmp(out, "{\"mode\":\"x\",\"brightness\":200,\"rgb_color\":[255, 0, 0]}") == 0);
+
+    CHECK(merge(NULL, "{\"a\":1}", NULL, out, sizeof(out)));
+    CHECK(strcmp(out, "{\"a\":1}") == 0);
+    CHECK(merge("", NULL, NULL, out, sizeof(out)));
+    CHECK(strcmp(out, "{}") == 0);
+    CHECK(merge("{\"a\":1,\"b\":2}", NULL, "[\"a\",\"b\",\"zzz\"]", out, sizeof(out)));
+    CHECK(strcmp(out, "{}") == 0);
+    /* Escaped keys are compared raw and copied verbatim. */
+    CHECK(merge("{\"q\\\"k\":1}", "{\"q\\\"k\":2}", NULL, out, sizeof(out)));
+    CHECK(strcmp(out, "{\"q\\\"k\":2}") == 0);
+
+    /* Exact fit, then one byte short. */
+    const char *expected = "{\"a\":1,\"b\":2}";
+    size_t need = strlen(expected) + 1U;
+    CHECK(merge("{\"a\":1}", "{\"b\":2}", NULL, out, need));
+    CHECK(strcmp(out, expected) == 0);
+    CHECK(!merge("{\"a\":1}", "{\"b\":2}", NULL, out, need - 1U));
+
+    /* Wrong shapes and malformed input are refused. */
+    CHECK(!merge("[1]", NULL, NULL, out, sizeof(out)));
+    CHECK(!merge("{\"a\":1}", "[1]", NULL, out, sizeof(out)));
+    CHECK(!merge("{\"a\":1}", NULL, "{\"a\":1}", out, sizeof(out)));
+    CHECK(!merge("{\"a\" 1}", NULL, NULL, out, sizeof(out)));
+}
+
+int main(void)
+{
+    test_value_types();
+    test_escapes();
+    test_copy_truncation();
+    test_truncated_input();
+    test_nesting_limit();
+    test_iteration_and_lookup();
+    test_merge_object();
+    return HOST_TEST_RESULT();
+}
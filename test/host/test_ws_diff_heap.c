@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "ha/ha_model.h"
+#include "host_heap_trace.h"
+#include "host_test.h"
+#include "util/json_scan.h"
+
+/* Heap trace of the steady-state subscribe_entities "c" path: the same steps
+ * ha_client_apply_ws_entity_diff takes (borrow the previous state, merge "+a"/"-a" into the reused
+ * scratch buffer, take "+s", upsert and extract typed attributes from the text) must not allocate. */
+
+#define LIGHT_ID "light.living_room"
+#define DIFF_UPDATES 100
+
+static const char s_light_attrs[] =
+    "{\"min_color_temp_kelvin\":2000,\"max_color_temp_kelvin\":6535,\"supported_color_modes\":[\"rgb\"],"
+    "\"color_mode\":\"rgb\",\"brightness\":10,\"rgb_color\":[255,255,255],\"effect_list\":[\"none\",\"rainbow\"],"
+    "\"effect\":\"none\",\"friendly_name\":\"Living room\",\"supported_features\":44}";
+
+/* Applies one "c" entry; returns whether the model stored something new. */
+static bool apply_diff(ha_entity_handle_t entity, const char *entry_text, char *scratch, int64_t now_ms)
+{
+    json_span_t entry = {0};
+    json_span_t plus = {0};
+    json_span_t minus = {0};
+    json_span_t plus_state = {0};
+    json_span_t plus_attrs = {0};
+    json_span_t minus_keys = {0};
+    CHECK(json_scan_value(entry_text, strlen(entry_text), &entry));
+    if (json_scan_object_get(&entry, "+", &plus)) {
+        (void)json_scan_object_get(&plus, "s", &plus_state);
+        (void)json_scan_object_get(&plus, "a", &plus_attrs);
+    }
+    if (json_scan_object_get(&entry, "-", &minus)) {
+        (void)json_scan_object_get(&minus, "a", &minus_keys);
+    }
+
+    ha_state_t next = {0};
+    next.entity = entity;
+    ha_model_state_ref_t prev = {0};
+    CHECK(ha_model_borrow_state(entity, &prev));
+    snprintf(next.state, sizeof(next.state), "%s", prev.state->state);
+    next.last_changed_unix_ms = prev.state->last_changed_unix_ms;
+    const char *base = prev.state->attributes_json;
+    bool merged = json_scan_merge_object(base, strlen(base),
+        plus_attrs.type == JSON_SPAN_OBJECT ? &plus_attrs : NULL,
+        minus_keys.type == JSON_SPAN_ARRAY ? &minus_keys : NULL, scratch, APP_HA_ATTRS_MAX_LEN);
+    ha_model_release_state(&prev);
+    CHECK(merged);
+
+    char new_state[sizeof(next.state)] = {0};
+    if (plus_state.type == JSON_SPAN_STRING && json_span_copy_string(&plus_state, new_state, sizeof(new_state)) &&
+        strcmp(new_state, next.state) != 0) {
+        memcpy(next.state, new_state, sizeof(next.state));
+        next.last_changed_unix_ms = now_ms;
+    }
+    next.attributes_json = scratch;
+    bool stored = false;
+    CHECK(ha_model_upsert_state_changed(&next, &stored) == ESP_OK);
+    return stored;
+}
+
+int main(void)
+{
+    CHECK(ha_model_init() == ESP_OK);
+    char *scratch = malloc(APP_HA_ATTRS_MAX_LEN);
+    CHECK(scratch != NULL);
+
+    ha_state_t initial = {0};
+    initial.entity = ha_model_intern_entity_id(LIGHT_ID);
+    strcpy(initial.state, "off");
+    initial.attributes_json = s_light_attrs;
+    initial.last_changed_unix_ms = 1;
+    CHECK(ha_model_upsert_state(&initial) == ESP_OK);
+
+    /* Warm both slot buffers so the arena has blocks of the steady-state size to recycle. */
+    char entry[256];
+    for (int i = 0; i < 4; i++) {
+        snprintf(entry, sizeof(entry), "{\"+\":{\"a\":{\"brightness\":%d}}}", 20 + i);
+        CHECK(apply_diff(initial.entity, entry, scratch, 2));
+    }
+
+    host_heap_trace_reset();
+    int stored_count = 0;
+    for (int i = 0; i < DIFF_UPDATES; i++) {
+        snprintf(entry, sizeof(entry),
+            "{\"+\":{\"s\":\"%s\",\"a\":{\"brightness\":%d,\"rgb_color\":[255,%d,0]}},\"-\":{\"a\":[\"effect_list\"]}}",
+            (i & 1) ? "off" : "on", 100 + i, i);
+        stored_count += apply_diff(initial.entity, entry, scratch, 1000 + i);
+    }
+    host_heap_trace_t trace = host_heap_trace_get();
+    printf("%d diff updates: %llu allocations, peak %zu B\n", DIFF_UPDATES, (unsigned long long)trace.alloc_calls,
+        trace.peak_bytes);
+    CHECK_EQ_U(trace.alloc_calls, 0);
+    CHECK_EQ_U(stored_count, DIFF_UPDATES);
+
+    /* Result matches the merge: replaced and added members follow the kept ones, effect_list is gone. */
+    ha_model_state_ref_t ref = {0};
+    CHECK(ha_model_borrow_state(initial.entity, &ref));
+    CHECK(strcmp(ref.state->state, "off") == 0);
+    CHECK(strstr(ref.state->attributes_json, "effect_list") == NULL);
+    CHECK(strstr(ref.state->attributes_json, "\"brightness\":199,\"rgb_color\":[255,99,0]") != NULL);
+    CHECK(strstr(ref.state->attributes_json, "\"friendly_name\":\"Living room\"") != NULL);
+    CHECK((ref.state->attrs.present & HA_ATTR_BRIGHTNESS) != 0U);
+    CHECK(ref.state->attrs.brightness == 199.0f);
+    CHECK_EQ_U(ref.state->last_changed_unix_ms, 1000 + DIFF_UPDATES - 1);
+    ha_model_release_state(&ref);
+
+    /* An attribute-only diff keeps last_changed; repeating it stores nothing. */
+    snprintf(entry, sizeof(entry), "{\"+\":{\"s\":\"off\",\"a\":{\"brightness\":7}}}");
+    CHECK(apply_diff(initial.entity, entry, scratch, 5000));
+    CHECK(!apply_diff(initial.entity, entry, scratch, 6000));
+    ha_state_t out = {0};
+    CHECK(ha_model_get_state(LIGHT_ID, &out));
+    CHECK_EQ_U(out.last_changed_unix_ms, 1000 + DIFF_UPDATES - 1);
+    CHECK(out.attrs.brightness == 7.0f);
+
+    free(scratch);
+    return HOST_TEST_RESULT();
+}
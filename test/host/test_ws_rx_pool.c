@@ -0,0 +1,160 @@
+/* SPDX-License-Identifier: LicenseRef-FNCL-1.1
+ * Copyright (c) 2026 Christopher Gleiche
+ */
+#include <string.h>
+
+#include "ha/ha_ws_rx_pool.h"
+#include "host_test.h"
+
+/* Stand-in for the client's ws_rx_queue: FIFO of leases, oldest at index 0. */
+#define TEST_QUEUE_LEN 16
+
+static ha_ws_rx_lease_t s_queue[TEST_QUEUE_LEN];
+static int s_queued = 0;
+
+static size_t slabs_len(unsigned slabs)
+{
+    return (size_t)slabs * APP_HA_WS_RX_SLAB_SIZE - 1U;
+}
+
+static uint32_t slabs_in_use(void)
+{
+    ha_ws_rx_pool_stats_t stats;
+    ha_ws_rx_pool_get_stats(&stats);
+    return stats.slabs_in_use;
+}
+
+static void queue_push(const ha_ws_rx_lease_t *lease)
+{
+    s_queue[s_queued++] = *lease;
+}
+
+/* Mirrors ha_client_reserve_ws_rx: evict the oldest queued frame until the new one fits, unless
+ * eviction cannot help. Returns the number of frames evicted, or -1 when the frame was dropped. */
+static int reserve_evicting(size_t len, ha_ws_rx_lease_t *out)
+{
+    int evicted = 0;
+    while (!ha_ws_rx_pool_reserve(len, out)) {
+        if (s_queued == 0 || !ha_ws_rx_pool_eviction_can_fit(&s_queue[0], len)) {
+            ha_ws_rx_pool_note_drop_full();
+            return -1;
+        }
+        ha_ws_rx_lease_t dropped = s_queue[0];
+        memmove(&s_queue[0], &s_queue[1], (size_t)(s_queued - 1) * sizeof(s_queue[0]));
+        s_queued--;
+        ha_ws_rx_pool_release(&dropped);
+        ha_ws_rx_pool_note_drop_oldest();
+        evicted++;
+    }
+    return evicted;
+}
+
+static void release_queue(void)
+{
+    while (s_queued > 0) {
+        ha_ws_rx_pool_release(&s_queue[--s_queued]);
+    }
+}
+
+/* A held 40-slab tail frame plus three 20-slab queued frames, then a 40-slab reserve: every evicted
+ * run at the newest end must go back to the head, so the ring counts only live slabs. */
+static void test_evict_behind_held_tail(void)
+{
+    ha_ws_rx_lease_t held;
+    ha_ws_rx_lease_t lease;
+    CHECK(ha_ws_rx_pool_reserve(slabs_len(40), &held));
+    for (int i = 0; i < 3; i++) {
+        CHECK(ha_ws_rx_pool_reserve(slabs_len(20), &lease));
+        queue_push(&lease);
+    }
+    CHECK_EQ_U(slabs_in_use(), 100);
+
+    ha_ws_rx_lease_t fresh;
+    CHECK_EQ_U(reserve_evicting(slabs_len(40), &fresh), 3);
+    CHECK_EQ_U(fresh.slab_span, 40);
+    CHECK_EQ_U(fresh.first_slab, 40);
+    CHECK_EQ_U(slabs_in_use(), 80);
+
+    ha_ws_rx_pool_release(&held);
+    CHECK_EQ_U(slabs_in_use(), 40);
+    ha_ws_rx_pool_release(&fresh);
+    CHECK_EQ_U(slabs_in_use(), 0);
+}
+
+/* When the held tail frame leaves too little room beside it, the queue is left alone. */
+static void test_futile_eviction_drops_new_frame(void)
+{
+    ha_ws_rx_lease_t filler;
+    ha_ws_rx_lease_t held;
+    ha_ws_rx_lease_t lease;
+    CHECK(ha_ws_rx_pool_reserve(slabs_len(30), &filler));
+    CHECK(ha_ws_rx_pool_reserve(slabs_len(60), &held));
+    ha_ws_rx_pool_release(&filler);
+    for (int i = 0; i < 2; i++) {
+        CHECK(ha_ws_rx_pool_reserve(slabs_len(15), &lease));
+        queue_push(&lease);
+    }
+    CHECK_EQ_U(slabs_in_use(), 90);
+
+    /* 38 slabs beside the held run, split 8 + 30 across the ring end: 40 can never fit. */
+    ha_ws_rx_lease_t fresh;
+    CHECK(reserve_evicting(slabs_len(40), &fresh) < 0);
+    CHECK_EQ_U(s_queued, 2);
+    ha_ws_rx_pool_stats_t stats;
+    ha_ws_rx_pool_get_stats(&stats);
+    CHECK_EQ_U(stats.dropped_oldest, 3); /* from the previous case only */
+    CHECK_EQ_U(stats.dropped_full, 1);
+
+    CHECK_EQ_U(reserve_evicting(slabs_len(8), &fresh), 0);
+    ha_ws_rx_pool_release(&fresh);
+    release_queue();
+    CHECK_EQ_U(slabs_in_use(), 60);
+    ha_ws_rx_pool_release(&held);
+    CHECK_EQ_U(slabs_in_use(), 0);
+}
+
+/* Once the consumer is done with the tail frame, evicting from the queue front advances the tail. */
+static void test_evict_after_tail_released(void)
+{
+    ha_ws_rx_lease_t lease;
+    for (int i = 0; i < 4; i++) {
+        CHECK(ha_ws_rx_pool_reserve(slabs_len(30), &lease));
+        queue_push(&lease);
+    }
+    ha_ws_rx_lease_t fresh;
+    CHECK_EQ_U(reserve_evicting(slabs_len(60), &fresh), 2);
+    CHECK_EQ_U(fresh.slab_span, 68);
+    CHECK_EQ_U(slabs_in_use(), 128);
+    release_queue();
+    ha_ws_rx_pool_release(&fresh);
+    CHECK_EQ_U(slabs_in_use(), 0);
+}
+
+/* A run that has to skip the ring end folds the padding into its span and still gives it all back. */
+static void test_wrap_padding(void)
+{
+    ha_ws_rx_lease_t a;
+    ha_ws_rx_lease_t b;
+    ha_ws_rx_lease_t c;
+    CHECK(ha_ws_rx_pool_reserve(slabs_len(60), &a));
+    CHECK(ha_ws_rx_pool_reserve(slabs_len(60), &b));
+    ha_ws_rx_pool_release(&a);
+    CHECK(ha_ws_rx_pool_reserve(slabs_len(30), &c));
+    CHECK_EQ_U(c.slab_span, 38);
+    CHECK(c.data == b.data - (size_t)60 * APP_HA_WS_RX_SLAB_SIZE);
+    CHECK_EQ_U(slabs_in_use(), 98);
+    ha_ws_rx_pool_release(&b);
+    ha_ws_rx_pool_release(&c);
+    CHECK_EQ_U(slabs_in_use(), 0);
+}
+
+int main(void)
+{
+    CHECK(ha_ws_rx_pool_init() == ESP_OK);
+    test_evict_behind_held_tail();
+    test_futile_eviction_drops_new_frame();
+    test_evict_after_tail_released();
+    test_wrap_padding();
+    ha_ws_rx_pool_deinit();
+    return HOST_TEST_RESULT();
+}